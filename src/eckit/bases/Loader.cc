@@ -8,6 +8,8 @@
  * does it submit to any jurisdiction.
  */
 
+#include <atomic>
+
 #include "eckit/bases/Loader.h"
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -16,11 +18,32 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+static std::atomic<bool> started_(false);
+
 Loader::Loader() :
-    ClassExtent<Loader>(this) {}
+    ClassExtent<Loader>(this), executed_(false) {}
 
 Loader::~Loader() {}
 
+void Loader::executeAll() {
+    started_ = true;
+    callAll(&Loader::executeOnce);
+}
+
+void Loader::executePending() {
+    if (started_) {
+        callAll(&Loader::executeOnce);
+    }
+}
+
+// Called with the lock of the extent held, so that a loader is only executed once
+void Loader::executeOnce() {
+    if (!executed_) {
+        executed_ = true;
+        execute();
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit
@@ -32,8 +32,20 @@ public:  // methods
 
     virtual void execute() = 0;
 
+    /// Executes the loaders, each once, called by Main once the libraries and plugins are loaded
+    static void executeAll();
+
+    /// Executes the loaders created since executeAll(), such as those of plugins loaded on first use.
+    /// Does nothing before executeAll() is called.
+    static void executePending();
+
 private:  // methods
           // There is no private copy constructor as this will confuse g++ 4.x.x
+
+    void executeOnce();
+
+private:  // members
+    bool executed_;
 };
 
 
@@ -0,0 +1,87 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/cmd/ProfileCmd.h"
+
+#include "eckit/cmd/Arg.h"
+#include "eckit/cmd/CmdArg.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/os/SamplingProfiler.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ProfileCmd::ProfileCmd() :
+    CmdResource("profile") {}
+
+ProfileCmd::~ProfileCmd() {}
+
+void ProfileCmd::execute(std::istream&, std::ostream& out, CmdArg& arg) {
+    SamplingProfiler& profiler = SamplingProfiler::instance();
+
+    std::string action = arg.exists(1) ? std::string(arg[1]) : std::string("status");
+
+    if (action == "start") {
+        profiler.start();
+    }
+    else if (action == "stop") {
+        profiler.stop();
+    }
+    else if (action == "allocations") {
+        profiler.startAllocations();
+    }
+    else if (action == "clear") {
+        profiler.clear();
+    }
+    else if (action == "cpu") {
+        profiler.folded(out, SamplingProfiler::CPU);
+        return;
+    }
+    else if (action == "memory") {
+        profiler.folded(out, SamplingProfiler::ALLOCATIONS);
+        return;
+    }
+    else if (action == "save") {
+        if (!arg.exists(2)) {
+            out << "profile save: a file name is required" << std::endl;
+            return;
+        }
+        PathName path = std::string(arg[2]);
+        profiler.save(path, SamplingProfiler::CPU);
+        out << "CPU profile saved to " << path << std::endl;
+        return;
+    }
+    else if (action != "status") {
+        out << "profile: unknown action '" << action << "'" << std::endl;
+        return;
+    }
+
+    out << "Profiler " << (profiler.running() ? "running" : "stopped") << ", "
+        << profiler.samples(SamplingProfiler::CPU) << " CPU samples (" << profiler.lost(SamplingProfiler::CPU)
+        << " lost), " << profiler.samples(SamplingProfiler::ALLOCATIONS) << " allocation samples" << std::endl;
+}
+
+void ProfileCmd::help(std::ostream& out) const {
+    out << "profile [status|start|stop|clear|allocations|cpu|memory|save <file>]: control the sampling profiler, "
+           "print the CPU or allocation (memory) profile as folded stacks, or save the CPU profile "
+           "(pprof format if the file name ends in .prof)";
+}
+
+Arg ProfileCmd::usage(const std::string& cmd) const {
+    return ~(Arg("<action>", Arg::text) + ~Arg("<file>", Arg::text));
+}
+
+static ProfileCmd profileCmd;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,43 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ProfileCmd.h
+/// @date   Oct 2026
+
+#ifndef eckit_cmd_ProfileCmd_H
+#define eckit_cmd_ProfileCmd_H
+
+#include "eckit/cmd/CmdResource.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Controls the SamplingProfiler of a running process
+class ProfileCmd : public CmdResource {
+public:
+    ProfileCmd();
+
+    ~ProfileCmd() override;
+
+private:
+    void execute(std::istream&, std::ostream&, CmdArg&) override;
+
+    void help(std::ostream&) const override;
+    Arg usage(const std::string& cmd) const override;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -15,9 +15,11 @@
 // #include <limits>  // for std::numeric_limits
 #include <sstream>
 
+#include "eckit/eckit.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/geometry/Point2.h"
 #include "eckit/geometry/Point3.h"
+#include "eckit/geometry/detail/Trigonometry.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -43,6 +45,9 @@ static std::streamsize max_digits10 = 15 + 3;
 
 // C++-11: std::numeric_limits<double>::max_digits10;
 
+// batches smaller than this are not worth distributing to threads
+constexpr size_t parallel_threshold = 16384;
+
 }  // namespace
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -78,6 +83,41 @@ void EllipsoidOfRevolution::convertSphericalToCartesian(const double& a, const d
     B[2] = (N_phi * (b * b) / (a * a) + height) * sin_phi;
 }
 
+void EllipsoidOfRevolution::convertSphericalToCartesian(const double& a, const double& b, size_t n, const double lon[],
+                                                        const double lat[], double x[], double y[], double z[],
+                                                        double height) {
+    ASSERT(a > 0.);
+    ASSERT(b > 0.);
+
+    // checked first, as exceptions cannot leave a parallel region
+    for (size_t i = 0; i < n; ++i) {
+        if (!(-90. <= lat[i] && lat[i] <= 90.)) {
+            std::ostringstream oss;
+            oss.precision(max_digits10);
+            oss << "Invalid latitude " << lat[i];
+            throw BadValue(oss.str(), Here());
+        }
+    }
+
+    const double aa = a * a;
+    const double bb = b * b;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for simd if (n > parallel_threshold)
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        double sin_phi, cos_phi, sin_lambda, cos_lambda;
+        detail::sincosd(lat[i], sin_phi, cos_phi);
+        detail::sincosd(lon[i], sin_lambda, cos_lambda);
+
+        const double N_phi = aa / std::sqrt(aa * cos_phi * cos_phi + bb * sin_phi * sin_phi);
+
+        x[i] = (N_phi + height) * cos_phi * cos_lambda;
+        y[i] = (N_phi + height) * cos_phi * sin_lambda;
+        z[i] = (N_phi * bb / aa + height) * sin_phi;
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::geometry
@@ -11,6 +11,8 @@
 #ifndef EllipsoidOfRevolution_H
 #define EllipsoidOfRevolution_H
 
+#include <cstddef>
+
 //------------------------------------------------------------------------------------------------------
 
 namespace eckit::geometry {
@@ -26,6 +28,12 @@ struct EllipsoidOfRevolution {
     // Convert elliptic coordinates to Cartesian
     static void convertSphericalToCartesian(const double& radiusA, const double& radiusB, const Point2& Alonlat,
                                             Point3& B, double height = 0.);
+
+    // Convert elliptic coordinates to Cartesian, for n points given as arrays of coordinates, vectorised and in
+    // parallel if OpenMP is available
+    static void convertSphericalToCartesian(const double& radiusA, const double& radiusB, size_t n, const double lon[],
+                                            const double lat[], double x[], double y[], double z[],
+                                            double height = 0.);
 };
 
 //------------------------------------------------------------------------------------------------------
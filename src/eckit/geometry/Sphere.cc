@@ -16,10 +16,12 @@
 #include <limits>
 #include <sstream>
 
+#include "eckit/eckit.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/geometry/GreatCircle.h"
 #include "eckit/geometry/Point2.h"
 #include "eckit/geometry/Point3.h"
+#include "eckit/geometry/detail/Trigonometry.h"
 #include "eckit/types/FloatCompare.h"
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -48,6 +50,20 @@ inline double squared(double x) {
     return x * x;
 }
 
+// batches smaller than this are not worth distributing to threads
+static constexpr size_t parallel_threshold = 16384;
+
+static void check_latitudes(size_t n, const double lat[]) {
+    for (size_t i = 0; i < n; ++i) {
+        if (!(-90. <= lat[i] && lat[i] <= 90.)) {
+            std::ostringstream oss;
+            oss.precision(max_digits10);
+            oss << "Invalid latitude " << lat[i];
+            throw BadValue(oss.str(), Here());
+        }
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 double Sphere::centralAngle(const Point2& Alonlat, const Point2& Blonlat) {
@@ -227,4 +243,75 @@ void Sphere::convertCartesianToSpherical(const double& radius, const Point3& A,
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void Sphere::centralAngle(size_t n, const double Alon[], const double Alat[], const double Blon[],
+                          const double Blat[], double angle[]) {
+    // exceptions cannot leave a parallel region
+    check_latitudes(n, Alat);
+    check_latitudes(n, Blat);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for simd if (n > parallel_threshold)
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        double sin_phi1, cos_phi1, sin_phi2, cos_phi2, sin_lambda, cos_lambda;
+        detail::sincosd(Alat[i], sin_phi1, cos_phi1);
+        detail::sincosd(Blat[i], sin_phi2, cos_phi2);
+        detail::sincosd(Blon[i] - Alon[i], sin_lambda, cos_lambda);
+
+        const double a = std::atan2(
+            std::sqrt(squared(cos_phi2 * sin_lambda) + squared(cos_phi1 * sin_phi2 - sin_phi1 * cos_phi2 * cos_lambda)),
+            sin_phi1 * sin_phi2 + cos_phi1 * cos_phi2 * cos_lambda);
+
+        angle[i] = types::is_approximately_equal(a, 0.) ? 0. : a;
+    }
+}
+
+void Sphere::distance(const double& radius, size_t n, const double Alon[], const double Alat[], const double Blon[],
+                      const double Blat[], double distance[]) {
+    centralAngle(n, Alon, Alat, Blon, Blat, distance);
+
+    const double r = radius;
+    for (size_t i = 0; i < n; ++i) {
+        distance[i] *= r;
+    }
+}
+
+void Sphere::convertSphericalToCartesian(const double& radius, size_t n, const double lon[], const double lat[],
+                                         double x[], double y[], double z[], double height) {
+    ASSERT(radius > 0.);
+    check_latitudes(n, lat);
+
+    const double r = radius + height;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for simd if (n > parallel_threshold)
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        double sin_phi, cos_phi, sin_lambda, cos_lambda;
+        detail::sincosd(lat[i], sin_phi, cos_phi);
+        detail::sincosd(lon[i], sin_lambda, cos_lambda);
+
+        x[i] = r * cos_phi * cos_lambda;
+        y[i] = r * cos_phi * sin_lambda;
+        z[i] = r * sin_phi;
+    }
+}
+
+void Sphere::convertCartesianToSpherical(const double& radius, size_t n, const double x[], const double y[],
+                                         const double z[], double lon[], double lat[]) {
+    ASSERT(radius > 0.);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for if (n > parallel_threshold)
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        Point2 P;
+        convertCartesianToSpherical(radius, Point3(x[i], y[i], z[i]), P);
+        lon[i] = P[0];
+        lat[i] = P[1];
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::geometry
@@ -11,6 +11,8 @@
 #ifndef Sphere_H
 #define Sphere_H
 
+#include <cstddef>
+
 //------------------------------------------------------------------------------------------------------
 
 namespace eckit::geometry {
@@ -56,6 +58,26 @@ struct Sphere {
 
     // Convert Cartesian coordinates to spherical
     static void convertCartesianToSpherical(const double& radius, const Point3& A, Point2& Blonlat);
+
+    // -- Batch versions, over n points given as arrays of coordinates, vectorised and in parallel if OpenMP is
+    //    available. Sines and cosines are computed by polynomials (see detail/Trigonometry.h), which are exact at the
+    //    poles and quadrants and otherwise agree with the single-point versions to 1e-14 (relative)
+
+    /// Great-circle central angles between pairs of points A[i], B[i] (latitude/longitude coordinates) in radians
+    static void centralAngle(size_t n, const double Alon[], const double Alat[], const double Blon[],
+                             const double Blat[], double angle[]);
+
+    /// Great-circle distances between pairs of points A[i], B[i] (latitude/longitude coordinates) in metres
+    static void distance(const double& radius, size_t n, const double Alon[], const double Alat[], const double Blon[],
+                         const double Blat[], double distance[]);
+
+    // Convert spherical coordinates to Cartesian
+    static void convertSphericalToCartesian(const double& radius, size_t n, const double lon[], const double lat[],
+                                            double x[], double y[], double z[], double height = 0.);
+
+    // Convert Cartesian coordinates to spherical
+    static void convertCartesianToSpherical(const double& radius, size_t n, const double x[], const double y[],
+                                            const double z[], double lon[], double lat[]);
 };
 
 //------------------------------------------------------------------------------------------------------
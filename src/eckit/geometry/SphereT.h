@@ -74,6 +74,28 @@ struct SphereT {
     inline static void convertCartesianToSpherical(const Point3& A, Point2& Blonlat) {
         Sphere::convertCartesianToSpherical(DATUM::radius(), A, Blonlat);
     }
+
+    // -- Batch versions, see Sphere
+
+    inline static void centralAngle(size_t n, const double Alon[], const double Alat[], const double Blon[],
+                                    const double Blat[], double angle[]) {
+        Sphere::centralAngle(n, Alon, Alat, Blon, Blat, angle);
+    }
+
+    inline static void distance(size_t n, const double Alon[], const double Alat[], const double Blon[],
+                                const double Blat[], double distance[]) {
+        Sphere::distance(DATUM::radius(), n, Alon, Alat, Blon, Blat, distance);
+    }
+
+    inline static void convertSphericalToCartesian(size_t n, const double lon[], const double lat[], double x[],
+                                                   double y[], double z[], double height = 0.) {
+        Sphere::convertSphericalToCartesian(DATUM::radius(), n, lon, lat, x, y, z, height);
+    }
+
+    inline static void convertCartesianToSpherical(size_t n, const double x[], const double y[], const double z[],
+                                                   double lon[], double lat[]) {
+        Sphere::convertCartesianToSpherical(DATUM::radius(), n, x, y, z, lon, lat);
+    }
 };
 
 //------------------------------------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#pragma once
+
+#include <cmath>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace eckit::geometry::detail {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Nearest integer (ties to even) for |x| < 2^51, by additions only so that it vectorises without SSE4.1
+inline double round_integer(double x) {
+    constexpr double magic = 6755399441055744.;  // 2^52 + 2^51
+    return (x + magic) - magic;
+}
+
+/// Sine and cosine of an angle in degrees, without branches nor calls, so that loops over arrays can be vectorised.
+///
+/// The angle is reduced to [-45°, 45°] by the nearest multiple of 90°, which is exact (Sterbenz), so that multiples of
+/// 90° give exact results. The Cephes minimax polynomials then have a relative error of about 1 ulp, and unlike
+/// sqrt(1 - sin^2), keep their accuracy near the zeros of the cosine (the poles).
+inline void sincosd(double degrees, double& s, double& c) {
+    constexpr double degrees_to_radians = M_PI / 180.;
+
+    const double q = round_integer(degrees * (1. / 90.));
+    const double x = (degrees - 90. * q) * degrees_to_radians;
+    const double z = x * x;
+
+    const double sx = x + x * z * (((((1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) * z
+                                      + 2.75573136213857245213e-6) * z - 1.98412698295895385996e-4) * z
+                                    + 8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+
+    const double cx = 1. - 0.5 * z + z * z * (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) * z
+                                                 - 2.75573141792967388112e-7) * z + 2.48015872888517045348e-5) * z
+                                               - 1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+
+    // quadrant q mod 4 = 2h + o, selected by arithmetic rather than branches, which mispredict on random angles
+    double quadrant = q - 4. * round_integer(0.25 * q);
+    quadrant += 4. * double(quadrant < 0.);
+
+    const double h    = double(quadrant >= 2.);
+    const double o    = quadrant - 2. * h;
+    const double sign = 1. - 2. * h;
+
+    s = sign * ((1. - o) * sx + o * cx);
+    c = sign * ((1. - o) * cx - o * sx);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::geometry::detail
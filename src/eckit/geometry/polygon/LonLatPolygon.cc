@@ -10,9 +10,13 @@
 
 #include "eckit/geometry/polygon/LonLatPolygon.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <ostream>
 
+#include "eckit/eckit.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/types/FloatCompare.h"
 
@@ -88,6 +92,57 @@ LonLatPolygon::LonLatPolygon(const std::vector<Point2>& points, bool includePole
     ASSERT(is_approximately_greater_or_equal(90, max_[LAT]));
 
     quickCheckLongitude_ = is_approximately_greater_or_equal(360, max_[LON] - min_[LON]);
+
+    index();
+}
+
+void LonLatPolygon::index() {
+    ASSERT(size() <= std::numeric_limits<std::uint32_t>::max());
+
+    // Aim for a few edges per band, with the long edges (listed in each band they span) taking at most ~8x the
+    // storage of the edges
+
+    const size_t edges  = size() - 1;
+    const double height = max_[LAT] - min_[LAT];
+
+    size_t bands = 1;
+    if (height > 0 && edges > 16) {
+        double extent = 0;
+        for (size_t i = 1; i < size(); ++i) {
+            extent += std::abs(operator[](i)[LAT] - operator[](i - 1)[LAT]) / height;
+        }
+        bands = std::max<size_t>(1, size_t(std::min(double(edges), 7. * double(edges) / std::max(extent, 1.))));
+    }
+
+    bandScale_ = height > 0 ? double(bands) / height : 0;
+    bandStart_.assign(bands + 1, 0);
+
+    for (size_t i = 1; i < size(); ++i) {
+        const auto lat = std::minmax(operator[](i - 1)[LAT], operator[](i)[LAT]);
+        for (size_t b = band(lat.first), last = band(lat.second); b <= last; ++b) {
+            ++bandStart_[b + 1];
+        }
+    }
+
+    for (size_t b = 0; b < bands; ++b) {
+        bandStart_[b + 1] += bandStart_[b];
+    }
+
+    bandEdges_.resize(bandStart_.back());
+
+    std::vector<size_t> next(bandStart_.begin(), bandStart_.end() - 1);
+    for (size_t i = 1; i < size(); ++i) {
+        const auto lat = std::minmax(operator[](i - 1)[LAT], operator[](i)[LAT]);
+        for (size_t b = band(lat.first), last = band(lat.second); b <= last; ++b) {
+            bandEdges_[next[b]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+}
+
+size_t LonLatPolygon::band(double lat) const {
+    // monotonic, so that an edge spanning lat is listed in band(lat)
+    const double b = (lat - min_[LAT]) * bandScale_;
+    return b <= 0 ? 0 : std::min(bandStart_.size() - 2, size_t(b));
 }
 
 void LonLatPolygon::print(std::ostream& out) const {
@@ -106,10 +161,31 @@ std::ostream& operator<<(std::ostream& out, const LonLatPolygon& pc) {
 }
 
 bool LonLatPolygon::contains(const Point2& P) const {
-    auto lat = P[LAT];
-    ASSERT(-90 <= lat && lat <= 90);
+    ASSERT(-90 <= P[LAT] && P[LAT] <= 90);
+    return containsLonLat(P[LON], P[LAT]);
+}
+
+void LonLatPolygon::contains(const Point2* points, size_t n, bool* result) const {
+    // checked first, as exceptions cannot leave a parallel region
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT(-90 <= points[i][LAT] && points[i][LAT] <= 90);
+    }
 
-    auto lon = P[LON];
+#if eckit_HAVE_OMP
+#pragma omp parallel for schedule(dynamic, 1024)
+#endif
+    for (long i = 0; i < long(n); ++i) {
+        result[i] = containsLonLat(points[i][LON], points[i][LAT]);
+    }
+}
+
+void LonLatPolygon::contains(const std::vector<Point2>& points, std::vector<bool>& result) const {
+    std::unique_ptr<bool[]> r(new bool[points.size()]);
+    contains(points.data(), points.size(), r.get());
+    result.assign(r.get(), r.get() + points.size());
+}
+
+bool LonLatPolygon::containsLonLat(double lon, double lat) const {
     while (lon >= min_[LON] + 360) {
         lon -= 360;
     }
@@ -135,15 +211,20 @@ bool LonLatPolygon::contains(const Point2& P) const {
         }
     }
 
+    // only the edges spanning lat, in order
+    const auto b              = band(lat);
+    const std::uint32_t* from = bandEdges_.data() + bandStart_[b];
+    const std::uint32_t* to   = bandEdges_.data() + bandStart_[b + 1];
+
     do {
         // winding number
         int wn   = 0;
         int prev = 0;
 
         // loop on polygon edges
-        for (size_t i = 1; i < size(); ++i) {
-            const auto& A = operator[](i - 1);
-            const auto& B = operator[](i);
+        for (const auto* e = from; e != to; ++e) {
+            const auto& A = operator[](*e - 1);
+            const auto& B = operator[](*e);
 
             // check point-edge side and direction, testing if P is on|above|below (in latitude) of a A,B polygon edge, by:
             // - intersecting "up" on forward crossing & P above edge, or
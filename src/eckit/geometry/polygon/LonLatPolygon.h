@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iosfwd>
 #include <vector>
 
@@ -61,9 +62,19 @@ public:
     /// @return if point (lon,lat) is in polygon
     bool contains(const Point2& Plonlat) const;
 
+    /// @brief Point-in-polygon test of many points, in parallel if OpenMP is available
+    /// @param[in] points given points (lon,lat)
+    /// @param[out] result if each point is in polygon, same as contains(points[i])
+    void contains(const Point2* points, size_t n, bool* result) const;
+    void contains(const std::vector<Point2>& points, std::vector<bool>& result) const;
+
 private:
     // -- Methods
 
+    void index();
+    size_t band(double lat) const;
+    bool containsLonLat(double lon, double lat) const;
+
     void print(std::ostream&) const;
     friend std::ostream& operator<<(std::ostream&, const LonLatPolygon&);
 
@@ -74,6 +85,12 @@ private:
     bool includeNorthPole_;
     bool includeSouthPole_;
     bool quickCheckLongitude_;
+
+    // Edges by band of latitude, as only the edges spanning the latitude of a point count in its winding number.
+    // Band b lists, in order, the edges (by end vertex) from bandEdges_[bandStart_[b]] to bandEdges_[bandStart_[b+1]]
+    double bandScale_;
+    std::vector<size_t> bandStart_;
+    std::vector<std::uint32_t> bandEdges_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
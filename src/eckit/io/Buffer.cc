@@ -12,6 +12,7 @@
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/os/SamplingProfiler.h"
 
 namespace eckit {
 
@@ -20,6 +21,7 @@ namespace eckit {
 namespace {
 
 static char* allocate(size_t size) {
+    SamplingProfiler::allocation(size);
     return new char[size];
 }
 
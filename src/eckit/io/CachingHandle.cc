@@ -0,0 +1,535 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/CachingHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/runtime/Metrics.h"
+#include "eckit/runtime/MetricsRegistry.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/utils/MD5.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::ostream& operator<<(std::ostream& s, const HandleCacheKey& k) {
+    s << k.digest_ << '.' << k.block_;
+    return s;
+}
+
+static HandleCache* cache_ = nullptr;
+
+/// Removes the blocks spilled to disk at exit
+struct HandleCacheCleanup {
+    ~HandleCacheCleanup() {
+        if (cache_) {
+            AutoLock<MutexCond> lock(cache_->cond_);
+            cache_->disk_.clear();
+        }
+    }
+};
+
+static HandleCacheCleanup cleanup;
+
+static size_t blocks(long bytes, size_t blockSize) {
+    return bytes > 0 ? std::max<size_t>(1, size_t(bytes) / blockSize) : 0;
+}
+
+HandleCache::HandleCache() :
+    blockSize_(size_t(
+        std::max(4096L, long(Resource<long>("handleCacheBlockSize;$ECKIT_HANDLE_CACHE_BLOCK_SIZE", 1024 * 1024))))),
+    directory_(Resource<std::string>("handleCacheDirectory;$ECKIT_HANDLE_CACHE_DIRECTORY", "")),
+    memory_(blocks(Resource<long>("handleCacheMemory;$ECKIT_HANDLE_CACHE_MEMORY", 256L * 1024 * 1024), blockSize_),
+            &evicted),
+    disk_(0, &unlink),
+    spill_(false),
+    memoryHits_(MetricsRegistry::instance().counter("eckit_handle_cache_hits_total", "Blocks read from the cache",
+                                                    {{"tier", "memory"}})),
+    diskHits_(MetricsRegistry::instance().counter("eckit_handle_cache_hits_total", "Blocks read from the cache",
+                                                  {{"tier", "disk"}})),
+    misses_(MetricsRegistry::instance().counter("eckit_handle_cache_misses_total", "Blocks read from the source")),
+    bytesSaved_(MetricsRegistry::instance().counter("eckit_handle_cache_saved_bytes_total",
+                                                    "Bytes read from the cache instead of the source")) {
+
+    if (!std::string(directory_).empty()) {
+        directory_.mkdir();
+        disk_.capacity(blocks(Resource<long>("handleCacheDisk;$ECKIT_HANDLE_CACHE_DISK", 10L * 1024 * 1024 * 1024),
+                              blockSize_));
+        spill_ = disk_.capacity() > 0;
+    }
+}
+
+HandleCache::~HandleCache() = default;
+
+HandleCache& HandleCache::instance() {
+    // Never deleted, as handles may still be read at exit. The spilled blocks are removed by HandleCacheCleanup.
+    static HandleCache* cache = cache_ = new HandleCache();
+    return *cache;
+}
+
+// Called by memory_ with cond_ locked: the blocks are written to disk once it is released
+
+void HandleCache::evicted(HandleCacheKey& key, Block& block) {
+    if (cache_->spill_) {
+        cache_->evicted_.emplace_back(key, block);
+        cache_->spilling_[key] = block;
+    }
+}
+
+void HandleCache::unlink(HandleCacheKey&, PathName& path) {
+    ::unlink(path.localPath());
+}
+
+HandleCache::Block HandleCache::fetch(const HandleCacheKey& key, const std::function<Block()>& load) {
+
+    Block block;
+    PathName path;
+    bool onDisk = false;
+    Evicted evicted;
+
+    {
+        AutoLock<MutexCond> lock(cond_);
+
+        for (;;) {
+            if (memory_.exists(key)) {
+                block = memory_.access(key);
+                break;
+            }
+
+            // Still being written to disk
+            auto j = spilling_.find(key);
+            if (j != spilling_.end()) {
+                block = j->second;
+                memory_.insert(key, block);
+                std::swap(evicted, evicted_);
+                break;
+            }
+
+            if (loading_.find(key) == loading_.end()) {
+                break;
+            }
+
+            cond_.wait();
+        }
+
+        if (!block) {
+            if (disk_.exists(key)) {
+                path   = disk_.access(key);
+                onDisk = true;
+            }
+
+            loading_.insert(key);
+        }
+    }
+
+    if (block) {
+        memoryHits_.inc();
+        bytesSaved_.inc(block->size());
+        spill(evicted);
+        return block;
+    }
+
+    bool fromDisk = false;
+
+    try {
+        if (onDisk) {
+            block    = read(path);
+            fromDisk = bool(block);
+        }
+
+        if (!block) {
+            block = load();
+        }
+    }
+    catch (...) {
+        // Let the waiting threads try for themselves
+        AutoLock<MutexCond> lock(cond_);
+        loading_.erase(key);
+        cond_.broadcast();
+        throw;
+    }
+
+    ASSERT(block);
+
+    {
+        AutoLock<MutexCond> lock(cond_);
+
+        loading_.erase(key);
+        memory_.insert(key, block);
+        std::swap(evicted, evicted_);
+
+        cond_.broadcast();
+    }
+
+    if (fromDisk) {
+        diskHits_.inc();
+        bytesSaved_.inc(block->size());
+    }
+    else {
+        misses_.inc();
+    }
+
+    spill(evicted);
+
+    return block;
+}
+
+HandleCache::Block HandleCache::read(const PathName& path) const {
+    int fd = ::open(path.localPath(), O_RDONLY);
+    if (fd < 0) {
+        // Evicted in the meantime
+        return Block();
+    }
+
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    std::shared_ptr<Buffer> block(new Buffer(size > 0 ? size_t(size) : 0));
+
+    ssize_t len = size >= 0 ? ::pread(fd, block->data(), block->size(), 0) : -1;
+    ::close(fd);
+
+    if (len != size) {
+        return Block();
+    }
+
+    return block;
+}
+
+void HandleCache::write(const HandleCacheKey& key, const Block& block) {
+    {
+        AutoLock<MutexCond> lock(cond_);
+        if (disk_.exists(key)) {
+            return;
+        }
+    }
+
+    std::ostringstream name;
+    name << key << '.' << ::getpid();
+    PathName path = directory_ / name.str();
+
+    int fd = ::open(path.localPath(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        Log::warning() << "HandleCache: cannot create " << path << Log::syserr << std::endl;
+        return;
+    }
+
+    ssize_t len = ::write(fd, block->data(), block->size());
+    bool ok     = (len == ssize_t(block->size()));
+    if (!ok) {
+        Log::warning() << "HandleCache: cannot write " << path << Log::syserr << std::endl;
+    }
+
+    if (::close(fd) != 0 || !ok) {
+        ::unlink(path.localPath());
+        return;
+    }
+
+    AutoLock<MutexCond> lock(cond_);
+    disk_.insert(key, path);
+}
+
+void HandleCache::spill(Evicted& evicted) {
+    for (const auto& e : evicted) {
+        write(e.first, e.second);
+
+        AutoLock<MutexCond> lock(cond_);
+        spilling_.erase(e.first);
+    }
+}
+
+void HandleCache::clear() {
+    AutoLock<MutexCond> lock(cond_);
+
+    bool spill = spill_;
+    spill_     = false;
+    memory_.clear();
+    spill_ = spill;
+
+    disk_.clear();
+    spilling_.clear();
+    evicted_.clear();
+}
+
+unsigned long long HandleCache::memoryHits() const {
+    return memoryHits_.value();
+}
+
+unsigned long long HandleCache::diskHits() const {
+    return diskHits_.value();
+}
+
+unsigned long long HandleCache::misses() const {
+    return misses_.value();
+}
+
+unsigned long long HandleCache::bytesSaved() const {
+    return bytesSaved_.value();
+}
+
+void HandleCache::print(std::ostream& s) const {
+    AutoLock<MutexCond> lock(cond_);
+    s << "HandleCache[blockSize=" << Bytes(double(blockSize_)) << ",memory=" << memory_.size() << "/"
+      << memory_.capacity() << ",disk=" << disk_.size() << "/" << disk_.capacity() << ",memoryHits=" << memoryHits()
+      << ",diskHits=" << diskHits() << ",misses=" << misses() << ",saved=" << Bytes(double(bytesSaved())) << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CachingHandle::CachingHandle(DataHandle* h) :
+    owned_(true),
+    handle_(h),
+    cached_(false),
+    opened_(false),
+    eof_(false),
+    position_(0),
+    source_(0),
+    estimate_(0),
+    blockIndex_(0),
+    hits_(0),
+    misses_(0),
+    bytesSaved_(0) {}
+
+CachingHandle::CachingHandle(DataHandle& h) :
+    owned_(false),
+    handle_(&h),
+    cached_(false),
+    opened_(false),
+    eof_(false),
+    position_(0),
+    source_(0),
+    estimate_(0),
+    blockIndex_(0),
+    hits_(0),
+    misses_(0),
+    bytesSaved_(0) {}
+
+CachingHandle::~CachingHandle() {
+    if (owned_) {
+        delete handle_;
+    }
+}
+
+Length CachingHandle::openForRead() {
+    position_ = 0;
+    source_   = 0;
+    eof_      = false;
+
+    try {
+        MD5 md5;
+        handle_->hash(md5);
+        digest_ = md5.digest();
+        cached_ = true;
+    }
+    catch (NotImplemented&) {
+        cached_ = false;
+    }
+
+    if (!cached_) {
+        opened_   = true;
+        estimate_ = handle_->openForRead();
+        return estimate_;
+    }
+
+    opened_   = false;
+    estimate_ = handle_->estimate();
+    return estimate_;
+}
+
+HandleCache::Block CachingHandle::load(unsigned long long block) {
+    size_t blockSize = HandleCache::instance().blockSize();
+    Offset offset(static_cast<long long>(block * blockSize));
+
+    ++misses_;
+
+    if (!opened_) {
+        handle_->openForRead();
+        opened_ = true;
+        source_ = 0;
+    }
+
+    if (source_ != offset) {
+        if (handle_->canSeek()) {
+            source_ = handle_->seek(offset);
+            ASSERT(source_ == offset);
+        }
+        else {
+            // Streams are read again from the start if needed, and skipped forward by reading
+            if (source_ > offset) {
+                handle_->close();
+                handle_->openForRead();
+                source_ = 0;
+            }
+
+            Buffer skip(std::min<size_t>(blockSize, size_t(offset - source_)));
+            while (source_ < offset) {
+                long len = handle_->read(skip, long(std::min<long long>(skip.size(), offset - source_)));
+                if (len <= 0) {
+                    return HandleCache::Block(new Buffer(0));
+                }
+                source_ += len;
+            }
+        }
+    }
+
+    std::shared_ptr<Buffer> result(new Buffer(blockSize));
+
+    size_t total = 0;
+    while (total < blockSize) {
+        long len = handle_->read(static_cast<char*>(result->data()) + total, long(blockSize - total));
+        if (len < 0) {
+            std::ostringstream oss;
+            oss << "CachingHandle: error reading " << *handle_ << " at " << offset;
+            throw ReadError(oss.str());
+        }
+        if (len == 0) {
+            break;
+        }
+        total += len;
+    }
+
+    source_ += Length(total);
+
+    if (total < blockSize) {
+        result->resize(total, true);
+    }
+
+    return result;
+}
+
+long CachingHandle::read(void* buffer, long length) {
+    if (!cached_) {
+        long len = handle_->read(buffer, length);
+        if (len > 0) {
+            position_ += len;
+        }
+        return len;
+    }
+
+    HandleCache& cache = HandleCache::instance();
+    size_t blockSize   = cache.blockSize();
+
+    char* p    = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length && !eof_) {
+        unsigned long long pos   = static_cast<unsigned long long>((long long)position_);
+        unsigned long long block = pos / blockSize;
+        size_t start             = size_t(pos % blockSize);
+
+        // Keep the current block, so that small sequential reads do not go to the cache every time
+        if (!block_ || blockIndex_ != block) {
+            unsigned long long before = misses_;
+            block_      = cache.fetch(HandleCacheKey{digest_, block}, [this, block] { return load(block); });
+            blockIndex_ = block;
+            if (misses_ == before) {
+                ++hits_;
+                bytesSaved_ += block_->size();
+            }
+        }
+
+        const HandleCache::Block& b = block_;
+
+        if (start >= b->size()) {
+            eof_ = true;
+            break;
+        }
+
+        size_t len = std::min(b->size() - start, size_t(length - total));
+        std::memcpy(p + total, static_cast<const char*>(b->data()) + start, len);
+
+        total += long(len);
+        position_ += Length(len);
+
+        // A short block is the last one
+        if (b->size() < blockSize && start + len == b->size()) {
+            eof_ = true;
+        }
+    }
+
+    return total;
+}
+
+void CachingHandle::close() {
+    block_.reset();
+    if (opened_) {
+        handle_->close();
+        opened_ = false;
+    }
+}
+
+void CachingHandle::print(std::ostream& s) const {
+    s << "CachingHandle[";
+    handle_->print(s);
+    s << ']';
+}
+
+Length CachingHandle::estimate() {
+    return estimate_;
+}
+
+void CachingHandle::skip(const Length& len) {
+    seek(position_ + len);
+}
+
+void CachingHandle::rewind() {
+    seek(0);
+}
+
+Offset CachingHandle::seek(const Offset& off) {
+    if (!cached_) {
+        position_ = handle_->seek(off);
+        return position_;
+    }
+
+    position_ = off;
+    eof_      = false;
+    return position_;
+}
+
+bool CachingHandle::canSeek() const {
+    return cached_ || handle_->canSeek();
+}
+
+Offset CachingHandle::position() {
+    return position_;
+}
+
+void CachingHandle::hash(MD5& md5) const {
+    handle_->hash(md5);
+}
+
+std::string CachingHandle::title() const {
+    return std::string("{") + handle_->title() + "}";
+}
+
+void CachingHandle::collectMetrics(const std::string& what) const {
+    handle_->collectMetrics(what);
+
+    if (cached_) {
+        unsigned long long total = hits_ + misses_;
+        Metrics::set(what + "_cache_hits", hits_);
+        Metrics::set(what + "_cache_misses", misses_);
+        Metrics::set(what + "_cache_hit_rate", total ? double(hits_) / double(total) : 0.0);
+        Metrics::set(what + "_cache_bytes_saved", bytesSaved_);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
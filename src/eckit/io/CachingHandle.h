@@ -0,0 +1,196 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_io_CachingHandle_h
+#define eckit_io_CachingHandle_h
+
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "eckit/container/CacheLRU.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/thread/MutexCond.h"
+
+namespace eckit {
+
+class MetricCounter;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A block of a handle: the digest of DataHandle::hash() and the index of the block
+struct HandleCacheKey {
+    std::string digest_;
+    unsigned long long block_;
+
+    bool operator<(const HandleCacheKey& other) const {
+        return block_ != other.block_ ? block_ < other.block_ : digest_ < other.digest_;
+    }
+
+    bool operator==(const HandleCacheKey& other) const {
+        return block_ == other.block_ && digest_ == other.digest_;
+    }
+
+    friend std::ostream& operator<<(std::ostream&, const HandleCacheKey&);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide cache of the blocks read by CachingHandle.
+///
+/// Blocks of handleCacheBlockSize ($ECKIT_HANDLE_CACHE_BLOCK_SIZE) bytes are kept in memory, in LRU order, up to
+/// handleCacheMemory ($ECKIT_HANDLE_CACHE_MEMORY) bytes. If handleCacheDirectory ($ECKIT_HANDLE_CACHE_DIRECTORY) is
+/// set, blocks evicted from memory are written there, ideally on a local SSD, up to handleCacheDisk
+/// ($ECKIT_HANDLE_CACHE_DISK) bytes, and read back on the next access.
+///
+/// A block is only read once from the source when several threads want it at the same time: the others wait for the
+/// first one.
+
+class HandleCache : private NonCopyable {
+public:  // types
+    typedef std::shared_ptr<const Buffer> Block;
+
+public:  // methods
+    static HandleCache& instance();
+
+    size_t blockSize() const { return blockSize_; }
+
+    /// @returns the block from memory or disk, or calls load() to read it from the source
+    Block fetch(const HandleCacheKey&, const std::function<Block()>& load);
+
+    /// Discard all the blocks, in memory and on disk
+    void clear();
+
+    unsigned long long memoryHits() const;
+    unsigned long long diskHits() const;
+    unsigned long long misses() const;
+    unsigned long long bytesSaved() const;
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const HandleCache& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // types
+    typedef std::vector<std::pair<HandleCacheKey, Block>> Evicted;
+
+private:  // methods
+    HandleCache();
+    ~HandleCache();
+
+    static void evicted(HandleCacheKey&, Block&);
+    static void unlink(HandleCacheKey&, PathName&);
+
+    Block read(const PathName&) const;
+    void write(const HandleCacheKey&, const Block&);
+    void spill(Evicted&);
+
+private:  // members
+    size_t blockSize_;
+    PathName directory_;
+
+    mutable MutexCond cond_;
+    CacheLRU<HandleCacheKey, Block> memory_;
+    CacheLRU<HandleCacheKey, PathName> disk_;
+    std::set<HandleCacheKey> loading_;
+    std::map<HandleCacheKey, Block> spilling_;  //< Evicted from memory but not yet on disk
+    Evicted evicted_;
+    bool spill_;
+
+    MetricCounter& memoryHits_;
+    MetricCounter& diskHits_;
+    MetricCounter& misses_;
+    MetricCounter& bytesSaved_;
+
+    friend struct HandleCacheCleanup;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Reads a handle through the HandleCache, for sources that are slow and read repeatedly, e.g. URLHandle or
+/// PartFileHandle on a parallel filesystem.
+///
+/// The handle must implement DataHandle::hash(), which identifies its contents; if not, reads go straight to the handle.
+/// The handle is only opened when a block is missing from the cache.
+
+class CachingHandle : public DataHandle {
+public:  // methods
+    CachingHandle(DataHandle*);
+    CachingHandle(DataHandle&);
+
+    ~CachingHandle() override;
+
+    /// Blocks read by this handle from the cache, and from its source
+    unsigned long long hits() const { return hits_; }
+    unsigned long long misses() const { return misses_; }
+
+    // -- Overridden methods
+
+    // From DataHandle
+
+    Length openForRead() override;
+
+    long read(void*, long) override;
+    void close() override;
+
+    void rewind() override;
+    void print(std::ostream&) const override;
+    void skip(const Length&) override;
+
+    Offset seek(const Offset&) override;
+    bool canSeek() const override;
+
+    Length estimate() override;
+    Offset position() override;
+
+    void hash(MD5&) const override;
+
+    std::string title() const override;
+    void collectMetrics(const std::string& what) const override;  // Tag for metrics collection
+
+private:  // methods
+    HandleCache::Block load(unsigned long long block);
+
+private:  // members
+    bool owned_;
+    DataHandle* handle_;
+
+    std::string digest_;
+    bool cached_;
+    bool opened_;
+    bool eof_;
+
+    Offset position_;
+    Offset source_;
+    Length estimate_;
+
+    HandleCache::Block block_;
+    unsigned long long blockIndex_;
+
+    unsigned long long hits_;
+    unsigned long long misses_;
+    unsigned long long bytesSaved_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
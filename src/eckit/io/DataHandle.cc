@@ -24,6 +24,7 @@
 #include "eckit/log/Bytes.h"
 #include "eckit/log/Progress.h"
 #include "eckit/log/Timer.h"
+#include "eckit/log/Tracer.h"
 #include "eckit/runtime/Metrics.h"
 
 
@@ -75,6 +76,8 @@ void DataHandle::flush() {
 
 Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
 
+    ECKIT_TRACE_SPAN("DataHandle::saveInto", "io");
+
     static const bool moverTransfer = Resource<bool>("-mover;moverTransfer", 0);
 
     compress();
@@ -198,6 +201,8 @@ Length DataHandle::saveInto(const PathName& path, TransferWatcher& w) {
 
 Length DataHandle::copyTo(DataHandle& other, long bufsize, Length maxsize, TransferWatcher& watcher) {
 
+    ECKIT_TRACE_SPAN("DataHandle::copyTo", "io");
+
     if (bufsize == -1) {
         bufsize = Resource<long>("bufferSize;$ECKIT_DATAHANDLE_COPYTO_BUFFER_SIZE", 64 * 1024 * 1024);
     }
@@ -0,0 +1,471 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/io/EasyCURLMulti.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <curl/curl.h>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Timer.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define _(a) call(#a, a)
+
+static void call(const char* what, CURLcode code) {
+    if (code != CURLE_OK) {
+        std::ostringstream oss;
+        oss << what << " failed: " << curl_easy_strerror(code);
+        throw SeriousBug(oss.str());
+    }
+}
+
+static void call(const char* what, CURLMcode code) {
+    if (code != CURLM_OK) {
+        std::ostringstream oss;
+        oss << what << " failed: " << curl_multi_strerror(code);
+        throw SeriousBug(oss.str());
+    }
+}
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static void init() {
+    _(curl_global_init(CURL_GLOBAL_DEFAULT));
+}
+
+static const size_t NO_TRANSFER = std::numeric_limits<size_t>::max();
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct EasyCURLMulti::Request {
+    std::string url_;
+    std::string range_;
+    DataHandle* target_;  // if null, the body is kept in body_
+    size_t transfer_;     // index in transfers_, if any
+
+    CURL* easy_;
+    bool finished_;
+    long code_;
+    Length bytes_;
+    std::string body_;
+    std::string error_;
+    std::string writeError_;
+    char errorBuffer_[CURL_ERROR_SIZE];
+    Timer timer_;
+
+    Request(const std::string& url, DataHandle* target, size_t transfer) :
+        url_(url),
+        target_(target),
+        transfer_(transfer),
+        easy_(nullptr),
+        finished_(false),
+        code_(0),
+        bytes_(0) {
+        errorBuffer_[0] = 0;
+    }
+
+    void range(const Offset& from, const Length& length) {
+        if (length != Length(0)) {
+            std::ostringstream oss;
+            oss << (long long)from << "-" << ((long long)from + (long long)length - 1);
+            range_ = oss.str();
+        }
+    }
+
+    size_t write(const char* ptr, size_t size) {
+        if (target_) {
+            try {
+                long n = target_->write(ptr, size);
+                if (n != long(size)) {
+                    std::ostringstream oss;
+                    oss << "written " << n << " out of " << size << " bytes to " << *target_;
+                    writeError_ = oss.str();
+                    return 0;
+                }
+            }
+            catch (std::exception& e) {
+                writeError_ = e.what();
+                return 0;  // aborts the transfer
+            }
+        }
+        else {
+            body_.append(ptr, size);
+        }
+        bytes_ += size;
+        return size;
+    }
+
+    static size_t writeCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+        return reinterpret_cast<Request*>(userdata)->write(ptr, size * nmemb);
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+EasyCURLMulti::EasyCURLMulti(size_t maxTransfers) :
+    multi_(nullptr),
+    headers_(nullptr),
+    maxTransfers_(maxTransfers),
+    active_(0),
+    verbose_(false),
+    http2_(true),
+    sslVerifyPeer_(true),
+    sslVerifyHost_(true) {
+
+    pthread_once(&once, init);
+
+    if (maxTransfers_ == 0) {
+        static size_t defaultMaxTransfers
+            = Resource<size_t>("easyCURLMultiMaxTransfers;$ECKIT_EASYCURL_MULTI_MAX_TRANSFERS", 16);
+        maxTransfers_ = defaultMaxTransfers;
+    }
+    ASSERT(maxTransfers_ > 0);
+
+    multi_ = curl_multi_init();
+    ASSERT(multi_);
+
+    // Connections are kept in the cache of the multi handle, and reused by all the transfers
+
+    _(curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, long(maxTransfers_)));
+    _(curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, long(maxTransfers_)));
+#if LIBCURL_VERSION_NUM >= 0x072b00
+    _(curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX));
+#endif
+}
+
+EasyCURLMulti::~EasyCURLMulti() {
+    for (Request* r : running_) {
+        curl_multi_remove_handle(multi_, r->easy_);
+        curl_easy_cleanup(r->easy_);
+    }
+    for (void* easy : idle_) {
+        curl_easy_cleanup(easy);
+    }
+    curl_slist_free_all(static_cast<curl_slist*>(headers_));
+    curl_multi_cleanup(multi_);
+}
+
+void EasyCURLMulti::headers(const EasyCURLHeaders& headers) {
+    curl_slist_free_all(static_cast<curl_slist*>(headers_));
+    headers_ = nullptr;
+
+    for (const auto& h : headers) {
+        headers_ = curl_slist_append(static_cast<curl_slist*>(headers_), (h.first + ": " + h.second).c_str());
+    }
+}
+
+void EasyCURLMulti::setup(void* easy, Request& r) {
+    curl_easy_reset(easy);
+
+    _(curl_easy_setopt(easy, CURLOPT_URL, r.url_.c_str()));
+    _(curl_easy_setopt(easy, CURLOPT_HTTPGET, 1L));
+    _(curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L));
+    _(curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L));
+    _(curl_easy_setopt(easy, CURLOPT_FAILONERROR, 1L));
+    _(curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, r.errorBuffer_));
+    _(curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &Request::writeCallback));
+    _(curl_easy_setopt(easy, CURLOPT_WRITEDATA, &r));
+    _(curl_easy_setopt(easy, CURLOPT_PRIVATE, &r));
+    _(curl_easy_setopt(easy, CURLOPT_VERBOSE, verbose_ ? 1L : 0L));
+    _(curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, sslVerifyPeer_ ? 1L : 0L));
+    _(curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, sslVerifyHost_ ? 2L : 0L));
+
+    if (!r.range_.empty()) {
+        _(curl_easy_setopt(easy, CURLOPT_RANGE, r.range_.c_str()));
+    }
+    if (headers_) {
+        _(curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers_));
+    }
+    if (!userAgent_.empty()) {
+        _(curl_easy_setopt(easy, CURLOPT_USERAGENT, userAgent_.c_str()));
+    }
+
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    if (http2_) {
+        // HTTP/2 over TLS when the server supports it, and wait for a connection to multiplex on rather than
+        // opening a new one
+        _(curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS));
+        _(curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L));
+    }
+#endif
+}
+
+size_t EasyCURLMulti::GET(const std::string& url, DataHandle& target, const Offset& from, const Length& length) {
+    size_t index = transfers_.size();
+    transfers_.push_back(Transfer{url, 0, 0, "", 0});
+
+    std::unique_ptr<Request> r(new Request(url, &target, index));
+    r->range(from, length);
+    pending_.push_back(std::move(r));
+
+    return index;
+}
+
+void EasyCURLMulti::start(Request& r) {
+    CURL* easy;
+    if (idle_.empty()) {
+        easy = curl_easy_init();
+        ASSERT(easy);
+    }
+    else {
+        easy = idle_.back();
+        idle_.pop_back();
+    }
+
+    try {
+        setup(easy, r);
+        _(curl_multi_add_handle(multi_, easy));
+    }
+    catch (...) {
+        idle_.push_back(easy);
+        throw;
+    }
+
+    r.easy_ = easy;
+    r.timer_.start();
+    running_.push_back(&r);
+    active_++;
+}
+
+void EasyCURLMulti::done(void* easy, int result) {
+    auto j = std::find_if(running_.begin(), running_.end(), [easy](Request* r) { return r->easy_ == easy; });
+    ASSERT(j != running_.end());
+
+    Request& r = **j;
+    running_.erase(j);
+
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &r.code_);
+    if (result != CURLE_OK) {
+        if (!r.writeError_.empty()) {
+            r.error_ = r.writeError_;
+        }
+        else if (r.errorBuffer_[0]) {
+            r.error_ = r.errorBuffer_;
+        }
+        else {
+            r.error_ = curl_easy_strerror(CURLcode(result));
+        }
+    }
+    r.finished_ = true;
+
+    _(curl_multi_remove_handle(multi_, easy));
+    r.easy_ = nullptr;
+    idle_.push_back(easy);
+    active_--;
+
+    if (r.transfer_ != NO_TRANSFER) {
+        Transfer& t = transfers_[r.transfer_];
+        t.code_     = r.code_;
+        t.bytes_    = r.bytes_;
+        t.error_    = r.error_;
+        t.time_     = r.timer_.elapsed();
+    }
+
+    LOG_DEBUG_LIB(LibEcKit) << "EasyCURLMulti: " << r.url_ << (r.range_.empty() ? "" : " range ") << r.range_
+                            << ", code=" << r.code_ << ", " << r.bytes_ << " bytes"
+                            << (r.error_.empty() ? "" : ", error: ") << r.error_ << std::endl;
+}
+
+void EasyCURLMulti::wait() {
+
+    // Progress all the transfers, then wait for some activity if none completed
+
+    int running = 0;
+    _(curl_multi_perform(multi_, &running));
+
+    bool completed = false;
+    int queued     = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+        if (msg->msg == CURLMSG_DONE) {
+            done(msg->easy_handle, msg->data.result);
+            completed = true;
+        }
+    }
+
+    if (!completed && active_ > 0) {
+        int fds = 0;
+#if LIBCURL_VERSION_NUM >= 0x074200
+        _(curl_multi_poll(multi_, nullptr, 0, 1000, &fds));
+#else
+        _(curl_multi_wait(multi_, nullptr, 0, 1000, &fds));
+#endif
+    }
+}
+
+void EasyCURLMulti::perform() {
+
+    std::vector<std::unique_ptr<Request>> requests;
+
+    try {
+        while (!pending_.empty() || active_ > 0) {
+            while (!pending_.empty() && active_ < maxTransfers_) {
+                requests.push_back(std::move(pending_.front()));
+                pending_.pop_front();
+                start(*requests.back());
+            }
+            wait();
+        }
+    }
+    catch (...) {
+        for (Request* r : running_) {
+            curl_multi_remove_handle(multi_, r->easy_);
+            idle_.push_back(r->easy_);
+        }
+        running_.clear();
+        active_ = 0;
+        throw;
+    }
+
+    size_t failed = 0;
+    std::ostringstream oss;
+    for (const auto& r : requests) {
+        if (!r->error_.empty()) {
+            if (failed++ < 10) {
+                oss << ", " << r->url_ << " (" << r->error_ << ")";
+            }
+        }
+    }
+
+    if (failed) {
+        std::ostringstream msg;
+        msg << "EasyCURLMulti: " << failed << " transfer(s) failed" << oss.str();
+        throw ReadError(msg.str(), Here());
+    }
+}
+
+void EasyCURLMulti::clear() {
+    ASSERT(active_ == 0);
+    pending_.clear();
+    transfers_.clear();
+}
+
+Length EasyCURLMulti::contentLength(const std::string& url) {
+    CURL* easy = curl_easy_init();
+    ASSERT(easy);
+
+    Request r(url, nullptr, NO_TRANSFER);
+
+    try {
+        setup(easy, r);
+        _(curl_easy_setopt(easy, CURLOPT_NOBODY, 1L));
+
+        CURLcode code = curl_easy_perform(easy);
+        if (code != CURLE_OK) {
+            throw ReadError(url + ": " + (r.errorBuffer_[0] ? r.errorBuffer_ : curl_easy_strerror(code)), Here());
+        }
+
+        curl_off_t length = -1;
+        _(curl_easy_getinfo(easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length));
+        if (length < 0) {
+            throw BadValue("EasyCURLMulti: cannot establish the content length of " + url, Here());
+        }
+
+        idle_.push_back(easy);
+        return length;
+    }
+    catch (...) {
+        curl_easy_cleanup(easy);
+        throw;
+    }
+}
+
+Length EasyCURLMulti::GETRanges(const std::string& url, DataHandle& target, size_t rangeSize, const Length& size) {
+    ASSERT(rangeSize > 0);
+    ASSERT(pending_.empty() && active_ == 0);
+
+    long long total = size != Length(0) ? size : contentLength(url);
+    size_t count    = (total + rangeSize - 1) / rangeSize;
+
+    // The ranges are written in order, so only the next maxTransfers_ ones are fetched, and held until written
+
+    std::vector<std::unique_ptr<Request>> ranges(count);
+    size_t next    = 0;
+    size_t written = 0;
+
+    try {
+        while (written < count) {
+
+            while (next < count && next < written + maxTransfers_ && active_ < maxTransfers_) {
+                long long from   = (long long)next * rangeSize;
+                long long length = std::min<long long>(rangeSize, total - from);
+
+                ranges[next].reset(new Request(url, nullptr, NO_TRANSFER));
+                ranges[next]->range(from, length);
+                start(*ranges[next]);
+                next++;
+            }
+
+            wait();
+
+            while (written < next && ranges[written]->finished_) {
+                Request& r = *ranges[written];
+
+                long long expected = std::min<long long>(rangeSize, total - (long long)written * rangeSize);
+
+                if (r.error_.empty() && r.code_ != 206 && !(r.code_ == 200 && count == 1)) {
+                    std::ostringstream oss;
+                    oss << "expected partial content, got HTTP code " << r.code_;
+                    r.error_ = oss.str();
+                }
+                if (r.error_.empty() && (long long)r.body_.size() != expected) {
+                    std::ostringstream oss;
+                    oss << "got " << r.body_.size() << " bytes, expected " << expected;
+                    r.error_ = oss.str();
+                }
+                if (!r.error_.empty()) {
+                    throw ReadError(url + " range " + r.range_ + ": " + r.error_, Here());
+                }
+
+                long len = target.write(r.body_.data(), r.body_.size());
+                if (len != long(r.body_.size())) {
+                    std::ostringstream oss;
+                    oss << "EasyCURLMulti: written " << len << " out of " << r.body_.size() << " bytes to " << target;
+                    throw WriteError(oss.str(), Here());
+                }
+
+                ranges[written].reset();
+                written++;
+            }
+        }
+    }
+    catch (...) {
+        for (Request* r : running_) {
+            curl_multi_remove_handle(multi_, r->easy_);
+            idle_.push_back(r->easy_);
+        }
+        running_.clear();
+        active_ = 0;
+        throw;
+    }
+
+    return total;
+}
+
+void EasyCURLMulti::print(std::ostream& s) const {
+    s << "EasyCURLMulti[maxTransfers=" << maxTransfers_ << ",pending=" << pending_.size() << ",active=" << active_
+      << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
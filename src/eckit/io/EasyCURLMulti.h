@@ -0,0 +1,125 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_io_EasyCURLMulti_h
+#define eckit_io_EasyCURLMulti_h
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/io/EasyCURL.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+class DataHandle;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Performs many HTTP GETs concurrently, from one thread, with the curl multi interface.
+///
+/// Transfers are queued with GET(), then run by perform(), at most maxTransfers() at a time. Connections are kept
+/// and reused between transfers, and, with HTTP/2, transfers to the same host are multiplexed over one connection.
+/// Bodies are streamed into the DataHandles given, which must be open for writing, as they arrive.
+///
+/// GETRanges() fetches one large object with concurrent ranged GETs, written to its handle in order.
+
+class EasyCURLMulti : private NonCopyable {
+public:  // types
+    /// The outcome of a transfer queued with GET()
+    struct Transfer {
+        std::string url_;
+        long code_;          // HTTP status, 0 if no response
+        Length bytes_;       // of the body
+        std::string error_;  // empty if the transfer succeeded
+        double time_;        // seconds
+    };
+
+public:  // methods
+    /// @param maxTransfers the maximum number of concurrent transfers, defaults to easyCURLMultiMaxTransfers
+    explicit EasyCURLMulti(size_t maxTransfers = 0);
+    ~EasyCURLMulti();
+
+    /// Queue the GET of the URL, whose body will be written to the handle, from the given offset if the length
+    /// is not 0. Returns the index of the transfer.
+    size_t GET(const std::string& url, DataHandle& target, const Offset& from = 0, const Length& length = 0);
+
+    /// Run the transfers queued, and return when they are all done. Throws if any of them failed (see transfers()).
+    void perform();
+
+    /// Of the transfers queued since the last clear()
+    const std::vector<Transfer>& transfers() const { return transfers_; }
+    void clear();
+
+    /// The size of the object, with a HEAD request
+    Length contentLength(const std::string& url);
+
+    /// Fetch the object with concurrent GETs of ranges of the given size, writing them in order to the handle.
+    /// The size of the object is found with a HEAD request, unless given. At most maxTransfers() ranges are held
+    /// in memory.
+    Length GETRanges(const std::string& url, DataHandle& target, size_t rangeSize, const Length& size = 0);
+
+    size_t maxTransfers() const { return maxTransfers_; }
+
+    // Options, for all the transfers
+
+    void verbose(bool on) { verbose_ = on; }
+    void http2(bool on) { http2_ = on; }
+    void sslVerifyPeer(bool on) { sslVerifyPeer_ = on; }
+    void sslVerifyHost(bool on) { sslVerifyHost_ = on; }
+    void headers(const EasyCURLHeaders&);
+    void userAgent(const std::string& userAgent) { userAgent_ = userAgent; }
+
+    void print(std::ostream&) const;
+
+private:  // types
+    struct Request;
+
+private:  // methods
+    void start(Request&);
+    void wait();
+    void done(void* easy, int result);
+    void setup(void* easy, Request&);
+
+    friend std::ostream& operator<<(std::ostream& s, const EasyCURLMulti& c) {
+        c.print(s);
+        return s;
+    }
+
+private:  // members
+    void* multi_;
+    std::vector<void*> idle_;  // easy handles, kept for reuse
+    void* headers_;            // curl_slist
+
+    size_t maxTransfers_;
+    size_t active_;
+
+    std::deque<std::unique_ptr<Request>> pending_;
+    std::vector<Request*> running_;
+    std::vector<Transfer> transfers_;
+
+    bool verbose_;
+    bool http2_;
+    bool sslVerifyPeer_;
+    bool sslVerifyHost_;
+    std::string userAgent_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/io/IOProfiler.h"
+
+#include <fstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/JSON.h"
+#include "eckit/log/Log.h"
+#include "eckit/runtime/Metrics.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/value/Value.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+IOProfiler::IOProfiler() :
+    output_(Resource<std::string>("ioProfilerOutput;$ECKIT_IO_PROFILER_OUTPUT", "")) {}
+
+IOProfiler::~IOProfiler() {
+    if (!output_.empty()) {
+        try {
+            save(output_);
+        }
+        catch (std::exception& e) {
+            Log::error() << "IOProfiler: cannot save profile to " << output_ << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+IOProfiler& IOProfiler::instance() {
+    static IOProfiler profiler;
+    return profiler;
+}
+
+bool IOProfiler::enabled() {
+    static bool enabled = Resource<bool>("ioProfiler;$ECKIT_IO_PROFILER", false);
+    return enabled;
+}
+
+const char* IOProfiler::name(Operation op) {
+    switch (op) {
+        case OPEN:
+            return "open";
+        case READ:
+            return "read";
+        case WRITE:
+            return "write";
+        case SEEK:
+            return "seek";
+        case FLUSH:
+            return "flush";
+        case CLOSE:
+            return "close";
+        default:
+            NOTIMP;
+    }
+}
+
+std::string IOProfiler::prefix(const std::string& path) {
+    static size_t depth = Resource<size_t>("ioProfilerPathDepth;$ECKIT_IO_PROFILER_PATH_DEPTH", 2);
+
+    size_t pos = path.find('/');
+    if (pos == std::string::npos) {
+        return path;
+    }
+
+    for (size_t i = 0; i < depth; ++i) {
+        pos = path.find('/', pos + 1);
+        if (pos == std::string::npos) {
+            return path;
+        }
+    }
+
+    return path.substr(0, pos);
+}
+
+IOProfiler::Profile& IOProfiler::profile(const std::string& handleClass, const std::string& path) {
+    AutoLock<Mutex> lock(mutex_);
+    auto& p = profiles_[handleClass][prefix(path)];
+    if (!p) {
+        p.reset(new Profile());
+    }
+    return *p;
+}
+
+IOProfiler::Profile& IOProfiler::profile(const DataHandle& handle) {
+    return profile(handle.className(), handle.metricsTag());
+}
+
+void IOProfiler::reset() {
+    AutoLock<Mutex> lock(mutex_);
+    for (auto& c : profiles_) {
+        for (auto& p : c.second) {
+            for (auto& h : p.second->latencies_) {
+                h.reset();
+            }
+            p.second->bytesRead_    = 0;
+            p.second->bytesWritten_ = 0;
+        }
+    }
+}
+
+Value IOProfiler::report() const {
+    AutoLock<Mutex> lock(mutex_);
+
+    Value classes = Value::makeOrderedMap();
+    for (const auto& c : profiles_) {
+        Value prefixes = Value::makeOrderedMap();
+        for (const auto& p : c.second) {
+            Value profile = Value::makeOrderedMap();
+            profile["bytes_read"]    = p.second->bytesRead_.load();
+            profile["bytes_written"] = p.second->bytesWritten_.load();
+            for (size_t op = 0; op < OPERATIONS; ++op) {
+                const LatencyHistogram& h = p.second->latencies_[op];
+                if (h.count()) {
+                    profile[name(Operation(op))] = h.summary();
+                }
+            }
+            prefixes[p.first] = profile;
+        }
+        classes[c.first] = prefixes;
+    }
+
+    return classes;
+}
+
+void IOProfiler::json(JSON& json) const {
+    json << report();
+}
+
+void IOProfiler::collectMetrics() const {
+    Metrics::set("io_profile", report(), true);
+}
+
+void IOProfiler::save(const PathName& path) const {
+    std::ofstream out(path.localPath());
+    if (!out) {
+        throw CantOpenFile(path.asString());
+    }
+
+    JSON json(out);
+    this->json(json);
+    out << std::endl;
+
+    if (!out) {
+        throw WriteError(path.asString());
+    }
+}
+
+void IOProfiler::print(std::ostream& s) const {
+    AutoLock<Mutex> lock(mutex_);
+
+    for (const auto& c : profiles_) {
+        for (const auto& p : c.second) {
+            s << c.first << " " << p.first << ": " << Bytes(double(p.second->bytesRead_)) << " read, "
+              << Bytes(double(p.second->bytesWritten_)) << " written" << std::endl;
+            for (size_t op = 0; op < OPERATIONS; ++op) {
+                const LatencyHistogram& h = p.second->latencies_[op];
+                if (h.count()) {
+                    s << "  " << name(Operation(op)) << ": " << h << std::endl;
+                }
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,107 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_io_IOProfiler_h
+#define eckit_io_IOProfiler_h
+
+#include <atomic>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "eckit/log/LatencyHistogram.h"
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit {
+
+class DataHandle;
+class JSON;
+class PathName;
+class Value;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide latency histograms of I/O operations, by handle class and path prefix.
+///
+/// Handles wrapped in a StatsHandle are profiled when ioProfiler ($ECKIT_IO_PROFILER) is set. Paths are reduced to
+/// their first ioProfilerPathDepth ($ECKIT_IO_PROFILER_PATH_DEPTH) components. Recording is lock-free, the profile of
+/// a handle being looked up once, when it is opened.
+///
+/// The profile can be exported to Metrics, as JSON, and is saved at exit into ioProfilerOutput
+/// ($ECKIT_IO_PROFILER_OUTPUT), if set, which eckit-info --io-profile prints.
+
+class IOProfiler : private NonCopyable {
+public:  // types
+    enum Operation
+    {
+        OPEN,
+        READ,
+        WRITE,
+        SEEK,
+        FLUSH,
+        CLOSE,
+        OPERATIONS
+    };
+
+    struct Profile {
+        LatencyHistogram latencies_[OPERATIONS];
+        std::atomic<unsigned long long> bytesRead_{0};
+        std::atomic<unsigned long long> bytesWritten_{0};
+    };
+
+public:  // methods
+    static IOProfiler& instance();
+
+    static bool enabled();
+
+    static const char* name(Operation);
+
+    /// The first components of the path, keeping any "node:" prefix
+    static std::string prefix(const std::string& path);
+
+    /// The profile of the handles of this class, for this path. It lives as long as the process.
+    Profile& profile(const std::string& handleClass, const std::string& path);
+    Profile& profile(const DataHandle&);
+
+    void reset();
+
+    /// By handle class, then path prefix, then operation
+    Value report() const;
+
+    void json(JSON&) const;
+    void collectMetrics() const;
+    void save(const PathName&) const;
+
+    void print(std::ostream&) const;
+
+private:  // methods
+    IOProfiler();
+    ~IOProfiler();
+
+    friend std::ostream& operator<<(std::ostream& s, const IOProfiler& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    mutable Mutex mutex_;
+    std::map<std::string, std::map<std::string, std::unique_ptr<Profile>>> profiles_;
+    std::string output_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
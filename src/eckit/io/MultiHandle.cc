@@ -8,12 +8,20 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <numeric>
 
 #include "eckit/config/Resource.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/io/MultiHandle.h"
 #include "eckit/log/Timer.h"
 #include "eckit/runtime/Metrics.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/MutexCond.h"
+#include "eckit/thread/Thread.h"
+#include "eckit/thread/ThreadControler.h"
 #include "eckit/types/Types.h"
 
 namespace eckit {
@@ -26,14 +34,208 @@ ClassSpec MultiHandle::classSpec_ = {
 };
 Reanimator<MultiHandle> MultiHandle::reanimator_;
 
+//----------------------------------------------------------------------------------------------------------------------
+
+static size_t defaultPrefetch() {
+    static size_t prefetch = Resource<size_t>("multiHandlePrefetch;$ECKIT_MULTIHANDLE_PREFETCH", 0);
+    return prefetch;
+}
+
+/// The handles being read ahead, in order, from the one being consumed. Each one is read by a thread, into a queue
+/// of buffers bounded to its share of the buffer size.
+
+struct MultiHandle::Prefetcher {
+
+    struct Slot {
+        DataHandle* handle_;
+        Offset from_;   // to start reading from
+        bool restart_;  // with restartReadFrom(), rather than seek()
+        bool eof_;      // and closed
+        std::string error_;
+        std::deque<std::pair<Buffer, size_t>> buffers_;
+        size_t head_;  // bytes consumed from the first buffer
+        size_t queued_;
+
+        Slot(DataHandle* handle) :
+            handle_(handle), from_(0), restart_(false), eof_(false), head_(0), queued_(0) {}
+    };
+
+    const HandleList& handles_;
+    size_t ahead_;
+    size_t limit_;  // of the bytes queued per slot
+    size_t chunk_;
+
+    // Where to start
+    size_t first_;
+    Offset from_;
+    bool restart_;
+
+    MutexCond cond_;
+    std::deque<std::unique_ptr<Slot>> slots_;
+    size_t next_;  // handle, to assign to a reader
+    bool stop_;
+    Offset position_;  // of the data returned so far
+
+    std::vector<std::unique_ptr<ThreadControler>> threads_;
+
+    Prefetcher(const HandleList& handles, size_t ahead, size_t first, const Offset& from, bool restart,
+               const Offset& position) :
+        handles_(handles),
+        ahead_(ahead),
+        first_(first),
+        from_(from),
+        restart_(restart),
+        next_(first),
+        stop_(false),
+        position_(position) {
+        static size_t size = Resource<size_t>("multiHandlePrefetchBufferSize;$ECKIT_MULTIHANDLE_PREFETCH_BUFFER_SIZE",
+                                              64 * 1024 * 1024);
+        limit_ = std::max<size_t>(size / ahead_, 1);
+        chunk_ = std::min<size_t>(limit_, 1024 * 1024);
+    }
+
+    size_t consumed() const { return next_ - slots_.size(); }
+};
+
+class MultiHandleReader : public Thread {
+    MultiHandle::Prefetcher& owner_;
+    void run() override;
+    void read(MultiHandle::Prefetcher::Slot&);
+
+public:
+    MultiHandleReader(MultiHandle::Prefetcher& owner) :
+        owner_(owner) {}
+};
+
+void MultiHandleReader::run() {
+    AutoLock<MutexCond> lock(owner_.cond_);
+
+    for (;;) {
+        while (!owner_.stop_ && owner_.next_ < owner_.handles_.size()
+               && owner_.next_ >= owner_.consumed() + owner_.ahead_) {
+            owner_.cond_.wait();
+        }
+
+        if (owner_.stop_ || owner_.next_ >= owner_.handles_.size()) {
+            return;
+        }
+
+        // Slots are created in order, by whichever reader is free
+
+        owner_.slots_.emplace_back(new MultiHandle::Prefetcher::Slot(owner_.handles_[owner_.next_]));
+        MultiHandle::Prefetcher::Slot* slot = owner_.slots_.back().get();
+        if (owner_.next_ == owner_.first_) {
+            slot->from_    = owner_.from_;
+            slot->restart_ = owner_.restart_;
+        }
+        owner_.next_++;
+
+        read(*slot);
+    }
+}
+
+void MultiHandleReader::read(MultiHandle::Prefetcher::Slot& slot) {
+
+    // With the lock held, released during I/O.
+    //
+    // A copy of the handle is read, which is opened, read, closed and deleted by this thread: some handles keep
+    // per-thread state that must not outlive the thread (e.g. PartFileHandle, through PooledHandle)
+
+    std::unique_ptr<DataHandle> clone;
+    DataHandle* handle = slot.handle_;
+    bool opened        = false;
+
+    try {
+        owner_.cond_.unlock();
+        try {
+            try {
+                clone.reset(slot.handle_->clone());
+                handle = clone.get();
+            }
+            catch (NotImplemented&) {
+            }
+
+            handle->openForRead();
+            opened = true;
+            if (slot.from_ != Offset(0)) {
+                if (slot.restart_) {
+                    handle->restartReadFrom(slot.from_);
+                }
+                else {
+                    handle->seek(slot.from_);
+                }
+            }
+        }
+        catch (...) {
+            owner_.cond_.lock();
+            throw;
+        }
+        owner_.cond_.lock();
+
+        for (;;) {
+            while (!owner_.stop_ && slot.queued_ >= owner_.limit_) {
+                owner_.cond_.wait();
+            }
+            if (owner_.stop_) {
+                break;
+            }
+
+            owner_.cond_.unlock();
+            Buffer buffer(owner_.chunk_);
+            long n;
+            try {
+                n = handle->read(buffer, buffer.size());
+                if (n <= 0) {
+                    opened = false;
+                    handle->close();
+                }
+            }
+            catch (...) {
+                owner_.cond_.lock();
+                throw;
+            }
+            owner_.cond_.lock();
+
+            if (n <= 0) {
+                slot.eof_ = true;
+                owner_.cond_.broadcast();
+                return;
+            }
+
+            slot.buffers_.emplace_back(std::move(buffer), n);
+            slot.queued_ += n;
+            owner_.cond_.broadcast();
+        }
+    }
+    catch (std::exception& e) {
+        slot.error_ = e.what();
+        owner_.cond_.broadcast();
+    }
+
+    // Stopped, or failed
+
+    if (opened) {
+        owner_.cond_.unlock();
+        try {
+            handle->close();
+        }
+        catch (std::exception& e) {
+            Log::warning() << "MultiHandle: closing " << *handle << ": " << e.what() << std::endl;
+        }
+        owner_.cond_.lock();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 MultiHandle::MultiHandle() :
-    current_(datahandles_.end()), read_(false) {}
+    current_(datahandles_.end()), read_(false), prefetch_(defaultPrefetch()) {}
 
 MultiHandle::MultiHandle(const std::vector<DataHandle*>& v) :
-    datahandles_(v), current_(datahandles_.end()), read_(false) {}
+    datahandles_(v), current_(datahandles_.end()), read_(false), prefetch_(defaultPrefetch()) {}
 
 MultiHandle::MultiHandle(Stream& s) :
-    DataHandle(s), read_(false) {
+    DataHandle(s), read_(false), prefetch_(defaultPrefetch()) {
     unsigned long size;
     s >> size;
 
@@ -58,6 +260,7 @@ void MultiHandle::encode(Stream& s) const {
 }
 
 MultiHandle::~MultiHandle() {
+    stopPrefetch();
     for (size_t i = 0; i < datahandles_.size(); i++) {
         delete datahandles_[i];
     }
@@ -94,6 +297,12 @@ Length MultiHandle::openForRead() {
 
     read_ = true;
 
+    if (prefetch_ > 0 && datahandles_.size() > 1) {
+        current_ = datahandles_.end();
+        startPrefetch(0, 0, false, 0);
+        return estimate();
+    }
+
     current_ = datahandles_.begin();
     openCurrent();
 
@@ -158,11 +367,94 @@ long MultiHandle::read1(char* buffer, long length) {
     return n;
 }
 
+void MultiHandle::startPrefetch(size_t handle, const Offset& from, bool restart, const Offset& position) {
+    stopPrefetch();
+
+    ASSERT(handle < datahandles_.size());
+    prefetcher_.reset(new Prefetcher(datahandles_, prefetch_, handle, from, restart, position));
+
+    size_t threads = std::min(prefetch_, datahandles_.size() - handle);
+    for (size_t i = 0; i < threads; ++i) {
+        prefetcher_->threads_.emplace_back(new ThreadControler(new MultiHandleReader(*prefetcher_), false));
+        prefetcher_->threads_.back()->start();
+    }
+}
+
+void MultiHandle::stopPrefetch() {
+    if (!prefetcher_) {
+        return;
+    }
+
+    {
+        AutoLock<MutexCond> lock(prefetcher_->cond_);
+        prefetcher_->stop_ = true;
+        prefetcher_->cond_.broadcast();
+    }
+
+    // The readers close the handles they opened
+
+    for (auto& t : prefetcher_->threads_) {
+        t->wait();
+    }
+
+    prefetcher_.reset();
+}
+
 long MultiHandle::read(void* buffer, long length) {
     char* p    = static_cast<char*>(buffer);
     long n     = 0;
     long total = 0;
 
+    if (prefetcher_) {
+        Prefetcher& f = *prefetcher_;
+        AutoLock<MutexCond> lock(f.cond_);
+
+        while (length > 0) {
+
+            if (f.slots_.empty() && f.next_ >= datahandles_.size()) {
+                break;
+            }
+
+            while (f.slots_.empty()
+                   || (f.slots_.front()->buffers_.empty() && !f.slots_.front()->eof_
+                       && f.slots_.front()->error_.empty())) {
+                f.cond_.wait();
+            }
+
+            Prefetcher::Slot& slot = *f.slots_.front();
+
+            if (!slot.buffers_.empty()) {
+                auto& b  = slot.buffers_.front();
+                size_t m = std::min<size_t>(length, b.second - slot.head_);
+                ::memcpy(p, static_cast<const char*>(b.first) + slot.head_, m);
+                slot.head_ += m;
+                slot.queued_ -= m;
+                if (slot.head_ == b.second) {
+                    slot.buffers_.pop_front();
+                    slot.head_ = 0;
+                }
+                length -= m;
+                total += m;
+                p += m;
+                f.position_ += m;
+                f.cond_.broadcast();
+                continue;
+            }
+
+            if (!slot.error_.empty()) {
+                throw ReadError(slot.handle_->title() + ": " + slot.error_, Here());
+            }
+
+            // Done with this handle
+
+            f.slots_.pop_front();
+            f.cond_.broadcast();
+        }
+
+        Log::debug() << "MultiHandle::read " << total << std::endl;
+        return total;
+    }
+
     while (length > 0 && (n = read1(p, length)) > 0) {
         length -= n;
         total += n;
@@ -219,6 +511,7 @@ long MultiHandle::write(const void* buffer, long length) {
 }
 
 void MultiHandle::close() {
+    stopPrefetch();
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -233,6 +526,10 @@ void MultiHandle::flush() {
 
 void MultiHandle::rewind() {
     ASSERT(read_);
+    if (prefetcher_) {
+        startPrefetch(0, 0, false, 0);
+        return;
+    }
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -320,6 +617,11 @@ bool MultiHandle::canSeek() const {
 }
 
 Offset MultiHandle::position() {
+    if (prefetcher_) {
+        AutoLock<MutexCond> lock(prefetcher_->cond_);
+        return prefetcher_->position_;
+    }
+
     long long accumulated = 0;
     for (HandleList::iterator it = datahandles_.begin(); it != current_ && it != datahandles_.end(); ++it) {
         accumulated += (*it)->size();
@@ -330,6 +632,23 @@ Offset MultiHandle::position() {
 Offset MultiHandle::seek(const Offset& offset) {
     ASSERT(read_);  /// seek only allowed on read mode
 
+    if (prefetcher_) {
+        const long long seekto = offset;
+        long long accumulated  = 0;
+        for (size_t i = 0; i < datahandles_.size(); ++i) {
+            long long size = datahandles_[i]->size();
+            if (accumulated <= seekto && seekto < accumulated + size) {
+                startPrefetch(i, seekto - accumulated, false, offset);
+                return offset;
+            }
+            accumulated += size;
+        }
+        stopPrefetch();
+        Offset beyond = seekto - accumulated;
+        ASSERT(not beyond);
+        return offset;
+    }
+
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -354,6 +673,25 @@ Offset MultiHandle::seek(const Offset& offset) {
 void MultiHandle::restartReadFrom(const Offset& offset) {
     Log::warning() << *this << " restart read from " << offset << std::endl;
     ASSERT(read_);
+
+    if (prefetcher_) {
+        long long from        = offset;
+        long long accumulated = 0;
+        for (size_t i = 0; i < datahandles_.size(); ++i) {
+            long long e = datahandles_[i]->estimate();
+            if (from >= accumulated && from < accumulated + e) {
+                Log::warning() << *this << " restart read from " << from << ", current=" << i << std::endl;
+                startPrefetch(i, from - accumulated, true, offset);
+                return;
+            }
+            accumulated += e;
+        }
+        stopPrefetch();
+        Offset beyond = from - accumulated;
+        ASSERT(not beyond);
+        return;
+    }
+
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
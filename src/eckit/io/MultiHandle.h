@@ -17,12 +17,21 @@
 #ifndef eckit_filesystem_MultiHandle_h
 #define eckit_filesystem_MultiHandle_h
 
+#include <memory>
+
 #include "eckit/io/DataHandle.h"
 
 namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Concatenates several handles.
+///
+/// When reading, the next handles can be prefetched: up to prefetch() of them are opened and read ahead, each by a
+/// background thread, into a bounded amount of buffers (multiHandlePrefetchBufferSize, shared among them). The
+/// threads read clones of the handles, when they can be cloned. The data is returned in order, and errors are
+/// reported when the handle that failed is reached.
+
 class MultiHandle : public DataHandle {
 public:
     typedef std::vector<DataHandle*> HandleList;
@@ -44,6 +53,12 @@ public:
     virtual void operator+=(DataHandle*);
     virtual void operator+=(const Length&);
 
+    // -- Methods
+
+    /// The number of handles to read ahead, 0 to read them in turn. Defaults to multiHandlePrefetch.
+    void prefetch(size_t handles) { prefetch_ = handles; }
+    size_t prefetch() const { return prefetch_; }
+
     // -- Overridden methods
 
     // From DataHandle
@@ -98,16 +113,25 @@ private:
     mutable std::set<std::string> requiredAttributes_;
     bool read_;
 
+    struct Prefetcher;
+    size_t prefetch_;
+    std::unique_ptr<Prefetcher> prefetcher_;
+
     // -- Methods
 
     void openCurrent();
     void open();
     long read1(char*, long);
 
+    void startPrefetch(size_t handle, const Offset& from, bool restart, const Offset& position);
+    void stopPrefetch();
+
     // -- Class members
 
     static ClassSpec classSpec_;
     static Reanimator<MultiHandle> reanimator_;
+
+    friend class MultiHandleReader;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
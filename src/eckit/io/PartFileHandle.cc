@@ -18,6 +18,7 @@
 #include "eckit/io/PartFileHandle.h"
 
 #include "eckit/io/PooledHandle.h"
+#include "eckit/utils/MD5.h"
 
 namespace eckit {
 
@@ -285,6 +286,15 @@ std::string PartFileHandle::metricsTag() const {
     return PathName::metricsTag(path_);
 }
 
+void PartFileHandle::hash(MD5& md5) const {
+    md5 << "PartFileHandle";
+    md5 << std::string(path_);
+    for (size_t i = 0; i < offset_.size(); ++i) {
+        md5 << (long long)offset_[i];
+        md5 << (long long)length_[i];
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit
@@ -66,6 +66,7 @@ public:  // methods
     void cost(std::map<std::string, Length>&, bool) const override;
     std::string title() const override;
     std::string metricsTag() const override;
+    void hash(MD5&) const override;
 
 
     bool moveable() const override { return true; }
@@ -8,6 +8,9 @@
  * does it submit to any jurisdiction.
  */
 
+#include <chrono>
+#include <iomanip>
+
 #include "eckit/eckit.h"
 
 #include "eckit/config/Resource.h"
@@ -19,6 +22,8 @@
 #include "eckit/log/BigNum.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/log/Seconds.h"
+#include "eckit/runtime/Metrics.h"
+#include "eckit/value/Value.h"
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -27,6 +32,33 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Times an operation, and records its latency
+class StatsHandleProbe {
+public:
+    StatsHandleProbe(StatsHandle& handle, IOProfiler::Operation op, double* total = nullptr) :
+        handle_(handle), op_(op), total_(total), start_(std::chrono::steady_clock::now()) {}
+
+    ~StatsHandleProbe() {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_)
+                          .count();
+        handle_.latencies_[op_].recordNanoseconds(ns);
+        if (handle_.profile_) {
+            handle_.profile_->latencies_[op_].recordNanoseconds(ns);
+        }
+        if (total_) {
+            *total_ += ns * 1e-9;
+        }
+    }
+
+private:
+    StatsHandle& handle_;
+    IOProfiler::Operation op_;
+    double* total_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 StatsHandle::StatsHandle(DataHandle& handle) :
     HandleHolder(handle),
     reads_(0),
@@ -38,7 +70,8 @@ StatsHandle::StatsHandle(DataHandle& handle) :
     timer_(),
     readTime_(0),
     writeTime_(0),
-    seekTime_(0) {}
+    seekTime_(0),
+    profile_(nullptr) {}
 
 StatsHandle::StatsHandle(DataHandle* handle) :
     HandleHolder(handle),
@@ -51,7 +84,8 @@ StatsHandle::StatsHandle(DataHandle* handle) :
     timer_(),
     readTime_(0),
     writeTime_(0),
-    seekTime_(0) {}
+    seekTime_(0),
+    profile_(nullptr) {}
 
 StatsHandle::~StatsHandle() {
     std::cout << "StatsHandle for " << handle() << std::endl;
@@ -77,6 +111,19 @@ StatsHandle::~StatsHandle() {
         std::cout << "  No. of seeks: " << eckit::BigNum(seeks_) << std::endl;
         std::cout << "     Seek time: " << eckit::Seconds(seekTime_) << std::endl;
     }
+
+    for (size_t op = 0; op < IOProfiler::OPERATIONS; ++op) {
+        if (latencies_[op].count()) {
+            std::string title = IOProfiler::name(IOProfiler::Operation(op)) + std::string(" latency");
+            std::cout << std::setw(14) << title << ": " << latencies_[op] << std::endl;
+        }
+    }
+}
+
+void StatsHandle::profile() {
+    if (!profile_ && IOProfiler::enabled()) {
+        profile_ = &IOProfiler::instance().profile(handle());
+    }
 }
 
 void StatsHandle::print(std::ostream& s) const {
@@ -88,40 +135,52 @@ void StatsHandle::print(std::ostream& s) const {
 }
 
 Length StatsHandle::openForRead() {
+    profile();
+    StatsHandleProbe probe(*this, IOProfiler::OPEN);
     return handle().openForRead();
 }
 
 void StatsHandle::openForWrite(const Length& l) {
+    profile();
+    StatsHandleProbe probe(*this, IOProfiler::OPEN);
     handle().openForWrite(l);
 }
 
 void StatsHandle::openForAppend(const Length& l) {
+    profile();
+    StatsHandleProbe probe(*this, IOProfiler::OPEN);
     handle().openForAppend(l);
 }
 
 long StatsHandle::read(void* data, long len) {
-    double x = timer_.elapsed();
+    StatsHandleProbe probe(*this, IOProfiler::READ, &readTime_);
     reads_++;
     bytesRead_ += len;
     long ret = handle().read(data, len);
-    readTime_ += timer_.elapsed() - x;
+    if (profile_ && ret > 0) {
+        profile_->bytesRead_ += ret;
+    }
     return ret;
 }
 
 long StatsHandle::write(const void* data, long len) {
-    double x = timer_.elapsed();
+    StatsHandleProbe probe(*this, IOProfiler::WRITE, &writeTime_);
     writes_++;
     bytesWritten_ += len;
     long ret = handle().write(data, len);
-    writeTime_ += timer_.elapsed() - x;
+    if (profile_ && ret > 0) {
+        profile_->bytesWritten_ += ret;
+    }
     return ret;
 }
 
 void StatsHandle::close() {
+    StatsHandleProbe probe(*this, IOProfiler::CLOSE);
     handle().close();
 }
 
 void StatsHandle::flush() {
+    StatsHandleProbe probe(*this, IOProfiler::FLUSH);
     return handle().flush();
 }
 
@@ -134,25 +193,22 @@ Offset StatsHandle::position() {
 }
 
 Offset StatsHandle::seek(const Offset& o) {
-    double x = timer_.elapsed();
+    StatsHandleProbe probe(*this, IOProfiler::SEEK, &seekTime_);
     seeks_++;
     Offset ret = handle().seek(o);
-    seekTime_ += timer_.elapsed() - x;
     return ret;
 }
 
 void StatsHandle::skip(const Length& n) {
-    double x = timer_.elapsed();
+    StatsHandleProbe probe(*this, IOProfiler::SEEK, &seekTime_);
     seeks_++;
     handle().skip(n);
-    seekTime_ += timer_.elapsed() - x;
 }
 
 void StatsHandle::rewind() {
-    double x = timer_.elapsed();
+    StatsHandleProbe probe(*this, IOProfiler::SEEK, &seekTime_);
     seeks_++;
     handle().rewind();
-    seekTime_ += timer_.elapsed() - x;
 }
 
 void StatsHandle::restartReadFrom(const Offset& o) {
@@ -216,6 +272,14 @@ std::string StatsHandle::title() const {
 
 void StatsHandle::collectMetrics(const std::string& what) const {
     handle().collectMetrics(what);
+
+    Value latencies = Value::makeOrderedMap();
+    for (size_t op = 0; op < IOProfiler::OPERATIONS; ++op) {
+        if (latencies_[op].count()) {
+            latencies[IOProfiler::name(IOProfiler::Operation(op))] = latencies_[op].summary();
+        }
+    }
+    Metrics::set(what + "_latency", latencies);
 }
 
 Length StatsHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
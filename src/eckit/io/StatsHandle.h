@@ -17,6 +17,8 @@
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/Buffer.h"
 #include "eckit/io/HandleHolder.h"
+#include "eckit/io/IOProfiler.h"
+#include "eckit/log/LatencyHistogram.h"
 #include "eckit/log/Timer.h"
 #include "eckit/types/Types.h"
 
@@ -26,6 +28,9 @@ namespace eckit {
 
 //-----------------------------------------------------------------------------
 
+/// Wraps a handle, and reports statistics of its use when destroyed: counts, bytes, times, and latency histograms
+/// of each operation. The latencies are also recorded by the IOProfiler, if enabled.
+
 class StatsHandle : public DataHandle, public HandleHolder {
 public:
     // -- Contructors
@@ -39,6 +44,8 @@ public:
 
     // -- Methods
 
+    const LatencyHistogram& latency(IOProfiler::Operation op) const { return latencies_[op]; }
+
     // -- Overridden methods
 
     // From DataHandle
@@ -105,6 +112,15 @@ private:
     double readTime_;
     double writeTime_;
     double seekTime_;
+
+    LatencyHistogram latencies_[IOProfiler::OPERATIONS];
+    IOProfiler::Profile* profile_;
+
+    // -- Methods
+
+    void profile();
+
+    friend class StatsHandleProbe;
 };
 
 
@@ -8,8 +8,21 @@
  * does it submit to any jurisdiction.
  */
 
-#include "eckit/io/TeeHandle.h"
+#include <cstring>
+#include <deque>
+#include <sstream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/io/SharedBuffer.h"
+#include "eckit/io/TeeHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Timer.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/MutexCond.h"
+#include "eckit/thread/Thread.h"
+#include "eckit/thread/ThreadControler.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -23,19 +36,101 @@ ClassSpec TeeHandle::classSpec_ = {
 };
 Reanimator<TeeHandle> TeeHandle::reanimator_;
 
-TeeHandle::TeeHandle() {}
+//----------------------------------------------------------------------------------------------------------------------
+
+struct TeeHandle::Sink {
+    DataHandle& handle_;
+
+    MutexCond cond_;
+    std::deque<std::pair<SharedBuffer, long>> queue_;  // the front is being written
+    size_t queued_;                                    // bytes
+    bool done_;                                        // nothing more will be queued
+    std::string error_;
+
+    Statistics statistics_;
+
+    std::unique_ptr<ThreadControler> thread_;
+
+    Sink(DataHandle& handle) :
+        handle_(handle), queued_(0), done_(false), statistics_{0, 0, 0} {}
+};
+
+class TeeHandleWriter : public Thread {
+    TeeHandle::Sink& sink_;
+    void run() override;
+
+public:
+    TeeHandleWriter(TeeHandle::Sink& sink) :
+        sink_(sink) {}
+};
+
+void TeeHandleWriter::run() {
+    AutoLock<MutexCond> lock(sink_.cond_);
+
+    for (;;) {
+        while (sink_.queue_.empty() && !sink_.done_) {
+            sink_.cond_.wait();
+        }
+
+        if (sink_.queue_.empty()) {
+            return;
+        }
+
+        // Write without holding the lock, so that more buffers can be queued meanwhile
+
+        std::pair<SharedBuffer, long> p = sink_.queue_.front();
+        sink_.cond_.unlock();
+
+        std::string error;
+        Timer timer;
+        try {
+            long written = sink_.handle_.write(p.first.data(), p.second);
+            if (written != p.second) {
+                std::ostringstream oss;
+                oss << "written " << written << " out of " << p.second;
+                error = oss.str();
+            }
+        }
+        catch (std::exception& e) {
+            error = e.what();
+        }
+        double elapsed = timer.elapsed();
 
-TeeHandle::TeeHandle(const std::vector<DataHandle*>& v) :
-    datahandles_(v) {}
+        sink_.cond_.lock();
 
-TeeHandle::TeeHandle(DataHandle* a, DataHandle* b) {
+        sink_.queue_.pop_front();
+        sink_.queued_ -= p.second;
+        sink_.statistics_.bytes_ += p.second;
+        sink_.statistics_.writeTime_ += elapsed;
+
+        if (!error.empty()) {
+            Log::error() << "TeeHandleWriter: " << sink_.handle_ << ": " << error << std::endl;
+            sink_.error_ = error;
+            sink_.queue_.clear();
+            sink_.queued_ = 0;
+        }
+
+        sink_.cond_.broadcast();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TeeHandle::TeeHandle(bool async) :
+    async_(async) {}
+
+TeeHandle::TeeHandle(const std::vector<DataHandle*>& v, bool async) :
+    datahandles_(v), async_(async) {}
+
+TeeHandle::TeeHandle(DataHandle* a, DataHandle* b, bool async) :
+    async_(async) {
     datahandles_.push_back(a);
     datahandles_.push_back(b);
 }
 
 
 TeeHandle::TeeHandle(Stream& s) :
-    DataHandle(s) {
+    DataHandle(s), async_(false) {
     unsigned long size;
     s >> size;
 
@@ -57,6 +152,7 @@ void TeeHandle::encode(Stream& s) const {
 }
 
 TeeHandle::~TeeHandle() {
+    stop();
     for (size_t i = 0; i < datahandles_.size(); i++) {
         delete datahandles_[i];
     }
@@ -72,9 +168,43 @@ Length TeeHandle::openForRead() {
 }
 
 void TeeHandle::openForWrite(const Length& length) {
+    stop();
     for (size_t i = 0; i < datahandles_.size(); i++) {
         datahandles_[i]->openForWrite(length);
     }
+    start();
+}
+
+void TeeHandle::start() {
+    for (DataHandle* dh : datahandles_) {
+        sinks_.emplace_back(new Sink(*dh));
+        if (async_) {
+            Sink& sink = *sinks_.back();
+            sink.thread_.reset(new ThreadControler(new TeeHandleWriter(sink), false));
+            sink.thread_->start();
+        }
+    }
+}
+
+void TeeHandle::stop() {
+
+    // Without close(), e.g. after an exception, the data still queued is dropped
+
+    for (auto& sink : sinks_) {
+        if (sink->thread_) {
+            {
+                AutoLock<MutexCond> lock(sink->cond_);
+                sink->done_ = true;
+                if (sink->queue_.size() > 1) {
+                    sink->queue_.erase(sink->queue_.begin() + 1, sink->queue_.end());  // The front is being written
+                }
+                sink->cond_.broadcast();
+            }
+            sink->thread_->wait();
+            sink->thread_.reset();
+        }
+    }
+    sinks_.clear();
 }
 
 void TeeHandle::openForAppend(const Length&) {
@@ -86,29 +216,143 @@ long TeeHandle::read(void*, long) {
 }
 
 long TeeHandle::write(const void* buffer, long length) {
-    long len = 0;
-    for (size_t i = 0; i < datahandles_.size(); i++) {
-        long l = datahandles_[i]->write(buffer, length);
-        if (i) {
-            ASSERT(len == l);
+
+    if (!async_) {
+        long len = 0;
+        for (size_t i = 0; i < datahandles_.size(); i++) {
+            Timer timer;
+            long l = datahandles_[i]->write(buffer, length);
+            if (i) {
+                ASSERT(len == l);
+            }
+            len = l;
+            if (i < sinks_.size()) {
+                sinks_[i]->statistics_.bytes_ += l;
+                sinks_[i]->statistics_.writeTime_ += timer.elapsed();
+            }
         }
-        len = l;
+        return len;
+    }
+
+    ASSERT(sinks_.size() == datahandles_.size());
+
+    static size_t queueSize = Resource<size_t>("teeHandleQueueSize;$ECKIT_TEE_HANDLE_QUEUE_SIZE", 64 * 1024 * 1024);
+
+    if (length <= 0) {
+        return length;
     }
-    return len;
+
+    SharedBuffer shared(length);
+    ::memcpy(shared.data(), buffer, length);
+
+    for (auto& sink : sinks_) {
+        ASSERT(sink->thread_);
+        AutoLock<MutexCond> lock(sink->cond_);
+
+        // A buffer larger than the queue is queued on its own
+
+        if (!sink->queue_.empty() && sink->queued_ + length > queueSize && sink->error_.empty()) {
+            Timer timer;
+            while (!sink->queue_.empty() && sink->queued_ + length > queueSize && sink->error_.empty()) {
+                sink->cond_.wait();
+            }
+            sink->statistics_.waitTime_ += timer.elapsed();
+        }
+
+        // The error is reported on close()
+
+        if (!sink->error_.empty()) {
+            continue;
+        }
+
+        sink->queue_.emplace_back(shared, length);
+        sink->queued_ += length;
+        sink->cond_.broadcast();
+    }
+
+    return length;
 }
 
 void TeeHandle::close() {
-    for (size_t i = 0; i < datahandles_.size(); i++) {
-        datahandles_[i]->close();
+
+    if (!async_) {
+        for (size_t i = 0; i < datahandles_.size(); i++) {
+            datahandles_[i]->close();
+        }
+        return;
+    }
+
+    // Let the writers drain their queues, then close all the handles, whatever the errors
+
+    for (auto& sink : sinks_) {
+        AutoLock<MutexCond> lock(sink->cond_);
+        sink->done_ = true;
+        sink->cond_.broadcast();
+    }
+
+    std::ostringstream errors;
+    for (auto& sink : sinks_) {
+        // Already drained, and its error reported, by a previous close()
+        if (!sink->thread_) {
+            continue;
+        }
+
+        sink->thread_->wait();
+        sink->thread_.reset();
+        if (!sink->error_.empty()) {
+            errors << " " << sink->handle_ << ": " << sink->error_ << ";";
+        }
+
+        const Statistics& s = sink->statistics_;
+        LOG_DEBUG_LIB(LibEcKit) << "TeeHandle: " << sink->handle_ << ": " << Bytes(s.bytes_) << " in "
+                                << s.writeTime_ << "s (" << Bytes(s.bytes_, s.writeTime_) << "), waited for "
+                                << s.waitTime_ << "s" << std::endl;
+    }
+
+    for (DataHandle* dh : datahandles_) {
+        try {
+            dh->close();
+        }
+        catch (std::exception& e) {
+            errors << " " << *dh << ": " << e.what() << ";";
+        }
+    }
+
+    std::string message = errors.str();
+    if (!message.empty()) {
+        throw WriteError("TeeHandle:" + message);
     }
 }
 
 void TeeHandle::flush() {
+
+    // In asynchronous mode, wait until what was written so far is handed over to the handles (except those that
+    // failed)
+
     for (size_t i = 0; i < datahandles_.size(); i++) {
+        if (i < sinks_.size() && sinks_[i]->thread_) {
+            Sink& sink = *sinks_[i];
+            AutoLock<MutexCond> lock(sink.cond_);
+            while (!sink.queue_.empty()) {
+                sink.cond_.wait();
+            }
+            if (!sink.error_.empty()) {
+                continue;
+            }
+        }
         datahandles_[i]->flush();
     }
 }
 
+std::vector<TeeHandle::Statistics> TeeHandle::statistics() const {
+    std::vector<Statistics> result;
+    for (const auto& sink : sinks_) {
+        AutoLock<MutexCond> lock(sink->cond_);
+        result.push_back(sink->statistics_);
+    }
+    return result;
+}
+
 void TeeHandle::rewind() {
     NOTIMP;
 }
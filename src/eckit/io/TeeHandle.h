@@ -14,6 +14,8 @@
 #ifndef eckit_filesystem_TeeHandle_h
 #define eckit_filesystem_TeeHandle_h
 
+#include <memory>
+
 #include "eckit/io/DataHandle.h"
 
 //-----------------------------------------------------------------------------
@@ -22,15 +24,30 @@ namespace eckit {
 
 //-----------------------------------------------------------------------------
 
+/// Writes the same data to several handles.
+///
+/// In asynchronous mode, each handle is written to by its own thread, from a bounded queue of the buffers
+/// still to write, which are shared by all the handles (the data is copied once). A slow handle then only
+/// holds back the others once its queue is full. Errors are reported by close(), once all the handles are
+/// closed; a handle that fails is not written to any more.
+
 class TeeHandle : public DataHandle {
 public:
     typedef std::vector<DataHandle*> HandleList;
 
+    /// Of the writes to one of the handles
+    struct Statistics {
+        Length bytes_;
+        double writeTime_;  // spent writing to the handle
+        double waitTime_;   // spent waiting for room in the queue of the handle (asynchronous mode)
+    };
+
     // -- Contructors
 
-    TeeHandle();
-    TeeHandle(DataHandle*, DataHandle*);
-    TeeHandle(const HandleList&);
+    explicit TeeHandle(bool async = false);
+    TeeHandle(DataHandle*) = delete;  // would convert to bool, rather than tee to the handle
+    TeeHandle(DataHandle*, DataHandle*, bool async = false);
+    TeeHandle(const HandleList&, bool async = false);
     TeeHandle(Stream&);
 
     // -- Destructor
@@ -41,6 +58,13 @@ public:
 
     virtual void operator+=(DataHandle*);
 
+    // -- Methods
+
+    bool async() const { return async_; }
+
+    /// Per handle, since the last open
+    std::vector<Statistics> statistics() const;
+
     // -- Overridden methods
 
     // From DataHandle
@@ -75,18 +99,30 @@ public:
     static const ClassSpec& classSpec() { return classSpec_; }
 
 private:
+    // -- Types
+
+    struct Sink;
+
     // -- Members
 
     HandleList datahandles_;
+    bool async_;
+
+    std::vector<std::unique_ptr<Sink>> sinks_;
 
     // -- Methods
 
+    void start();
+    void stop();
+
     // -- Class members
 
     static ClassSpec classSpec_;
     static Reanimator<TeeHandle> reanimator_;
 
     mutable std::set<std::string> requiredAttributes_;
+
+    friend class TeeHandleWriter;
 };
 
 
@@ -13,6 +13,7 @@
 #include "eckit/io/URLHandle.h"
 
 #include "eckit/io/EasyCURL.h"
+#include "eckit/utils/MD5.h"
 
 namespace eckit {
 
@@ -29,6 +30,11 @@ void URLHandle::print(std::ostream& s) const {
     s << "URLHandle[uri=" << uri_ << ']';
 }
 
+void URLHandle::hash(MD5& md5) const {
+    md5 << "URLHandle";
+    md5 << uri_;
+}
+
 void URLHandle::encode(Stream& s) const {
     DataHandle::encode(s);
     s << uri_;
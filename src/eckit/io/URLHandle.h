@@ -58,6 +58,8 @@ public:
 
     bool canSeek() const override { return false; }
 
+    void hash(MD5&) const override;
+
     // From Streamable
 
     void encode(Stream&) const override;
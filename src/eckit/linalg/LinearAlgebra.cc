@@ -15,6 +15,7 @@
 #include <sstream>
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/log/Tracer.h"
 #include "eckit/utils/StringTools.h"
 
 namespace eckit::linalg {
@@ -115,6 +116,42 @@ std::string LinearAlgebra::name() {
 }
 
 
+Scalar LinearAlgebra::dot(const Vector& x, const Vector& y) {
+    ECKIT_TRACE_SPAN("linalg::dot", "linalg");
+    return LinearAlgebraDense::backend().dot(x, y);
+}
+
+
+void LinearAlgebra::gemv(const Matrix& A, const Vector& x, Vector& y) {
+    ECKIT_TRACE_SPAN("linalg::gemv", "linalg");
+    LinearAlgebraDense::backend().gemv(A, x, y);
+}
+
+
+void LinearAlgebra::gemm(const Matrix& A, const Matrix& X, Matrix& Y) {
+    ECKIT_TRACE_SPAN("linalg::gemm", "linalg");
+    LinearAlgebraDense::backend().gemm(A, X, Y);
+}
+
+
+void LinearAlgebra::spmv(const SparseMatrix& A, const Vector& x, Vector& y) {
+    ECKIT_TRACE_SPAN("linalg::spmv", "linalg");
+    LinearAlgebraSparse::backend().spmv(A, x, y);
+}
+
+
+void LinearAlgebra::spmm(const SparseMatrix& A, const Matrix& X, Matrix& Y) {
+    ECKIT_TRACE_SPAN("linalg::spmm", "linalg");
+    LinearAlgebraSparse::backend().spmm(A, X, Y);
+}
+
+
+void LinearAlgebra::dsptd(const Vector& x, const SparseMatrix& A, const Vector& y, SparseMatrix& B) {
+    ECKIT_TRACE_SPAN("linalg::dsptd", "linalg");
+    LinearAlgebraSparse::backend().dsptd(x, A, y, B);
+}
+
+
 //-----------------------------------------------------------------------------
 
 }  // namespace eckit::linalg
@@ -67,40 +67,28 @@ public:
     static std::string name();
 
     /// Compute the inner product of vectors x and y
-    static Scalar dot(const Vector& x, const Vector& y) {
-        return LinearAlgebraDense::backend().dot(x, y);
-    }
+    static Scalar dot(const Vector& x, const Vector& y);
 
     /// Compute the product of a dense matrix A and vector x
     /// @note y must be allocated and sized correctly
-    static void gemv(const Matrix& A, const Vector& x, Vector& y) {
-        LinearAlgebraDense::backend().gemv(A, x, y);
-    }
+    static void gemv(const Matrix& A, const Vector& x, Vector& y);
 
     /// Compute the product of dense matrices A and X
     /// @note Y must be allocated and sized correctly
-    static void gemm(const Matrix& A, const Matrix& X, Matrix& Y) {
-        LinearAlgebraDense::backend().gemm(A, X, Y);
-    }
+    static void gemm(const Matrix& A, const Matrix& X, Matrix& Y);
 
     /// Compute the product of a sparse matrix A and vector x
     /// @note y must be allocated and sized correctly
-    static void spmv(const SparseMatrix& A, const Vector& x, Vector& y) {
-        LinearAlgebraSparse::backend().spmv(A, x, y);
-    }
+    static void spmv(const SparseMatrix& A, const Vector& x, Vector& y);
 
     /// Compute the product of sparse matrix A and dense matrix X
     /// @note Y must be allocated and sized correctly
-    static void spmm(const SparseMatrix& A, const Matrix& X, Matrix& Y) {
-        LinearAlgebraSparse::backend().spmm(A, X, Y);
-    }
+    static void spmm(const SparseMatrix& A, const Matrix& X, Matrix& Y);
 
     /// Compute the product x A' y with x and y diagonal matrices stored as
     /// vectors and A a sparse matrix
     /// @note B does NOT need to be allocated/sized correctly
-    static void dsptd(const Vector& x, const SparseMatrix& A, const Vector& y, SparseMatrix& B) {
-        LinearAlgebraSparse::backend().dsptd(x, A, y, B);
-    }
+    static void dsptd(const Vector& x, const SparseMatrix& A, const Vector& y, SparseMatrix& B);
 
 protected:
     LinearAlgebra() = default;
@@ -0,0 +1,228 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/log/LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/value/Value.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const uint64_t SUB_BUCKETS = uint64_t(1) << LatencyHistogram::SUB_BUCKET_BITS;
+static const uint64_t NO_MIN      = std::numeric_limits<uint64_t>::max();
+
+static const std::memory_order relaxed = std::memory_order_relaxed;
+
+static void print(std::ostream& s, double seconds) {
+    if (seconds < 1e-6) {
+        s << std::round(seconds * 1e9) << "ns";
+    }
+    else if (seconds < 1e-3) {
+        s << std::setprecision(3) << seconds * 1e6 << "us";
+    }
+    else if (seconds < 1) {
+        s << std::setprecision(3) << seconds * 1e3 << "ms";
+    }
+    else {
+        s << std::setprecision(3) << seconds << "s";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other) {
+    reset();
+    *this += other;
+}
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other) {
+    if (this != &other) {
+        reset();
+        *this += other;
+    }
+    return *this;
+}
+
+LatencyHistogram& LatencyHistogram::operator+=(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        if (uint64_t n = other.counts_[i].load(relaxed)) {
+            counts_[i].fetch_add(n, relaxed);
+        }
+    }
+
+    count_.fetch_add(other.count_.load(relaxed), relaxed);
+    sum_.fetch_add(other.sum_.load(relaxed), relaxed);
+
+    uint64_t lo = other.min_.load(relaxed);
+    uint64_t m  = min_.load(relaxed);
+    while (lo < m && !min_.compare_exchange_weak(m, lo, relaxed)) {}
+
+    uint64_t hi = other.max_.load(relaxed);
+    m           = max_.load(relaxed);
+    while (hi > m && !max_.compare_exchange_weak(m, hi, relaxed)) {}
+
+    return *this;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts_) {
+        c.store(0, relaxed);
+    }
+    count_.store(0, relaxed);
+    sum_.store(0, relaxed);
+    min_.store(NO_MIN, relaxed);
+    max_.store(0, relaxed);
+}
+
+size_t LatencyHistogram::bucket(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+
+    // The magnitude selects a group of buckets, and the next SUB_BUCKET_BITS bits the bucket in the group
+
+    size_t magnitude = 63 - __builtin_clzll(value);
+    if (magnitude >= MAX_BITS) {
+        return BUCKETS - 1;
+    }
+
+    size_t shift = magnitude - SUB_BUCKET_BITS;
+    return ((shift + 1) << SUB_BUCKET_BITS) + ((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::lowest(size_t bucket) {
+    size_t group = bucket >> SUB_BUCKET_BITS;
+    uint64_t sub = bucket & (SUB_BUCKETS - 1);
+    return group == 0 ? sub : (SUB_BUCKETS + sub) << (group - 1);
+}
+
+uint64_t LatencyHistogram::highest(size_t bucket) {
+    size_t group = bucket >> SUB_BUCKET_BITS;
+    return lowest(bucket) + (group == 0 ? 0 : (uint64_t(1) << (group - 1)) - 1);
+}
+
+void LatencyHistogram::recordNanoseconds(uint64_t value) {
+    counts_[bucket(value)].fetch_add(1, relaxed);
+    count_.fetch_add(1, relaxed);
+    sum_.fetch_add(value, relaxed);
+
+    uint64_t m = min_.load(relaxed);
+    while (value < m && !min_.compare_exchange_weak(m, value, relaxed)) {}
+
+    m = max_.load(relaxed);
+    while (value > m && !max_.compare_exchange_weak(m, value, relaxed)) {}
+}
+
+double LatencyHistogram::sum() const {
+    return sum_.load(relaxed) * 1e-9;
+}
+
+double LatencyHistogram::mean() const {
+    size_t n = count();
+    return n ? sum() / n : 0;
+}
+
+double LatencyHistogram::min() const {
+    return count() ? min_.load(relaxed) * 1e-9 : 0;
+}
+
+double LatencyHistogram::max() const {
+    return max_.load(relaxed) * 1e-9;
+}
+
+double LatencyHistogram::percentile(double p) const {
+    ASSERT(p >= 0 && p <= 100);
+
+    uint64_t total = 0;
+    for (const auto& c : counts_) {
+        total += c.load(relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // The rank of the value, from 1 to total
+
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p / 100. * total)));
+    uint64_t seen = 0;
+
+    // The largest value is known exactly
+
+    if (rank >= total) {
+        return max();
+    }
+
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts_[i].load(relaxed);
+        if (seen >= rank) {
+            // The middle of the bucket, within the values recorded
+            uint64_t value = lowest(i) + (highest(i) - lowest(i)) / 2;
+            value          = std::min(std::max(value, min_.load(relaxed)), max_.load(relaxed));
+            return value * 1e-9;
+        }
+    }
+
+    return max();
+}
+
+Value LatencyHistogram::summary() const {
+    Value v = Value::makeOrderedMap();
+
+    v["count"] = count();
+    v["mean"]  = mean();
+    v["min"]   = min();
+    v["max"]   = max();
+    v["p50"]   = percentile(50);
+    v["p90"]   = percentile(90);
+    v["p99"]   = percentile(99);
+    v["p99.9"] = percentile(99.9);
+
+    return v;
+}
+
+void LatencyHistogram::print(std::ostream& s) const {
+    std::ios::fmtflags flags(s.flags());
+    std::streamsize precision = s.precision();
+
+    s << "count=" << count();
+    if (count()) {
+        s << ", mean=";
+        eckit::print(s, mean());
+        s << ", p50=";
+        eckit::print(s, percentile(50));
+        s << ", p90=";
+        eckit::print(s, percentile(90));
+        s << ", p99=";
+        eckit::print(s, percentile(99));
+        s << ", p99.9=";
+        eckit::print(s, percentile(99.9));
+        s << ", max=";
+        eckit::print(s, max());
+    }
+
+    s.flags(flags);
+    s.precision(precision);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
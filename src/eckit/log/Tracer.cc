@@ -0,0 +1,430 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/log/Tracer.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/log/JSON.h"
+#include "eckit/serialisation/FileStream.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/utils/StringTools.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const char* MAGIC = "eckit::Tracer";
+static const int VERSION = 1;
+
+static uint64_t nanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Read from the environment rather than with a Resource, as spans can be recorded before Main is initialised
+
+static bool tracing() {
+    const char* e = ::getenv("ECKIT_TRACE");
+    return e && *e && std::string(e) != "0";
+}
+
+std::atomic<bool> Tracer::enabled_(tracing());
+
+// For converting ticks to time, from when the library is loaded
+
+static const uint64_t ticks0_       = Tracer::ticks();
+static const uint64_t nanoseconds0_ = nanoseconds();
+
+static std::atomic<Tracer*> tracer_(nullptr);
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The events of one thread. Only that thread writes to it; exporting reads it concurrently, and drops the events
+/// that may have been overwritten while they were copied.
+class TraceBuffer : private NonCopyable {
+public:
+    explicit TraceBuffer(size_t capacity) : events_(capacity), mask_(capacity - 1), head_(0), tail_(0), thread_(0) {
+        ASSERT((capacity & mask_) == 0);
+    }
+
+    void push(const TraceEvent& e) {
+        uint64_t h         = head_.load(std::memory_order_relaxed);
+        events_[h & mask_]         = e;
+        events_[h & mask_].thread_ = thread_;
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    void snapshot(std::vector<TraceEvent>& out) const {
+        uint64_t head  = head_.load(std::memory_order_acquire);
+        uint64_t first = std::max<uint64_t>(tail_.load(std::memory_order_relaxed),
+                                            head > events_.size() ? head - events_.size() : 0);
+
+        std::vector<TraceEvent> copy;
+        copy.reserve(head - first);
+        for (uint64_t i = first; i < head; ++i) {
+            copy.push_back(events_[i & mask_]);
+        }
+
+        uint64_t now  = head_.load(std::memory_order_acquire);
+        uint64_t lost = now > events_.size() + first ? now - events_.size() - first : 0;
+        out.insert(out.end(), copy.begin() + std::min<uint64_t>(lost, copy.size()), copy.end());
+    }
+
+    void clear() { tail_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed); }
+
+    size_t size() const {
+        uint64_t head  = head_.load(std::memory_order_acquire);
+        uint64_t first = std::max<uint64_t>(tail_.load(std::memory_order_relaxed),
+                                            head > events_.size() ? head - events_.size() : 0);
+        return head - first;
+    }
+
+    /// Set when the buffer is handed to a thread, before that thread records into it
+    void thread(uint32_t thread) { thread_ = thread; }
+
+private:
+    std::vector<TraceEvent> events_;
+    uint64_t mask_;
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+    uint32_t thread_;
+};
+
+// The buffer of the current thread, read on every event
+static thread_local TraceBuffer* buffer_ = nullptr;
+static thread_local bool released_       = false;
+
+/// Hands the buffer of a thread back to the Tracer when the thread exits. Only touched when the thread records its
+/// first event, so that recording only reads buffer_.
+struct TraceBufferOwner {
+    TraceBuffer* buffer_ = nullptr;
+    ~TraceBufferOwner() {
+        if (buffer_) {
+            eckit::buffer_ = nullptr;
+            released_      = true;
+            Tracer::instance().release(*buffer_);
+        }
+    }
+};
+
+static thread_local TraceBufferOwner owner_;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct Tracer::Event {
+    char type_;
+    unsigned long thread_;
+    std::string name_;
+    std::string category_;
+    double start_;     // microseconds
+    double duration_;  // microseconds
+    long long value_;
+};
+
+Tracer::Tracer() : threads_(0) {
+    static size_t size = Resource<size_t>("traceBufferSize;$ECKIT_TRACE_BUFFER_SIZE", 16384);
+    capacity_          = 1;
+    while (capacity_ < size) {
+        capacity_ <<= 1;
+    }
+
+    output_ = Resource<std::string>("traceOutput;$ECKIT_TRACE_OUTPUT", "");
+}
+
+Tracer::~Tracer() = default;
+
+Tracer& Tracer::instance() {
+    // Never deleted, as threads may still be recording at exit
+    static Tracer* tracer = [] {
+        Tracer* t = new Tracer();
+        tracer_   = t;
+        return t;
+    }();
+    return *tracer;
+}
+
+void Tracer::start() {
+    enabled_ = true;
+}
+
+void Tracer::stop() {
+    enabled_ = false;
+}
+
+void Tracer::clear() {
+    AutoLock<Mutex> lock(mutex_);
+    for (auto& b : buffers_) {
+        b->clear();
+    }
+}
+
+TraceBuffer& Tracer::buffer() {
+    AutoLock<Mutex> lock(mutex_);
+
+    // Reuse the buffer released the longest ago, whose events are the oldest. The events it holds keep the id of the
+    // thread that recorded them.
+    TraceBuffer* b;
+    if (!free_.empty()) {
+        b = free_.front();
+        free_.pop_front();
+    }
+    else {
+        buffers_.emplace_back(new TraceBuffer(capacity_));
+        b = buffers_.back().get();
+    }
+
+    b->thread(++threads_);
+    return *b;
+}
+
+void Tracer::release(TraceBuffer& b) {
+    AutoLock<Mutex> lock(mutex_);
+    free_.push_back(&b);
+}
+
+void Tracer::record(const TraceEvent& e) {
+    if (!buffer_) {
+        // Events recorded by the destructors of thread_local objects, after the buffer is released, are dropped
+        if (released_) {
+            return;
+        }
+        buffer_ = owner_.buffer_ = &instance().buffer();
+    }
+    buffer_->push(e);
+}
+
+size_t Tracer::buffers() const {
+    AutoLock<Mutex> lock(mutex_);
+    return buffers_.size();
+}
+
+size_t Tracer::size() const {
+    AutoLock<Mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& b : buffers_) {
+        n += b->size();
+    }
+    return n;
+}
+
+std::vector<Tracer::Event> Tracer::events() const {
+
+    // The TSC is calibrated against the steady clock, over the life of the process
+
+    uint64_t t = ticks();
+    uint64_t n = nanoseconds();
+    double nanosecondsPerTick
+        = (t > ticks0_ && n > nanoseconds0_) ? double(n - nanoseconds0_) / double(t - ticks0_) : 1.;
+
+    auto microseconds = [&](uint64_t ticks) {
+        return ticks > ticks0_ ? double(ticks - ticks0_) * nanosecondsPerTick / 1000. : 0.;
+    };
+
+    std::vector<Event> result;
+    std::vector<TraceEvent> events;
+
+    AutoLock<Mutex> lock(mutex_);
+
+    for (const auto& b : buffers_) {
+        events.clear();
+        b->snapshot(events);
+        for (const auto& e : events) {
+            double start = microseconds(e.start_);
+            result.push_back(Event{e.type_, e.thread_, e.name_, e.category_, start,
+                                   e.type_ == TraceEvent::SPAN ? microseconds(e.end_) - start : 0.,
+                                   static_cast<long long>(e.value_)});
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Event& a, const Event& b) { return a.start_ < b.start_; });
+
+    return result;
+}
+
+void Tracer::json(std::ostream& out, const std::vector<Event>& events) {
+    JSON json(out);
+    json.precision(15);
+
+    long pid = ::getpid();
+
+    json.startObject();
+    json << "traceEvents";
+    json.startList();
+
+    for (const auto& e : events) {
+        json.startObject();
+        json << "name" << e.name_;
+        json << "cat" << e.category_;
+        json << "ph" << std::string(1, e.type_);
+        json << "ts" << e.start_;
+        json << "pid" << pid;
+        json << "tid" << e.thread_;
+        if (e.type_ == TraceEvent::SPAN) {
+            json << "dur" << e.duration_;
+        }
+        else {
+            json << "args";
+            json.startObject();
+            json << "value" << e.value_;
+            json.endObject();
+        }
+        json.endObject();
+    }
+
+    json.endList();
+    json << "displayTimeUnit"
+         << "ns";
+    json.endObject();
+}
+
+void Tracer::json(std::ostream& out) const {
+    json(out, events());
+}
+
+void Tracer::save(const PathName& path) const {
+    std::vector<Event> events = this->events();
+
+    // Names and categories are saved once, and referred to by index
+
+    std::map<std::string, unsigned int> index;
+    std::vector<std::string> strings;
+    for (const auto& e : events) {
+        for (const std::string* s : {&e.name_, &e.category_}) {
+            if (index.find(*s) == index.end()) {
+                index[*s] = strings.size();
+                strings.push_back(*s);
+            }
+        }
+    }
+
+    FileStream s(path, "w");
+    s << MAGIC;
+    s << VERSION;
+
+    s << strings.size();
+    for (const auto& str : strings) {
+        s << str;
+    }
+
+    s << events.size();
+    for (const auto& e : events) {
+        s << e.type_;
+        s << e.thread_;
+        s << index[e.name_];
+        s << index[e.category_];
+        s << e.start_;
+        if (e.type_ == TraceEvent::SPAN) {
+            s << e.duration_;
+        }
+        else {
+            s << e.value_;
+        }
+    }
+
+    s.close();
+}
+
+void Tracer::decode(const PathName& path, std::ostream& out) {
+    FileStream s(path, "r");
+
+    std::string magic;
+    s >> magic;
+    if (magic != MAGIC) {
+        throw BadValue(path.asString() + ": not a trace");
+    }
+
+    int version;
+    s >> version;
+    if (version != VERSION) {
+        std::ostringstream oss;
+        oss << path << ": unsupported trace version " << version;
+        throw BadValue(oss.str());
+    }
+
+    size_t n;
+    s >> n;
+    std::vector<std::string> strings(n);
+    for (auto& str : strings) {
+        s >> str;
+    }
+
+    s >> n;
+    std::vector<Event> events(n);
+    for (auto& e : events) {
+        unsigned int name;
+        unsigned int category;
+        s >> e.type_;
+        s >> e.thread_;
+        s >> name;
+        s >> category;
+        s >> e.start_;
+        e.duration_ = 0;
+        e.value_    = 0;
+        if (e.type_ == TraceEvent::SPAN) {
+            s >> e.duration_;
+        }
+        else {
+            s >> e.value_;
+        }
+        ASSERT(name < strings.size() && category < strings.size());
+        e.name_     = strings[name];
+        e.category_ = strings[category];
+    }
+
+    s.close();
+
+    json(out, events);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Saves the trace at exit, if traceOutput is set
+struct TraceOutput {
+    ~TraceOutput() {
+        Tracer* tracer = tracer_;
+        if (!tracer) {
+            return;
+        }
+        const std::string& path = tracer->output_;
+        if (path.empty()) {
+            return;
+        }
+        try {
+            if (StringTools::endsWith(path, ".json")) {
+                std::ofstream out(path.c_str());
+                tracer->json(out);
+            }
+            else {
+                tracer->save(path);
+            }
+        }
+        catch (std::exception& e) {
+            std::cerr << "Tracer: cannot save trace to " << path << ": " << e.what() << std::endl;
+        }
+    }
+};
+
+static TraceOutput output_;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,177 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_log_Tracer_h
+#define eckit_log_Tracer_h
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/eckit_config.h"
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace eckit {
+
+class PathName;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// One span or counter sample. Names and categories are not copied: they must be string literals.
+struct TraceEvent {
+    enum Type : char
+    {
+        SPAN    = 'X',
+        COUNTER = 'C'
+    };
+
+    uint64_t start_;  // ticks
+    uint64_t end_;    // ticks, for spans
+    int64_t value_;   // for counters
+    const char* name_;
+    const char* category_;
+    Type type_;
+    uint32_t thread_;  // set when recorded
+};
+
+class TraceBuffer;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Records spans and counters of hot paths, for profiling.
+///
+/// Each thread records into its own ring buffer, without locks, the last traceBufferSize ($ECKIT_TRACE_BUFFER_SIZE)
+/// events. Timestamps are read from the TSC where available, and converted when exported. Recording is off unless
+/// $ECKIT_TRACE is set or start() is called, and can be compiled out with the TRACING feature.
+///
+/// The events are exported as Chrome trace JSON (chrome://tracing, Perfetto), or in a compact binary format that
+/// decode() converts to JSON. If traceOutput ($ECKIT_TRACE_OUTPUT) is set, the trace is saved there at exit, as JSON if
+/// the file name ends in .json.
+///
+/// Use the ECKIT_TRACE_SPAN and ECKIT_TRACE_COUNTER macros to instrument code.
+
+class Tracer : private NonCopyable {
+public:  // methods
+    static Tracer& instance();
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    void start();
+    void stop();
+
+    /// Discard the events recorded
+    void clear();
+
+    static void record(const TraceEvent&);
+
+    static void counter(const char* name, const char* category, int64_t value) {
+        if (enabled()) {
+            record(TraceEvent{ticks(), 0, value, name, category, TraceEvent::COUNTER, 0});
+        }
+    }
+
+    /// The number of events held
+    size_t size() const;
+
+    /// The number of thread buffers allocated. The buffers of threads that have finished are reused by new threads.
+    size_t buffers() const;
+
+    void json(std::ostream&) const;
+    void save(const PathName&) const;
+
+    /// Convert a trace saved in binary to JSON
+    static void decode(const PathName&, std::ostream&);
+
+private:  // methods
+    Tracer();
+    ~Tracer();
+
+    TraceBuffer& buffer();
+    void release(TraceBuffer&);
+
+    struct Event;
+    std::vector<Event> events() const;
+    static void json(std::ostream&, const std::vector<Event>&);
+
+private:  // members
+    static std::atomic<bool> enabled_;
+
+    mutable Mutex mutex_;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+    std::deque<TraceBuffer*> free_;
+    uint32_t threads_;
+
+    size_t capacity_;
+    std::string output_;
+
+    friend struct TraceOutput;
+    friend struct TraceBufferOwner;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Records a span from its construction to its destruction
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category) :
+        name_(name), category_(category), start_(Tracer::enabled() ? Tracer::ticks() : 0) {}
+
+    ~TraceSpan() {
+        if (start_) {
+            Tracer::record(TraceEvent{start_, Tracer::ticks(), 0, name_, category_, TraceEvent::SPAN, 0});
+        }
+    }
+
+private:
+    const char* name_;
+    const char* category_;
+    uint64_t start_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#define ECKIT_TRACE_CONCAT_(a, b) a##b
+#define ECKIT_TRACE_CONCAT(a, b) ECKIT_TRACE_CONCAT_(a, b)
+
+#if eckit_HAVE_TRACING
+#define ECKIT_TRACE_SPAN(name, category) \
+    ::eckit::TraceSpan ECKIT_TRACE_CONCAT(eckit_trace_span_, __LINE__)(name, category)
+#define ECKIT_TRACE_COUNTER(name, category, value) ::eckit::Tracer::counter(name, category, value)
+#else
+#define ECKIT_TRACE_SPAN(name, category) ((void)0)
+#define ECKIT_TRACE_COUNTER(name, category, value) ((void)0)
+#endif
+
+#endif
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/system/LibraryManager.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Mutex.h"
 
@@ -46,7 +47,7 @@ public:  // methods
     /// @returns class name of the type built by this factory
     static std::string build_type() { return T::className(); }
 
-    /// Checks if a builder is registered
+    /// Checks if a builder is registered, loading the plugin that provides it if deferred
     /// @param name of the builder
     bool exists(const key_t& k) const;
 
@@ -59,13 +60,14 @@ public:  // methods
     /// @throw BadParameter if the builder is not registered
     void unregist(const key_t&);
 
-    /// Gets the builder registered to the associated key
+    /// Gets the builder registered to the associated key, loading the plugin that provides it if deferred
     /// @param name of the builder
     const builder_t& get(const key_t& name) const;
 
-    /// @returns the number of builders registered to the factory
+    /// @returns the number of builders registered to the factory, once the deferred plugins are loaded
     size_t size() const;
 
+    /// @returns the keys of the builders, once the deferred plugins are loaded
     std::vector<key_t> keys() const;
 
     friend std::ostream& operator<<(std::ostream& os, const Factory<T>& o) {
@@ -76,6 +78,8 @@ public:  // methods
 private:  // methods
     void print(std::ostream&) const;
 
+    bool registered(const key_t& k) const { return store_.find(k) != store_.end(); }
+
     Factory() {
         // std::cout << "Building Factory of " << build_type() << std::endl;
     }
@@ -106,15 +110,27 @@ Factory<T>& Factory<T>::instance() {
 
 template <class T>
 bool Factory<T>::exists(const key_t& k) const {
+    {
+        AutoLock<Mutex> lock(mutex_);
+        if (registered(k)) {
+            return true;
+        }
+    }
+
+    // The builder may be provided by a plugin that is only loaded on first use
+    if (!system::LibraryManager::loadPluginsFor(k)) {
+        return false;
+    }
+
     AutoLock<Mutex> lock(mutex_);
-    return (store_.find(k) != store_.end());
+    return registered(k);
 }
 
 template <class T>
 void Factory<T>::regist(const key_t& k, builder_ptr b) {
     AutoLock<Mutex> lock(mutex_);
     ASSERT(b);
-    if (exists(k)) {
+    if (registered(k)) {
         throw BadParameter("Factory of " + build_type() + " has already a builder for " + k, Here());
     }
     store_[k] = b;
@@ -123,7 +139,7 @@ void Factory<T>::regist(const key_t& k, builder_ptr b) {
 template <class T>
 void Factory<T>::unregist(const key_t& k) {
     AutoLock<Mutex> lock(mutex_);
-    if (!exists(k)) {
+    if (!registered(k)) {
         throw BadParameter("Factory of " + build_type() + " has no builder for " + k, Here());
     }
     store_.erase(k);
@@ -131,14 +147,19 @@ void Factory<T>::unregist(const key_t& k) {
 
 template <class T>
 size_t Factory<T>::size() const {
+    system::LibraryManager::loadDeferredPlugins();
+
     AutoLock<Mutex> lock(mutex_);
     return store_.size();
 }
 
 template <class T>
 const typename Factory<T>::builder_t& Factory<T>::get(const key_t& k) const {
+    // Loads the plugin providing the builder, if deferred
+    exists(k);
+
     AutoLock<Mutex> lock(mutex_);
-    if (!exists(k)) {
+    if (!registered(k)) {
         throw BadParameter("Factory of " + build_type() + " has no builder for " + k, Here());
     }
     return *store_.find(k)->second;
@@ -146,6 +167,8 @@ const typename Factory<T>::builder_t& Factory<T>::get(const key_t& k) const {
 
 template <class T>
 void Factory<T>::print(std::ostream& os) const {
+    system::LibraryManager::loadDeferredPlugins();
+
     AutoLock<Mutex> lock(mutex_);
     os << "Factory(" << build_type() << ")" << std::endl;
 
@@ -161,6 +184,8 @@ void Factory<T>::print(std::ostream& os) const {
 
 template <class T>
 std::vector<typename Factory<T>::key_t> Factory<T>::keys() const {
+    system::LibraryManager::loadDeferredPlugins();
+
     AutoLock<Mutex> lock(mutex_);
 
     std::vector<key_t> keysv;
@@ -0,0 +1,614 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "eckit/eckit.h"
+
+#if eckit_HAVE_EXECINFO_BACKTRACE || defined(__FreeBSD__)
+#include <execinfo.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#if eckit_HAVE_CXXABI_H
+#include <cxxabi.h>
+#endif
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/os/SamplingProfiler.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/utils/StringTools.h"
+
+#if defined(__GNUC__)
+#define ECKIT_PROFILER_NOINLINE __attribute__((noinline))
+#else
+#define ECKIT_PROFILER_NOINLINE
+#endif
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::atomic<SamplingProfiler*> profiler_(nullptr);
+
+std::atomic<bool> SamplingProfiler::allocations_(false);
+
+// Set by prepare(), as sysconf() is not async-signal-safe
+static uintptr_t pageSize_ = 4096;
+
+// Used for allocation samples only: backtrace() may allocate and take locks, and is not async-signal-safe
+static int backtrace(void** frames, int size) {
+#if (eckit_HAVE_EXECINFO_BACKTRACE || defined(__FreeBSD__)) && !defined(_AIX)
+    return ::backtrace(frames, size);
+#else
+    return 0;
+#endif
+}
+
+// Whether the word at p can be read, without faulting. The kernel copies the signal set from p before rejecting the
+// invalid 'how', so the call fails with EFAULT if p is not readable, and changes nothing otherwise.
+static bool readable(const void* p) {
+#if defined(__linux__) && defined(SYS_rt_sigprocmask)
+    int saved = errno;
+    bool ok   = !(::syscall(SYS_rt_sigprocmask, ~0, p, nullptr, _NSIG / 8) == -1 && errno == EFAULT);
+    errno     = saved;
+    return ok;
+#else
+    (void)p;
+    return false;
+#endif
+}
+
+/// Unwinds the thread interrupted by a signal by following its frame pointers, as backtrace() cannot be called from a
+/// signal handler. Records the interrupted instruction, then the return address of each frame. The walk stops at the
+/// first frame pointer that is not aligned, not above the previous one, too far from it, or not readable, which is
+/// where code compiled without frame pointers (-fno-omit-frame-pointer) truncates the stack.
+static int unwind(void* context, void** frames, int size) {
+    const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+
+    uintptr_t pc;
+    uintptr_t fp;
+    uintptr_t sp;
+
+#if defined(__linux__) && defined(__x86_64__)
+    pc = uc->uc_mcontext.gregs[REG_RIP];
+    fp = uc->uc_mcontext.gregs[REG_RBP];
+    sp = uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__linux__) && defined(__aarch64__)
+    pc = uc->uc_mcontext.pc;
+    fp = uc->uc_mcontext.regs[29];
+    sp = uc->uc_mcontext.sp;
+#else
+    (void)uc;
+    (void)fp;
+    (void)sp;
+    return 0;
+#endif
+
+    const uintptr_t maxFrame = 1024 * 1024;
+    const uintptr_t page     = pageSize_;
+
+    int n = 0;
+    if (size > 0 && pc) {
+        frames[n++] = reinterpret_cast<void*>(pc);
+    }
+
+    uintptr_t checked = 0;  // the last page found readable
+    uintptr_t low     = sp;
+    while (n < size) {
+        // A frame holds the caller's frame pointer, then the return address, 16-byte aligned on both architectures
+        if (fp < low || fp - low > maxFrame || (fp & (2 * sizeof(void*) - 1))) {
+            break;
+        }
+        if ((fp & ~(page - 1)) != checked) {
+            if (!readable(reinterpret_cast<const void*>(fp))) {
+                break;
+            }
+            checked = fp & ~(page - 1);
+        }
+
+        const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+        if (!frame[1]) {
+            break;
+        }
+        frames[n++] = reinterpret_cast<void*>(frame[1]);
+
+        low = fp + 2 * sizeof(void*);
+        fp  = frame[0];
+    }
+
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Stacks written by any thread, possibly from a signal handler, and drained under the profiler's lock. A slot is only
+/// drained once its sequence shows that it was completely written, and not overwritten while it was copied.
+class ProfileBuffer : private NonCopyable {
+public:
+    static const size_t DEPTH = 64;
+
+    explicit ProfileBuffer(size_t capacity) :
+        slots_(new Slot[capacity]), mask_(capacity - 1), head_(0), tail_(0), samples_(0), lost_(0) {
+        ASSERT(capacity && (capacity & mask_) == 0);
+        for (size_t i = 0; i < capacity; ++i) {
+            slots_[i].sequence_.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// Records the stack of the caller, less skip frames. Not async-signal-safe.
+    ECKIT_PROFILER_NOINLINE void push(uint64_t weight, int skip) {
+        void* frames[DEPTH + 4];
+        int n = eckit::backtrace(frames, DEPTH + skip);
+        if (n > skip) {
+            push(weight, frames + skip, n - skip);
+        }
+    }
+
+    /// Records the stack of the thread interrupted by a signal. Async-signal-safe.
+    void push(uint64_t weight, void* context) {
+        void* frames[DEPTH];
+        int n = unwind(context, frames, DEPTH);
+        if (n > 0) {
+            push(weight, frames, n);
+        }
+    }
+
+    void push(uint64_t weight, void* const* frames, int n) {
+        uint64_t i = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& s    = slots_[i & mask_];
+
+        s.sequence_.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        s.weight_ = weight;
+        s.depth_  = n;
+        ::memcpy(s.frames_, frames, n * sizeof(void*));
+
+        s.sequence_.store(i + 1, std::memory_order_release);
+    }
+
+    void drain(std::map<std::vector<void*>, uint64_t>& stacks) {
+        uint64_t head     = head_.load(std::memory_order_acquire);
+        uint64_t capacity = mask_ + 1;
+        uint64_t first    = std::max(tail_, head > capacity ? head - capacity : 0);
+
+        lost_ += first - tail_;
+
+        std::vector<void*> frames;
+        for (uint64_t i = first; i < head; ++i) {
+            const Slot& s = slots_[i & mask_];
+            if (s.sequence_.load(std::memory_order_acquire) != i + 1) {
+                lost_++;
+                continue;
+            }
+
+            uint64_t weight = s.weight_;
+            frames.assign(s.frames_, s.frames_ + std::min<size_t>(s.depth_, DEPTH));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (s.sequence_.load(std::memory_order_relaxed) != i + 1) {
+                lost_++;
+                continue;
+            }
+
+            stacks[frames] += weight;
+            samples_++;
+        }
+
+        tail_ = head;
+    }
+
+    void clear() {
+        tail_    = head_.load(std::memory_order_acquire);
+        samples_ = 0;
+        lost_    = 0;
+    }
+
+    size_t samples() const { return samples_; }
+    size_t lost() const { return lost_; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence_;  // index + 1 when written
+        uint64_t weight_;
+        size_t depth_;
+        void* frames_[DEPTH];
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t mask_;
+    std::atomic<uint64_t> head_;
+
+    // Only used when draining
+    uint64_t tail_;
+    size_t samples_;
+    size_t lost_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Symbols {
+public:
+    const std::string& operator()(void* address) {
+        auto j = cache_.find(address);
+        if (j != cache_.end()) {
+            return j->second;
+        }
+        return cache_[address] = symbol(address);
+    }
+
+private:
+    static std::string symbol(void* address) {
+        // Return addresses point after the call. The interrupted instruction that starts a CPU sample is looked up
+        // the same way, as it is rarely the first of its function.
+        void* pc = static_cast<char*>(address) - 1;
+
+        std::ostringstream oss;
+        Dl_info info;
+        if (::dladdr(pc, &info) && info.dli_sname) {
+#if eckit_HAVE_CXXABI_H
+            int status;
+            char* d = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            if (status == 0 && d) {
+                std::string s(d);
+                ::free(d);
+                return s;
+            }
+            ::free(d);
+#endif
+            return info.dli_sname;
+        }
+
+        if (info.dli_fname) {
+            oss << PathName(info.dli_fname).baseName() << "+0x" << std::hex
+                << (static_cast<char*>(address) - static_cast<char*>(info.dli_fbase));
+        }
+        else {
+            oss << address;
+        }
+        return oss.str();
+    }
+
+    std::map<void*, std::string> cache_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SamplingProfiler::SamplingProfiler() :
+    running_(false),
+    prepared_(false),
+    interval_(0.01),
+    allocationInterval_(512 * 1024),
+    capacity_(16384) {}
+
+SamplingProfiler::~SamplingProfiler() = default;
+
+SamplingProfiler& SamplingProfiler::instance() {
+    // Never deleted, as signals may still be delivered at exit
+    static SamplingProfiler* profiler = new SamplingProfiler();
+    return *profiler;
+}
+
+void SamplingProfiler::initialise() {
+    bool enabled = Resource<bool>("profiler;$ECKIT_PROFILER", false);
+    int signal   = Resource<int>("profilerSignal;$ECKIT_PROFILER_SIGNAL", 0);
+
+    if (!enabled && !signal) {
+        return;
+    }
+
+    SamplingProfiler& p = instance();
+
+    p.interval_           = Resource<double>("profilerInterval;$ECKIT_PROFILER_INTERVAL", p.interval_);
+    p.allocationInterval_ = Resource<size_t>("profilerAllocationInterval;$ECKIT_PROFILER_ALLOCATION_INTERVAL",
+                                             p.allocationInterval_);
+    p.capacity_           = Resource<size_t>("profilerBufferSize;$ECKIT_PROFILER_BUFFER_SIZE", p.capacity_);
+    p.output_             = Resource<std::string>("profilerOutput;$ECKIT_PROFILER_OUTPUT", "");
+
+    p.prepare();
+
+    if (signal) {
+        struct sigaction a;
+        ::memset(&a, 0, sizeof(a));
+        a.sa_handler = onToggle;
+        a.sa_flags   = SA_RESTART;
+        sigemptyset(&a.sa_mask);
+        SYSCALL(::sigaction(signal, &a, nullptr));
+    }
+
+    if (enabled) {
+        p.start();
+        if (Resource<bool>("profilerAllocations;$ECKIT_PROFILER_ALLOCATIONS", false)) {
+            p.startAllocations();
+        }
+    }
+}
+
+void SamplingProfiler::prepare() {
+    AutoLock<Mutex> lock(mutex_);
+
+    if (prepared_) {
+        return;
+    }
+
+    size_t capacity = 1;
+    while (capacity < capacity_) {
+        capacity <<= 1;
+    }
+
+    cpu_.reset(new ProfileBuffer(capacity));
+    allocationSamples_.reset(new ProfileBuffer(capacity));
+
+    // The first call may allocate, which must not happen while an allocation is sampled
+    void* frames[1];
+    eckit::backtrace(frames, 1);
+
+    pageSize_ = ::sysconf(_SC_PAGESIZE);
+
+    struct sigaction a;
+    ::memset(&a, 0, sizeof(a));
+    a.sa_sigaction = onProfile;
+    a.sa_flags     = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&a.sa_mask);
+    SYSCALL(::sigaction(SIGPROF, &a, nullptr));
+
+    profiler_ = this;
+    prepared_ = true;
+}
+
+void SamplingProfiler::start() {
+    if (!prepared_) {
+        prepare();
+    }
+
+    long usec = static_cast<long>(interval_ * 1e6);
+    ASSERT(usec > 0);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec  = usec / 1000000;
+    timer.it_interval.tv_usec = usec % 1000000;
+    timer.it_value            = timer.it_interval;
+
+    running_ = true;
+    ::setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+void SamplingProfiler::stop() {
+    struct itimerval timer;
+    ::memset(&timer, 0, sizeof(timer));
+    ::setitimer(ITIMER_PROF, &timer, nullptr);
+    running_ = false;
+}
+
+void SamplingProfiler::startAllocations() {
+    if (!prepared_) {
+        prepare();
+    }
+    allocations_ = true;
+}
+
+void SamplingProfiler::stopAllocations() {
+    allocations_ = false;
+}
+
+void SamplingProfiler::onProfile(int, siginfo_t*, void* context) {
+    int saved           = errno;
+    SamplingProfiler* p = profiler_.load(std::memory_order_relaxed);
+    if (p && p->running_.load(std::memory_order_relaxed)) {
+        p->cpu_->push(1, context);
+    }
+    errno = saved;
+}
+
+void SamplingProfiler::onToggle(int) {
+    int saved           = errno;
+    SamplingProfiler* p = profiler_.load(std::memory_order_relaxed);
+    if (p) {
+        if (p->running_) {
+            p->stop();
+        }
+        else {
+            p->start();
+        }
+    }
+    errno = saved;
+}
+
+ECKIT_PROFILER_NOINLINE void SamplingProfiler::sampleAllocation(size_t bytes) {
+    static thread_local size_t allocated = 0;
+    static thread_local bool sampling    = false;
+
+    SamplingProfiler* p = profiler_.load(std::memory_order_relaxed);
+    if (!p || sampling) {
+        return;
+    }
+
+    allocated += bytes;
+    if (allocated >= p->allocationInterval_) {
+        // Unwinding may allocate
+        sampling = true;
+        p->allocationSamples_->push(allocated, 2);
+        allocated = 0;
+        sampling  = false;
+    }
+}
+
+void SamplingProfiler::drain() const {
+    if (prepared_) {
+        cpu_->drain(cpuStacks_);
+        allocationSamples_->drain(allocationStacks_);
+    }
+}
+
+const SamplingProfiler::Stacks& SamplingProfiler::stacks(Kind kind) const {
+    return kind == CPU ? cpuStacks_ : allocationStacks_;
+}
+
+void SamplingProfiler::clear() {
+    AutoLock<Mutex> lock(mutex_);
+    if (prepared_) {
+        cpu_->clear();
+        allocationSamples_->clear();
+    }
+    cpuStacks_.clear();
+    allocationStacks_.clear();
+}
+
+size_t SamplingProfiler::samples(Kind kind) const {
+    AutoLock<Mutex> lock(mutex_);
+    drain();
+    if (!prepared_) {
+        return 0;
+    }
+    return kind == CPU ? cpu_->samples() : allocationSamples_->samples();
+}
+
+size_t SamplingProfiler::lost(Kind kind) const {
+    AutoLock<Mutex> lock(mutex_);
+    drain();
+    if (!prepared_) {
+        return 0;
+    }
+    return kind == CPU ? cpu_->lost() : allocationSamples_->lost();
+}
+
+void SamplingProfiler::folded(std::ostream& out, Kind kind) const {
+    AutoLock<Mutex> lock(mutex_);
+    drain();
+
+    Symbols symbols;
+    std::map<std::string, uint64_t> folded;
+
+    for (const auto& s : stacks(kind)) {
+        const std::vector<void*>& frames = s.first;
+
+        // Innermost frame first
+        std::string stack;
+        for (size_t i = frames.size(); i > 0; --i) {
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += symbols(frames[i - 1]);
+        }
+
+        folded[stack] += s.second;
+    }
+
+    for (const auto& f : folded) {
+        out << f.first << ' ' << f.second << '\n';
+    }
+    out.flush();
+}
+
+void SamplingProfiler::pprof(std::ostream& out) const {
+    AutoLock<Mutex> lock(mutex_);
+    drain();
+
+    // The legacy CPU profile format of gperftools, in native words, followed by the memory map
+
+    auto word = [&out](uintptr_t w) { out.write(reinterpret_cast<const char*>(&w), sizeof(w)); };
+
+    word(0);
+    word(3);
+    word(0);
+    word(static_cast<uintptr_t>(interval_ * 1e6));
+    word(0);
+
+    Symbols symbols;
+    for (const auto& s : cpuStacks_) {
+        const std::vector<void*>& frames = s.first;
+        word(s.second);
+        word(frames.size());
+        for (void* f : frames) {
+            word(reinterpret_cast<uintptr_t>(f));
+        }
+    }
+
+    word(0);
+    word(1);
+    word(0);
+
+    std::ifstream maps("/proc/self/maps");
+    if (maps) {
+        out << maps.rdbuf();
+    }
+    out.flush();
+}
+
+void SamplingProfiler::save(const PathName& path, Kind kind) const {
+    bool pprof = StringTools::endsWith(path.asString(), ".prof");
+    if (pprof && kind != CPU) {
+        throw UserError("SamplingProfiler: only CPU profiles can be saved in the pprof format");
+    }
+
+    std::ofstream out(path.asString().c_str(), std::ios::binary);
+    if (!out) {
+        throw CantOpenFile(path.asString());
+    }
+
+    if (pprof) {
+        this->pprof(out);
+    }
+    else {
+        folded(out, kind);
+    }
+
+    out.close();
+    if (out.fail()) {
+        throw WriteError(path.asString());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Saves the profile at exit, if profilerOutput is set
+struct ProfileOutput {
+    ~ProfileOutput() {
+        SamplingProfiler* p = profiler_;
+        if (!p || p->output_.empty()) {
+            return;
+        }
+
+        p->stop();
+        p->stopAllocations();
+
+        try {
+            p->save(p->output_, SamplingProfiler::CPU);
+            if (p->samples(SamplingProfiler::ALLOCATIONS)) {
+                p->save(p->output_ + ".allocations", SamplingProfiler::ALLOCATIONS);
+            }
+        }
+        catch (std::exception& e) {
+            std::cerr << "SamplingProfiler: cannot save profile to " << p->output_ << ": " << e.what() << std::endl;
+        }
+    }
+};
+
+static ProfileOutput output_;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_os_SamplingProfiler_h
+#define eckit_os_SamplingProfiler_h
+
+#include <signal.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit {
+
+class PathName;
+class ProfileBuffer;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Statistical profiler of a running process.
+///
+/// CPU samples are taken on SIGPROF, every profilerInterval ($ECKIT_PROFILER_INTERVAL) seconds of CPU time, by
+/// unwinding the stack of the interrupted thread into a lock-free ring buffer of profilerBufferSize samples.
+/// As backtrace() is not async-signal-safe, the signal handler follows the frame pointers instead, checking each before
+/// reading it: stacks are truncated at the first function compiled without frame pointers, so build with
+/// -fno-omit-frame-pointer for complete CPU profiles. CPU samples are only taken on Linux, on x86_64 and aarch64.
+/// Allocations are sampled by the allocation() hook, once every profilerAllocationInterval
+/// ($ECKIT_PROFILER_ALLOCATION_INTERVAL) bytes allocated by a thread, and weighted by the bytes allocated since the last
+/// sample.
+///
+/// The profiler is off by default. Main starts it if profiler ($ECKIT_PROFILER) is set, sampling allocations too if
+/// profilerAllocations ($ECKIT_PROFILER_ALLOCATIONS) is set, and toggles CPU profiling when it receives profilerSignal
+/// ($ECKIT_PROFILER_SIGNAL). The profile is saved at exit to profilerOutput ($ECKIT_PROFILER_OUTPUT), and
+/// can be requested from a running server with the 'profile' command.
+///
+/// Profiles are written as folded stacks, for flame graphs, or for CPU samples in the legacy pprof format.
+
+class SamplingProfiler : private NonCopyable {
+public:  // types
+    enum Kind
+    {
+        CPU,
+        ALLOCATIONS
+    };
+
+public:  // methods
+    static SamplingProfiler& instance();
+
+    /// Set up the profiler from the resources, called by Main
+    static void initialise();
+
+    void start();
+    void stop();
+    bool running() const { return running_; }
+
+    void startAllocations();
+    void stopAllocations();
+
+    /// Discard the samples collected
+    void clear();
+
+    /// Samples collected, and samples lost because the buffer was full
+    size_t samples(Kind) const;
+    size_t lost(Kind) const;
+
+    void folded(std::ostream&, Kind = CPU) const;
+    void pprof(std::ostream&) const;
+
+    /// Save as pprof if the file name ends in .prof, as folded stacks otherwise
+    void save(const PathName&, Kind = CPU) const;
+
+    /// Called by allocators
+    static void allocation(size_t bytes) {
+        if (allocations_.load(std::memory_order_relaxed)) {
+            sampleAllocation(bytes);
+        }
+    }
+
+private:  // types
+    typedef std::map<std::vector<void*>, uint64_t> Stacks;
+
+private:  // methods
+    SamplingProfiler();
+    ~SamplingProfiler();
+
+    /// Allocates the buffers and installs the handlers, so that start() and stop() can be called from a signal
+    void prepare();
+
+    static void sampleAllocation(size_t bytes);
+    static void onProfile(int, siginfo_t*, void* context);
+    static void onToggle(int);
+
+    void drain() const;
+    const Stacks& stacks(Kind) const;
+
+private:  // members
+    static std::atomic<bool> allocations_;
+
+    std::unique_ptr<ProfileBuffer> cpu_;
+    std::unique_ptr<ProfileBuffer> allocationSamples_;
+
+    mutable Mutex mutex_;
+    mutable Stacks cpuStacks_;
+    mutable Stacks allocationStacks_;
+
+    std::atomic<bool> running_;
+    std::atomic<bool> prepared_;
+
+    double interval_;
+    size_t allocationInterval_;
+    size_t capacity_;
+    std::string output_;
+
+    friend struct ProfileOutput;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
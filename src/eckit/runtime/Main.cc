@@ -18,10 +18,13 @@
 #include "eckit/filesystem/LocalPathName.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/log/OStreamTarget.h"
+#include "eckit/log/Timer.h"
 #include "eckit/os/BackTrace.h"
+#include "eckit/os/SamplingProfiler.h"
 #include "eckit/runtime/Library.h"
 #include "eckit/runtime/Main.h"
 #include "eckit/system/LibraryManager.h"
+#include "eckit/system/StartupReport.h"
 #include "eckit/system/SystemInfo.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Mutex.h"
@@ -107,10 +110,19 @@ Main::Main(int argc, char** argv, const char* homeenv) :
 
     instance_ = this;
 
+    system::StartupReport& report = system::StartupReport::instance();
+
+    // The first resource reads the configuration files
+    Timer timer;
+    std::vector<std::string> libraries = Resource<std::vector<std::string>>("dynamicLibraries", {});
+    std::vector<std::string> plugins   = Resource<std::vector<std::string>>("$LOAD_PLUGINS;loadPlugins", {});
+    bool autoLoadPlugins = Resource<bool>("$AUTO_LOAD_PLUGINS;autoLoadPlugins;-autoLoadPlugins", true);
+    bool startupReport   = Resource<bool>("$ECKIT_STARTUP_REPORT;startupReport", false);
+    report.add("resources", "configuration", timer.elapsed());
+
     // Load the libraries configured to be dynamically loaded at runtime
     // This may include eckit::Plugin libraries, but they must be identified by the filename (libname) not Plugin name
     // Note this also works for non eckit::Plugin libraries
-    std::vector<std::string> libraries = Resource<std::vector<std::string>>("dynamicLibraries", {});
     for (const std::string& library : libraries) {
         void* h = system::LibraryManager::loadLibrary(library);
         if (not h) {
@@ -122,8 +134,6 @@ Main::Main(int argc, char** argv, const char* homeenv) :
     }
 
     // Load eckit::Plugin libraries
-    std::vector<std::string> plugins = Resource<std::vector<std::string>>("$LOAD_PLUGINS;loadPlugins", {});
-    bool autoLoadPlugins             = Resource<bool>("$AUTO_LOAD_PLUGINS;autoLoadPlugins;-autoLoadPlugins", true);
     if (autoLoadPlugins or plugins.size()) {
         Log::debug() << "Configured to load plugins " << plugins << std::endl;
         system::LibraryManager::autoLoadPlugins(plugins);
@@ -131,7 +141,15 @@ Main::Main(int argc, char** argv, const char* homeenv) :
 
     Log::debug() << "Application " << name_ << " loaded libraries: " << system::LibraryManager::list() << std::endl;
 
-    Loader::callAll(&Loader::execute);
+    Timer loaders;
+    Loader::executeAll();
+    report.add("loaders", "execute", loaders.elapsed());
+
+    SamplingProfiler::initialise();
+
+    if (startupReport) {
+        Log::info() << report;
+    }
 }
 
 Main::~Main() {
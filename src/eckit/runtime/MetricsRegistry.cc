@@ -0,0 +1,344 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/runtime/MetricsRegistry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/JSON.h"
+#include "eckit/runtime/Telemetry.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const std::memory_order relaxed = std::memory_order_relaxed;
+
+static bool validName(const std::string& name, bool colons) {
+    if (name.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i) {
+        char c = name[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (colons && c == ':')
+                  || (i > 0 && c >= '0' && c <= '9');
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string number(double v) {
+    if (std::isnan(v)) {
+        return "NaN";
+    }
+    if (std::isinf(v)) {
+        return v > 0 ? "+Inf" : "-Inf";
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", v);
+    return buf;
+}
+
+static void escape(std::ostream& out, const std::string& s, bool quotes) {
+    for (char c : s) {
+        switch (c) {
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '"':
+                out << (quotes ? "\\\"" : "\"");
+                break;
+            default:
+                out << c;
+        }
+    }
+}
+
+static void labels(std::ostream& out, const MetricLabels& l, const char* le = nullptr) {
+    if (l.empty() && !le) {
+        return;
+    }
+    const char* sep = "";
+    out << '{';
+    for (const auto& j : l) {
+        out << sep << j.first << "=\"";
+        escape(out, j.second, true);
+        out << '"';
+        sep = ",";
+    }
+    if (le) {
+        out << sep << "le=\"" << le << '"';
+    }
+    out << '}';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t MetricShards::next() {
+    static std::atomic<size_t> next_(0);
+    return next_.fetch_add(1, relaxed) & (SHARDS - 1);
+}
+
+uint64_t MetricCounter::value() const {
+    uint64_t n = 0;
+    for (const auto& c : cells_) {
+        n += c.value_.load(relaxed);
+    }
+    return n;
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds) :
+    bounds_(bounds), shards_(new Shard[MetricShards::SHARDS]) {
+    if (!std::is_sorted(bounds_.begin(), bounds_.end())
+        || std::adjacent_find(bounds_.begin(), bounds_.end()) != bounds_.end()) {
+        throw BadValue("MetricHistogram: bounds must be strictly increasing");
+    }
+
+    for (size_t s = 0; s < MetricShards::SHARDS; ++s) {
+        shards_[s].counts_.reset(new std::atomic<uint64_t>[bounds_.size() + 1]);
+        for (size_t i = 0; i <= bounds_.size(); ++i) {
+            shards_[s].counts_[i].store(0, relaxed);
+        }
+    }
+}
+
+std::vector<uint64_t> MetricHistogram::cumulative() const {
+    std::vector<uint64_t> result(bounds_.size() + 1, 0);
+    for (size_t s = 0; s < MetricShards::SHARDS; ++s) {
+        for (size_t i = 0; i < result.size(); ++i) {
+            result[i] += shards_[s].counts_[i].load(relaxed);
+        }
+    }
+    for (size_t i = 1; i < result.size(); ++i) {
+        result[i] += result[i - 1];
+    }
+    return result;
+}
+
+uint64_t MetricHistogram::count() const {
+    return cumulative().back();
+}
+
+double MetricHistogram::sum() const {
+    double sum = 0;
+    for (size_t s = 0; s < MetricShards::SHARDS; ++s) {
+        sum += shards_[s].sum_.load(relaxed);
+    }
+    return sum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct MetricsRegistry::Family {
+    struct Series {
+        std::unique_ptr<MetricCounter> counter_;
+        std::unique_ptr<MetricGauge> gauge_;
+        std::unique_ptr<MetricHistogram> histogram_;
+    };
+
+    std::string help_;
+    const char* type_;
+    std::map<MetricLabels, Series> series_;
+};
+
+MetricsRegistry::MetricsRegistry()  = default;
+MetricsRegistry::~MetricsRegistry() = default;
+
+MetricsRegistry& MetricsRegistry::instance() {
+    // Never deleted, as metrics may still be updated at exit
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, const char* type) {
+    if (!validName(name, true)) {
+        throw BadValue("MetricsRegistry: invalid metric name '" + name + "'");
+    }
+
+    auto j = families_.find(name);
+    if (j == families_.end()) {
+        j = families_.emplace(name, std::unique_ptr<Family>(new Family{help, type, {}})).first;
+    }
+
+    if (std::strcmp(j->second->type_, type) != 0) {
+        throw UserError("MetricsRegistry: metric '" + name + "' is already registered as a " + j->second->type_);
+    }
+
+    return *j->second;
+}
+
+static void checkLabels(const std::string& name, const MetricLabels& l, bool histogram) {
+    for (const auto& j : l) {
+        if (!validName(j.first, false) || (histogram && j.first == "le")) {
+            throw BadValue("MetricsRegistry: invalid label '" + j.first + "' for metric '" + name + "'");
+        }
+    }
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& l) {
+    checkLabels(name, l, false);
+    AutoLock<Mutex> lock(mutex_);
+    auto& s = family(name, help, "counter").series_[l];
+    if (!s.counter_) {
+        s.counter_.reset(new MetricCounter());
+    }
+    return *s.counter_;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& l) {
+    checkLabels(name, l, false);
+    AutoLock<Mutex> lock(mutex_);
+    auto& s = family(name, help, "gauge").series_[l];
+    if (!s.gauge_) {
+        s.gauge_.reset(new MetricGauge());
+    }
+    return *s.gauge_;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                            const std::vector<double>& bounds, const MetricLabels& l) {
+    checkLabels(name, l, true);
+    AutoLock<Mutex> lock(mutex_);
+    auto& s = family(name, help, "histogram").series_[l];
+    if (!s.histogram_) {
+        s.histogram_.reset(new MetricHistogram(bounds));
+    }
+    else if (s.histogram_->bounds() != bounds) {
+        throw UserError("MetricsRegistry: histogram '" + name + "' is already registered with other bounds");
+    }
+    return *s.histogram_;
+}
+
+const std::vector<double>& MetricsRegistry::latencyBounds() {
+    static const std::vector<double> bounds{0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                            0.025,  0.05,    0.1,    0.25,  0.5,    1,     2.5,
+                                            5,      10};
+    return bounds;
+}
+
+void MetricsRegistry::prometheus(std::ostream& out) const {
+    AutoLock<Mutex> lock(mutex_);
+
+    for (const auto& f : families_) {
+        const std::string& name = f.first;
+        const Family& family    = *f.second;
+
+        out << "# HELP " << name << ' ';
+        escape(out, family.help_, false);
+        out << '\n';
+        out << "# TYPE " << name << ' ' << family.type_ << '\n';
+
+        for (const auto& s : family.series_) {
+            const Family::Series& series = s.second;
+
+            if (series.counter_) {
+                out << name;
+                labels(out, s.first);
+                out << ' ' << series.counter_->value() << '\n';
+            }
+
+            if (series.gauge_) {
+                out << name;
+                labels(out, s.first);
+                out << ' ' << number(series.gauge_->value()) << '\n';
+            }
+
+            if (series.histogram_) {
+                const MetricHistogram& h      = *series.histogram_;
+                std::vector<uint64_t> buckets = h.cumulative();
+                for (size_t i = 0; i < buckets.size(); ++i) {
+                    out << name << "_bucket";
+                    labels(out, s.first, i < h.bounds().size() ? number(h.bounds()[i]).c_str() : "+Inf");
+                    out << ' ' << buckets[i] << '\n';
+                }
+                out << name << "_sum";
+                labels(out, s.first);
+                out << ' ' << number(h.sum()) << '\n';
+                out << name << "_count";
+                labels(out, s.first);
+                out << ' ' << buckets.back() << '\n';
+            }
+        }
+    }
+}
+
+void MetricsRegistry::json(JSON& j) const {
+    AutoLock<Mutex> lock(mutex_);
+
+    j.startObject();
+    for (const auto& f : families_) {
+        const Family& family = *f.second;
+
+        j << f.first;
+        j.startObject();
+        j << "type" << family.type_;
+        j << "help" << family.help_;
+        j << "series";
+        j.startList();
+
+        for (const auto& s : family.series_) {
+            const Family::Series& series = s.second;
+
+            j.startObject();
+            j << "labels";
+            j.startObject();
+            for (const auto& l : s.first) {
+                j << l.first << l.second;
+            }
+            j.endObject();
+
+            if (series.counter_) {
+                j << "value" << series.counter_->value();
+            }
+
+            if (series.gauge_) {
+                j << "value" << series.gauge_->value();
+            }
+
+            if (series.histogram_) {
+                const MetricHistogram& h      = *series.histogram_;
+                std::vector<uint64_t> buckets = h.cumulative();
+                j << "count" << buckets.back();
+                j << "sum" << h.sum();
+                j << "buckets";
+                j.startObject();
+                for (size_t i = 0; i < buckets.size(); ++i) {
+                    j << (i < h.bounds().size() ? number(h.bounds()[i]) : std::string("+Inf")) << buckets[i];
+                }
+                j.endObject();
+            }
+
+            j.endObject();
+        }
+
+        j.endList();
+        j.endObject();
+    }
+    j.endObject();
+}
+
+std::string MetricsRegistry::report() const {
+    return runtime::Telemetry::report(runtime::Report::COUNTER, [this](JSON& j) { json(j); });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
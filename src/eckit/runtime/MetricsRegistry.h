@@ -0,0 +1,169 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit {
+
+class JSON;
+
+using MetricLabels = std::map<std::string, std::string>;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Metrics are updated in one of SHARDS cells, picked per thread, so that threads do not contend for the same cache
+/// line. The cells are summed when read.
+class MetricShards {
+public:
+    static constexpr size_t SHARDS = 64;
+
+    static size_t shard() {
+        static thread_local size_t shard = next();
+        return shard;
+    }
+
+private:
+    static size_t next();
+};
+
+struct alignas(64) MetricCell {
+    std::atomic<uint64_t> value_{0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A monotonic count, e.g. of requests or bytes
+class MetricCounter : private NonCopyable {
+public:
+    void inc(uint64_t n = 1) { cells_[MetricShards::shard()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const;
+
+private:
+    MetricCell cells_[MetricShards::SHARDS];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A value that goes up and down, e.g. the size of a queue. Gauges are mostly set, so they are not sharded.
+class MetricGauge : private NonCopyable {
+public:
+    void set(double v) { value_.store(v, std::memory_order_relaxed); }
+
+    void inc(double v = 1) {
+        double old = value_.load(std::memory_order_relaxed);
+        while (!value_.compare_exchange_weak(old, old + v, std::memory_order_relaxed)) {}
+    }
+
+    void dec(double v = 1) { inc(-v); }
+
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The distribution of observed values, counted in buckets of given upper bounds
+class MetricHistogram : private NonCopyable {
+public:
+    explicit MetricHistogram(const std::vector<double>& bounds);
+
+    void observe(double v) {
+        size_t i = 0;
+        while (i < bounds_.size() && v > bounds_[i]) {
+            ++i;
+        }
+
+        Shard& s = shards_[MetricShards::shard()];
+        s.counts_[i].fetch_add(1, std::memory_order_relaxed);
+
+        double old = s.sum_.load(std::memory_order_relaxed);
+        while (!s.sum_.compare_exchange_weak(old, old + v, std::memory_order_relaxed)) {}
+    }
+
+    const std::vector<double>& bounds() const { return bounds_; }
+
+    /// The cumulative counts of the values less or equal to each bound, followed by the total count
+    std::vector<uint64_t> cumulative() const;
+
+    uint64_t count() const;
+    double sum() const;
+
+private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+        std::atomic<double> sum_{0};
+    };
+
+    std::vector<double> bounds_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide registry of metrics, for high-frequency instrumentation.
+///
+/// Metrics are registered once, by name and labels, and the handles returned are updated without locks. Registering
+/// the same name and labels again returns the same handle. Handles live as long as the process.
+///
+/// The registry is exported in the Prometheus text format (served at /metrics by eckit_web), as JSON, or sent as a
+/// Telemetry report.
+///
+/// Unlike Metrics, which collects the values of one request, this is meant for counts over the life of the process.
+
+class MetricsRegistry : private NonCopyable {
+public:  // methods
+    static MetricsRegistry& instance();
+
+    MetricCounter& counter(const std::string& name, const std::string& help, const MetricLabels& = {});
+    MetricGauge& gauge(const std::string& name, const std::string& help, const MetricLabels& = {});
+    MetricHistogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+                               const MetricLabels& = {});
+
+    /// Default bounds for latencies in seconds, from 100us to 10s
+    static const std::vector<double>& latencyBounds();
+
+    void prometheus(std::ostream&) const;
+    void json(JSON&) const;
+
+    /// Send the metrics to the Telemetry servers, as a COUNTER report
+    /// @returns the message sent
+    std::string report() const;
+
+private:  // methods
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    struct Family;
+    Family& family(const std::string& name, const std::string& help, const char* type);
+
+private:  // members
+    mutable Mutex mutex_;
+    std::map<std::string, std::unique_ptr<Family>> families_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -303,6 +303,27 @@ char Monitor::state(char c) {
     return x;
 }
 
+long Monitor::statistic(const std::string& name, TaskStatistic::Kind kind) {
+    if (!ready_) {
+        return -1;
+    }
+    return task().statistic(name, kind);
+}
+
+void Monitor::publish(long slot, double value) {
+    if (!ready_) {
+        return;
+    }
+    task().publish(slot, value);
+}
+
+void Monitor::publish(long slot, const LatencyHistogram& h) {
+    if (!ready_) {
+        return;
+    }
+    task().publish(slot, h);
+}
+
 void Monitor::status(const std::string& msg) {
     if (!ready_) {
         return;
@@ -74,6 +74,11 @@ public:  // methods
 
     char state(char);
 
+    /// Statistics of the current task, see TaskInfo::statistic()
+    long statistic(const std::string&, TaskStatistic::Kind);
+    void publish(long, double);
+    void publish(long, const LatencyHistogram&);
+
     void message(const std::string&);
     std::string message();
 
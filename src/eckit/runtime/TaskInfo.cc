@@ -15,6 +15,7 @@
 #include <iterator>
 
 #include "eckit/log/JSON.h"
+#include "eckit/log/LatencyHistogram.h"
 #include "eckit/log/Timer.h"
 #include "eckit/memory/Zero.h"
 #include "eckit/os/SignalHandler.h"
@@ -210,6 +211,92 @@ void TaskInfo::parent(long p) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+template <class F>
+static void write(std::atomic<unsigned long>& sequence, TaskStatistic& statistic, F update) {
+    unsigned long seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    update(statistic);
+    ::gettimeofday(&statistic.time_, nullptr);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+long TaskInfo::statistic(const std::string& name, TaskStatistic::Kind kind) {
+    ASSERT(kind != TaskStatistic::NONE);
+
+    for (size_t i = 0; i < statistics_; ++i) {
+        const TaskStatistic& s = statistic_[i].statistic_;
+        if (s.kind_ == TaskStatistic::NONE) {
+            write(statistic_[i].sequence_, statistic_[i].statistic_, [&name, kind](TaskStatistic& t) {
+                zero(t);
+                t.kind_ = kind;
+                ::strncpy(t.name_, name.c_str(), sizeof(t.name_) - 1);
+            });
+            return i;
+        }
+        if (s.kind_ == kind && name.compare(0, sizeof(s.name_) - 1, s.name_) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void TaskInfo::publish(long slot, double value) {
+    if (slot < 0 || slot >= statistics_) {
+        return;
+    }
+    StatisticSlot& s = statistic_[slot];
+    write(s.sequence_, s.statistic_, [value](TaskStatistic& t) { t.values_[0] = value; });
+}
+
+void TaskInfo::publish(long slot, const LatencyHistogram& h) {
+    if (slot < 0 || slot >= statistics_) {
+        return;
+    }
+
+    // Computed outside the critical section, to keep it short
+
+    double values[TaskStatistic::VALUES];
+    values[TaskStatistic::COUNT] = h.count();
+    values[TaskStatistic::MEAN]  = h.mean();
+    values[TaskStatistic::P50]   = h.percentile(50);
+    values[TaskStatistic::P90]   = h.percentile(90);
+    values[TaskStatistic::P99]   = h.percentile(99);
+    values[TaskStatistic::MAX]   = h.max();
+
+    StatisticSlot& s = statistic_[slot];
+    write(s.sequence_, s.statistic_, [&values](TaskStatistic& t) { ::memcpy(t.values_, values, sizeof(values)); });
+}
+
+bool TaskInfo::sample(size_t slot, TaskStatistic& out) const {
+    ASSERT(slot < statistics_);
+    const StatisticSlot& s = statistic_[slot];
+
+    // The writer may have died while writing, so give up eventually
+
+    for (size_t tries = 0; tries < 1000; ++tries) {
+        unsigned long before = s.sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        ::memcpy(&out, &s.statistic_, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (s.sequence_.load(std::memory_order_relaxed) == before) {
+            out.name_[sizeof(out.name_) - 1] = 0;
+            return out.kind_ != TaskStatistic::NONE;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void TaskInfo::json(JSON& json) const {
 
     Monitor& monitor = Monitor::instance();
@@ -274,6 +361,30 @@ void TaskInfo::json(JSON& json) const {
     json << "host" << host_;
     json << "message" << message_;
 
+    json << "statistics";
+    json.startObject();
+    TaskStatistic stat;
+    for (size_t i = 0; i < statistics_; ++i) {
+        if (!sample(i, stat)) {
+            continue;
+        }
+        json << stat.name_;
+        if (stat.kind_ == TaskStatistic::LATENCY) {
+            json.startObject();
+            json << "count" << stat.values_[TaskStatistic::COUNT];
+            json << "mean" << stat.values_[TaskStatistic::MEAN];
+            json << "p50" << stat.values_[TaskStatistic::P50];
+            json << "p90" << stat.values_[TaskStatistic::P90];
+            json << "p99" << stat.values_[TaskStatistic::P99];
+            json << "max" << stat.values_[TaskStatistic::MAX];
+            json.endObject();
+        }
+        else {
+            json << stat.values_[0];
+        }
+    }
+    json.endObject();
+
     json.endObject();
 }
 
@@ -16,6 +16,7 @@
 #define eckit_TaskInfo_h
 
 #include <sys/time.h>
+#include <atomic>
 #include <cstring>
 
 #include "eckit/memory/Padded.h"
@@ -25,6 +26,36 @@
 namespace eckit {
 
 class JSON;
+class LatencyHistogram;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A named value published by a task, see TaskInfo::statistic()
+struct TaskStatistic {
+    enum Kind : char
+    {
+        NONE = 0,
+        COUNTER,  // value_[0], monotonic: readers derive rates
+        GAUGE,    // value_[0]
+        LATENCY,  // count, mean, p50, p90, p99, max, in seconds
+    };
+
+    enum
+    {
+        COUNT = 0,
+        MEAN,
+        P50,
+        P90,
+        P99,
+        MAX,
+        VALUES
+    };
+
+    char kind_;
+    char name_[47];
+    ::timeval time_;
+    double values_[VALUES];
+};
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -92,6 +123,20 @@ protected:
     char host_[80];
 
     char message_[80];
+
+    // Statistics
+
+    enum
+    {
+        statistics_ = 32
+    };
+
+    struct StatisticSlot {
+        std::atomic<unsigned long> sequence_;  // odd while being written
+        TaskStatistic statistic_;
+    };
+
+    StatisticSlot statistic_[statistics_];
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -147,6 +192,23 @@ public:
     const ::timeval& progressStart() const { return progress_.start_; }
     const ::timeval& progressLast() const { return progress_.last_; }
 
+    // ---------------------------------------------------------
+    // Statistics
+    //
+    // Counters, gauges and latency summaries published in fixed slots, that other processes (e.g. eckit-top) can
+    // sample at any time without locking. A slot is only written by the thread owning the task, under a seqlock.
+
+    /// @returns the slot of the named statistic, allocated on first use, or -1 if all slots are taken
+    long statistic(const std::string& name, TaskStatistic::Kind);
+
+    void publish(long slot, double value);
+    void publish(long slot, const LatencyHistogram&);
+
+    /// Copy a slot consistently, @returns false if the slot is not used, or is being written
+    bool sample(size_t slot, TaskStatistic&) const;
+
+    static size_t statistics() { return statistics_; }
+
     // ---------------------------------------------------------
 
     void kind(const std::string&);
@@ -222,7 +284,7 @@ private:  // methods
 // Used by MappedArray
 
 inline unsigned long version(TaskInfo*) {
-    return 1;
+    return 2;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
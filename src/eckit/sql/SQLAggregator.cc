@@ -0,0 +1,543 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLAggregator.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLBatch.h"
+#include "eckit/sql/SQLKeySet.h"
+#include "eckit/sql/expression/SQLExpressionEvaluated.h"
+#include "eckit/sql/expression/function/FunctionAVG.h"
+#include "eckit/sql/expression/function/FunctionCOUNT.h"
+#include "eckit/sql/expression/function/FunctionMAX.h"
+#include "eckit/sql/expression/function/FunctionMIN.h"
+#include "eckit/sql/expression/function/FunctionRMS.h"
+#include "eckit/sql/expression/function/FunctionSTDEV.h"
+#include "eckit/sql/expression/function/FunctionSUM.h"
+#include "eckit/sql/expression/function/FunctionVAR.h"
+#include "eckit/sql/type/SQLType.h"
+
+using namespace eckit::sql::expression;
+using namespace eckit::sql::expression::function;
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const size_t npos = std::numeric_limits<size_t>::max();
+
+static size_t doublesWidth(const SQLExpression& e) {
+    return std::max<size_t>(1, (e.type()->size() + sizeof(double) - 1) / sizeof(double));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLAggregator::SQLAggregator(const Expressions& columns) :
+    keyWidth_(0), slots_(64, 0), groups_(0), finalised_(false) {
+
+    std::vector<size_t> widths;
+
+    for (const auto& column : columns) {
+
+        if (!column->isAggregate()) {
+            isKey_.push_back(true);
+            indexes_.push_back(keys_.size());
+
+            Key k;
+            k.expression_ = column;
+            k.string_     = (column->type()->getKind() == type::SQLType::stringType);
+            k.offset_     = 0;
+            k.width_      = 0;
+            keys_.push_back(k);
+            widths.push_back(k.string_ ? doublesWidth(*column) : 1);
+            continue;
+        }
+
+        isKey_.push_back(false);
+        indexes_.push_back(aggregates_.size());
+
+        Aggregate a;
+        a.expression_ = column;
+        a.kind_       = GENERIC;
+
+        const SQLExpression* e = column.get();
+        if (dynamic_cast<const FunctionCOUNT*>(e)) {
+            a.kind_ = COUNT;
+        }
+        else if (dynamic_cast<const FunctionSUM*>(e)) {
+            a.kind_ = SUM;
+        }
+        else if (dynamic_cast<const FunctionAVG*>(e)) {
+            a.kind_ = AVG;
+        }
+        else if (dynamic_cast<const FunctionMIN*>(e)) {
+            a.kind_ = MIN;
+        }
+        else if (dynamic_cast<const FunctionMAX*>(e)) {
+            a.kind_ = MAX;
+        }
+        else if (dynamic_cast<const FunctionSTDEV*>(e)) {
+            a.kind_ = STDEV;
+        }
+        else if (dynamic_cast<const FunctionVAR*>(e)) {
+            a.kind_ = VAR;
+        }
+        else if (dynamic_cast<const FunctionRMS*>(e)) {
+            a.kind_ = RMS;
+        }
+
+        if (a.kind_ != GENERIC) {
+            a.argument_ = dynamic_cast<FunctionExpression&>(*column).args()[0];
+        }
+
+        aggregates_.emplace_back(std::move(a));
+    }
+
+    layout(widths);
+}
+
+SQLAggregator::~SQLAggregator() {}
+
+void SQLAggregator::layout(const std::vector<size_t>& widths) {
+
+    // (Re)compute where each key lives in the flat key. Existing keys are moved into the new layout,
+    // zero padded (which is how strings are padded anyway).
+
+    ASSERT(widths.size() == keys_.size());
+
+    std::vector<Key> keys(keys_);
+    size_t width = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT(widths[i] >= keys[i].width_);
+        keys[i].offset_ = width;
+        keys[i].width_  = widths[i];
+        width += 1 + widths[i];
+    }
+
+    if (groups_ > 0) {
+        std::vector<double> data(groups_ * width, 0);
+        for (size_t g = 0; g < groups_; ++g) {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                ::memcpy(&data[g * width + keys[i].offset_], &keyData_[g * keyWidth_ + keys_[i].offset_],
+                         (1 + keys_[i].width_) * sizeof(double));
+            }
+        }
+        keyData_.swap(data);
+    }
+
+    keys_.swap(keys);
+    keyWidth_ = width;
+    scratch_.assign(keyWidth_, 0);
+
+    if (groups_ > 0) {
+        rehash(slots_.size());
+    }
+}
+
+size_t SQLAggregator::hash(const double* key) const {
+
+    // n.b. keys are normalised (-0.0 stored as 0.0, missing values zeroed, strings trimmed and
+    //      zero padded), so bitwise equality is equivalent to the comparisons used by SQL.
+
+    return SQLKeySet::hash(key, keyWidth_);
+}
+
+size_t SQLAggregator::evaluateKey() {
+
+    // The width of strings may change part way through a table (see SQLSelect::refreshCursorMetadata)
+
+    bool widen = false;
+    std::vector<size_t> widths;
+    for (const Key& k : keys_) {
+        size_t w = k.string_ ? std::max(k.width_, doublesWidth(*k.expression_)) : 1;
+        widen    = widen || (w != k.width_);
+        widths.push_back(w);
+    }
+    if (widen) {
+        layout(widths);
+    }
+
+    std::fill(scratch_.begin(), scratch_.end(), 0);
+
+    for (const Key& k : keys_) {
+        bool missing = false;
+        double* out  = &scratch_[k.offset_ + 1];
+
+        if (k.string_) {
+            k.expression_->eval(out, missing);
+            SQLKeySet::trimString(reinterpret_cast<char*>(out), k.width_ * sizeof(double));
+        }
+        else {
+            *out = k.expression_->eval(missing);
+            if (*out == 0) {
+                *out = 0;
+            }
+        }
+
+        if (missing) {
+            std::fill(out, out + k.width_, 0);
+            scratch_[k.offset_] = 1;
+        }
+    }
+
+    return hash(scratch_.data());
+}
+
+size_t SQLAggregator::find(const double* key, size_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask; slots_[i] != 0; i = (i + 1) & mask) {
+        size_t g = slots_[i] - 1;
+        if (::memcmp(&keyData_[g * keyWidth_], key, keyWidth_ * sizeof(double)) == 0) {
+            return g;
+        }
+    }
+    return npos;
+}
+
+void SQLAggregator::rehash(size_t slots) {
+    slots_.assign(slots, 0);
+    size_t mask = slots - 1;
+    for (size_t g = 0; g < groups_; ++g) {
+        size_t i = hash(&keyData_[g * keyWidth_]) & mask;
+        while (slots_[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = g + 1;
+    }
+}
+
+size_t SQLAggregator::insert(const double* key, size_t hash) {
+
+    ASSERT(groups_ < std::numeric_limits<uint32_t>::max());
+
+    // Keep the table at most half full
+
+    if (2 * (groups_ + 1) > slots_.size()) {
+        rehash(2 * slots_.size());
+    }
+
+    size_t mask = slots_.size() - 1;
+    size_t i    = hash & mask;
+    while (slots_[i] != 0) {
+        i = (i + 1) & mask;
+    }
+
+    keyData_.insert(keyData_.end(), key, key + keyWidth_);
+    addGroup();
+
+    slots_[i] = groups_;
+    return groups_ - 1;
+}
+
+void SQLAggregator::addGroup() {
+    for (Aggregate& a : aggregates_) {
+        switch (a.kind_) {
+            case GENERIC:
+                a.generic_.push_back(a.expression_->clone());
+                break;
+            case MIN:
+                a.value_.push_back(DBL_MAX);
+                break;
+            case MAX:
+                a.value_.push_back(-DBL_MAX);
+                break;
+            default:
+                a.count_.push_back(0);
+                a.value_.push_back(0);
+                a.squares_.push_back(0);
+                break;
+        }
+    }
+    ++groups_;
+}
+
+void SQLAggregator::update() {
+
+    ASSERT(!finalised_);
+
+    size_t h = evaluateKey();
+    size_t g = find(scratch_.data(), h);
+    if (g == npos) {
+        g = insert(scratch_.data(), h);
+    }
+
+    for (Aggregate& a : aggregates_) {
+
+        if (a.kind_ == GENERIC) {
+            a.generic_[g]->partialResult();
+            continue;
+        }
+
+        bool missing = false;
+        double value = a.argument_->eval(missing);
+        if (!missing) {
+            accumulate(a, g, value);
+        }
+    }
+}
+
+void SQLAggregator::accumulate(Aggregate& a, size_t g, double value) {
+    switch (a.kind_) {
+        case MIN:
+            a.value_[g] = std::min(a.value_[g], value);
+            break;
+        case MAX:
+            a.value_[g] = std::max(a.value_[g], value);
+            break;
+        default:
+            a.count_[g] += 1;
+            a.value_[g] += value;
+            a.squares_[g] += value * value;
+            break;
+    }
+}
+
+bool SQLAggregator::vectorised() const {
+    for (const Key& k : keys_) {
+        if (k.string_ || !k.expression_->isVectorised()) {
+            return false;
+        }
+    }
+    for (const Aggregate& a : aggregates_) {
+        if (a.kind_ == GENERIC || !a.argument_->isVectorised()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SQLAggregator::update(const SQLBatch& batch, const uint8_t* selected) {
+
+    ASSERT(!finalised_);
+    ASSERT(vectorised());
+
+    // Evaluate the keys, then the aggregated values, column by column. n.b. only the aggregator's
+    // own state is modified, so different aggregators may be updated from different threads.
+
+    size_t n       = batch.size();
+    size_t columns = keys_.size() + aggregates_.size();
+
+    batchValues_.resize(columns);
+    batchMissing_.resize(columns * n);
+
+    for (size_t i = 0; i < columns; ++i) {
+        const SQLExpression& e = (i < keys_.size()) ? *keys_[i].expression_ : *aggregates_[i - keys_.size()].argument_;
+        batchValues_[i].resize(n);
+        e.evalBatch(batch, batchValues_[i].data(), &batchMissing_[i * n]);
+    }
+
+    for (size_t row = 0; row < n; ++row) {
+        if (!selected[row]) {
+            continue;
+        }
+
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            double* out = &scratch_[keys_[i].offset_];
+            if (batchMissing_[i * n + row]) {
+                out[0] = 1;
+                out[1] = 0;
+            }
+            else {
+                out[0] = 0;
+                out[1] = (batchValues_[i][row] == 0) ? 0 : batchValues_[i][row];
+            }
+        }
+
+        size_t h = hash(scratch_.data());
+        size_t g = find(scratch_.data(), h);
+        if (g == npos) {
+            g = insert(scratch_.data(), h);
+        }
+
+        for (size_t i = 0; i < aggregates_.size(); ++i) {
+            size_t column = keys_.size() + i;
+            if (!batchMissing_[column * n + row]) {
+                accumulate(aggregates_[i], g, batchValues_[column][row]);
+            }
+        }
+    }
+}
+
+bool SQLAggregator::mergeable() const {
+    for (const Aggregate& a : aggregates_) {
+        if (a.kind_ == GENERIC) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SQLAggregator::mergeGroup(size_t group, const SQLAggregator& other, size_t otherGroup) {
+    for (size_t i = 0; i < aggregates_.size(); ++i) {
+        Aggregate& a       = aggregates_[i];
+        const Aggregate& b = other.aggregates_[i];
+        switch (a.kind_) {
+            case GENERIC:
+                throw eckit::SeriousBug("SQLAggregator: cannot merge the partial results of " + a.expression_->title());
+            case MIN:
+                a.value_[group] = std::min(a.value_[group], b.value_[otherGroup]);
+                break;
+            case MAX:
+                a.value_[group] = std::max(a.value_[group], b.value_[otherGroup]);
+                break;
+            default:
+                a.count_[group] += b.count_[otherGroup];
+                a.value_[group] += b.value_[otherGroup];
+                a.squares_[group] += b.squares_[otherGroup];
+                break;
+        }
+    }
+}
+
+void SQLAggregator::merge(const SQLAggregator& other) {
+
+    ASSERT(!finalised_ && !other.finalised_);
+    ASSERT(keys_.size() == other.keys_.size());
+    ASSERT(aggregates_.size() == other.aggregates_.size());
+    for (size_t i = 0; i < aggregates_.size(); ++i) {
+        ASSERT(aggregates_[i].kind_ == other.aggregates_[i].kind_);
+    }
+
+    std::vector<size_t> widths;
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        widths.push_back(std::max(keys_[i].width_, other.keys_[i].width_));
+    }
+    layout(widths);
+
+    for (size_t og = 0; og < other.groups_; ++og) {
+
+        std::fill(scratch_.begin(), scratch_.end(), 0);
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            ::memcpy(&scratch_[keys_[i].offset_], &other.keyData_[og * other.keyWidth_ + other.keys_[i].offset_],
+                     (1 + other.keys_[i].width_) * sizeof(double));
+        }
+
+        size_t h = hash(scratch_.data());
+        size_t g = find(scratch_.data(), h);
+        if (g == npos) {
+            g = insert(scratch_.data(), h);
+        }
+
+        mergeGroup(g, other, og);
+    }
+}
+
+void SQLAggregator::finalise() {
+
+    // Output the groups ordered by key, as has always been the case
+
+    order_.resize(groups_);
+    std::iota(order_.begin(), order_.end(), 0);
+
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+        for (const Key& k : keys_) {
+            const double* ka = &keyData_[a * keyWidth_ + k.offset_];
+            const double* kb = &keyData_[b * keyWidth_ + k.offset_];
+
+            // Missing values first
+            if (ka[0] != kb[0]) {
+                return ka[0] > kb[0];
+            }
+
+            if (k.string_) {
+                int c = ::memcmp(ka + 1, kb + 1, k.width_ * sizeof(double));
+                if (c != 0) {
+                    return c < 0;
+                }
+            }
+            else if (ka[1] != kb[1]) {
+                return ka[1] < kb[1];
+            }
+        }
+        return false;
+    });
+
+    finalised_ = true;
+}
+
+double SQLAggregator::finalValue(const Aggregate& a, size_t g, bool& missing) const {
+
+    // n.b. These reproduce the eval() of the corresponding aggregate functions
+
+    double n = (a.kind_ == MIN || a.kind_ == MAX) ? 0 : a.count_[g];
+
+    switch (a.kind_) {
+        case COUNT:
+            return n;
+        case SUM:
+            missing = (n == 0);
+            return a.value_[g];
+        case AVG:
+            missing = (n == 0);
+            return missing ? 0 : a.value_[g] / n;
+        case MIN:
+            missing = (a.value_[g] == DBL_MAX);
+            return a.value_[g];
+        case MAX:
+            missing = (a.value_[g] == -DBL_MAX);
+            return a.value_[g];
+        case VAR:
+        case STDEV: {
+            missing = (n == 0);
+            if (missing) {
+                return 0;
+            }
+            double x = a.value_[g] / n;
+            double y = a.squares_[g] / n;
+            double v = y - x * x;
+            return (a.kind_ == VAR) ? v : std::sqrt(std::max(v, 0.0));
+        }
+        case RMS:
+            missing = (n == 0);
+            return missing ? 0 : std::sqrt(a.squares_[g] / n);
+        default:
+            NOTIMP;
+    }
+}
+
+Expressions SQLAggregator::result(size_t n) const {
+
+    ASSERT(n < groups_);
+    size_t g = finalised_ ? order_[n] : n;
+
+    Expressions results;
+    for (size_t i = 0; i < isKey_.size(); ++i) {
+
+        if (isKey_[i]) {
+            const Key& k(keys_[indexes_[i]]);
+            const double* key = &keyData_[g * keyWidth_ + k.offset_];
+            results.emplace_back(std::make_shared<SQLExpressionEvaluated>(*k.expression_, key + 1, k.width_, key[0] != 0));
+            continue;
+        }
+
+        const Aggregate& a(aggregates_[indexes_[i]]);
+        if (a.kind_ == GENERIC) {
+            results.emplace_back(std::make_shared<SQLExpressionEvaluated>(*a.generic_[g]));
+        }
+        else {
+            bool missing = false;
+            double value = finalValue(a, g, missing);
+            results.emplace_back(std::make_shared<SQLExpressionEvaluated>(*a.expression_, &value, 1, missing));
+        }
+    }
+
+    return results;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLAggregator_H
+#define eckit_sql_SQLAggregator_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit::sql {
+
+class SQLBatch;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Hash aggregation of a SELECT that mixes aggregated and non-aggregated columns.
+///
+/// The non-aggregated columns form the group key. Keys are stored flat (one missing flag, followed by
+/// the value(s), per key column - strings are held trimmed and zero padded to a fixed width) and looked
+/// up through an open addressing hash table. The states of COUNT, SUM, AVG, MIN, MAX, VAR, STDEV and RMS
+/// are held in contiguous arrays indexed by group. Any other aggregate expression is cloned per group,
+/// and updated through partialResult().
+///
+/// Aggregation may be done in two phases: partitions of the input are aggregated independently
+/// (update()), then merged into one aggregator (merge()), before finalise(). Merging requires that
+/// all the aggregates are of the known kinds (see mergeable()). If, further, all of the keys are numeric
+/// and everything can be evaluated over a batch directly (see vectorised()), partitions may be
+/// aggregated concurrently, each into its own aggregator, through update(const SQLBatch&, ...).
+
+class SQLAggregator : private eckit::NonCopyable {
+public:  // methods
+    /// The columns of the select, in order. Non-aggregated columns are used as the key.
+    SQLAggregator(const expression::Expressions& columns);
+    ~SQLAggregator();
+
+    /// Accumulate the current row
+    void update();
+
+    /// Accumulate the selected rows of a batch, without going through the current row
+    void update(const SQLBatch& batch, const uint8_t* selected);
+    bool vectorised() const;
+
+    /// Combine the partial results of another aggregator, with the same layout, into this one
+    void merge(const SQLAggregator& other);
+    bool mergeable() const;
+
+    /// Sort the groups into key order. No more rows may be added after this.
+    void finalise();
+    bool finalised() const { return finalised_; }
+
+    /// Number of groups
+    size_t size() const { return groups_; }
+
+    /// The output row for the n'th group (in key order, once finalised)
+    expression::Expressions result(size_t n) const;
+
+private:  // types
+    enum Kind
+    {
+        GENERIC,
+        COUNT,
+        SUM,
+        AVG,
+        MIN,
+        MAX,
+        VAR,
+        STDEV,
+        RMS
+    };
+
+    struct Key {
+        std::shared_ptr<expression::SQLExpression> expression_;
+        bool string_;
+        size_t offset_;  // in doubles, of the missing flag. The value(s) follow.
+        size_t width_;   // in doubles
+    };
+
+    struct Aggregate {
+        std::shared_ptr<expression::SQLExpression> expression_;
+        std::shared_ptr<expression::SQLExpression> argument_;
+        Kind kind_;
+
+        std::vector<double> count_;
+        std::vector<double> value_;  // sum, or extreme value
+        std::vector<double> squares_;
+        std::vector<std::shared_ptr<expression::SQLExpression>> generic_;
+    };
+
+private:  // methods
+    size_t evaluateKey();
+    void layout(const std::vector<size_t>& widths);
+    size_t find(const double* key, size_t hash) const;
+    size_t insert(const double* key, size_t hash);
+    void rehash(size_t slots);
+    size_t hash(const double* key) const;
+
+    void addGroup();
+    void accumulate(Aggregate& a, size_t group, double value);
+    void mergeGroup(size_t group, const SQLAggregator& other, size_t otherGroup);
+    double finalValue(const Aggregate& a, size_t group, bool& missing) const;
+
+private:  // members
+    std::vector<bool> isKey_;
+    std::vector<size_t> indexes_;  // position of each column within keys_ or aggregates_
+
+    std::vector<Key> keys_;
+    std::vector<Aggregate> aggregates_;
+
+    size_t keyWidth_;
+    std::vector<double> keyData_;  // groups_ * keyWidth_
+    std::vector<double> scratch_;
+    std::vector<std::vector<double>> batchValues_;
+    std::vector<uint8_t> batchMissing_;
+    std::vector<uint32_t> slots_;  // group + 1, or 0 if empty. Size is a power of 2.
+
+    size_t groups_;
+    std::vector<size_t> order_;
+    bool finalised_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
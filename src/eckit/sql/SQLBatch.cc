@@ -0,0 +1,160 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLColumn.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// n.b. SQLColumn::dataSizeDoubles() is not updated when a table iterator resizes a column, so
+///      use the (updated) column type.
+
+static size_t doublesWidth(const SQLColumn& column) {
+    return std::max<size_t>(1, (column.type().size() + sizeof(double) - 1) / sizeof(double));
+}
+
+SQLBatch::SQLBatch(size_t capacity, const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                   const std::vector<ValueLookup*>& values, bool attached) :
+    capacity_(capacity), size_(0), attached_(attached) {
+
+    ASSERT(capacity_ > 0);
+    ASSERT(columns.size() == values.size());
+
+    columns_.reserve(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        Column c;
+        c.column_ = &columns[i].get();
+        c.value_  = values[i];
+        c.cursor_ = attached_ ? values[i]->first : nullptr;
+        c.stride_ = doublesWidth(*c.column_);
+        c.data_.resize(capacity_ * c.stride_);
+        c.missing_.resize(capacity_);
+        columns_.emplace_back(std::move(c));
+    }
+}
+
+SQLBatch::~SQLBatch() {}
+
+size_t SQLBatch::defaultCapacity() {
+    return Resource<size_t>("$ECKIT_SQL_BATCH_SIZE;eckitSQLBatchSize", 1024);
+}
+
+void SQLBatch::clear() {
+    ASSERT(attached_);
+    size_ = 0;
+    for (Column& c : columns_) {
+        c.value_->first = c.cursor_;
+    }
+}
+
+void SQLBatch::restride(Column& c, size_t stride) {
+
+    // The table iterator may widen (string) columns part way through. We never narrow a batch
+    // column, as the rows already stored would be truncated. Shorter values are zero padded, which
+    // is how strings are padded anyway.
+
+    if (stride <= c.stride_) {
+        return;
+    }
+
+    std::vector<double> data(capacity_ * stride, 0);
+    for (size_t row = 0; row < size_; ++row) {
+        ::memcpy(&data[row * stride], &c.data_[row * c.stride_], c.stride_ * sizeof(double));
+    }
+
+    c.data_.swap(data);
+    c.stride_ = stride;
+}
+
+void SQLBatch::appendColumn(Column& c, const double* value, size_t width, bool missing) {
+
+    restride(c, width);
+
+    double* out = &c.data_[size_ * c.stride_];
+    if (c.stride_ == 1) {
+        *out = *value;
+    }
+    else {
+        ::memcpy(out, value, width * sizeof(double));
+        std::fill(out + width, out + c.stride_, 0);
+    }
+
+    c.missing_[size_] = missing;
+}
+
+void SQLBatch::append() {
+
+    ASSERT(size_ < capacity_);
+
+    for (Column& c : columns_) {
+
+        // n.b. the iterator may have changed its buffer layout during next() (see
+        //      SQLSelect::refreshCursorMetadata), so always take the current lookup
+
+        c.cursor_ = c.value_->first;
+        appendColumn(c, c.cursor_, doublesWidth(*c.column_), c.column_->isMissingValue(c.cursor_));
+    }
+
+    ++size_;
+}
+
+void SQLBatch::append(const double* const* values, const size_t* widths, const uint8_t* missing) {
+
+    ASSERT(size_ < capacity_);
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        appendColumn(columns_[i], values[i], std::max<size_t>(1, widths[i]), missing[i]);
+    }
+
+    ++size_;
+}
+
+void SQLBatch::append(const SQLBatch& other, size_t row) {
+
+    ASSERT(size_ < capacity_);
+    ASSERT(row < other.size_);
+    ASSERT(columns_.size() == other.columns_.size());
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const Column& o(other.columns_[i]);
+        appendColumn(columns_[i], &o.data_[row * o.stride_], o.stride_, o.missing_[row]);
+    }
+
+    ++size_;
+}
+
+void SQLBatch::select(size_t row) const {
+    ASSERT(row < size_);
+    for (const Column& c : columns_) {
+        c.value_->first  = &c.data_[row * c.stride_];
+        c.value_->second = c.missing_[row];
+    }
+}
+
+int SQLBatch::columnIndex(const ValueLookup* value) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].value_ == value) {
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
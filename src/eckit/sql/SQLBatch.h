@@ -0,0 +1,109 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLBatch_H
+#define eckit_sql_SQLBatch_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit::sql {
+
+class SQLColumn;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A batch of up to capacity() rows read from one SQLTableIterator, stored column by column.
+///
+/// Each fetched column is held contiguously (with a per-column stride in doubles, to cater for
+/// strings), together with a byte-per-row missing value map. Expressions evaluate over the whole
+/// batch via SQLExpression::evalBatch().
+///
+/// The batch is bound to the value lookups that SQLSelect hands to the ColumnExpressions. Calling
+/// select(row) points those lookups at the given row of the batch, so that the row-at-a-time
+/// eval() path works unchanged on batched data.
+
+class SQLBatch : private eckit::NonCopyable {
+public:  // types
+    typedef std::pair<const double*, bool> ValueLookup;
+
+public:  // methods
+    /// A batch that is not attached does not read the value lookups, which another thread may be writing, and can
+    /// only be filled through the explicit append()s. It cannot be clear()ed.
+    SQLBatch(size_t capacity, const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+             const std::vector<ValueLookup*>& values, bool attached = true);
+    ~SQLBatch();
+
+    /// Default number of rows per batch. 0 disables batched execution.
+    static size_t defaultCapacity();
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool full() const { return size_ == capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    /// Discard all rows, and re-attach the value lookups to the table iterator's buffer
+    void clear();
+
+    /// Discard all rows, without touching the value lookups (for batches filled through the other append()s)
+    void truncate() { size_ = 0; }
+
+    /// Copy the row that the table iterator currently exposes into the batch
+    void append();
+
+    /// Copy a row given explicitly, column by column, rather than through the value lookups. This is
+    /// used to fill batches from iterators other than the one the lookups are attached to.
+    void append(const double* const* values, const size_t* widths, const uint8_t* missing);
+
+    /// Copy a row of another batch, with the same columns
+    void append(const SQLBatch& other, size_t row);
+
+    /// Point the value lookups at the given row of the batch
+    void select(size_t row) const;
+
+    /// Find the batch column associated with a value lookup. Returns -1 if not in this batch
+    int columnIndex(const ValueLookup* value) const;
+
+    const double* data(size_t column) const { return columns_[column].data_.data(); }
+    const uint8_t* missing(size_t column) const { return columns_[column].missing_.data(); }
+    size_t stride(size_t column) const { return columns_[column].stride_; }
+
+private:  // types
+    struct Column {
+        const SQLColumn* column_;
+        ValueLookup* value_;
+        const double* cursor_;
+        size_t stride_;
+        std::vector<double> data_;
+        std::vector<uint8_t> missing_;
+    };
+
+private:  // methods
+    void restride(Column& column, size_t stride);
+    void appendColumn(Column& column, const double* value, size_t width, bool missing);
+
+private:  // members
+    size_t capacity_;
+    size_t size_;
+    bool attached_;
+    std::vector<Column> columns_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -0,0 +1,565 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLColumnarTable.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/parser/CSVParser.h"
+#include "eckit/sql/SQLColumn.h"
+#include "eckit/sql/type/SQLBitfield.h"
+#include "eckit/utils/Tokenizer.h"
+#include "eckit/value/Value.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const size_t noBlock = std::numeric_limits<size_t>::max();
+
+/// The missing value of the numeric columns made for CSV
+static const double csvMissingValue = -2147483647;
+
+static bool parseNumber(const std::string& s, double& value) {
+    const char* begin = s.c_str();
+    char* end         = nullptr;
+    value             = ::strtod(begin, &end);
+    if (end == begin) {
+        return false;
+    }
+    while (::isspace(*end)) {
+        ++end;
+    }
+    return *end == 0;
+}
+
+bool SQLColumnarTable::Column::isMissing(const double* value) const {
+    return hasMissingValue_ && ::memcmp(value, &missingValue_, sizeof(double)) == 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class SQLColumnarTable::Iterator : public SQLTableIterator {
+public:
+    Iterator(const SQLColumnarTable& owner, const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+             size_t begin, size_t end) :
+        owner_(owner), begin_(begin), end_(std::min(end, owner.rows_)), row_(begin), block_(noBlock) {
+
+        size_t offset = 0;
+        for (const SQLColumn& c : columns) {
+            ASSERT(c.index() >= 0);
+            const Column* column = owner_.find(c.index());
+            size_t width         = column ? column->width_ : c.dataSizeDoubles();
+            columns_.push_back(column);
+            offsets_.push_back(offset);
+            doublesSizes_.push_back(width);
+            hasMissing_.push_back(c.hasMissingValue());
+            missingValues_.push_back(c.missingValue());
+            offset += width;
+        }
+        data_.resize(offset);
+    }
+
+private:
+    void rewind() override {
+        row_   = begin_;
+        block_ = noBlock;
+    }
+
+    bool next() override {
+
+        while (row_ < end_) {
+
+            // Check each block against the statistics as it is entered, and skip it if nothing in it can match
+
+            size_t block = row_ / owner_.blockSize_;
+            if (block != block_) {
+                block_ = block;
+                if (!blockMayMatch(block)) {
+                    ++owner_.blocksSkipped_;
+                    row_ = std::min(end_, (block + 1) * owner_.blockSize_);
+                    continue;
+                }
+                ++owner_.blocksRead_;
+            }
+
+            size_t row = row_++;
+            if (rowMatches(row)) {
+                for (size_t i = 0; i < columns_.size(); ++i) {
+                    const Column& column(*columns_[i]);
+                    double* out = &data_[offsets_[i]];
+                    if (column.string_) {
+                        const std::string& s(column.dictionary_[column.codes_[row]]);
+                        ::memcpy(out, s.data(), s.size());
+                        ::memset(reinterpret_cast<char*>(out) + s.size(), 0,
+                                 doublesSizes_[i] * sizeof(double) - s.size());
+                    }
+                    else {
+                        ::memcpy(out, &column.values_[row * column.width_], column.width_ * sizeof(double));
+                    }
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool pushDown(const std::vector<SQLPredicate>& predicates) override {
+        predicates_.clear();
+        for (const SQLPredicate& predicate : predicates) {
+            ASSERT(predicate.column_ < columns_.size());
+            const Column* column = columns_[predicate.column_];
+            if (column && column->width_ == 1 && !column->string_) {
+                predicates_.emplace_back(column, predicate);
+            }
+        }
+        return !predicates_.empty();
+    }
+
+    bool blockMayMatch(size_t block) const {
+        for (const auto& p : predicates_) {
+            if (p.first->statistics_ && !p.second.overlaps(p.first->min_[block], p.first->max_[block])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool rowMatches(size_t row) const {
+        for (const auto& p : predicates_) {
+            const double* value = &p.first->values_[row];
+            if (p.first->isMissing(value) || !p.second.matches(*value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<size_t> columnOffsets() const override { return offsets_; }
+    std::vector<size_t> doublesDataSizes() const override { return doublesSizes_; }
+    std::vector<char> columnsHaveMissing() const override { return hasMissing_; }
+    std::vector<double> missingValues() const override { return missingValues_; }
+    const double* data() const override { return data_.data(); }
+
+    const SQLColumnarTable& owner_;
+    size_t begin_;
+    size_t end_;
+    size_t row_;
+    size_t block_;
+
+    std::vector<const Column*> columns_;
+    std::vector<std::pair<const Column*, SQLPredicate>> predicates_;
+
+    std::vector<size_t> offsets_;
+    std::vector<size_t> doublesSizes_;
+    std::vector<char> hasMissing_;
+    std::vector<double> missingValues_;
+    std::vector<double> data_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLColumnarTable::SQLColumnarTable(SQLDatabase& owner, const std::string& name, size_t blockSize) :
+    SQLTable(owner, name, name), blockSize_(blockSize), rows_(0), width_(0), blocksRead_(0), blocksSkipped_(0) {
+    ASSERT(blockSize_ > 0);
+}
+
+SQLColumnarTable::~SQLColumnarTable() {}
+
+void SQLColumnarTable::layout() {
+
+    // The columns can only be changed while the table is empty
+
+    ASSERT(rows_ == 0);
+
+    columns_.clear();
+    members_.clear();
+    width_ = 0;
+
+    for (size_t i = 0; i < columnsByIndex_.size(); ++i) {
+        auto c = columnsByIndex_.find(i);
+        if (c == columnsByIndex_.end()) {
+            throw UserError("SQLColumnarTable: the columns of " + fullName() + " must be numbered from 0", Here());
+        }
+
+        const SQLColumn& column(*c->second);
+
+        Column col;
+        col.width_           = column.dataSizeDoubles();
+        col.hasMissingValue_ = column.hasMissingValue();
+        col.missingValue_    = column.missingValue();
+        col.string_          = column.type().getKind() == type::SQLType::stringType;
+        col.statistics_      = col.width_ == 1 && !col.string_;
+        col.mask_            = 0;
+        col.shift_           = 0;
+
+        // Each field of a bitfield becomes an integer column, which replaces the bitfield under the names
+        // given to the field by SQLTable::addColumn()
+
+        if (column.type().getKind() == type::SQLType::bitmapType) {
+
+            const auto& bitfield = dynamic_cast<const type::SQLBitfield&>(column.type());
+
+            std::vector<std::string> tokens;
+            Tokenizer("@")(column.name(), tokens);
+            ASSERT(tokens.size() == 1 || tokens.size() == 2);
+
+            for (const std::string& field : bitfield.bitfieldDef().first) {
+
+                Column member;
+                member.width_           = 1;
+                member.hasMissingValue_ = col.hasMissingValue_;
+                member.string_          = false;
+                member.statistics_      = true;
+                member.mask_            = bitfield.mask(field);
+                member.shift_           = bitfield.shift(field);
+
+                // The missing value must not be one of the values of the field
+
+                member.missingValue_ = (col.missingValue_ < 0 || col.missingValue_ > (member.mask_ >> member.shift_))
+                                           ? col.missingValue_
+                                           : -1;
+
+                std::string name = tokens[0] + "." + field + (tokens.size() == 2 ? "@" + tokens[1] : "");
+                size_t index     = columnsByIndex_.size() + members_.size();
+
+                std::unique_ptr<SQLColumn> sqlColumn(new SQLColumn(type::SQLType::lookup("integer"), *this, name,
+                                                                   index, member.hasMissingValue_,
+                                                                   member.missingValue_));
+                columnsByName_[name] = sqlColumn.get();
+                ownedColumns_.push_back(std::move(sqlColumn));
+
+                col.fields_.push_back(members_.size());
+                members_.emplace_back(std::move(member));
+            }
+        }
+
+        width_ += col.width_;
+        columns_.emplace_back(std::move(col));
+    }
+}
+
+const SQLColumnarTable::Column* SQLColumnarTable::find(size_t index) const {
+    if (index < columns_.size()) {
+        return &columns_[index];
+    }
+    if (index - columns_.size() < members_.size()) {
+        return &members_[index - columns_.size()];
+    }
+    return nullptr;
+}
+
+void SQLColumnarTable::append(Column& column, const double* value, size_t width) {
+
+    if (column.string_) {
+
+        // Strings are held without their trailing zeros, so that the same string is encoded the same way
+        // whatever the width it comes with
+
+        const char* p = reinterpret_cast<const char*>(value);
+        size_t length = width * sizeof(double);
+        while (length > 0 && p[length - 1] == 0) {
+            --length;
+        }
+
+        std::string s(p, length);
+        auto code = column.lookup_.find(s);
+        if (code == column.lookup_.end()) {
+            ASSERT(column.dictionary_.size() < std::numeric_limits<uint32_t>::max());
+            code = column.lookup_.emplace(s, column.dictionary_.size()).first;
+            column.dictionary_.push_back(s);
+        }
+
+        column.codes_.push_back(code->second);
+        column.width_ = std::max(column.width_, width);
+        return;
+    }
+
+    ASSERT(width == column.width_);
+    column.values_.insert(column.values_.end(), value, value + width);
+
+    bool missing = column.isMissing(value);
+
+    if (column.statistics_) {
+        size_t block = rows_ / blockSize_;
+        if (column.min_.size() == block) {
+            column.min_.push_back(std::numeric_limits<double>::infinity());
+            column.max_.push_back(-std::numeric_limits<double>::infinity());
+        }
+        if (!missing && !std::isnan(*value)) {
+            column.min_[block] = std::min(column.min_[block], *value);
+            column.max_[block] = std::max(column.max_[block], *value);
+        }
+    }
+
+    for (size_t field : column.fields_) {
+        Column& member(members_[field]);
+        double bits = missing ? member.missingValue_
+                              : double((static_cast<unsigned long>(*value) & member.mask_) >> member.shift_);
+        append(member, &bits, 1);
+    }
+}
+
+void SQLColumnarTable::appendRow(const std::vector<double>& values) {
+    if (columns_.size() != columnsByIndex_.size()) {
+        layout();
+    }
+    ASSERT(values.size() == width_);
+    appendRow(values.data());
+}
+
+void SQLColumnarTable::appendRow(const double* values) {
+
+    if (columns_.size() != columnsByIndex_.size()) {
+        layout();
+    }
+
+    for (Column& column : columns_) {
+        append(column, values, column.width_);
+        values += column.width_;
+    }
+
+    ++rows_;
+}
+
+void SQLColumnarTable::updateWidths() {
+
+    // Strings wider than those of the columns may have been loaded
+
+    width_ = 0;
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].string_) {
+            updateColumnDoublesWidth(columnsByIndex_[i]->name(), columns_[i].width_);
+        }
+        width_ += columns_[i].width_;
+    }
+}
+
+void SQLColumnarTable::load(const SQLTable& table) {
+
+    std::vector<std::string> names(table.columnNames());
+
+    std::vector<std::reference_wrapper<const SQLColumn>> source;
+    for (const std::string& name : names) {
+        source.push_back(table.column(name));
+    }
+
+    bool refresh = true;
+    std::unique_ptr<SQLTableIterator> it(table.iterator(source, [&refresh](SQLTableIterator&) { refresh = true; }));
+
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes;
+    std::vector<char> hasMissing;
+    std::vector<double> missingValues;
+
+    auto metadata = [&]() {
+        offsets       = it->columnOffsets();
+        sizes         = it->doublesDataSizes();
+        hasMissing    = it->columnsHaveMissing();
+        missingValues = it->missingValues();
+        refresh       = false;
+    };
+
+    metadata();
+
+    if (columnsByIndex_.empty()) {
+        for (size_t i = 0; i < source.size(); ++i) {
+            const SQLColumn& column(source[i]);
+            const type::SQLType& type(column.type().getKind() == type::SQLType::stringType
+                                          ? type::SQLType::lookup("string", sizes[i])
+                                          : column.type());
+            addColumn(names[i], i, type, hasMissing[i], missingValues[i],
+                      type.getKind() == type::SQLType::bitmapType, column.bitfieldDef());
+        }
+    }
+    else if (columnNames() != names) {
+        throw UserError("SQLColumnarTable: the columns of " + table.fullName() + " are not those of " + fullName(),
+                        Here());
+    }
+
+    if (columns_.size() != columnsByIndex_.size()) {
+        layout();
+    }
+
+    while (it->next()) {
+
+        if (refresh) {
+            metadata();
+        }
+
+        const double* data = it->data();
+
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            Column& column(columns_[i]);
+            const double* value = &data[offsets[i]];
+
+            // The missing values of the source may change from row to row, but not those of the table
+
+            if (!column.string_ && hasMissing[i] && ::memcmp(value, &missingValues[i], sizeof(double)) == 0) {
+                if (!column.hasMissingValue_) {
+                    throw UserError("SQLColumnarTable: " + names[i] + " has missing values in " + table.fullName()
+                                        + ", but not in " + fullName(),
+                                    Here());
+                }
+                value = &column.missingValue_;
+            }
+
+            append(column, value, sizes[i]);
+        }
+
+        ++rows_;
+    }
+
+    updateWidths();
+}
+
+void SQLColumnarTable::loadCSV(const PathName& path) {
+    std::ifstream in(std::string(path).c_str());
+    if (!in) {
+        throw CantOpenFile(path);
+    }
+    loadCSV(in);
+}
+
+void SQLColumnarTable::loadCSV(std::istream& in) {
+
+    CSVParser parser(in, true);
+    Value rows(parser.parse());
+    Value header(parser.header());
+
+    std::vector<std::string> names;
+    for (size_t j = 0; j < header.size(); ++j) {
+        names.push_back(header[int(j)]);
+    }
+
+    if (columnsByIndex_.empty()) {
+        for (size_t j = 0; j < names.size(); ++j) {
+
+            bool numbers  = true;
+            bool integers = true;
+            bool missing  = false;
+            size_t length = 0;
+
+            for (size_t r = 0; r < rows.size(); ++r) {
+                std::string s = rows[int(r)][names[j]];
+                double value;
+                length = std::max(length, s.size());
+                if (s.empty()) {
+                    missing = true;
+                }
+                else if (!parseNumber(s, value)) {
+                    numbers = false;
+                }
+                else if (value != std::trunc(value) || s.find_first_of(".eE") != std::string::npos) {
+                    integers = false;
+                }
+            }
+
+            if (numbers) {
+                addColumn(names[j], j, type::SQLType::lookup(integers ? "integer" : "real"), missing,
+                          csvMissingValue);
+            }
+            else {
+                size_t width = std::max<size_t>(1, (length + sizeof(double) - 1) / sizeof(double));
+                addColumn(names[j], j, type::SQLType::lookup("string", width), false, 0);
+            }
+        }
+    }
+
+    if (columns_.size() != columnsByIndex_.size()) {
+        layout();
+    }
+
+    std::vector<std::string> columns;
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        columns.push_back(columnsByIndex_[i]->name());
+        if (std::find(names.begin(), names.end(), columns.back()) == names.end()) {
+            throw UserError("SQLColumnarTable: no column " + columns.back() + " in CSV for " + fullName(), Here());
+        }
+    }
+
+    std::vector<double> buffer;
+
+    for (size_t r = 0; r < rows.size(); ++r) {
+        Value row(rows[int(r)]);
+        for (size_t i = 0; i < columns_.size(); ++i) {
+
+            Column& column(columns_[i]);
+            std::string s = row[columns[i]];
+
+            if (column.string_) {
+                buffer.assign(std::max<size_t>(1, (s.size() + sizeof(double) - 1) / sizeof(double)), 0);
+                ::memcpy(buffer.data(), s.data(), s.size());
+                append(column, buffer.data(), buffer.size());
+                continue;
+            }
+
+            double value;
+            if (s.empty()) {
+                if (!column.hasMissingValue_) {
+                    throw UserError("SQLColumnarTable: empty value of " + columns[i] + ", which has no missing value",
+                                    Here());
+                }
+                value = column.missingValue_;
+            }
+            else if (!parseNumber(s, value)) {
+                throw UserError("SQLColumnarTable: '" + s + "' is not a number, for " + columns[i], Here());
+            }
+
+            append(column, &value, 1);
+        }
+
+        ++rows_;
+    }
+
+    updateWidths();
+}
+
+void SQLColumnarTable::resetStatistics() {
+    blocksRead_    = 0;
+    blocksSkipped_ = 0;
+}
+
+SQLTableIterator* SQLColumnarTable::iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                                             std::function<void(SQLTableIterator&)>) const {
+    return new Iterator(*this, columns, 0, rows_);
+}
+
+std::vector<SQLTableRange> SQLColumnarTable::scanRanges(size_t count) const {
+
+    ASSERT(count > 0);
+
+    std::vector<SQLTableRange> ranges;
+    size_t step = (blocks() + count - 1) / count * blockSize_;
+    for (size_t begin = 0; begin < rows_; begin += step) {
+        ranges.push_back({begin, std::min(begin + step, rows_)});
+    }
+    return ranges;
+}
+
+SQLTableIterator* SQLColumnarTable::rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                                                  std::function<void(SQLTableIterator&)>,
+                                                  const SQLTableRange& range) const {
+    return new Iterator(*this, columns, range.begin_, range.end_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,136 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLColumnarTable_H
+#define eckit_sql_SQLColumnarTable_H
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "eckit/sql/SQLTable.h"
+
+namespace eckit {
+class PathName;
+}
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// An in-memory table, which holds the values of each column contiguously.
+///
+/// The columns are described with SQLTable::addColumn(), with indexes 0, 1, 2..., before any rows are
+/// appended. The rows are split into blocks, and the minimum and maximum of the (non-missing) values of
+/// the numeric columns are kept for every block.
+///
+/// Iterators only copy out the columns that are asked for. Conditions pushed down to them (see
+/// SQLTableIterator::pushDown) are checked against the statistics of each block, so that blocks which
+/// cannot hold any of the rows selected are skipped entirely, and then against the rows of the blocks
+/// that are read. The table can be split into ranges, at block boundaries, for parallel scans.
+///
+/// String columns are dictionary-encoded: each distinct string is held once, and the rows hold its code.
+/// The fields of bitfield columns are unpacked as the rows are appended, into integer columns of their
+/// own, so that "column.field" is read like any other column, with statistics of its own, rather than
+/// extracted from the bitfield row by row.
+///
+/// A table can be filled from any other table, or from CSV, once, and then queried repeatedly without
+/// decoding its source again.
+
+class SQLColumnarTable : public SQLTable {
+public:  // methods
+    /// @param blockSize rows per block, for which statistics are kept
+    SQLColumnarTable(SQLDatabase& owner, const std::string& name, size_t blockSize = 4096);
+    ~SQLColumnarTable() override;
+
+    /// Append a row, made of the values of each column in turn (with dataSizeDoubles() doubles each)
+    void appendRow(const double* values);
+    void appendRow(const std::vector<double>& values);
+
+    /// Append all the rows of another table. If no columns have been described yet, those of the other
+    /// table are taken, in order.
+    void load(const SQLTable& table);
+
+    /// Append the rows of CSV, with a header line naming the columns. If no columns have been described
+    /// yet, a column is made for each name: integer, or real, if all of its values are numbers, and string
+    /// otherwise. Empty numbers are missing.
+    void loadCSV(std::istream& in);
+    void loadCSV(const PathName& path);
+
+    size_t rows() const { return rows_; }
+    size_t blocks() const { return (rows_ + blockSize_ - 1) / blockSize_; }
+    size_t blockSize() const { return blockSize_; }
+
+    /// Blocks read, and skipped thanks to their statistics, by the iterators since the last reset
+    size_t blocksRead() const { return blocksRead_; }
+    size_t blocksSkipped() const { return blocksSkipped_; }
+    void resetStatistics();
+
+    SQLTableIterator* iterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                               std::function<void(SQLTableIterator&)> metadataUpdateCallback) const override;
+
+    std::vector<SQLTableRange> scanRanges(size_t count) const override;
+
+    SQLTableIterator* rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>& columns,
+                                    std::function<void(SQLTableIterator&)> metadataUpdateCallback,
+                                    const SQLTableRange& range) const override;
+
+private:  // types
+    struct Column {
+        size_t width_;  // doubles per value
+        bool hasMissingValue_;
+        double missingValue_;
+        bool string_;      // dictionary-encoded
+        bool statistics_;  // single, numeric, values
+
+        std::vector<double> values_;  // rows_ * width_, unless a string
+        std::vector<double> min_;     // per block
+        std::vector<double> max_;     // per block
+
+        std::vector<uint32_t> codes_;                       // per row, of a string
+        std::vector<std::string> dictionary_;               // the strings, by code, without trailing zeros
+        std::unordered_map<std::string, uint32_t> lookup_;  // the codes, by string
+
+        std::vector<size_t> fields_;  // of a bitfield, in members_
+        unsigned long mask_;          // of a field of a bitfield, before the shift
+        unsigned long shift_;
+
+        bool isMissing(const double* value) const;
+    };
+
+    class Iterator;
+
+private:  // methods
+    void layout();
+    void append(Column& column, const double* value, size_t width);
+    void updateWidths();
+    const Column* find(size_t index) const;
+
+private:  // members
+    size_t blockSize_;
+    size_t rows_;
+    size_t width_;                 // of the rows appended, in doubles
+    std::vector<Column> columns_;  // by index
+    std::vector<Column> members_;  // the fields of the bitfields, indexed from columns_.size()
+
+    mutable std::atomic<size_t> blocksRead_;
+    mutable std::atomic<size_t> blocksSkipped_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -9,6 +9,9 @@
  */
 
 #include "eckit/sql/SQLDistinctOutput.h"
+
+#include <algorithm>
+
 #include "eckit/sql/SQLSelect.h"
 #include "eckit/sql/expression/SQLExpressions.h"
 
@@ -48,14 +51,15 @@ bool SQLDistinctOutput::output(const expression::Expressions& results) {
 
     ASSERT(results.size() == offsets_.size());
 
+    std::fill(tmp_.begin(), tmp_.end(), 0);
+
     for (size_t i = 0; i < results.size(); i++) {
         bool missing = false;
         results[i]->eval(&tmp_[offsets_[i]], missing);
         // What do we do with missing? Or has it been already evaluated somewhere before and it doesn't matter???...
     }
 
-    if (seen_.find(tmp_) == seen_.end()) {
-        seen_.insert(tmp_);
+    if (seen_.insert(tmp_.data())) {
         return output_.output(results);
     }
 
@@ -76,15 +80,31 @@ void SQLDistinctOutput::updateTypes(SQLSelect& sql) {
 
     output_.updateTypes(sql);
 
-    // How much space is needed to store each row of selected data
-    offsets_.clear();
-    size_t offset = 0;
+    // How much space is needed to store each row of selected data. n.b. the types may change (strings
+    // widen) part way through, in which case the rows already seen are padded to match.
 
+    std::vector<size_t> widths;
     for (const auto& column : sql.output()) {
         size_t colSizeBytes = column->type()->size();
         ASSERT(colSizeBytes % 8 == 0);
+        widths.push_back(colSizeBytes / 8);
+    }
+
+    if (widths.size() != seen_.widths().size() || seen_.empty()) {
+        seen_ = SQLKeySet(widths);
+    }
+    else {
+        for (size_t i = 0; i < widths.size(); ++i) {
+            widths[i] = std::max(widths[i], seen_.widths()[i]);
+        }
+        seen_.reshape(widths);
+    }
+
+    offsets_.clear();
+    size_t offset = 0;
+    for (size_t w : seen_.widths()) {
         offsets_.push_back(offset);
-        offset += colSizeBytes / 8;
+        offset += w;
     }
 
     // And buffers to do the storage
@@ -0,0 +1,526 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLFilter.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <typeinfo>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLBatch.h"
+#include "eckit/sql/expression/ColumnExpression.h"
+#include "eckit/sql/expression/ParameterExpression.h"
+#include "eckit/sql/expression/function/FunctionAND.h"
+#include "eckit/sql/expression/function/FunctionEQ.h"
+#include "eckit/sql/expression/function/FunctionNE.h"
+#include "eckit/sql/expression/function/FunctionOR.h"
+#include "eckit/sql/type/SQLType.h"
+
+using namespace eckit::sql::expression;
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The values of an operand, for the rows of a batch. Constants are read at index 0 for every row.
+
+struct SQLFilter::Argument {
+    const double* values_;
+    const uint8_t* missing_;
+    size_t mask_;
+
+    double value(size_t i) const { return values_[i & mask_]; }
+    bool missing(size_t i) const { return missing_[i & mask_]; }
+};
+
+namespace {
+
+template <typename F>
+inline void forEachRow(const std::vector<uint32_t>& rows, bool all, size_t n, F f) {
+    if (all) {
+        for (size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+    }
+    else {
+        for (uint32_t i : rows) {
+            f(i);
+        }
+    }
+}
+
+bool isNumeric(const SQLExpression& e) {
+    return e.type()->getKind() != type::SQLType::stringType && e.type()->size() == sizeof(double);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLFilter::SQLFilter(const Expressions& conditions) :
+    conditions_(conditions), registers_(0), depth_(0), capacity_(0) {
+
+    // The compilation can be turned off, to compare with evaluating the expressions as they are
+
+    bool compiled = Resource<bool>("$ECKIT_SQL_COMPILE;eckitSQLCompile", true);
+
+    for (const auto& condition : conditions_) {
+        compileCondition(condition, compiled);
+    }
+
+    size_t depth = 0;
+    for (const Instruction& instruction : program_) {
+        if (instruction.op_ == PUSH_TRUE || instruction.op_ == PUSH_FALSE) {
+            depth_ = std::max(depth_, ++depth);
+        }
+        else if (instruction.op_ == POP) {
+            --depth;
+        }
+    }
+
+    Log::debug<LibEcKit>() << "SQLFilter: " << *this << std::endl;
+}
+
+SQLFilter::~SQLFilter() {}
+
+void SQLFilter::compileCondition(const std::shared_ptr<SQLExpression>& e, bool compiled) {
+
+    Operand result = compiled ? compile(e) : evaluate(e);
+
+    // Conditions that are always true are dropped
+
+    if (result.kind_ == Operand::CONSTANT && result.value_ != 0 && !result.missing_) {
+        return;
+    }
+
+    Instruction instruction{};
+    instruction.op_      = FILTER;
+    instruction.args_[0] = result;
+    program_.push_back(instruction);
+}
+
+SQLFilter::Operand SQLFilter::compile(const std::shared_ptr<SQLExpression>& e) {
+
+    // A filter is made for one execution, during which parameters do not change
+
+    bool constant = e->isConstant() || dynamic_cast<const ParameterExpression*>(e.get());
+
+    if (constant && isNumeric(*e)) {
+        bool missing = false;
+        double value = e->eval(missing);
+        return Operand{Operand::CONSTANT, missing, 0, value};
+    }
+
+    // Columns are read from the batch
+
+    const SQLExpression& expression(*e);
+    if (typeid(expression) == typeid(ColumnExpression) && isNumeric(expression)) {
+        const auto* value = static_cast<const ColumnExpression&>(*e).valueLookup();
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (columns_[i].value_ == value) {
+                return Operand{Operand::COLUMN, 0, i, 0};
+            }
+        }
+        columns_.push_back(Column{e.get(), value, newRegister()});
+        return Operand{Operand::COLUMN, 0, columns_.size() - 1, 0};
+    }
+
+    auto* f = dynamic_cast<function::FunctionExpression*>(e.get());
+    if (!f) {
+        return evaluate(e);
+    }
+
+    // Functions of numbers, for which the row by row results are reproduced exactly. Strings are compared
+    // trimmed, so are left to the expressions themselves.
+
+    Expressions& args(f->args());
+    for (const auto& arg : args) {
+        if (!isNumeric(*arg)) {
+            return evaluate(e);
+        }
+    }
+
+    Instruction instruction{};
+    instruction.missingValue_ = e->missingValue();
+
+    if (args.size() == 2 && (dynamic_cast<function::FunctionAND*>(f) || dynamic_cast<function::FunctionOR*>(f))) {
+
+        bool isAnd = dynamic_cast<function::FunctionAND*>(f);
+
+        // Only evaluate the right hand side for the rows where the left hand side does not decide
+
+        Operand lhs = compile(args[0]);
+
+        size_t push = program_.size();
+        Instruction restrict{};
+        restrict.op_      = isAnd ? PUSH_TRUE : PUSH_FALSE;
+        restrict.args_[0] = lhs;
+        program_.push_back(restrict);
+
+        Operand rhs = compile(args[1]);
+
+        program_[push].jump_ = program_.size();
+        Instruction pop{};
+        pop.op_ = POP;
+        program_.push_back(pop);
+
+        instruction.op_      = isAnd ? AND : OR;
+        instruction.args_[0] = lhs;
+        instruction.args_[1] = rhs;
+        return emit(instruction);
+    }
+
+    static const std::map<std::pair<std::string, size_t>, Op> operators{
+        {{"-", 1}, NEGATE},
+        {{"not", 1}, NOT},
+        {{"+", 2}, ADD},
+        {{"-", 2}, SUBTRACT},
+        {{"*", 2}, MULTIPLY},
+        {{"/", 2}, DIVIDE},
+        {{"=", 2}, EQUAL},
+        {{"<>", 2}, NOT_EQUAL},
+        {{"<", 2}, LESS},
+        {{"<=", 2}, LESS_EQUAL},
+        {{">", 2}, GREATER},
+        {{">=", 2}, GREATER_EQUAL},
+        {{"between", 3}, BETWEEN},
+        {{"between_exclude_first", 3}, BETWEEN},
+        {{"between_exclude_second", 3}, BETWEEN},
+        {{"between_exclude_both", 3}, BETWEEN},
+        {{"not_between", 3}, NOT_BETWEEN},
+    };
+
+    auto op = operators.find(std::make_pair(f->name(), args.size()));
+    if (op == operators.end()) {
+        return evaluate(e);
+    }
+
+    instruction.op_             = op->second;
+    instruction.lowerInclusive_ = (f->name() == "between" || f->name() == "between_exclude_second");
+    instruction.upperInclusive_ = (f->name() == "between" || f->name() == "between_exclude_first");
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        instruction.args_[i] = compile(args[i]);
+    }
+
+    return emit(instruction);
+}
+
+SQLFilter::Operand SQLFilter::evaluate(const std::shared_ptr<SQLExpression>& e) {
+    Instruction instruction{};
+    instruction.op_         = EVALUATE;
+    instruction.expression_ = e.get();
+    return emit(instruction);
+}
+
+SQLFilter::Operand SQLFilter::emit(Instruction instruction) {
+    instruction.out_ = newRegister();
+    program_.push_back(instruction);
+    return Operand{Operand::REGISTER, 0, instruction.out_, 0};
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLFilter::Argument SQLFilter::argument(const Instruction& instruction, size_t i) const {
+    const Operand& operand(instruction.args_[i]);
+    switch (operand.kind_) {
+        case Operand::REGISTER:
+            return Argument{&values_[operand.index_ * capacity_], &missing_[operand.index_ * capacity_], ~size_t(0)};
+        case Operand::COLUMN:
+            return Argument{columnValues_[operand.index_], columnMissing_[operand.index_], ~size_t(0)};
+        default:
+            return Argument{&operand.value_, &operand.missing_, 0};
+    }
+}
+
+void SQLFilter::select(const SQLBatch& batch, uint8_t* selected) {
+
+    size_t n = batch.size();
+    if (n == 0 || program_.empty()) {
+        return;
+    }
+
+    if (capacity_ < n) {
+        capacity_ = std::max(n, batch.capacity());
+        values_.assign(registers_ * capacity_, 0);
+        missing_.assign(registers_ * capacity_, 0);
+        selections_.resize(depth_ + 1);
+        for (Selection& s : selections_) {
+            s.rows_.reserve(capacity_);
+        }
+    }
+
+    // Read the columns in place where possible
+
+    columnValues_.resize(columns_.size());
+    columnMissing_.resize(columns_.size());
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const Column& column(columns_[i]);
+        int index = batch.columnIndex(column.value_);
+        if (index >= 0 && batch.stride(index) == 1) {
+            columnValues_[i]  = batch.data(index);
+            columnMissing_[i] = batch.missing(index);
+        }
+        else {
+            double* values   = &values_[column.register_ * capacity_];
+            uint8_t* missing = &missing_[column.register_ * capacity_];
+            column.expression_->evalBatch(batch, values, missing);
+            columnValues_[i]  = values;
+            columnMissing_[i] = missing;
+        }
+    }
+
+    // Start with the rows that are flagged
+
+    Selection& first(selections_[0]);
+    first.rows_.clear();
+    for (size_t i = 0; i < n; ++i) {
+        if (selected[i]) {
+            first.rows_.push_back(i);
+        }
+    }
+    first.all_ = (first.rows_.size() == n);
+    if (first.rows_.empty()) {
+        return;
+    }
+
+    // n.b. When narrowing, the rows are compacted in place when the selection is the same
+
+    auto narrow = [n](const Selection& from, Selection& to, auto keep) {
+        if (from.all_) {
+            to.rows_.clear();
+            for (size_t i = 0; i < n; ++i) {
+                if (keep(i)) {
+                    to.rows_.push_back(i);
+                }
+            }
+            to.all_ = (to.rows_.size() == n);
+            return;
+        }
+
+        size_t count = from.rows_.size();
+        to.rows_.resize(count);
+        size_t k = 0;
+        for (size_t j = 0; j < count; ++j) {
+            uint32_t i = from.rows_[j];
+            if (keep(i)) {
+                to.rows_[k++] = i;
+            }
+        }
+        to.rows_.resize(k);
+        to.all_ = false;
+    };
+
+    size_t level = 0;
+
+    for (size_t pc = 0; pc < program_.size(); ++pc) {
+
+        const Instruction& instruction(program_[pc]);
+
+        switch (instruction.op_) {
+
+            case PUSH_TRUE:
+            case PUSH_FALSE: {
+                Argument a(argument(instruction, 0));
+                bool keepTrue = (instruction.op_ == PUSH_TRUE);
+                narrow(selections_[level], selections_[level + 1],
+                       [&a, keepTrue](size_t i) { return (a.value(i) != 0) == keepTrue; });
+                ++level;
+                if (selections_[level].rows_.empty()) {
+                    pc = instruction.jump_ - 1;
+                }
+                break;
+            }
+
+            case POP:
+                --level;
+                break;
+
+            case FILTER: {
+                ASSERT(level == 0);
+                Argument a(argument(instruction, 0));
+                narrow(first, first, [&a](size_t i) { return a.value(i) != 0 && !a.missing(i); });
+                if (first.rows_.empty()) {
+                    std::fill(selected, selected + n, 0);
+                    return;
+                }
+                break;
+            }
+
+            default:
+                execute(instruction, batch, selections_[level]);
+                break;
+        }
+    }
+
+    // The rows that remain selected are a subset of those flagged at the start
+
+    if (!first.all_) {
+        std::fill(selected, selected + n, 0);
+        for (uint32_t i : first.rows_) {
+            selected[i] = 1;
+        }
+    }
+}
+
+void SQLFilter::execute(const Instruction& instruction, const SQLBatch& batch, const Selection& rows) {
+
+    size_t n         = batch.size();
+    double* out      = &values_[instruction.out_ * capacity_];
+    uint8_t* missing = &missing_[instruction.out_ * capacity_];
+    const double mv  = instruction.missingValue_;
+
+    // Other expressions are evaluated for the whole batch
+
+    if (instruction.op_ == EVALUATE) {
+        instruction.expression_->evalBatch(batch, out, missing);
+        return;
+    }
+
+    Argument a(argument(instruction, 0));
+    Argument b(argument(instruction, 1));
+    Argument c(argument(instruction, 2));
+
+    // As the functions evaluated row by row (see UnaryFunction, BinaryFunction and TertiaryFunction in
+    // DoubleFunctions.cc), a missing argument gives a missing result, with the function's missing value
+
+    auto unary = [&](auto fn) {
+        forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+            bool m     = a.missing(i);
+            out[i]     = m ? mv : fn(a.value(i));
+            missing[i] = m;
+        });
+    };
+
+    auto binary = [&](auto fn) {
+        forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+            bool m     = a.missing(i) | b.missing(i);
+            out[i]     = m ? mv : fn(a.value(i), b.value(i));
+            missing[i] = m;
+        });
+    };
+
+    switch (instruction.op_) {
+        case NEGATE:
+            unary([](double x) { return -x; });
+            break;
+
+        case NOT:
+            unary([](double x) { return double(!x); });
+            break;
+
+        case ADD:
+            binary([](double x, double y) { return x + y; });
+            break;
+
+        case SUBTRACT:
+            binary([](double x, double y) { return x - y; });
+            break;
+
+        case DIVIDE:
+            binary([](double x, double y) { return x / y; });
+            break;
+
+        case LESS:
+            binary([](double x, double y) { return double(x < y); });
+            break;
+
+        case LESS_EQUAL:
+            binary([](double x, double y) { return double(x <= y); });
+            break;
+
+        case GREATER:
+            binary([](double x, double y) { return double(x > y); });
+            break;
+
+        case GREATER_EQUAL:
+            binary([](double x, double y) { return double(x >= y); });
+            break;
+
+        case MULTIPLY:
+            // A product with zero is zero, unless both factors are missing (see MultiplyFunction)
+            forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+                double x   = a.value(i);
+                double y   = b.value(i);
+                bool m0    = a.missing(i);
+                bool m1    = b.missing(i);
+                bool zero  = (x == 0 || y == 0) && !(m0 && m1);
+                bool m     = !zero && (m0 || m1);
+                out[i]     = zero ? 0 : (m ? mv : x * y);
+                missing[i] = m;
+            });
+            break;
+
+        case EQUAL:
+        case NOT_EQUAL: {
+            // As FunctionEQ and FunctionNE, which compare the values even if they are missing
+            bool equal = (instruction.op_ == EQUAL);
+            forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+                out[i]     = (a.value(i) == b.value(i)) == equal;
+                missing[i] = a.missing(i) | b.missing(i);
+            });
+            break;
+        }
+
+        case BETWEEN:
+        case NOT_BETWEEN: {
+            bool lowerInclusive = instruction.lowerInclusive_;
+            bool upperInclusive = instruction.upperInclusive_;
+            bool inside         = (instruction.op_ == BETWEEN);
+            forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+                bool m   = a.missing(i) | b.missing(i) | c.missing(i);
+                double x = a.value(i);
+                bool in  = inside ? (lowerInclusive ? x >= b.value(i) : x > b.value(i))
+                                       && (upperInclusive ? x <= c.value(i) : x < c.value(i))
+                                  : !(x < b.value(i) || x > c.value(i));
+                out[i]     = m ? mv : double(in == inside);
+                missing[i] = m;
+            });
+            break;
+        }
+
+        case AND:
+            // The right hand side was only evaluated where the left hand side is true (see FunctionAND)
+            forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+                bool lhs   = (a.value(i) != 0);
+                bool rhs   = lhs && (b.value(i) != 0);
+                missing[i] = a.missing(i) | (lhs && b.missing(i));
+                out[i]     = rhs;
+            });
+            break;
+
+        case OR:
+            // The right hand side was only evaluated where the left hand side is false (see FunctionOR)
+            forEachRow(rows.rows_, rows.all_, n, [&](size_t i) {
+                bool lhs   = (a.value(i) != 0);
+                bool rhs   = !lhs && (b.value(i) != 0);
+                missing[i] = a.missing(i) | (!lhs && b.missing(i));
+                out[i]     = lhs || rhs;
+            });
+            break;
+
+        default:
+            NOTIMP;
+    }
+}
+
+void SQLFilter::print(std::ostream& s) const {
+    s << program_.size() << " instructions, " << registers_ << " registers";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,161 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLFilter_H
+#define eckit_sql_SQLFilter_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <utility>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit::sql {
+
+class SQLBatch;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The conditions that the rows of a batch must all satisfy (e.g. the checks of a WHERE clause on one
+/// table), compiled into a flat program over registers, each holding a value and a missing flag per row.
+///
+/// The program is run once per batch, each instruction looping over the rows, rather than walking the
+/// expression tree row by row. Constant sub-expressions, and parameters, are folded when compiling. Columns
+/// are read in place from the batch. AND and OR are short-circuited: the right hand side is only evaluated
+/// for the rows where the left hand side does not decide the result, and each condition only for the rows
+/// that passed the previous ones. Comparisons, arithmetic, BETWEEN, NOT, AND and OR on numbers are compiled
+/// natively; any other expression is evaluated through SQLExpression::evalBatch().
+///
+/// The results are those that the expressions give row by row (see SQLExpression::eval), missing values
+/// included. A filter holds the scratch space of its registers, so it must not be used from several
+/// threads at once.
+
+class SQLFilter : private eckit::NonCopyable {
+public:  // methods
+    SQLFilter(const expression::Expressions& conditions);
+    ~SQLFilter();
+
+    /// Clear the flags of the rows of the batch for which any condition is false, or missing. Rows that
+    /// are not flagged to start with are not evaluated.
+    void select(const SQLBatch& batch, uint8_t* selected);
+
+    bool empty() const { return conditions_.empty(); }
+    const expression::Expressions& conditions() const { return conditions_; }
+
+    void print(std::ostream&) const;
+
+private:  // types
+    enum Op : uint8_t
+    {
+        EVALUATE,
+        NEGATE,
+        NOT,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        BETWEEN,
+        NOT_BETWEEN,
+        AND,
+        OR,
+        PUSH_TRUE,   // restrict the rows to those where the operand is true (non-zero)
+        PUSH_FALSE,  // restrict the rows to those where the operand is false
+        POP,         // back to the rows before the matching push
+        FILTER       // keep only the rows where the operand is true, and not missing
+    };
+
+    struct Operand {
+        enum Kind : uint8_t
+        {
+            REGISTER,
+            COLUMN,
+            CONSTANT
+        };
+
+        Kind kind_;
+        uint8_t missing_;  // of a constant
+        size_t index_;     // of the register or column
+        double value_;     // of a constant
+    };
+
+    struct Instruction {
+        Op op_;
+        bool lowerInclusive_;  // BETWEEN
+        bool upperInclusive_;  // BETWEEN
+        size_t out_;           // register
+        size_t jump_;          // PUSH_*: the matching POP, to go to if no rows are left
+        double missingValue_;  // the value of missing results
+        Operand args_[3];
+        const expression::SQLExpression* expression_;  // EVALUATE
+    };
+
+    /// A column of the batch, or the register it is evaluated into if it cannot be read in place
+    struct Column {
+        const expression::SQLExpression* expression_;
+        const std::pair<const double*, bool>* value_;  // lookup, see SQLBatch::columnIndex()
+        size_t register_;
+    };
+
+    /// The rows being evaluated
+    struct Selection {
+        bool all_;  // all of the rows of the batch
+        std::vector<uint32_t> rows_;
+    };
+
+    struct Argument;
+
+private:  // methods
+    void compileCondition(const std::shared_ptr<expression::SQLExpression>& e, bool compiled);
+    Operand compile(const std::shared_ptr<expression::SQLExpression>& e);
+    Operand evaluate(const std::shared_ptr<expression::SQLExpression>& e);
+    Operand emit(Instruction instruction);
+    size_t newRegister() { return registers_++; }
+
+    Argument argument(const Instruction& instruction, size_t i) const;
+    void execute(const Instruction& instruction, const SQLBatch& batch, const Selection& rows);
+
+    friend std::ostream& operator<<(std::ostream& s, const SQLFilter& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    expression::Expressions conditions_;
+
+    std::vector<Instruction> program_;
+    std::vector<Column> columns_;
+    size_t registers_;
+    size_t depth_;  // of the nested pushes
+
+    // Scratch space
+
+    size_t capacity_;
+    std::vector<double> values_;
+    std::vector<uint8_t> missing_;
+    std::vector<Selection> selections_;
+    std::vector<const double*> columnValues_;
+    std::vector<const uint8_t*> columnMissing_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLJoin.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/BigNum.h"
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLBatch.h"
+#include "eckit/sql/SQLFilter.h"
+#include "eckit/sql/SQLTable.h"
+#include "eckit/sql/SelectOneTable.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const size_t npos = std::numeric_limits<size_t>::max();
+
+SQLJoin::SQLJoin(const SelectOneTable& table, const std::shared_ptr<expression::SQLExpression>& buildKey,
+                 const std::shared_ptr<expression::SQLExpression>& probeKey, const expression::Expressions& filters) :
+    table_(table),
+    buildKey_(buildKey),
+    probeKey_(probeKey),
+    filters_(filters),
+    strategy_(UNDECIDED),
+    chunkSize_(std::max<size_t>(SQLBatch::defaultCapacity(), 1)),
+    position_(0),
+    current_(npos),
+    key_(0) {}
+
+SQLJoin::~SQLJoin() {}
+
+void SQLJoin::build(SQLTableIterator& cursor) {
+
+    // Read the table a batch at a time, apply the single-table checks, and copy the rows that pass
+    // (and have a valid key) into the stored chunks.
+
+    SQLBatch batch(chunkSize_, table_.fetch_, table_.values_);
+    SQLFilter filter(filters_);
+    std::vector<uint8_t> selected(chunkSize_);
+
+    bool sorted = true;
+
+    for (;;) {
+        batch.clear();
+        while (!batch.full() && cursor.next()) {
+            batch.append();
+        }
+
+        size_t n = batch.size();
+        if (n == 0) {
+            break;
+        }
+
+        std::fill(selected.begin(), selected.begin() + n, 1);
+        filter.select(batch, selected.data());
+
+        for (size_t i = 0; i < n; ++i) {
+            if (!selected[i]) {
+                continue;
+            }
+
+            batch.select(i);
+
+            bool m   = false;
+            double k = buildKey_->eval(m);
+            if (m || std::isnan(k)) {
+                continue;
+            }
+
+            if (keys_.size() % chunkSize_ == 0) {
+                chunks_.emplace_back(new SQLBatch(chunkSize_, table_.fetch_, table_.values_));
+            }
+            chunks_.back()->append();
+
+            sorted = sorted && (keys_.empty() || keys_.back() <= k);
+            keys_.push_back(k);
+        }
+    }
+
+    batch.clear();
+
+    strategy_ = sorted ? MERGE : HASH;
+
+    if (strategy_ == HASH) {
+        next_.assign(keys_.size(), npos);
+        for (size_t row = 0; row < keys_.size(); ++row) {
+            auto it = buckets_.find(keys_[row]);
+            if (it == buckets_.end()) {
+                buckets_.emplace(keys_[row], std::make_pair(row, row));
+            }
+            else {
+                next_[it->second.second] = row;
+                it->second.second        = row;
+            }
+        }
+    }
+
+    Log::debug<LibEcKit>() << "SQLJoin: " << *this << std::endl;
+}
+
+void SQLJoin::probe(SQLTableIterator& cursor) {
+
+    if (strategy_ == UNDECIDED) {
+        build(cursor);
+    }
+
+    bool missing = false;
+    key_         = probeKey_->eval(missing);
+
+    if (missing || std::isnan(key_)) {
+        current_ = npos;
+        return;
+    }
+
+    if (strategy_ == HASH) {
+        auto it  = buckets_.find(key_);
+        current_ = (it == buckets_.end()) ? npos : it->second.first;
+        return;
+    }
+
+    // MERGE: if the outer keys are increasing (i.e. both sides are sorted), carry on from where the
+    // previous key was found. Otherwise start again.
+
+    auto begin = keys_.begin();
+    if (position_ < keys_.size() && keys_[position_] <= key_) {
+        begin += position_;
+    }
+
+    auto it   = std::lower_bound(begin, keys_.end(), key_);
+    position_ = it - keys_.begin();
+    current_  = (it == keys_.end() || *it != key_) ? npos : position_;
+}
+
+bool SQLJoin::next() {
+
+    if (current_ == npos) {
+        return false;
+    }
+
+    size_t row = current_;
+
+    if (strategy_ == HASH) {
+        current_ = next_[row];
+    }
+    else {
+        current_ = (row + 1 < keys_.size() && keys_[row + 1] == key_) ? row + 1 : npos;
+    }
+
+    select(row);
+    return true;
+}
+
+void SQLJoin::select(size_t row) const {
+    chunks_[row / chunkSize_]->select(row % chunkSize_);
+}
+
+void SQLJoin::print(std::ostream& s) const {
+    switch (strategy_) {
+        case HASH:
+            s << "HASH JOIN";
+            break;
+        case MERGE:
+            s << "MERGE JOIN";
+            break;
+        default:
+            s << "HASH or MERGE JOIN (decided when read)";
+            break;
+    }
+
+    s << " " << table_.table_->fullName() << " ON " << *buildKey_ << " = " << *probeKey_;
+
+    if (strategy_ != UNDECIDED) {
+        s << " (" << BigNum(keys_.size()) << " rows";
+        if (strategy_ == HASH) {
+            s << ", " << BigNum(buckets_.size()) << " keys";
+        }
+        s << ")";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,110 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLJoin_H
+#define eckit_sql_SQLJoin_H
+
+#include <iosfwd>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit::sql {
+
+class SQLBatch;
+class SQLTableIterator;
+struct SelectOneTable;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Equi-join of one table against the (current rows of the) tables that are enumerated outside it.
+///
+/// Rather than rewinding and re-reading the table for every row of the outer tables, all of the rows
+/// that pass the single-table checks are read once, and held in memory together with their join key.
+/// Each outer row then only visits the rows with a matching key.
+///
+/// If the keys are read in (non-decreasing) order a merge join is used, which walks forward through
+/// the stored keys as the outer keys increase. Otherwise the rows are chained into a hash table.
+
+class SQLJoin : private eckit::NonCopyable {
+public:  // types
+    enum Strategy
+    {
+        UNDECIDED,
+        HASH,
+        MERGE
+    };
+
+public:  // methods
+    SQLJoin(const SelectOneTable& table, const std::shared_ptr<expression::SQLExpression>& buildKey,
+            const std::shared_ptr<expression::SQLExpression>& probeKey, const expression::Expressions& filters);
+    ~SQLJoin();
+
+    /// Look up the rows matching the current probe key. The table is read on the first call.
+    void probe(SQLTableIterator& cursor);
+
+    /// Point the table's value lookups at the next matching row. Returns false if there are no more.
+    bool next();
+
+    Strategy strategy() const { return strategy_; }
+    const expression::Expressions& filters() const { return filters_; }
+    size_t size() const { return keys_.size(); }
+
+    void print(std::ostream&) const;
+
+private:  // methods
+    void build(SQLTableIterator& cursor);
+    void select(size_t row) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const SQLJoin& j) {
+        j.print(s);
+        return s;
+    }
+
+private:  // members
+    const SelectOneTable& table_;
+
+    std::shared_ptr<expression::SQLExpression> buildKey_;
+    std::shared_ptr<expression::SQLExpression> probeKey_;
+    expression::Expressions filters_;
+
+    Strategy strategy_;
+
+    // The stored rows, and their keys
+
+    size_t chunkSize_;
+    std::vector<std::unique_ptr<SQLBatch>> chunks_;
+    std::vector<double> keys_;
+
+    // HASH: buckets of rows with the same key, as (first, last) rows of a chain through next_
+
+    std::unordered_map<double, std::pair<size_t, size_t>> buckets_;
+    std::vector<size_t> next_;
+
+    // MERGE: where the last key was found
+
+    size_t position_;
+
+    // The current match
+
+    size_t current_;
+    double key_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLKeySet.h"
+
+#include <cstring>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const size_t initialSlots = 64;
+
+SQLKeySet::SQLKeySet(const std::vector<size_t>& widths) :
+    widths_(widths), width_(0), slots_(initialSlots, 0), size_(0) {
+    for (size_t w : widths_) {
+        width_ += w;
+    }
+}
+
+void SQLKeySet::reshape(const std::vector<size_t>& widths) {
+
+    ASSERT(widths.size() == widths_.size());
+
+    size_t width = 0;
+    for (size_t i = 0; i < widths.size(); ++i) {
+        ASSERT(widths[i] >= widths_[i]);
+        width += widths[i];
+    }
+
+    if (width == width_) {
+        widths_ = widths;
+        return;
+    }
+
+    if (size_ > 0) {
+        std::vector<double> keys(size_ * width, 0);
+        for (size_t n = 0; n < size_; ++n) {
+            const double* from = &keys_[n * width_];
+            double* to         = &keys[n * width];
+            for (size_t i = 0; i < widths.size(); ++i) {
+                ::memcpy(to, from, widths_[i] * sizeof(double));
+                from += widths_[i];
+                to += widths[i];
+            }
+        }
+        keys_.swap(keys);
+    }
+
+    widths_ = widths;
+    width_  = width;
+
+    if (size_ > 0) {
+        rehash(slots_.size());
+    }
+}
+
+size_t SQLKeySet::hash(const double* key, size_t width) {
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < width; ++i) {
+        uint64_t bits;
+        ::memcpy(&bits, &key[i], sizeof(bits));
+        h ^= bits + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+size_t SQLKeySet::find(const double* key) const {
+    return find(key, hash(key, width_));
+}
+
+size_t SQLKeySet::find(const double* key, size_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask; slots_[i] != 0; i = (i + 1) & mask) {
+        size_t n = slots_[i] - 1;
+        if (::memcmp(&keys_[n * width_], key, width_ * sizeof(double)) == 0) {
+            return n;
+        }
+    }
+    return npos;
+}
+
+bool SQLKeySet::insert(const double* key) {
+    size_t h = hash(key, width_);
+    if (find(key, h) != npos) {
+        return false;
+    }
+    insert(key, h);
+    return true;
+}
+
+size_t SQLKeySet::findOrInsert(const double* key) {
+    size_t h = hash(key, width_);
+    size_t n = find(key, h);
+    return n != npos ? n : insert(key, h);
+}
+
+size_t SQLKeySet::insert(const double* key, size_t hash) {
+
+    ASSERT(size_ < std::numeric_limits<uint32_t>::max());
+
+    // Keep the table at most half full
+
+    if (2 * (size_ + 1) > slots_.size()) {
+        rehash(2 * slots_.size());
+    }
+
+    size_t mask = slots_.size() - 1;
+    size_t i    = hash & mask;
+    while (slots_[i] != 0) {
+        i = (i + 1) & mask;
+    }
+
+    keys_.insert(keys_.end(), key, key + width_);
+    slots_[i] = ++size_;
+    return size_ - 1;
+}
+
+void SQLKeySet::rehash(size_t slots) {
+    slots_.assign(slots, 0);
+    size_t mask = slots - 1;
+    for (size_t n = 0; n < size_; ++n) {
+        size_t i = hash(&keys_[n * width_], width_) & mask;
+        while (slots_[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = n + 1;
+    }
+}
+
+void SQLKeySet::clear() {
+    keys_.clear();
+    slots_.assign(initialSlots, 0);
+    size_ = 0;
+}
+
+void SQLKeySet::trimString(char* s, size_t size) {
+
+    static const char* whitespace = "\t\n\v\f\r ";
+
+    size_t end = ::strnlen(s, size);
+    while (end > 0 && ::strchr(whitespace, s[end - 1])) {
+        --end;
+    }
+
+    size_t begin = 0;
+    while (begin < end && ::strchr(whitespace, s[begin])) {
+        ++begin;
+    }
+
+    if (begin > 0) {
+        ::memmove(s, s + begin, end - begin);
+    }
+    ::memset(s + end - begin, 0, size - (end - begin));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,93 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLKeySet_H
+#define eckit_sql_SQLKeySet_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A set of fixed width keys, made of doubles, compared bitwise.
+///
+/// Keys are made of fields, each of one or more doubles (e.g. the values of the columns of a row, with
+/// strings occupying several doubles). They are stored flat, one after the other, in the order they were
+/// inserted, and looked up through an open addressing hash table. Nothing is allocated per key once
+/// the storage has grown.
+///
+/// n.b. As comparisons are bitwise, callers must normalise the keys where SQL would consider differing
+///      values equal (e.g. -0.0 and 0.0, or strings with surrounding white space - see trimString()).
+
+class SQLKeySet {
+public:  // types
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+public:  // methods
+    /// @param widths in doubles, of each field of the keys
+    SQLKeySet(const std::vector<size_t>& widths = std::vector<size_t>());
+
+    /// Change the widths of the fields. Fields may only grow, and the existing keys are zero padded.
+    void reshape(const std::vector<size_t>& widths);
+
+    const std::vector<size_t>& widths() const { return widths_; }
+
+    /// Width of the keys, in doubles
+    size_t width() const { return width_; }
+
+    /// Index of the key (in insertion order), or npos
+    size_t find(const double* key) const;
+    bool contains(const double* key) const { return find(key) != npos; }
+
+    /// Add the key if it is not yet present. Returns true if it was added.
+    bool insert(const double* key);
+
+    /// Index of the key, which is added if not yet present
+    size_t findOrInsert(const double* key);
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /// The n'th key inserted
+    const double* key(size_t n) const { return &keys_[n * width_]; }
+
+    void clear();
+
+    static size_t hash(const double* key, size_t width);
+
+    /// Trim the white space surrounding a string stored in doubles, moving it to the start and zero
+    /// padding the remainder, so that strings equal in SQL (see FunctionEQ) are bitwise equal.
+    static void trimString(char* s, size_t size);
+
+private:  // methods
+    size_t find(const double* key, size_t hash) const;
+    size_t insert(const double* key, size_t hash);
+    void rehash(size_t slots);
+
+private:  // members
+    std::vector<size_t> widths_;
+    size_t width_;
+
+    std::vector<double> keys_;     // size_ * width_
+    std::vector<uint32_t> slots_;  // key + 1, or 0 if empty. Size is a power of 2.
+    size_t size_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -9,7 +9,17 @@
  */
 
 #include "eckit/sql/SQLOrderOutput.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLSorter.h"
 #include "eckit/sql/expression/SQLExpressionEvaluated.h"
+#include "eckit/sql/type/SQLType.h"
+#include "eckit/utils/StringTools.h"
 
 using namespace eckit::sql::expression;
 
@@ -25,8 +35,8 @@ namespace eckit::sql {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-SQLOrderOutput::SQLOrderOutput(SQLOutput& output, const std::pair<Expressions, std::vector<bool>>& by) :
-    output_(output), by_(by) {}
+SQLOrderOutput::SQLOrderOutput(SQLOutput& output, const std::pair<Expressions, std::vector<bool>>& by, size_t limit) :
+    output_(output), by_(by), limit_(limit), layout_(0), sorted_(false) {}
 
 SQLOrderOutput::~SQLOrderOutput() {}
 
@@ -36,6 +46,9 @@ void SQLOrderOutput::print(std::ostream& s) const {
         s << *(by_.first[i]) << (by_.second[i] ? " ASC " : " DESC ") << ", ";
     }
     s << "]";
+    if (limit_) {
+        s << " LIMIT " << limit_;
+    }
 }
 
 unsigned long long SQLOrderOutput::count() {
@@ -44,6 +57,10 @@ unsigned long long SQLOrderOutput::count() {
 
 void SQLOrderOutput::reset() {
     output_.reset();
+    sorter_.reset();
+    sorted_ = false;
+    layouts_.clear();
+    layout_ = 0;
 }
 
 void SQLOrderOutput::flush() {
@@ -52,49 +69,167 @@ void SQLOrderOutput::flush() {
 
 bool SQLOrderOutput::cachedNext() {
 
-    while (true) {
+    if (!sorter_) {
+        return false;
+    }
 
-        auto it = sortedResults_.begin();
+    if (!sorted_) {
+        sorter_->sort();
+        sorted_ = true;
+        Log::debug<LibEcKit>() << "SQLOrderOutput: " << *sorter_ << std::endl;
+    }
 
-        // If there are no more results, we are done
+    const char* payload;
+    size_t length;
 
-        if (it == sortedResults_.end()) {
-            return false;
+    while (sorter_->next(payload, length)) {
+
+        uint32_t layout;
+        ::memcpy(&layout, payload, sizeof(layout));
+        payload += sizeof(layout);
+
+        const std::vector<Column>& columns(layouts_[layout]);
+
+        Expressions row;
+        row.reserve(columns.size());
+        for (const Column& column : columns) {
+            bool missing = *payload++;
+            ::memcpy(values_.data(), payload, column.width_ * sizeof(double));
+            payload += column.width_ * sizeof(double);
+            row.push_back(std::make_shared<SQLExpressionEvaluated>(*column.type_, values_.data(), column.width_, missing,
+                                                                   column.missingValue_, column.hasMissingValue_));
         }
 
-        // Given identical sorted keys, we use the order that rows are appended
+        if (output_.output(row)) {
+            return true;
+        }
+    }
 
-        std::queue<Expressions>& rows = it->second;
-        ASSERT(rows.size() >= 1);
-        bool success = output_.output(rows.front());
+    return false;
+}
 
-        // Remove entries that have been output
+/// The key is built from each of the ORDER BY values in turn, such that a bytewise comparison of two keys
+/// gives the same ordering as comparing the values (see OrderByExpressions):
+///
+///  - A byte that is 0 for a missing value, and 1 otherwise. Missing values sort first.
+///  - Numbers as the bits of the double, big endian, with the sign bit flipped for positive values, and
+///    all the bits flipped for negative ones.
+///  - Strings, trimmed of white space, with any zero byte escaped as 0x00 0xff, and terminated by 0x00 0x00.
+///
+/// For descending order all of the bytes of that value are inverted.
+
+void SQLOrderOutput::encodeKey(const Expressions& results) {
+
+    key_.clear();
+
+    for (size_t i = 0; i < by_.first.size(); ++i) {
+
+        const SQLExpression& e(byIndices_[i] ? *results[byIndices_[i] - 1] : *by_.first[i]);
+        size_t start = key_.size();
+        bool missing = false;
+
+        if (e.type()->getKind() == type::SQLType::stringType) {
+            std::string value(e.evalAsString(missing));
+            key_.push_back(missing ? 0 : 1);
+            if (!missing) {
+                for (char c : StringTools::trim(value, "\t\n\v\f\r ")) {
+                    key_.push_back(c);
+                    if (c == 0) {
+                        key_.push_back(static_cast<char>(0xff));
+                    }
+                }
+                key_.push_back(0);
+                key_.push_back(0);
+            }
+        }
+        else {
+            double value = e.eval(missing);
+            key_.push_back(missing ? 0 : 1);
+            if (!missing) {
+                if (value == 0) {
+                    value = 0;  // n.b. -0.0 == 0.0
+                }
+                uint64_t bits;
+                ::memcpy(&bits, &value, sizeof(bits));
+                bits = (bits >> 63) ? ~bits : (bits | (uint64_t(1) << 63));
+                for (int shift = 56; shift >= 0; shift -= 8) {
+                    key_.push_back(static_cast<char>((bits >> shift) & 0xff));
+                }
+            }
+        }
 
-        rows.pop();
-        if (rows.empty()) {
-            sortedResults_.erase(it);
+        if (!by_.second[i]) {
+            for (size_t j = start; j < key_.size(); ++j) {
+                key_[j] = ~key_[j];
+            }
         }
+    }
+}
 
-        if (success) {
-            return true;
+/// The row is stored as the index of its layout, then for each column a missing flag and the value(s)
+
+void SQLOrderOutput::encodeRow(const Expressions& results) {
+
+    auto matches = [&results](const std::vector<Column>& columns) {
+        if (columns.size() != results.size()) {
+            return false;
         }
+        for (size_t i = 0; i < columns.size(); ++i) {
+            double missingValue = results[i]->missingValue();
+            if (columns[i].type_ != results[i]->type() || columns[i].hasMissingValue_ != results[i]->hasMissingValue()
+                || ::memcmp(&columns[i].missingValue_, &missingValue, sizeof(double)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // The layout is normally the same as that of the previous row
+
+    if (layouts_.empty() || !matches(layouts_[layout_])) {
+        auto it = std::find_if(layouts_.begin(), layouts_.end(), matches);
+        if (it == layouts_.end()) {
+            std::vector<Column> columns;
+            for (const auto& r : results) {
+                Column column;
+                column.type_            = r->type();
+                column.missingValue_    = r->missingValue();
+                column.hasMissingValue_ = r->hasMissingValue();
+                column.width_           = std::max<size_t>(1, column.type_->size() / sizeof(double));
+                values_.resize(std::max(values_.size(), column.width_));
+                columns.emplace_back(column);
+            }
+            it = layouts_.insert(layouts_.end(), columns);
+        }
+        layout_ = it - layouts_.begin();
+    }
+
+    const std::vector<Column>& columns(layouts_[layout_]);
+
+    payload_.clear();
+    uint32_t layout = layout_;
+    payload_.append(reinterpret_cast<const char*>(&layout), sizeof(layout));
+
+    for (size_t i = 0; i < columns.size(); ++i) {
+        bool missing = false;
+        std::fill(values_.begin(), values_.begin() + columns[i].width_, 0);
+        results[i]->eval(values_.data(), missing);
+        payload_.push_back(missing ? 1 : 0);
+        payload_.append(reinterpret_cast<const char*>(values_.data()), columns[i].width_ * sizeof(double));
     }
 }
 
 bool SQLOrderOutput::output(const Expressions& results) {
-    OrderByExpressions byValues(by_.second);
-    Expressions& byExpressions(by_.first);
-    for (size_t i = 0; i < byExpressions.size(); ++i) {
-        byValues.push_back(
-            std::make_shared<SQLExpressionEvaluated>(byIndices_[i] ? *results[byIndices_[i] - 1] : *byExpressions[i]));
-    }
 
-    Expressions resultValues;
-    for (size_t i = 0; i < results.size(); ++i) {
-        resultValues.push_back(std::make_shared<SQLExpressionEvaluated>(*results[i]));
+    if (!sorter_) {
+        size_t memory  = Resource<size_t>("$ECKIT_SQL_SORT_MEMORY;eckitSQLSortMemory", 512 * 1024 * 1024);
+        size_t threads = Resource<size_t>("$ECKIT_SQL_THREADS;eckitSQLThreads", 1);
+        sorter_.reset(new SQLSorter(memory, threads, limit_));
     }
 
-    sortedResults_[byValues].push(resultValues);
+    encodeKey(results);
+    encodeRow(results);
+    sorter_->add(key_.data(), key_.size(), payload_.data(), payload_.size());
     return false;
 }
 
@@ -16,39 +16,73 @@
 #ifndef eckit_sql_SQLOrderOutput_H
 #define eckit_sql_SQLOrderOutput_H
 
-#include <queue>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "eckit/sql/SQLOutput.h"
-#include "eckit/sql/expression/OrderByExpressions.h"
 #include "eckit/sql/expression/SQLExpressions.h"
 
 namespace eckit::sql {
 
+class SQLSorter;
+
+namespace type {
+class SQLType;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Buffers the rows of a select, and outputs them in the order of the ORDER BY expressions.
+///
+/// Each row is stored as raw values, together with a normalised binary key (see encodeKey) that sorts
+/// in the order given by the ORDER BY clause when compared bytewise. Sorting, and spilling to disk
+/// once the memory budget (eckitSQLSortMemory) is exceeded, is done by an SQLSorter. If a LIMIT is
+/// given only that many rows are retained.
+
 class SQLOrderOutput : public SQLOutput {
 public:
-    SQLOrderOutput(SQLOutput& output, const std::pair<expression::Expressions, std::vector<bool>>& by);
+    SQLOrderOutput(SQLOutput& output, const std::pair<expression::Expressions, std::vector<bool>>& by,
+                   size_t limit = 0);
     ~SQLOrderOutput() override;
 
 private:  // methods
     void print(std::ostream&) const override;
 
+    void encodeKey(const expression::Expressions&);
+    void encodeRow(const expression::Expressions&);
+
     // -- Members
 
     SQLOutput& output_;
     std::pair<expression::Expressions, std::vector<bool>> by_;
+    size_t limit_;
 
-    typedef std::map<expression::OrderByExpressions, std::queue<Expressions>> SortedResults;
-
-    SortedResults sortedResults_;
     std::vector<size_t> byIndices_;
 
+    /// How the values of a column are stored. This may change while the rows are read.
+    struct Column {
+        const type::SQLType* type_;
+        double missingValue_;
+        bool hasMissingValue_;
+        size_t width_;  // in doubles
+    };
+
+    std::vector<std::vector<Column>> layouts_;
+    size_t layout_;  // of the last row
+
+    std::unique_ptr<SQLSorter> sorter_;
+    bool sorted_;
+
+    std::string key_;
+    std::string payload_;
+    std::vector<double> values_;
+
     // -- Overridden methods
     void reset() override;
     void flush() override;
 
-    /// OrderBy builds a std::map of sorted results. Now we start outputting them.
+    /// OrderBy buffers all of the results. Now we start outputting them, in order.
     bool cachedNext() override;
 
     bool output(const expression::Expressions&) override;
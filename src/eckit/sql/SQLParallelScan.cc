@@ -0,0 +1,294 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLParallelScan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/container/Queue.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/sql/SQLAggregator.h"
+#include "eckit/sql/SQLBatch.h"
+#include "eckit/sql/SQLFilter.h"
+#include "eckit/sql/SelectOneTable.h"
+#include "eckit/thread/ThreadPool.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Batches queued per range, ahead of the consumer
+static const size_t depth = 4;
+
+class SQLParallelScan::Task : public ThreadPoolTask {
+public:
+    Task(SQLParallelScan& owner, Range& range) :
+        owner_(owner), range_(range) {}
+
+private:
+    void execute() override {
+        if (!owner_.cancelled_) {
+            owner_.scan(range_);
+        }
+    }
+
+    SQLParallelScan& owner_;
+    Range& range_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLParallelScan::Metadata::Metadata(const SQLTableIterator& cursor) :
+    offsets_(cursor.columnOffsets()),
+    doublesSizes_(cursor.doublesDataSizes()),
+    hasMissing_(cursor.columnsHaveMissing()),
+    missingValues_(cursor.missingValues()) {}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLParallelScan::SQLParallelScan(const SelectOneTable& table, const std::vector<SQLTableRange>& ranges,
+                                 size_t threads, size_t batchSize, MetadataUpdateCallback metadataUpdateCallback,
+                                 SQLAggregator* aggregator, const expression::Expressions& columns) :
+    table_(table),
+    ranges_(ranges.size()),
+    threads_(std::max<size_t>(threads, 1)),
+    batchSize_(std::max<size_t>(batchSize, 1)),
+    metadataUpdateCallback_(metadataUpdateCallback),
+    filter_(canFilter(table)),
+    aggregator_(aggregator),
+    columns_(columns),
+    cancelled_(false),
+    current_(0),
+    skipped_(0) {
+
+    ASSERT(!aggregator_ || (filter_ && aggregator_->vectorised()));
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        ranges_[i].range_   = ranges[i];
+        ranges_[i].chunks_.reset(new Queue<Chunk>(depth));
+        ranges_[i].skipped_ = 0;
+        if (aggregator_) {
+            ranges_[i].aggregator_.reset(new SQLAggregator(columns_));
+        }
+        if (filter_) {
+            ranges_[i].filter_.reset(new SQLFilter(table_.check_));
+        }
+    }
+
+    // The ranges are taken by the threads in order, so the range being handed over is always being read
+
+    pool_.reset(new ThreadPool("sql-scan", std::min(threads_, ranges_.size())));
+    for (auto& range : ranges_) {
+        pool_->push(new Task(*this, range));
+    }
+}
+
+SQLParallelScan::~SQLParallelScan() {
+
+    // Release the threads blocked on full queues, and skip the ranges not yet started
+
+    cancelled_ = true;
+    for (auto& range : ranges_) {
+        range.chunks_->interrupt(std::make_exception_ptr(QueueInterruptedError("scan cancelled", Here())));
+    }
+    pool_.reset();
+}
+
+bool SQLParallelScan::canFilter(const SelectOneTable& table) {
+    for (const auto& check : table.check_) {
+        if (!check->isVectorised()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SQLParallelScan::scan(Range& range) {
+
+    // n.b. runs on one of the threads of the pool. Only the range, and objects created here, may be
+    //      modified.
+
+    try {
+        std::shared_lock<std::shared_mutex> lock(layout_);
+
+        bool changed = true;
+        std::unique_ptr<SQLTableIterator> cursor(table_.table_->rangeIterator(
+            table_.fetch_, [&changed](SQLTableIterator&) { changed = true; }, range.range_));
+        if (!table_.predicates_.empty()) {
+            cursor->pushDown(table_.predicates_);
+        }
+        cursor->rewind();
+
+        size_t columns = table_.fetch_.size();
+        std::vector<const double*> row(columns);
+        std::vector<uint8_t> rowMissing(columns);
+
+        std::shared_ptr<const Metadata> metadata;
+        // The consumer writes the value lookups while the batches are filled
+        std::unique_ptr<SQLBatch> batch(new SQLBatch(batchSize_, table_.fetch_, table_.values_, false));
+        std::vector<uint8_t> selected(batchSize_);
+        std::vector<Chunk> chunks;
+
+        bool more = true;
+        while (more && !cancelled_) {
+
+            // Fill and process one batch under the lock, then hand it over without the lock, as the
+            // queue may be full until the consumer (which may need the lock) takes from it
+
+            more = cursor->next();
+            while (more) {
+
+                // A batch only ever holds rows with the same layout
+
+                if (changed) {
+                    if (!batch->empty()) {
+                        flush(range, batch, metadata, selected, chunks);
+                    }
+                    metadata = std::make_shared<const Metadata>(*cursor);
+                    changed  = false;
+                }
+
+                const double* data = cursor->data();
+                for (size_t i = 0; i < columns; ++i) {
+                    row[i]        = data + metadata->offsets_[i];
+                    rowMissing[i] = metadata->hasMissing_[i]
+                                    && ::memcmp(row[i], &metadata->missingValues_[i], sizeof(double)) == 0;
+                }
+
+                batch->append(row.data(), metadata->doublesSizes_.data(), rowMissing.data());
+
+                if (batch->full()) {
+                    flush(range, batch, metadata, selected, chunks);
+                    break;
+                }
+
+                more = cursor->next();
+            }
+
+            if (!more && !batch->empty()) {
+                flush(range, batch, metadata, selected, chunks);
+            }
+
+            lock.unlock();
+            for (auto& chunk : chunks) {
+                range.chunks_->emplace(std::move(chunk));
+            }
+            chunks.clear();
+            lock.lock();
+        }
+    }
+    catch (...) {
+        if (cancelled_) {
+            return;
+        }
+        range.error_ = std::current_exception();
+    }
+
+    range.chunks_->close();
+}
+
+void SQLParallelScan::flush(Range& range, std::unique_ptr<SQLBatch>& batch,
+                            const std::shared_ptr<const Metadata>& metadata, std::vector<uint8_t>& selected,
+                            std::vector<Chunk>& chunks) {
+
+    size_t n = batch->size();
+    std::fill(selected.begin(), selected.begin() + n, 1);
+
+    if (range.filter_) {
+        range.filter_->select(*batch, selected.data());
+    }
+
+    size_t count = std::count(selected.begin(), selected.begin() + n, 1);
+    range.skipped_ += n - count;
+
+    if (range.aggregator_) {
+        range.aggregator_->update(*batch, selected.data());
+        batch->truncate();
+        return;
+    }
+
+    Chunk chunk;
+    chunk.metadata_ = metadata;
+
+    if (count == n) {
+        chunk.batch_ = std::move(batch);
+        batch.reset(new SQLBatch(batchSize_, table_.fetch_, table_.values_, false));
+    }
+    else if (count > 0) {
+        chunk.batch_.reset(new SQLBatch(count, table_.fetch_, table_.values_, false));
+        for (size_t i = 0; i < n; ++i) {
+            if (selected[i]) {
+                chunk.batch_->append(*batch, i);
+            }
+        }
+        batch->truncate();
+    }
+    else {
+        batch->truncate();
+        return;
+    }
+
+    chunk.selected_.assign(count, 1);
+    chunks.emplace_back(std::move(chunk));
+}
+
+bool SQLParallelScan::next(std::unique_ptr<SQLBatch>& batch, std::vector<uint8_t>& selected) {
+
+    while (current_ < ranges_.size()) {
+        Range& range(ranges_[current_]);
+
+        Chunk chunk;
+        if (range.chunks_->pop(chunk) >= 0) {
+            if (chunk.metadata_ != metadata_) {
+                std::unique_lock<std::shared_mutex> lock(layout_);
+                metadata_ = chunk.metadata_;
+                metadataUpdateCallback_(*metadata_);
+            }
+            batch = std::move(chunk.batch_);
+            selected.swap(chunk.selected_);
+            return true;
+        }
+
+        // This range is done with (n.b. closing the queue publishes the results of its thread)
+
+        if (range.error_) {
+            std::rethrow_exception(range.error_);
+        }
+
+        if (range.aggregator_) {
+            aggregator_->merge(*range.aggregator_);
+            range.aggregator_.reset();
+        }
+
+        skipped_ += range.skipped_;
+        ++current_;
+    }
+
+    return false;
+}
+
+unsigned long long SQLParallelScan::skipped() {
+    unsigned long long n = skipped_;
+    skipped_             = 0;
+    return n;
+}
+
+void SQLParallelScan::print(std::ostream& s) const {
+    s << "PARALLEL SCAN " << table_.table_->fullName() << " (" << ranges_.size() << " ranges on " << threads_
+      << " threads, batches of " << batchSize_ << " rows)";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,150 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLParallelScan_H
+#define eckit_sql_SQLParallelScan_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/SQLTable.h"
+#include "eckit/sql/expression/SQLExpressions.h"
+
+namespace eckit {
+class ThreadPool;
+template <typename ELEM>
+class Queue;
+}  // namespace eckit
+
+namespace eckit::sql {
+
+class SQLAggregator;
+class SQLBatch;
+class SQLFilter;
+struct SelectOneTable;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Reads a single table, split into ranges (see SQLTable::scanRanges), on a pool of threads.
+///
+/// Each range is read through its own iterator into batches. If the checks on the table are all
+/// vectorised (see SQLExpression::isVectorised) they are applied by the thread reading the range, and
+/// only the matching rows kept. If the select is aggregated, and the aggregation can be done over
+/// batches (see SQLAggregator::vectorised), each range is aggregated on its thread as well, and the
+/// partial results merged into the select's aggregator.
+///
+/// The rows are handed back in the order of the ranges, so the results are the same as those of a
+/// sequential scan. Each range is streamed through a queue a few batches deep, so that the consumer
+/// drains a range while the following ones are still being read, and only those few batches per thread
+/// are held in memory.
+///
+/// n.b. the column types are updated (by the metadata callback) when the layout of an iterator changes,
+///      and the threads read them when checking and aggregating. The threads therefore hold a shared
+///      lock while they fill and process a batch, and the callback is only called under an exclusive
+///      lock.
+
+class SQLParallelScan : private eckit::NonCopyable {
+public:  // types
+    /// The layout of the rows returned by an iterator
+    struct Metadata {
+        explicit Metadata(const SQLTableIterator&);
+
+        std::vector<size_t> offsets_;
+        std::vector<size_t> doublesSizes_;
+        std::vector<char> hasMissing_;
+        std::vector<double> missingValues_;
+    };
+
+    typedef std::function<void(const Metadata&)> MetadataUpdateCallback;
+
+public:  // methods
+    /// n.b. If aggregator is given, rows are aggregated (into it) rather than returned
+    SQLParallelScan(const SelectOneTable& table, const std::vector<SQLTableRange>& ranges, size_t threads,
+                    size_t batchSize, MetadataUpdateCallback metadataUpdateCallback,
+                    SQLAggregator* aggregator = nullptr, const expression::Expressions& columns = {});
+    ~SQLParallelScan();
+
+    /// Can the checks on the table be applied by the scanning threads?
+    static bool canFilter(const SelectOneTable& table);
+
+    /// Hand over the next batch of rows, in range order, and which of them pass the checks. The metadata
+    /// callback is called beforehand if the layout of the rows has changed. Returns false at the end.
+    bool next(std::unique_ptr<SQLBatch>& batch, std::vector<uint8_t>& selected);
+
+    /// Rows that were read, but did not pass the checks, since the last call
+    unsigned long long skipped();
+
+    bool filtering() const { return filter_; }
+    bool aggregating() const { return aggregator_ != nullptr; }
+
+    void print(std::ostream&) const;
+
+private:  // types
+    struct Chunk {
+        std::unique_ptr<SQLBatch> batch_;
+        std::vector<uint8_t> selected_;
+        std::shared_ptr<const Metadata> metadata_;
+    };
+
+    struct Range {
+        SQLTableRange range_;
+        std::unique_ptr<Queue<Chunk>> chunks_;  // closed when the range has been read
+        std::unique_ptr<SQLAggregator> aggregator_;
+        std::unique_ptr<SQLFilter> filter_;  // the checks, compiled for this range's thread
+        unsigned long long skipped_;
+        std::exception_ptr error_;
+    };
+
+    class Task;
+
+private:  // methods
+    void scan(Range& range);
+    void flush(Range& range, std::unique_ptr<SQLBatch>& batch, const std::shared_ptr<const Metadata>& metadata,
+               std::vector<uint8_t>& selected, std::vector<Chunk>& chunks);
+
+    friend std::ostream& operator<<(std::ostream& s, const SQLParallelScan& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    const SelectOneTable& table_;
+    std::vector<Range> ranges_;
+    size_t threads_;
+    size_t batchSize_;
+    MetadataUpdateCallback metadataUpdateCallback_;
+
+    bool filter_;
+    SQLAggregator* aggregator_;
+    expression::Expressions columns_;
+
+    std::unique_ptr<ThreadPool> pool_;
+    std::shared_mutex layout_;     // see above
+    std::atomic<bool> cancelled_;  // stop reading, the scan is being destroyed
+
+    size_t current_;  // range being handed over
+    std::shared_ptr<const Metadata> metadata_;  // as last passed to the callback
+    unsigned long long skipped_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLParameters.h"
+
+#include <cstring>
+#include <ostream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/type/SQLType.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SQLParameters::bindInteger(int which, long value) {
+    values_[which] = Value{&type::SQLType::lookup("integer"), {double(value)}, std::string()};
+}
+
+void SQLParameters::bindReal(int which, double value) {
+    values_[which] = Value{&type::SQLType::lookup("real"), {value}, std::string()};
+}
+
+void SQLParameters::bindString(int which, const std::string& value) {
+
+    size_t doubles = value.empty() ? 1 : (value.size() + sizeof(double) - 1) / sizeof(double);
+
+    Value& v(values_[which]);
+    v.type_   = &type::SQLType::lookup("string", doubles);
+    v.string_ = value;
+    v.value_.assign(doubles, 0);
+    ::memcpy(v.value_.data(), value.data(), value.size());
+}
+
+const SQLParameters::Value& SQLParameters::value(int which) const {
+    auto v = values_.find(which);
+    if (v == values_.end()) {
+        throw UserError("No value bound to SQL parameter ?" + std::to_string(which));
+    }
+    return v->second;
+}
+
+void SQLParameters::print(std::ostream& s) const {
+    const char* sep = "";
+    for (const auto& v : values_) {
+        s << sep << '?' << v.first << '=';
+        if (v.second.type_->getKind() == type::SQLType::stringType) {
+            s << "'" << v.second.string_ << "'";
+        }
+        else {
+            s << v.second.value_[0];
+        }
+        sep = ", ";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
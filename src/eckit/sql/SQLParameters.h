@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLParameters_H
+#define eckit_sql_SQLParameters_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace eckit::sql {
+
+namespace type {
+class SQLType;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The values bound to the parameters of a statement (?1, ?2...), with their types. Strings are held packed
+/// into doubles, as they are in the columns of tables.
+
+class SQLParameters {
+public:  // types
+    struct Value {
+        const type::SQLType* type_;
+        std::vector<double> value_;
+        std::string string_;  // of a string
+    };
+
+public:  // methods
+    void bindInteger(int which, long value);
+    void bindReal(int which, double value);
+    void bindString(int which, const std::string& value);
+
+    void clear() { values_.clear(); }
+    bool empty() const { return values_.empty(); }
+
+    /// Throws a UserError if no value is bound to the parameter
+    const Value& value(int which) const;
+
+    void print(std::ostream&) const;
+
+private:  // members
+    std::map<int, Value> values_;
+
+    friend std::ostream& operator<<(std::ostream& s, const SQLParameters& p) {
+        p.print(s);
+        return s;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
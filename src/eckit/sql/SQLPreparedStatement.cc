@@ -0,0 +1,87 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLPreparedStatement.h"
+
+#include <ostream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLSelect.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLPlan::SQLPlan(const std::string& sql, std::unique_ptr<SQLStatement> statement) :
+    sql_(sql), executions_(0), executing_(false) {
+
+    if (!dynamic_cast<SQLSelect*>(statement.get())) {
+        throw UserError("Only SELECT statements can be prepared", sql);
+    }
+
+    statement_.reset(static_cast<SQLSelect*>(statement.release()));
+}
+
+SQLPlan::~SQLPlan() {}
+
+unsigned long long SQLPlan::execute(const SQLParameters& parameters) {
+
+    // The mutex is recursive, so a nested execution by the same thread is caught by the flag
+
+    AutoLock<Mutex> lock(mutex_);
+    if (executing_) {
+        throw UserError("A prepared statement cannot be executed while another sharing its plan is executing", sql_);
+    }
+
+    // The parameters are only attached for the duration of the execution
+
+    executing_ = true;
+    statement_->parameters(&parameters);
+    try {
+        unsigned long long n = statement_->execute();
+        statement_->parameters(nullptr);
+        executing_ = false;
+        ++executions_;
+        return n;
+    }
+    catch (...) {
+        statement_->parameters(nullptr);
+        executing_ = false;
+        throw;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLPreparedStatement::SQLPreparedStatement(std::shared_ptr<SQLPlan> plan) :
+    plan_(plan), executions_(0) {
+    ASSERT(plan_);
+}
+
+SQLPreparedStatement::~SQLPreparedStatement() {}
+
+unsigned long long SQLPreparedStatement::execute() {
+    unsigned long long n = plan_->execute(parameters_);
+    ++executions_;
+    return n;
+}
+
+void SQLPreparedStatement::print(std::ostream& s) const {
+    s << "SQLPreparedStatement[" << sql();
+    if (!parameters_.empty()) {
+        s << ", " << parameters_;
+    }
+    s << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLPreparedStatement_H
+#define eckit_sql_SQLPreparedStatement_H
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/sql/SQLParameters.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit::sql {
+
+class SQLSelect;
+class SQLStatement;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A SELECT statement as parsed, cached by the session (see SQLSession::prepare) and shared by all the
+/// statements prepared from the same SQL. The tables and expressions are resolved when the statement is
+/// parsed. Nothing else is kept from one execution to the next: each one starts again from the statement as
+/// parsed, with the values bound by the statement being executed.
+///
+/// As the parsed statement holds the state of the execution, the executions of a plan do not overlap: those from
+/// other threads wait, and executing a statement from within the execution of another sharing the plan (e.g. from
+/// its output) throws a UserError.
+
+class SQLPlan : private eckit::NonCopyable {
+public:  // methods
+    SQLPlan(const std::string& sql, std::unique_ptr<SQLStatement> statement);
+    ~SQLPlan();
+
+    const std::string& sql() const { return sql_; }
+    const SQLSelect& statement() const { return *statement_; }
+
+    /// By all the statements sharing the plan
+    size_t executions() const { return executions_; }
+
+private:  // methods
+    unsigned long long execute(const SQLParameters& parameters);
+
+private:  // members
+    std::string sql_;
+    std::unique_ptr<SQLSelect> statement_;
+    size_t executions_;
+
+    Mutex mutex_;
+    bool executing_;
+
+    friend class SQLPreparedStatement;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A SELECT statement parsed once, to be executed repeatedly, with different values bound to its parameters
+/// (?1, ?2...) each time. Each execution only prepares the scan for the values bound (predicates pushed down
+/// to the tables, compiled WHERE clauses, ...).
+///
+/// Each call to SQLSession::prepare returns a new statement, with its own parameters, so that the values
+/// bound by one user are never seen by another preparing the same SQL. The values bound are kept from one
+/// execution to the next, until they are rebound or cleared.
+
+class SQLPreparedStatement : private eckit::NonCopyable {
+public:  // methods
+    explicit SQLPreparedStatement(std::shared_ptr<SQLPlan> plan);
+    ~SQLPreparedStatement();
+
+    void bindInteger(int which, long value) { parameters_.bindInteger(which, value); }
+    void bindReal(int which, double value) { parameters_.bindReal(which, value); }
+    void bindString(int which, const std::string& value) { parameters_.bindString(which, value); }
+    void clearBindings() { parameters_.clear(); }
+
+    unsigned long long execute();
+
+    const std::string& sql() const { return plan_->sql(); }
+    const SQLPlan& plan() const { return *plan_; }
+    size_t executions() const { return executions_; }
+
+    void print(std::ostream&) const;
+
+private:  // members
+    std::shared_ptr<SQLPlan> plan_;
+    SQLParameters parameters_;
+    size_t executions_;
+
+    friend std::ostream& operator<<(std::ostream& s, const SQLPreparedStatement& p) {
+        p.print(s);
+        return s;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
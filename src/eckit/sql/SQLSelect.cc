@@ -11,19 +11,32 @@
 #include "eckit/sql/SQLSelect.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <typeinfo>
 
 #include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
 #include "eckit/log/BigNum.h"
 #include "eckit/log/Log.h"
+#include "eckit/log/Tracer.h"
+#include "eckit/sql/SQLAggregator.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/SQLColumn.h"
 #include "eckit/sql/SQLDatabase.h"
+#include "eckit/sql/SQLFilter.h"
+#include "eckit/sql/SQLJoin.h"
 #include "eckit/sql/SQLOutput.h"
+#include "eckit/sql/SQLParallelScan.h"
 #include "eckit/sql/SQLTable.h"
 #include "eckit/sql/expression/ColumnExpression.h"
 #include "eckit/sql/expression/ConstantExpression.h"
 #include "eckit/sql/expression/OrderByExpressions.h"
-#include "eckit/sql/expression/SQLExpressionEvaluated.h"
+#include "eckit/sql/expression/ParameterExpression.h"
 #include "eckit/sql/expression/SQLExpressions.h"
+#include "eckit/sql/expression/function/FunctionEQ.h"
+#include "eckit/sql/expression/function/FunctionJOIN.h"
 
 namespace eckit::sql {
 
@@ -37,15 +50,19 @@ SQLSelect::SQLSelect(const Expressions& columns, const std::vector<std::referenc
     select_(columns),
     where_(where),
     simplifiedWhere_(0),
+    rowsStarted_(false),
+    rowsExhausted_(false),
     ownedOutputs_(std::move(ownedOutputs)),
     output_(output),
-    aggregatedResultsIterator_(aggregatedResults_.end()),
+    aggregatedResultsIndex_(0),
     count_(0),
     total_(0),
     skips_(0),
+    batchRow_(0),
     aggregate_(false),
     mixedAggregatedAndScalar_(false),
-    doOutputCached_(false) {
+    doOutputCached_(false),
+    parameters_(nullptr) {
     // TODO: Convert tables_, allTables_ to use references rather than pointers.
     for (const SQLTable& t : tables) {
         tables_.push_back(&t);
@@ -54,6 +71,13 @@ SQLSelect::SQLSelect(const Expressions& columns, const std::vector<std::referenc
 
 SQLSelect::~SQLSelect() {}
 
+const SQLParameters& SQLSelect::parameters() const {
+    if (!parameters_) {
+        throw eckit::UserError("SQL parameters (?1, ?2...) can only be used in prepared statements");
+    }
+    return *parameters_;
+}
+
 
 const SQLTable& SQLSelect::findTable(const std::string& name) const {
 
@@ -135,6 +159,151 @@ static bool compareTables(SelectOneTable* a, SelectOneTable* b) {
     // #endif
 }
 
+static bool isEquiJoin(const std::shared_ptr<SQLExpression>& e, const SQLTable* inner,
+                       const std::set<const SQLTable*>& outer, std::shared_ptr<SQLExpression>& innerKey,
+                       std::shared_ptr<SQLExpression>& outerKey) {
+
+    // Is this a condition of the form f(inner) = g(outer), where the (numerical) values can be compared
+    // directly, and do not depend on the order in which rows are read?
+
+    Expressions* args = nullptr;
+    if (auto* join = dynamic_cast<function::FunctionJOIN*>(e.get())) {
+        args = &join->args();
+    }
+    else if (auto* eq = dynamic_cast<function::FunctionEQ*>(e.get())) {
+        args = &eq->args();
+        for (const auto& arg : *args) {
+            if (arg->type()->getKind() == type::SQLType::stringType) {
+                return false;
+            }
+        }
+    }
+
+    if (!args || args->size() != 2 || !(*args)[0]->isBatchable() || !(*args)[1]->isBatchable()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+        std::set<const SQLTable*> t1;
+        std::set<const SQLTable*> t2;
+        (*args)[i]->tables(t1);
+        (*args)[1 - i]->tables(t2);
+
+        if (t1.size() == 1 && *t1.begin() == inner && !t2.empty() && t2.find(inner) == t2.end()
+            && std::includes(outer.begin(), outer.end(), t2.begin(), t2.end())) {
+            innerKey = (*args)[i];
+            outerKey = (*args)[1 - i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static size_t pushableColumn(const std::shared_ptr<SQLExpression>& e, const SelectOneTable& table) {
+
+    // Is this one of the (numeric) columns fetched from the table, as such?
+
+    auto* column = dynamic_cast<ColumnExpression*>(e.get());
+    if (!column || typeid(*column) != typeid(ColumnExpression) || e->type()->getKind() == type::SQLType::stringType
+        || e->type()->size() != sizeof(double)) {
+        return table.values_.size();
+    }
+
+    auto v = std::find(table.values_.begin(), table.values_.end(), column->valueLookup());
+    return std::distance(table.values_.begin(), v);
+}
+
+static bool pushableConstant(const std::shared_ptr<SQLExpression>& e, double& value) {
+    // Parameters do not change during an execution
+    bool constant = e->isConstant() || dynamic_cast<const expression::ParameterExpression*>(e.get());
+    if (!constant || e->type()->getKind() == type::SQLType::stringType) {
+        return false;
+    }
+    bool missing = false;
+    value        = e->eval(missing);
+    return !missing && !std::isnan(value);
+}
+
+static bool isPushablePredicate(const std::shared_ptr<SQLExpression>& e, const SelectOneTable& table,
+                                SQLPredicate& predicate) {
+
+    // Is this a comparison of a column of the table with constants, which an iterator can check on its own?
+
+    auto* f = dynamic_cast<function::FunctionExpression*>(e.get());
+    if (!f) {
+        return false;
+    }
+
+    const double inf = std::numeric_limits<double>::infinity();
+    Expressions& args(f->args());
+    std::string name(f->name());
+
+    if (args.size() == 3) {
+        static const std::map<std::string, std::pair<bool, bool>> between{{"between", {true, true}},
+                                                                          {"between_exclude_first", {false, true}},
+                                                                          {"between_exclude_second", {true, false}},
+                                                                          {"between_exclude_both", {false, false}}};
+        auto b = between.find(name);
+        if (b == between.end()) {
+            return false;
+        }
+        predicate.column_         = pushableColumn(args[0], table);
+        predicate.lowerInclusive_ = b->second.first;
+        predicate.upperInclusive_ = b->second.second;
+        return predicate.column_ < table.values_.size() && pushableConstant(args[1], predicate.lower_)
+               && pushableConstant(args[2], predicate.upper_);
+    }
+
+    if (args.size() != 2) {
+        return false;
+    }
+
+    // Put the column on the left hand side
+
+    double value;
+    predicate.column_ = pushableColumn(args[0], table);
+    if (predicate.column_ < table.values_.size()) {
+        if (!pushableConstant(args[1], value)) {
+            return false;
+        }
+    }
+    else {
+        predicate.column_ = pushableColumn(args[1], table);
+        if (predicate.column_ == table.values_.size() || !pushableConstant(args[0], value)) {
+            return false;
+        }
+        static const std::map<std::string, std::string> mirrored{
+            {"=", "="}, {"<", ">"}, {"<=", ">="}, {">", "<"}, {">=", "<="}};
+        auto m = mirrored.find(name);
+        if (m == mirrored.end()) {
+            return false;
+        }
+        name = m->second;
+    }
+
+    predicate.lower_          = -inf;
+    predicate.upper_          = inf;
+    predicate.lowerInclusive_ = true;
+    predicate.upperInclusive_ = true;
+
+    if (name == "=" && dynamic_cast<function::FunctionEQ*>(f)) {
+        predicate.lower_ = predicate.upper_ = value;
+    }
+    else if (name == "<" || name == "<=") {
+        predicate.upper_          = value;
+        predicate.upperInclusive_ = (name == "<=");
+    }
+    else if (name == ">" || name == ">=") {
+        predicate.lower_          = value;
+        predicate.lowerInclusive_ = (name == ">=");
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
 inline bool SQLSelect::resultsOut() {
     return output_.output(select_);
 }
@@ -218,6 +387,7 @@ void SQLSelect::prepareExecute() {
 
         if (aggregated_.size() != select_.size()) {
             mixedAggregatedAndScalar_ = true;
+            aggregator_.reset(new SQLAggregator(select_));
             Log::debug<LibEcKit>() << "SELECT has aggregated and non-aggregated results" << std::endl;
         }
     }
@@ -338,6 +508,45 @@ void SQLSelect::prepareExecute() {
     }
 
     std::sort(sortedTables_.begin(), sortedTables_.end(), compareTables);
+
+    // Keep the cursors in the same order as the tables they iterate over
+
+    if (cursors_.size() == sortedTables_.size()) {
+        std::vector<std::unique_ptr<SQLTableIterator>> cursors;
+        for (const SelectOneTable* t : sortedTables_) {
+            size_t i = std::distance(tablesToFetch_.begin(), tablesToFetch_.find(t->table_));
+            ASSERT(i < cursors_.size() && cursors_[i]);
+            cursors.emplace_back(std::move(cursors_[i]));
+        }
+        std::swap(cursors, cursors_);
+
+        // Hand the simple conditions on each table down to its iterator, so that it can skip rows that
+        // cannot be selected. n.b. Not if anything depends on which rows are read (e.g. values of
+        // previous rows), nor for tables read through links (offsets and lengths count all the rows).
+
+        bool pushDown = !where || where->isBatchable();
+        for (const auto& e : select_) {
+            pushDown = pushDown && e->isBatchable();
+        }
+
+        for (size_t i = 0; pushDown && i < sortedTables_.size(); ++i) {
+            SelectOneTable& table(*sortedTables_[i]);
+            table.predicates_.clear();
+            if (table.column_) {
+                continue;
+            }
+            for (const auto& check : table.check_) {
+                SQLPredicate predicate;
+                if (isPushablePredicate(check, table, predicate)) {
+                    table.predicates_.push_back(predicate);
+                }
+            }
+            if (!table.predicates_.empty() && !cursors_[i]->pushDown(table.predicates_)) {
+                table.predicates_.clear();
+            }
+        }
+    }
+    joins_.resize(sortedTables_.size());
     Log::debug<LibEcKit>() << "TABLE order " << std::endl;
     for (SortedTables::iterator k = sortedTables_.begin(); k != sortedTables_.end(); ++k) {
         Log::debug<LibEcKit>() << (*k)->table_->fullName() << " " << (*k)->order_ << std::endl;
@@ -352,7 +561,12 @@ void SQLSelect::prepareExecute() {
     }
 
 
-    // Add the multi-table quick checks
+    // Add the multi-table quick checks.
+    //
+    // n.b. The first table is the innermost in the enumeration (it varies fastest, see nextRow()), so
+    //      a check is attached to the first table that it involves. At that point the rows of all of
+    //      the other tables that it depends on are already current. If that check is an equality
+    //      between this table and the outer ones, use it to join the tables rather than scanning.
     if (where) {
         expression::Expressions e;
         if (!where->andSplit(e)) {
@@ -360,8 +574,24 @@ void SQLSelect::prepareExecute() {
         }
 
         std::set<const SQLTable*> ordered;
-        for (SortedTables::iterator k = sortedTables_.begin(); k != sortedTables_.end(); ++k) {
-            const SQLTable* table = (*k)->table_;
+        for (size_t level = sortedTables_.size(); level-- > 0;) {
+            SelectOneTable* k     = sortedTables_[level];
+            const SQLTable* table = k->table_;
+
+            if (level + 1 < sortedTables_.size() && level < cursors_.size() && !k->column_) {
+                for (size_t i = 0; i < e.size(); ++i) {
+                    std::shared_ptr<SQLExpression> innerKey;
+                    std::shared_ptr<SQLExpression> outerKey;
+                    if (e[i] && isEquiJoin(e[i], table, ordered, innerKey, outerKey)) {
+                        Log::debug<LibEcKit>() << "WHERE join for " << table->fullName() << " " << (*e[i]) << std::endl;
+                        joins_[level].reset(new SQLJoin(*k, innerKey, outerKey, k->check_));
+                        k->check_.clear();
+                        e[i] = 0;
+                        break;
+                    }
+                }
+            }
+
             ordered.insert(table);
 
             for (size_t i = 0; i < e.size(); ++i) {
@@ -379,7 +609,7 @@ void SQLSelect::prepareExecute() {
                         }
 
                         if (ok) {
-                            (*k)->check_.push_back(e[i]);
+                            k->check_.push_back(e[i]);
                             Log::debug<LibEcKit>() << "WHERE multi-table quick check for " << table->fullName() << " " << (*e[i])
                                                    << std::endl;
 
@@ -393,10 +623,10 @@ void SQLSelect::prepareExecute() {
             }
         }
 
-        // Add what's left to last table
+        // Add what's left to the innermost table
         for (size_t i = 0; i < e.size(); ++i) {
             if (e[i]) {
-                sortedTables_.back()->check_.push_back(e[i]);
+                sortedTables_.front()->check_.push_back(e[i]);
             }
         }
         where = 0;
@@ -413,9 +643,93 @@ void SQLSelect::prepareExecute() {
             Log::debug<LibEcKit>() << "    QUICK CHECK " << *((*k)->check_[i]) << std::endl;
         }
     }
+
+    prepareBatch();
+
+    if (Log::debug<LibEcKit>()) {
+        Log::debug<LibEcKit>() << "SQLSelect: plan" << std::endl;
+        explain(Log::debug<LibEcKit>());
+    }
+}
+
+void SQLSelect::prepareBatch() {
+
+    // Rows are read and checked a batch at a time, if it is only one table that is being read,
+    // and the checks do not depend on the order in which the rows are processed.
+    // Otherwise (joins, links, etc.) fall back to row-at-a-time.
+    //
+    // If, further, the table can be split into ranges, and more than one thread is allowed, the
+    // ranges are read (and where possible checked and aggregated) in parallel.
+
+    batch_.reset();
+    filter_.reset();
+    scan_.reset();
+
+    size_t capacity = SQLBatch::defaultCapacity();
+    if (capacity == 0 || cursors_.size() != 1 || sortedTables_.size() != 1) {
+        return;
+    }
+
+    SelectOneTable& table(*sortedTables_[0]);
+    if (table.column_ || table.fetch_.empty()) {
+        return;
+    }
+
+    for (const auto& check : table.check_) {
+        if (!check->isBatchable()) {
+            Log::debug<LibEcKit>() << "SQLSelect: row-at-a-time execution, due to " << *check << std::endl;
+            return;
+        }
+    }
+
+    // n.b. ask for a few ranges per thread, so that the work is balanced between the threads even if
+    //      the rows of some ranges are slower to read or check
+
+    size_t threads = Resource<size_t>("$ECKIT_SQL_THREADS;eckitSQLThreads", 1);
+    std::vector<SQLTableRange> ranges;
+    if (threads > 1) {
+        ranges = table.table_->scanRanges(4 * threads);
+    }
+
+    if (ranges.size() > 1) {
+
+        SQLTable* sqlTable = const_cast<SQLTable*>(table.table_);
+        auto refresh       = [this, sqlTable](const SQLParallelScan::Metadata& m) {
+            refreshColumnMetadata(sqlTable, m.doublesSizes_, m.hasMissing_, m.missingValues_);
+        };
+
+        // Aggregate on the scanning threads, if possible. This needs an aggregator for plain
+        // aggregates (without any keys) as well.
+
+        SQLAggregator* aggregator = nullptr;
+        if (aggregate_ && SQLParallelScan::canFilter(table)) {
+            if (!aggregator_) {
+                aggregator_.reset(new SQLAggregator(select_));
+            }
+            if (aggregator_->vectorised()) {
+                aggregator = aggregator_.get();
+            }
+            else if (!mixedAggregatedAndScalar_) {
+                aggregator_.reset();
+            }
+        }
+
+        scan_.reset(new SQLParallelScan(table, ranges, threads, capacity, refresh, aggregator, select_));
+    }
+    else if (table.check_.empty()) {
+        return;
+    }
+
+    batch_.reset(new SQLBatch(capacity, table.fetch_, table.values_));
+    filter_.reset(new SQLFilter(table.check_));
+    batchSelected_.resize(capacity);
+    batchRow_ = 0;
+
+    Log::debug<LibEcKit>() << "SQLSelect: batched execution, " << capacity << " rows per batch" << std::endl;
 }
 
 unsigned long long SQLSelect::execute() {
+    ECKIT_TRACE_SPAN("SQLSelect::execute", "sql");
     prepareExecute();
     process();
     postExecute();
@@ -449,9 +763,6 @@ void SQLSelect::refreshCursorMetadata(SQLTable* table, SQLTableIterator& cursor)
 
     const double* data(cursor.data());
     const std::vector<size_t> offsets(cursor.columnOffsets());
-    const std::vector<size_t> doublesSizes(cursor.doublesDataSizes());
-    const std::vector<char> hasMissing(cursor.columnsHaveMissing());
-    const std::vector<double> missingValues(cursor.missingValues());
 
     for (size_t i = 0; i < tbl.fetch_.size(); i++) {
         std::string fullname(tbl.fetch_[i].get().fullName());
@@ -459,21 +770,37 @@ void SQLSelect::refreshCursorMetadata(SQLTable* table, SQLTableIterator& cursor)
         // ASSERT is no longer true if using to refresh values
         // ASSERT(values_.find(fullname) == values_.end());
 
+        // This will create the value if it does not exist.
+        std::pair<const double*, bool>& value(values_[fullname]);
+        value.first = &data[offsets[i]];
+    }
+
+    refreshColumnMetadata(table, cursor.doublesDataSizes(), cursor.columnsHaveMissing(), cursor.missingValues());
+}
+
+void SQLSelect::refreshColumnMetadata(SQLTable* table, const std::vector<size_t>& doublesSizes,
+                                      const std::vector<char>& hasMissing, const std::vector<double>& missingValues) {
+
+    auto it = tablesToFetch_.find(table);
+
+    ASSERT(it != tablesToFetch_.end());
+    SelectOneTable& tbl(it->second);
+
+    for (size_t i = 0; i < tbl.fetch_.size(); i++) {
+        std::string fullname(tbl.fetch_[i].get().fullName());
+
         // HACK ALERT
         // Our output functionality gets the width of strings from the column type.
         // but the width can change on refreshCursorMetadata
         // --> We need to update the column type.
         // This is a function of the table. Aaaarg. Makes this horribly not parallelisable.
         // eckit::sql needs a rewrite. Will enable us to work around this shit.
+        // (SQLParallelScan only calls this under an exclusive lock, when none of its threads is checking.)
         table->updateColumnDoublesWidth(fullname, doublesSizes[i]);
 
         // Aaaargh, we need to know when we are looking at missing values. But these can change
         // down the column. As can 'hasMissing'
         table->updateColumnMissingValues(fullname, hasMissing[i], missingValues[i]);
-
-        // This will create the value if it does not exist.
-        std::pair<const double*, bool>& value(values_[fullname]);
-        value.first = &data[offsets[i]];
     }
 
     for (Expressions::iterator c = select_.begin(); c != select_.end(); ++c) {
@@ -494,10 +821,20 @@ void SQLSelect::reset() {
 
     aggregated_.clear();
     nonAggregated_.clear();
-    aggregatedResults_.clear();
+    aggregator_.reset();
+    aggregatedResultsIndex_ = 0;
 
     mixedResultColumnIsAggregated_.clear();
 
+    scan_.reset();
+    batch_.reset();
+    filter_.reset();
+    batchRow_ = 0;
+
+    joins_.clear();
+    rowsStarted_   = false;
+    rowsExhausted_ = false;
+
     values_.clear();
 
     tablesToFetch_.clear();
@@ -538,23 +875,7 @@ bool SQLSelect::writeOutput() {
                 // For each set of non-aggregated values, keep track of the aggregated values
                 // n.b. newRow=false, as we are accumulating the values
 
-                OrderByExpressions nonAggregatedValues;
-                for (size_t i = 0; i < nonAggregated_.size(); ++i) {
-                    nonAggregatedValues.emplace_back(std::make_shared<SQLExpressionEvaluated>(*nonAggregated_[i]));
-                }
-
-                AggregatedResults::iterator results = aggregatedResults_.find(nonAggregatedValues);
-                if (results == aggregatedResults_.end()) {
-                    Expressions& aggregated = aggregatedResults_[nonAggregatedValues];
-                    for (const auto& expr : aggregated_) {
-                        aggregated.emplace_back(expr->clone());
-                    }
-                }
-
-                Expressions& aggregated = aggregatedResults_[nonAggregatedValues];
-                for (size_t i = 0; i < aggregated.size(); ++i) {
-                    aggregated[i]->partialResult();
-                }
+                aggregator_->update();
             }
         }
     }
@@ -575,6 +896,44 @@ unsigned long long SQLSelect::process() {
 }
 
 
+bool SQLSelect::fillBatch(size_t tableIndex) {
+
+    /// Read the next batch of rows, and evaluate the checks over all of them at once.
+
+    if (scan_) {
+        bool more = scan_->next(batch_, batchSelected_);
+
+        unsigned long long skipped = scan_->skipped();
+        skips_ += skipped;
+        total_ += skipped;
+
+        if (!more) {
+            batch_->truncate();
+            return false;
+        }
+
+        batchRow_ = 0;
+        if (scan_->filtering()) {
+            return true;
+        }
+    }
+    else {
+        batch_->clear();
+        while (!batch_->full() && cursors_[tableIndex]->next()) {
+            batch_->append();
+        }
+    }
+
+    SQLBatch& batch(*batch_);
+    size_t n  = batch.size();
+    batchRow_ = 0;
+
+    std::fill(batchSelected_.begin(), batchSelected_.begin() + n, 1);
+    filter_->select(batch, batchSelected_.data());
+
+    return n != 0;
+}
+
 bool SQLSelect::processNextTableRow(size_t tableIndex) {
 
     ASSERT(cursors_.size() > tableIndex);
@@ -586,6 +945,36 @@ bool SQLSelect::processNextTableRow(size_t tableIndex) {
 
     total_++;
 
+    if (tableIndex < joins_.size() && joins_[tableIndex]) {
+        while (joins_[tableIndex]->next()) {
+            if (checkRow(fetchTable)) {
+                return true;
+            }
+            skips_++;
+            total_++;
+        }
+
+        total_--;
+        return false;
+    }
+
+    if (batch_) {
+        do {
+            while (batchRow_ < batch_->size()) {
+                size_t row = batchRow_++;
+                if (batchSelected_[row]) {
+                    batch_->select(row);
+                    return true;
+                }
+                skips_++;
+                total_++;
+            }
+        } while (fillBatch(tableIndex));
+
+        total_--;
+        return false;
+    }
+
     while (cursors_[tableIndex]->next()) {
 
         // Extract the missing values
@@ -596,17 +985,7 @@ bool SQLSelect::processNextTableRow(size_t tableIndex) {
 
         // Test thereturned row against the validation conditions.
 
-        bool ok = true;
-
-        for (auto& check : fetchTable.check_) {
-            bool missing = false;
-            if (!check->eval(missing) || missing) {
-                ok = false;
-                break;
-            }
-        }
-
-        if (ok) {
+        if (checkRow(fetchTable)) {
             return true;
         }
 
@@ -621,6 +1000,55 @@ bool SQLSelect::processNextTableRow(size_t tableIndex) {
 }
 
 
+bool SQLSelect::checkRow(const SelectOneTable& table) {
+    for (auto& check : table.check_) {
+        bool missing = false;
+        if (!check->eval(missing) || missing) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void SQLSelect::rewindTable(size_t tableIndex) {
+    if (joins_[tableIndex]) {
+        joins_[tableIndex]->probe(*cursors_[tableIndex]);
+    }
+    else {
+        cursors_[tableIndex]->rewind();
+    }
+}
+
+
+bool SQLSelect::nextRow() {
+
+    // Enumerate all the valid combinations of rows across the tables. The first table varies
+    // fastest. Whenever a table advances, all of the tables inside it are restarted (either
+    // rewound, or looked up again for a join) in the context of the new row.
+
+    if (rowsExhausted_) {
+        return false;
+    }
+
+    size_t idx = rowsStarted_ ? 0 : cursors_.size() - 1;
+    rowsStarted_ = true;
+
+    for (;;) {
+        if (processNextTableRow(idx)) {
+            if (idx == 0) {
+                return true;
+            }
+            rewindTable(--idx);
+        }
+        else if (++idx == cursors_.size()) {
+            rowsExhausted_ = true;
+            return false;
+        }
+    }
+}
+
+
 bool SQLSelect::processOneRow() {
 
     // n.b. it is acceptable for fromTables.size() == 0, if the expressions
@@ -641,42 +1069,29 @@ bool SQLSelect::processOneRow() {
 
     // If this is the first retrieve, we need to initialise all tables
 
-    if (count_ == 0) {
-        for (size_t idx = 0; idx < cursors_.size(); idx++) {
-            if (!processNextTableRow(idx)) {
-                return false;  // If false, there is no data
+    if (count_ == 0 && !rowsStarted_) {
+        if (!nextRow()) {
+            // If false, there is no data. n.b. unless it has all been aggregated by the parallel scan
+            if (!scan_ || !scan_->aggregating() || aggregator_->size() == 0) {
+                return false;
             }
         }
-
-        if (writeOutput()) {
+        else if (writeOutput()) {
             count_++;
             return true;
-            ;
         }
     }
 
-    // Otherwise, start by incrementing the first table. If that is exhausted, reset that table
-    // and increment the second, and continue until we have enumerated all possible combinations
-    // of valid data across the tables.
-
-    if (!mixedAggregatedAndScalar_ || aggregatedResultsIterator_ == aggregatedResults_.end()) {
+    // Otherwise, continue enumerating all possible combinations of valid data across the tables.
 
-        for (size_t idx = 0; idx < cursors_.size(); idx++) {
+    if (!mixedAggregatedAndScalar_ || !aggregator_->finalised()) {
 
-            // n.b. keep going until writeOutput() has done something - i.e. a row has been
-            // returned. This allows us to have filtering/unique/aggregation in the Output
-            while (processNextTableRow(idx)) {
-                if (writeOutput()) {
-                    count_++;
-                    return true;
-                }
-            }
-
-            // If we have exhausted the available rows, rewind and increment those in the next table
-
-            if (idx != cursors_.size() - 1) {
-                cursors_[idx]->rewind();
-                ASSERT(processNextTableRow(idx));
+        // n.b. keep going until writeOutput() has done something - i.e. a row has been
+        // returned. This allows us to have filtering/unique/aggregation in the Output
+        while (nextRow()) {
+            if (writeOutput()) {
+                count_++;
+                return true;
             }
         }
     }
@@ -686,33 +1101,18 @@ bool SQLSelect::processOneRow() {
     // We put this here rather than in postExecute such that the Select class in odb can
     // iterate over one entry at a time.
 
-    if (aggregatedResultsIterator_ == aggregatedResults_.end()) {
-        aggregatedResultsIterator_ = aggregatedResults_.begin();
-    }
-    else {
-        ++aggregatedResultsIterator_;
-    }
-    while (aggregatedResultsIterator_ != aggregatedResults_.end()) {
-        const OrderByExpressions& nonAggregated = aggregatedResultsIterator_->first;
-        Expressions& aggregated                 = aggregatedResultsIterator_->second;
-        Expressions results;
-        size_t ai = 0;
-        size_t ni = 0;
-        for (size_t i = 0; i < mixedResultColumnIsAggregated_.size(); i++) {
-            if (mixedResultColumnIsAggregated_[i]) {
-                results.push_back(aggregated[ai++]);
-            }
-            else {
-                results.push_back(nonAggregated[ni++]);
-            }
+    if (mixedAggregatedAndScalar_) {
+        if (!aggregator_->finalised()) {
+            aggregator_->finalise();
+            aggregatedResultsIndex_ = 0;
         }
 
-        if (output_.output(results)) {
-            count_++;
-            return true;
+        while (aggregatedResultsIndex_ < aggregator_->size()) {
+            if (output_.output(aggregator_->result(aggregatedResultsIndex_++))) {
+                count_++;
+                return true;
+            }
         }
-
-        ++aggregatedResultsIterator_;
     }
 
     // If this is an aggregate (not mixed aggregate) case, then we are done the
@@ -720,7 +1120,12 @@ bool SQLSelect::processOneRow() {
     // is at least some data!
 
     if (aggregate_ && !mixedAggregatedAndScalar_ && count_ == 0) {
-        resultsOut();
+        if (aggregator_ && aggregator_->size() != 0) {
+            output_.output(aggregator_->result(0));  // aggregated by the parallel scan
+        }
+        else {
+            resultsOut();
+        }
         count_++;
         return true;
     }
@@ -763,6 +1168,54 @@ void SQLSelect::print(std::ostream& s) const {
     s << " " << output_;
 }
 
+void SQLSelect::explain(std::ostream& s) const {
+
+    s << *this << std::endl;
+
+    // From the outermost table to the innermost
+
+    std::string indent = "  ";
+    for (size_t level = sortedTables_.size(); level-- > 0;) {
+        const SelectOneTable& table(*sortedTables_[level]);
+
+        s << indent;
+        if (level < joins_.size() && joins_[level]) {
+            s << *joins_[level] << std::endl;
+            for (const auto& filter : joins_[level]->filters()) {
+                s << indent << "  FILTER " << *filter << std::endl;
+            }
+        }
+        else if (scan_) {
+            s << *scan_ << std::endl;
+            if (scan_->aggregating()) {
+                s << indent << "  PARTIAL AGGREGATION per range" << std::endl;
+            }
+        }
+        else {
+            s << (level + 1 < sortedTables_.size() ? "NESTED LOOP SCAN " : "SCAN ") << table.table_->fullName();
+            if (batch_) {
+                s << " (batches of " << batch_->capacity() << " rows)";
+            }
+            s << std::endl;
+        }
+
+        for (const auto& predicate : table.predicates_) {
+            s << indent << "  PUSHED DOWN " << table.fetch_[predicate.column_].get().fullName() << " in " << predicate
+              << std::endl;
+        }
+
+        for (const auto& check : table.check_) {
+            s << indent << "  FILTER " << *check << std::endl;
+        }
+
+        if (filter_ && !table.check_.empty()) {
+            s << indent << "  COMPILED (" << *filter_ << ")" << std::endl;
+        }
+
+        indent += "  ";
+    }
+}
+
 expression::Expressions SQLSelect::output() const {
     return select_;
 }
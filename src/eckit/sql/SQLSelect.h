@@ -27,6 +27,12 @@
 #include "eckit/sql/expression/OrderByExpressions.h"
 
 namespace eckit::sql {
+class SQLAggregator;
+class SQLBatch;
+class SQLFilter;
+class SQLJoin;
+class SQLParallelScan;
+class SQLParameters;
 class SQLTableIterator;
 namespace expression::function {
 class FunctionROWNUMBER;
@@ -65,6 +71,14 @@ public:
 
     std::vector<eckit::PathName> outputFiles() const;
     void outputFiles(const std::vector<eckit::PathName>& files);
+
+    /// Describe how the rows will be (or were) enumerated. Only meaningful after prepareExecute()
+    void explain(std::ostream&) const;
+
+    /// The values bound to the parameters (?1, ?2...) for the following executions. Not owned.
+    void parameters(const SQLParameters* p) { parameters_ = p; }
+    const SQLParameters& parameters() const;
+
     const std::vector<const SQLTable*>& tables() { return tables_; }
     expression::SQLExpression* where() { return where_.get(); }
 
@@ -83,6 +97,10 @@ private:
     /// with the given SQL table.
     void refreshCursorMetadata(SQLTable* table, SQLTableIterator& cursor);
 
+    /// Update the column types, and everything that depends on them, for a new layout of the table's data
+    void refreshColumnMetadata(SQLTable* table, const std::vector<size_t>& doublesSizes,
+                               const std::vector<char>& hasMissing, const std::vector<double>& missingValues);
+
     // -- Members
     Expressions select_;
     std::vector<const SQLTable*> tables_;
@@ -94,15 +112,20 @@ private:
     // Cursors provide the environment for the iteration over the tables
     std::vector<std::unique_ptr<SQLTableIterator>> cursors_;
 
+    // Equi-joins replace the rewind/rescan of a table (indexed as cursors_, null if not joined)
+    std::vector<std::unique_ptr<SQLJoin>> joins_;
+    bool rowsStarted_;
+    bool rowsExhausted_;
+
     /// ownedOutputs allows us to create wrapping SQLOutputs with the same lifetime as the
     /// SQLSelect object.
     std::vector<std::unique_ptr<SQLOutput>> ownedOutputs_;
     SQLOutput& output_;
 
-    typedef std::map<expression::OrderByExpressions, expression::Expressions> AggregatedResults;
+    // Groups of results, where aggregated and non-aggregated columns are mixed
 
-    AggregatedResults aggregatedResults_;
-    AggregatedResults::iterator aggregatedResultsIterator_;
+    std::unique_ptr<SQLAggregator> aggregator_;
+    size_t aggregatedResultsIndex_;
 
     // n.b. we don't use std::vector<bool> as you cannot take a reference to a single element.
 
@@ -117,6 +140,17 @@ private:
     unsigned long long total_;
     unsigned long long skips_;
 
+    // Batched evaluation of the WHERE checks (single table selects only)
+
+    std::unique_ptr<SQLBatch> batch_;
+    std::unique_ptr<SQLFilter> filter_;
+    std::vector<uint8_t> batchSelected_;
+    size_t batchRow_;
+
+    // Parallel scan of a table split into ranges (replaces reading the cursor, if not null)
+
+    std::unique_ptr<SQLParallelScan> scan_;
+
     bool aggregate_;
     bool mixedAggregatedAndScalar_;
     bool doOutputCached_;
@@ -125,6 +159,8 @@ private:
     std::vector<bool> mixedResultColumnIsAggregated_;
     std::vector<eckit::PathName> outputFiles_;
 
+    const SQLParameters* parameters_;
+
     // -- Methods
 
     void reset();
@@ -133,6 +169,12 @@ private:
     std::shared_ptr<SQLExpression> findAliasedExpression(const std::string& alias);
 
     bool processNextTableRow(size_t tableIndex);
+    bool checkRow(const SelectOneTable& table);
+    void rewindTable(size_t tableIndex);
+    bool nextRow();
+
+    void prepareBatch();
+    bool fillBatch(size_t tableIndex);
 
     friend class expression::function::FunctionROWNUMBER;  // needs access to count_
     friend class expression::function::FunctionTHIN;       // needs access to count_
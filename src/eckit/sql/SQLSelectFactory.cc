@@ -98,7 +98,7 @@ MetaData SQLSelectFactory::columns(const std::string& tableName)
 SQLSelect* SQLSelectFactory::create(bool distinct, const Expressions& select_list, const std::string& into,
                                     const std::vector<std::reference_wrapper<SQLTable>>& from,
                                     std::shared_ptr<SQLExpression> where, const Expressions& group_by,
-                                    std::pair<Expressions, std::vector<bool>> order_by) {
+                                    std::pair<Expressions, std::vector<bool>> order_by, size_t limit) {
     std::ostream& L(Log::debug());
 
     if (where) {
@@ -173,7 +173,7 @@ SQLSelect* SQLSelectFactory::create(bool distinct, const Expressions& select_lis
     }
 
     if (order_by.first.size()) {
-        newOutputs.emplace_back(new SQLOrderOutput(*outputEndpoint, order_by));
+        newOutputs.emplace_back(new SQLOrderOutput(*outputEndpoint, order_by, limit));
         outputEndpoint = newOutputs.back().get();
     }
     if (distinct) {
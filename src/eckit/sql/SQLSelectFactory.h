@@ -45,7 +45,7 @@ public:
                       // n.b. not const SQLTable only for ease of integration with sqly.y
                       const std::vector<std::reference_wrapper<SQLTable>>& from,
                       std::shared_ptr<expression::SQLExpression> where, const expression::Expressions& group_by,
-                      std::pair<expression::Expressions, std::vector<bool>> order_by);
+                      std::pair<expression::Expressions, std::vector<bool>> order_by, size_t limit = 0);
 
     std::shared_ptr<expression::SQLExpression> createColumn(const std::string& columnName,
                                                             const std::string& bitfieldName,
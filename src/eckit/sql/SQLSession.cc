@@ -9,6 +9,7 @@
  */
 
 #include <libgen.h>
+#include <cctype>
 #include <cstring>
 
 #include "eckit/config/LibEcKit.h"
@@ -22,6 +23,7 @@
 #include "eckit/sql/SQLOutput.h"
 #include "eckit/sql/SQLOutputConfig.h"
 #include "eckit/sql/SQLParser.h"
+#include "eckit/sql/SQLPreparedStatement.h"
 #include "eckit/sql/SQLSession.h"
 #include "eckit/sql/SQLStatement.h"
 #include "eckit/sql/SQLTableFactory.h"
@@ -38,7 +40,8 @@ SQLSession::SQLSession(std::unique_ptr<SQLOutput> out, std::unique_ptr<SQLOutput
     lastExecuteResult_(),
     config_(config ? std::move(config) : std::unique_ptr<SQLOutputConfig>(new SQLOutputConfig())),
     output_(std::move(out)),
-    csvDelimiter_(csvDelimiter) {
+    csvDelimiter_(csvDelimiter),
+    preparedCapacity_(Resource<size_t>("$ECKIT_SQL_PREPARED_STATEMENTS;eckitSQLPreparedStatements", 64)) {
 
     ASSERT(output_ || config_);
     database_.open();
@@ -68,6 +71,90 @@ unsigned long long SQLSession::execute(SQLStatement& sql) {
     return lastExecuteResult_ = n;
 }
 
+static std::string normaliseSQL(const std::string& sql) {
+
+    // Runs of spaces outside of quotes become a single space. Leading and trailing spaces, and the final
+    // semicolon, are dropped.
+
+    std::string result;
+    char quote = 0;
+    bool space = false;
+
+    for (char c : sql) {
+        if (quote) {
+            result += c;
+            if (c == quote) {
+                quote = 0;
+            }
+            continue;
+        }
+        if (::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            continue;
+        }
+        if (space && !result.empty()) {
+            result += ' ';
+        }
+        space = false;
+        if (c == '\'' || c == '"') {
+            quote = c;
+        }
+        result += c;
+    }
+
+    while (!result.empty() && (result.back() == ';' || result.back() == ' ')) {
+        result.pop_back();
+    }
+
+    return result;
+}
+
+std::shared_ptr<SQLPreparedStatement> SQLSession::prepare(const std::string& sql) {
+
+    std::string key(normaliseSQL(sql));
+
+    auto cached = preparedBySQL_.find(key);
+    if (cached != preparedBySQL_.end()) {
+        prepared_.splice(prepared_.begin(), prepared_, cached->second);
+        return std::make_shared<SQLPreparedStatement>(prepared_.front());
+    }
+
+    // Parse the statement aside, leaving the current one in place
+
+    std::unique_ptr<SQLStatement> current(std::move(statement_));
+    try {
+        SQLParser::parseString(*this, sql);
+    }
+    catch (...) {
+        statement_ = std::move(current);
+        throw;
+    }
+
+    std::unique_ptr<SQLStatement> parsed(std::move(statement_));
+    statement_ = std::move(current);
+
+    if (!parsed) {
+        throw UserError("No statement to prepare", sql);
+    }
+
+    prepared_.emplace_front(std::make_shared<SQLPlan>(key, std::move(parsed)));
+    preparedBySQL_[key] = prepared_.begin();
+
+    auto result = std::make_shared<SQLPreparedStatement>(prepared_.front());
+
+    while (prepared_.size() > preparedCapacity_) {
+        preparedBySQL_.erase(prepared_.back()->sql());
+        prepared_.pop_back();
+    }
+
+    return result;
+}
+
+void SQLSession::clearPreparedStatements() {
+    preparedBySQL_.clear();
+    prepared_.clear();
+}
+
 std::unique_ptr<SQLOutput> SQLSession::newFileOutput(const eckit::PathName& path) {
     return std::unique_ptr<SQLOutput>(config_->buildOutput(path));
 }
@@ -22,7 +22,9 @@ namespace eckit {
 class DataHandle;
 }
 
+#include <list>
 #include <memory>
+#include <unordered_map>
 
 #include "eckit/memory/OnlyMovable.h"
 #include "eckit/sql/SQLSelectFactory.h"
@@ -39,6 +41,8 @@ class SQLDatabase;
 class SQLStatement;
 class SQLTable;
 class SQLOutputConfig;
+class SQLPlan;
+class SQLPreparedStatement;
 
 class SQLSession : private eckit::OnlyMovable {
 public:
@@ -71,6 +75,15 @@ public:
 
     virtual unsigned long long execute(SQLStatement&);
 
+    /// Parse a SELECT statement once, to execute it repeatedly (see SQLPreparedStatement). The parsed
+    /// statements (see SQLPlan) are cached, by their text with the spaces normalised, and shared by the
+    /// statements prepared from the same SQL while cached. Each call returns a new statement, with its own
+    /// parameters. The cache must be cleared if the tables are changed. Executions of the statements sharing a
+    /// plan are serialised, and may not be nested.
+    std::shared_ptr<SQLPreparedStatement> prepare(const std::string& sql);
+    void clearPreparedStatements();
+    size_t preparedStatements() const { return prepared_.size(); }
+
     virtual void interactive() {}
 
     unsigned long long lastExecuteResult() { return lastExecuteResult_; }
@@ -105,6 +118,13 @@ private:
     std::unique_ptr<SQLOutput> output_;
     const std::string csvDelimiter_;
 
+    // Parsed statements, the most recently used first, and by their normalised SQL
+
+    using PreparedStatements = std::list<std::shared_ptr<SQLPlan>>;
+    PreparedStatements prepared_;
+    std::unordered_map<std::string, PreparedStatements::iterator> preparedBySQL_;
+    size_t preparedCapacity_;
+
     friend std::ostream& operator<<(std::ostream& s, const SQLSession& p) {
         s << "[session@" << &p << ", currentDatabase: " << p.currentDatabase() << " ]";
         return s;
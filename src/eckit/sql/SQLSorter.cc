@@ -0,0 +1,364 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/sql/SQLSorter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <ostream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/TmpFile.h"
+#include "eckit/io/StdFile.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/thread/ThreadPool.h"
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Below this, splitting the sort of the buffer between threads is not worth it
+const size_t minimumPartition = 4096;
+
+const size_t noSource = std::numeric_limits<size_t>::max();
+
+int compareKeys(const char* a, size_t aLength, const char* b, size_t bLength) {
+    int c = ::memcmp(a, b, std::min(aLength, bLength));
+    if (c != 0) {
+        return c;
+    }
+    return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+uint64_t keyPrefix(const char* key, size_t length) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < sizeof(prefix); ++i) {
+        prefix = (prefix << 8) | (i < length ? static_cast<uint8_t>(key[i]) : 0);
+    }
+    return prefix;
+}
+
+/// Records retained when limited are held as: key length (uint32_t), key, payload
+
+const char* recordKey(const std::string& record, uint32_t& keyLength) {
+    ::memcpy(&keyLength, record.data(), sizeof(keyLength));
+    return record.data() + sizeof(keyLength);
+}
+
+bool recordLess(const std::string& a, const std::string& b) {
+    uint32_t aLength;
+    uint32_t bLength;
+    const char* aKey = recordKey(a, aLength);
+    const char* bKey = recordKey(b, bLength);
+    return compareKeys(aKey, aLength, bKey, bLength) < 0;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class SQLSorter::Task : public ThreadPoolTask {
+public:
+    Task(std::function<void()> work) :
+        work_(work) {}
+
+private:
+    void execute() override { work_(); }
+
+    std::function<void()> work_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SQLSorter::SQLSorter(size_t memory, size_t threads, size_t limit) :
+    memory_(memory),
+    threads_(std::max<size_t>(threads, 1)),
+    limit_(limit),
+    sequence_(0),
+    returned_(0),
+    current_(noSource),
+    merging_(false),
+    sorted_(false) {}
+
+SQLSorter::~SQLSorter() {}
+
+void SQLSorter::add(const char* key, size_t keyLength, const char* payload, size_t payloadLength) {
+
+    ASSERT(!sorted_);
+
+    // Records with equal keys are kept in order by appending the (big endian) sequence number to the key
+
+    key_.assign(key, keyLength);
+    uint64_t sequence = sequence_++;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        key_.push_back(static_cast<char>((sequence >> shift) & 0xff));
+    }
+
+    if (limit_) {
+
+        // Keep the best records seen so far in a max-heap, so the worst of them is at the front
+
+        if (best_.size() == limit_) {
+            uint32_t worstLength;
+            const char* worst = recordKey(best_.front(), worstLength);
+            if (compareKeys(key_.data(), key_.size(), worst, worstLength) >= 0) {
+                return;
+            }
+            std::pop_heap(best_.begin(), best_.end(), recordLess);
+            best_.pop_back();
+        }
+
+        uint32_t length = key_.size();
+        std::string record;
+        record.reserve(sizeof(length) + key_.size() + payloadLength);
+        record.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        record.append(key_);
+        record.append(payload, payloadLength);
+
+        best_.emplace_back(std::move(record));
+        std::push_heap(best_.begin(), best_.end(), recordLess);
+        return;
+    }
+
+    Entry entry;
+    entry.prefix_        = keyPrefix(key_.data(), key_.size());
+    entry.offset_        = buffer_.size();
+    entry.keyLength_     = key_.size();
+    entry.payloadLength_ = payloadLength;
+
+    buffer_.insert(buffer_.end(), key_.begin(), key_.end());
+    buffer_.insert(buffer_.end(), payload, payload + payloadLength);
+    entries_.push_back(entry);
+
+    if (buffer_.size() + entries_.size() * sizeof(Entry) > memory_) {
+        spill();
+    }
+}
+
+void SQLSorter::sortBuffer() {
+
+    const char* base = buffer_.data();
+    auto less        = [base](const Entry& a, const Entry& b) {
+        if (a.prefix_ != b.prefix_) {
+            return a.prefix_ < b.prefix_;
+        }
+        return compareKeys(base + a.offset_, a.keyLength_, base + b.offset_, b.keyLength_) < 0;
+    };
+
+    size_t n     = entries_.size();
+    size_t parts = std::min(threads_, n / minimumPartition);
+
+    if (parts <= 1) {
+        std::sort(entries_.begin(), entries_.end(), less);
+        return;
+    }
+
+    // Sort partitions of the buffer concurrently, then merge them pairwise, each level in parallel
+
+    if (!pool_) {
+        pool_.reset(new ThreadPool("sql-sort", threads_));
+    }
+
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t i = 0; i <= parts; ++i) {
+        bounds[i] = n * i / parts;
+    }
+
+    auto entries = entries_.begin();
+
+    for (size_t i = 0; i < parts; ++i) {
+        auto first = entries + bounds[i];
+        auto last  = entries + bounds[i + 1];
+        pool_->push(new Task([first, last, less]() { std::sort(first, last, less); }));
+    }
+    pool_->wait();
+
+    for (size_t width = 1; width < parts; width *= 2) {
+        for (size_t i = 0; i + width < parts; i += 2 * width) {
+            auto first  = entries + bounds[i];
+            auto middle = entries + bounds[i + width];
+            auto last   = entries + bounds[std::min(i + 2 * width, parts)];
+            pool_->push(new Task([first, middle, last, less]() { std::inplace_merge(first, middle, last, less); }));
+        }
+        pool_->wait();
+    }
+}
+
+void SQLSorter::spill() {
+
+    sortBuffer();
+
+    std::unique_ptr<TmpFile> path(new TmpFile(false));
+
+    {
+        AutoStdFile file(*path, "w");
+        for (const Entry& entry : entries_) {
+            uint32_t lengths[2] = {entry.keyLength_, entry.payloadLength_};
+            if (::fwrite(lengths, sizeof(lengths), 1, file) != 1
+                || ::fwrite(&buffer_[entry.offset_], entry.keyLength_ + entry.payloadLength_, 1, file) != 1) {
+                throw WriteError(*path, Here());
+            }
+        }
+    }
+
+    Log::debug<LibEcKit>() << "SQLSorter: spilled run of " << entries_.size() << " records (" << Bytes(buffer_.size())
+                           << ") to " << *path << std::endl;
+
+    runs_.emplace_back(std::move(path));
+    buffer_.clear();
+    entries_.clear();
+}
+
+void SQLSorter::sort() {
+
+    ASSERT(!sorted_);
+    sorted_ = true;
+
+    if (limit_) {
+        std::sort_heap(best_.begin(), best_.end(), recordLess);
+        return;
+    }
+
+    sortBuffer();
+
+    if (runs_.empty()) {
+        return;
+    }
+
+    // Merge the runs on disk, and what remains in the buffer
+
+    merging_ = true;
+
+    sources_.resize(runs_.size() + 1);
+    for (size_t i = 0; i < runs_.size(); ++i) {
+        sources_[i].path_ = *runs_[i];
+        sources_[i].file_.reset(new AutoStdFile(*runs_[i], "r"));
+    }
+    sources_.back().position_ = 0;
+
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        if (advance(sources_[i])) {
+            heap_.push_back(i);
+        }
+    }
+
+    auto greater = [this](size_t a, size_t b) {
+        return compareKeys(sources_[b].key_, sources_[b].keyLength_, sources_[a].key_, sources_[a].keyLength_) < 0;
+    };
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+}
+
+bool SQLSorter::advance(Source& source) {
+
+    if (!source.file_) {
+        if (source.position_ == entries_.size()) {
+            return false;
+        }
+        const Entry& entry(entries_[source.position_++]);
+        source.key_           = &buffer_[entry.offset_];
+        source.keyLength_     = entry.keyLength_;
+        source.payload_       = source.key_ + entry.keyLength_;
+        source.payloadLength_ = entry.payloadLength_;
+        return true;
+    }
+
+    uint32_t lengths[2];
+    if (::fread(lengths, sizeof(lengths), 1, *source.file_) != 1) {
+        if (::ferror(*source.file_)) {
+            throw ReadError(source.path_, Here());
+        }
+        source.file_.reset();
+        source.position_ = entries_.size();
+        return false;
+    }
+
+    source.record_.resize(lengths[0] + lengths[1]);
+    if (::fread(source.record_.data(), source.record_.size(), 1, *source.file_) != 1) {
+        throw ShortFile(source.path_, Here());
+    }
+
+    source.key_           = source.record_.data();
+    source.keyLength_     = lengths[0];
+    source.payload_       = source.key_ + lengths[0];
+    source.payloadLength_ = lengths[1];
+    return true;
+}
+
+bool SQLSorter::next(const char*& payload, size_t& payloadLength) {
+
+    ASSERT(sorted_);
+
+    if (limit_) {
+        if (returned_ == best_.size()) {
+            return false;
+        }
+        const std::string& record(best_[returned_++]);
+        uint32_t keyLength;
+        payload       = recordKey(record, keyLength) + keyLength;
+        payloadLength = record.size() - sizeof(keyLength) - keyLength;
+        return true;
+    }
+
+    if (!merging_) {
+        if (returned_ == entries_.size()) {
+            return false;
+        }
+        const Entry& entry(entries_[returned_++]);
+        payload       = &buffer_[entry.offset_ + entry.keyLength_];
+        payloadLength = entry.payloadLength_;
+        return true;
+    }
+
+    auto greater = [this](size_t a, size_t b) {
+        return compareKeys(sources_[b].key_, sources_[b].keyLength_, sources_[a].key_, sources_[a].keyLength_) < 0;
+    };
+
+    // The source of the previous record is only moved on now, so that its payload remained valid
+
+    if (current_ != noSource) {
+        if (advance(sources_[current_])) {
+            heap_.push_back(current_);
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+        current_ = noSource;
+    }
+
+    if (heap_.empty()) {
+        return false;
+    }
+
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    current_ = heap_.back();
+    heap_.pop_back();
+
+    payload       = sources_[current_].payload_;
+    payloadLength = sources_[current_].payloadLength_;
+    return true;
+}
+
+void SQLSorter::print(std::ostream& s) const {
+    if (limit_) {
+        s << "TOP " << limit_ << " of " << sequence_ << " rows";
+    }
+    else {
+        s << "SORT " << sequence_ << " rows (" << runs_.size() << " runs spilled to disk, " << threads_
+          << " threads)";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
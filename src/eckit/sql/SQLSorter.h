@@ -0,0 +1,130 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_sql_SQLSorter_H
+#define eckit_sql_SQLSorter_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+class AutoStdFile;
+class ThreadPool;
+class TmpFile;
+}  // namespace eckit
+
+namespace eckit::sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// External merge sort of records, each made of a binary key and an opaque payload.
+///
+/// Keys are compared bytewise (as memcmp), so callers encode whatever they sort on into an order
+/// preserving binary form. Records with equal keys are returned in the order in which they were added.
+///
+/// Records are appended to an in-memory buffer. Once the buffer exceeds the memory budget it is sorted,
+/// on a pool of threads, and written out to a temporary file as a sorted run. At the end the runs, and
+/// whatever remains in the buffer, are combined with a k-way merge.
+///
+/// If a limit is given only the first records, in key order, are wanted. A bounded heap of the best
+/// records seen so far is kept instead, and nothing is ever spilled.
+
+class SQLSorter : private eckit::NonCopyable {
+public:  // methods
+    /// @param memory  bytes of records to buffer before spilling a run to disk
+    /// @param threads number of threads used to sort the buffer
+    /// @param limit   if non-zero, only this many records are returned
+    SQLSorter(size_t memory, size_t threads, size_t limit = 0);
+    ~SQLSorter();
+
+    void add(const char* key, size_t keyLength, const char* payload, size_t payloadLength);
+
+    /// Prepare to return the records. No more records may be added after this.
+    void sort();
+
+    /// The next record, in key order. The payload is valid until the next call. Returns false at the end.
+    bool next(const char*& payload, size_t& payloadLength);
+
+    /// Number of records added
+    size_t size() const { return sequence_; }
+
+    /// Number of sorted runs written to disk
+    size_t runs() const { return runs_.size(); }
+
+    void print(std::ostream&) const;
+
+private:  // types
+    struct Entry {
+        uint64_t prefix_;  // first 8 bytes of the key, big endian, zero padded
+        size_t offset_;    // of the key in buffer_. The payload follows.
+        uint32_t keyLength_;
+        uint32_t payloadLength_;
+    };
+
+    /// The current record of a sorted run, or of the sorted buffer, during the merge
+    struct Source {
+        std::string path_;
+        std::unique_ptr<AutoStdFile> file_;  // if reading a run
+        std::vector<char> record_;
+        size_t position_;  // in entries_, if reading from the buffer
+
+        const char* key_;
+        size_t keyLength_;
+        const char* payload_;
+        size_t payloadLength_;
+    };
+
+    class Task;
+
+private:  // methods
+    void sortBuffer();
+    void spill();
+    bool advance(Source& source);
+
+    friend std::ostream& operator<<(std::ostream& s, const SQLSorter& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    size_t memory_;
+    size_t threads_;
+    size_t limit_;
+    uint64_t sequence_;
+
+    std::vector<char> buffer_;
+    std::vector<Entry> entries_;
+    std::vector<std::unique_ptr<TmpFile>> runs_;
+
+    std::vector<std::string> best_;  // when limited, a max-heap of key length, key and payload
+    size_t returned_;
+
+    std::vector<Source> sources_;
+    std::vector<size_t> heap_;  // of sources_, smallest key first
+    size_t current_;            // source of the last record returned
+    bool merging_;
+    bool sorted_;
+
+    std::unique_ptr<ThreadPool> pool_;
+    std::string key_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::sql
+
+#endif
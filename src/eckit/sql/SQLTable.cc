@@ -196,6 +196,21 @@ void SQLTable::updateColumnMissingValues(const std::string& name, bool hasMissin
     j->second->missingValue(missingValue);
 }
 
+std::ostream& operator<<(std::ostream& s, const SQLPredicate& p) {
+    s << (p.lowerInclusive_ ? "[" : "(") << p.lower_ << ", " << p.upper_
+      << (p.upperInclusive_ ? "]" : ")");
+    return s;
+}
+
+std::vector<SQLTableRange> SQLTable::scanRanges(size_t) const {
+    return {};
+}
+
+SQLTableIterator* SQLTable::rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>&,
+                                          std::function<void(SQLTableIterator&)>, const SQLTableRange&) const {
+    throw eckit::NotImplemented("SQLTable::rangeIterator: table " + fullName() + " cannot be split", Here());
+}
+
 void SQLTable::addLinkFrom(const SQLTable& from) {
     linksFrom_.insert(from);
 }
@@ -31,6 +31,30 @@ namespace eckit::sql {
 class SQLColumn;
 class SQLDatabase;
 
+/// A condition that a row must satisfy to be selected: the value of one of the (numeric) columns an
+/// iterator was created with lies between the bounds. Missing values never satisfy it. An equality has
+/// both bounds equal, and inclusive.
+
+struct SQLPredicate {
+    size_t column_;  // index in the columns passed to SQLTable::iterator()
+    double lower_;
+    double upper_;
+    bool lowerInclusive_;
+    bool upperInclusive_;
+
+    bool matches(double value) const {
+        return (lowerInclusive_ ? value >= lower_ : value > lower_)
+               && (upperInclusive_ ? value <= upper_ : value < upper_);
+    }
+
+    /// May any of the values in [min, max] satisfy the condition?
+    bool overlaps(double min, double max) const {
+        return (upperInclusive_ ? min <= upper_ : min < upper_) && (lowerInclusive_ ? max >= lower_ : max > lower_);
+    }
+};
+
+std::ostream& operator<<(std::ostream&, const SQLPredicate&);
+
 class SQLTableIterator {
 public:
     virtual ~SQLTableIterator() {}
@@ -41,6 +65,20 @@ public:
     virtual std::vector<size_t> doublesDataSizes() const = 0;
     virtual std::vector<char> columnsHaveMissing() const = 0;  // n.b. don't use std::vector<bool> ...
     virtual std::vector<double> missingValues() const    = 0;
+
+    /// Conditions that all of the selected rows satisfy, given before the first call to next(). Iterators
+    /// may use them to avoid reading or decoding rows (or whole blocks of rows, e.g. using statistics of
+    /// the values in them) that cannot be selected. This is an optimisation only: the rows returned are
+    /// still checked in full. Returns true if the conditions are made use of.
+    virtual bool pushDown(const std::vector<SQLPredicate>&) { return false; }
+};
+
+/// A part of a table that can be read independently of the rest of it, through its own iterator (see
+/// SQLTable::scanRanges). What begin_ and end_ count (rows, files, ...) is up to the table.
+
+struct SQLTableRange {
+    size_t begin_;
+    size_t end_;
 };
 
 typedef std::vector<std::string> ColumnNames;
@@ -87,6 +125,16 @@ public:
                                        std::function<void(SQLTableIterator&)> metadataUpdateCallback) const
         = 0;
 
+    /// Split the table into (at most) count ranges that may be scanned concurrently. Tables that cannot
+    /// be split return no ranges, which is the default.
+    virtual std::vector<SQLTableRange> scanRanges(size_t count) const;
+
+    /// An iterator over one of the ranges returned by scanRanges(). The iterators of different ranges
+    /// must be usable from different threads at the same time.
+    virtual SQLTableIterator* rangeIterator(const std::vector<std::reference_wrapper<const SQLColumn>>&,
+                                            std::function<void(SQLTableIterator&)> metadataUpdateCallback,
+                                            const SQLTableRange& range) const;
+
 protected:
     std::string path_;
     std::string name_;
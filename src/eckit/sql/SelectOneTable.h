@@ -15,6 +15,7 @@
 #ifndef eckit_sql_SelectOneTable_H
 #define eckit_sql_SelectOneTable_H
 
+#include "eckit/sql/SQLTable.h"
 #include "eckit/sql/expression/SQLExpressions.h"
 
 namespace eckit::sql {
@@ -44,6 +45,9 @@ struct SelectOneTable {
     Expressions check_;
     Expressions index_;
 
+    // Conditions from check_ handed down to the iterators (see SQLTableIterator::pushDown)
+    std::vector<SQLPredicate> predicates_;
+
 
     // For links
     std::pair<const double*, bool&> offset_;
@@ -14,6 +14,7 @@
 
 #include "eckit/filesystem/PathName.h"
 #include "eckit/os/BackTrace.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/SQLColumn.h"
 #include "eckit/sql/SQLSelect.h"
 #include "eckit/sql/SQLTable.h"
@@ -95,6 +96,21 @@ double BitColumnExpression::eval(bool& missing) const {
     return (x & mask_) >> bitShift_;
 }
 
+void BitColumnExpression::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+
+    if (batch.columnIndex(value_) < 0) {
+        SQLExpression::evalBatch(batch, out, missing);
+        return;
+    }
+
+    ColumnExpression::evalBatch(batch, out, missing);
+
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        unsigned long x = static_cast<unsigned long>(out[i]);
+        out[i]          = (x & mask_) >> bitShift_;
+    }
+}
+
 void BitColumnExpression::expandStars(const std::vector<std::reference_wrapper<const SQLTable>>& tables,
                                       expression::Expressions& e) {
     using namespace eckit;
@@ -46,6 +46,7 @@ protected:
     void prepare(SQLSelect& sql) override;
     void updateType(SQLSelect& sql) override;
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
     virtual void expandStars(const std::vector<std::reference_wrapper<const SQLTable>>&,
                              expression::Expressions&) override;
     const eckit::sql::type::SQLType* type() const override;
@@ -13,6 +13,7 @@
 #include <cstring>
 #include <ostream>
 
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/SQLColumn.h"
 #include "eckit/sql/SQLSelect.h"
 #include "eckit/sql/SQLTable.h"
@@ -69,6 +70,33 @@ void ColumnExpression::eval(double* out, bool& missing) const {
     ::memcpy(out, value_->first, type_->size());
 }
 
+void ColumnExpression::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+
+    int column = batch.columnIndex(value_);
+    if (column < 0) {
+        SQLExpression::evalBatch(batch, out, missing);
+        return;
+    }
+
+    const double* data  = batch.data(column);
+    const uint8_t* miss = batch.missing(column);
+    size_t stride       = batch.stride(column);
+    size_t n            = batch.size();
+
+    if (stride == 1) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i]     = data[i];
+            missing[i] = miss[i];
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            out[i]     = data[i * stride];
+            missing[i] = miss[i];
+        }
+    }
+}
+
 std::string ColumnExpression::evalAsString(bool& missing) const {
     if (value_->second) {
         missing = true;
@@ -36,6 +36,7 @@ public:
 
     const SQLTable* table() { return table_; }
     const double* current() { return value_->first; }
+    const std::pair<const double*, bool>* valueLookup() const { return value_; }
     std::shared_ptr<SQLExpression> clone() const override;
     std::shared_ptr<SQLExpression> reshift(int minColumnShift) const override;
 
@@ -64,6 +65,8 @@ protected:
     double eval(bool& missing) const override;
     void eval(double* out, bool& missing) const override;
     std::string evalAsString(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override { return true; }
     bool isConstant() const override { return false; }
     void output(SQLOutput& s) const override;
 
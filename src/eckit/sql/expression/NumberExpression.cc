@@ -12,6 +12,8 @@
 
 #include <ostream>
 
+#include "eckit/sql/SQLBatch.h"
+
 namespace eckit::sql::expression {
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -40,6 +42,13 @@ double NumberExpression::eval(bool& missing) const {
     return value_;
 }
 
+void NumberExpression::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        out[i]     = value_;
+        missing[i] = 0;
+    }
+}
+
 void NumberExpression::prepare(SQLSelect& sql) {}
 
 void NumberExpression::cleanup(SQLSelect& sql) {}
@@ -45,6 +45,8 @@ private:
 
     const type::SQLType* type() const override;
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override { return true; }
     bool isConstant() const override { return true; }
     bool isNumber() const override { return true; }
 };
@@ -10,15 +10,19 @@
 
 #include "eckit/sql/expression/ParameterExpression.h"
 
+#include <cstring>
+
 #include "eckit/exception/Exceptions.h"
-#include "eckit/sql/SQLSession.h"
+#include "eckit/sql/SQLBatch.h"
+#include "eckit/sql/SQLSelect.h"
+#include "eckit/sql/type/SQLType.h"
 
 namespace eckit::sql::expression {
 
 //----------------------------------------------------------------------------------------------------------------------
 
 ParameterExpression::ParameterExpression(int which) :
-    value_(0), which_(which) {
+    value_(nullptr), which_(which) {
     // don't use any Log::* here
     //	std::cout << "new ParameterExpression " << name << std::endl;
 }
@@ -33,28 +37,49 @@ std::shared_ptr<SQLExpression> ParameterExpression::ParameterExpression::clone()
 
 ParameterExpression::~ParameterExpression() {}
 
-// TODO: are only real parameters allowed?
 const type::SQLType* ParameterExpression::type() const {
-    return &type::SQLType::lookup("real");
+    // Parameters are numbers until they are bound
+    return value_ ? value_->type_ : &type::SQLType::lookup("real");
 }
 
 double ParameterExpression::eval(bool& missing) const {
-    return value_;
+    ASSERT(value_);
+    return value_->value_[0];
+}
+
+void ParameterExpression::eval(double* out, bool& missing) const {
+    ASSERT(value_);
+    ::memcpy(out, value_->value_.data(), value_->value_.size() * sizeof(double));
+}
+
+std::string ParameterExpression::evalAsString(bool& missing) const {
+    ASSERT(value_);
+    return type()->getKind() == type::SQLType::stringType ? value_->string_ : SQLExpression::evalAsString(missing);
+}
+
+void ParameterExpression::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+    ASSERT(value_);
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        out[i]     = value_->value_[0];
+        missing[i] = 0;
+    }
+}
+
+void ParameterExpression::output(SQLOutput& o) const {
+    ASSERT(value_);
+    value_->type_->output(o, value_->value_.data(), false);
 }
 
 void ParameterExpression::prepare(SQLSelect& sql) {
-    NOTIMP;
-    // TODO:
-    // value_ = SQLSession::current().getParameter(which_);
-    //	std::cout << "ParameterExpression " << name_ << " " << value_ << std::endl;
+    value_ = &sql.parameters().value(which_);
 }
 
 void ParameterExpression::cleanup(SQLSelect& sql) {
-    value_ = 0;
+    value_ = nullptr;
 }
 
 void ParameterExpression::print(std::ostream& s) const {
-    s << '?' << which_ << '=' << value_;
+    s << '?' << which_;
 }
 
 bool ParameterExpression::isConstant() const {
@@ -15,12 +15,17 @@
 #ifndef eckit_sql_ParameterExpression_H
 #define eckit_sql_ParameterExpression_H
 
+#include "eckit/sql/SQLParameters.h"
 #include "eckit/sql/expression/SQLExpression.h"
 
 namespace eckit::sql::expression {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// A parameter of a statement (?1, ?2...). Its value, and type, are those bound to it for each execution
+/// (see SQLSelect::parameters), so it is constant throughout an execution, but it is not a constant that
+/// may be folded into the statement.
+
 class ParameterExpression : public SQLExpression {
 public:
     ParameterExpression(int);
@@ -30,13 +35,14 @@ public:
     std::shared_ptr<SQLExpression> clone() const override;
     std::shared_ptr<SQLExpression> reshift(int minColumnShift) const override { return clone(); }
 
+    int which() const { return which_; }
+
 private:
     // No copy allowed
     ParameterExpression& operator=(const ParameterExpression&);
 
     // -- Members
-    // None
-    double value_;
+    const SQLParameters::Value* value_;  // while prepared
     int which_;
 
     void print(std::ostream& s) const override;
@@ -44,6 +50,11 @@ private:
     void cleanup(SQLSelect& sql) override;
 
     double eval(bool& missing) const override;
+    void eval(double* out, bool& missing) const override;
+    std::string evalAsString(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override { return true; }
+    void output(SQLOutput&) const override;
     const type::SQLType* type() const override;
     bool isConstant() const override;
 };
@@ -12,6 +12,7 @@
 
 #include "eckit/config/LibEcKit.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/SQLOutput.h"
 #include "eckit/sql/expression/NumberExpression.h"
 #include "eckit/sql/expression/SQLExpressions.h"
@@ -35,6 +36,15 @@ void SQLExpression::eval(double* out, bool& missing) const {
     *out = eval(missing);
 }
 
+void SQLExpression::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch.select(i);
+        bool m     = false;
+        out[i]     = eval(m);
+        missing[i] = m;
+    }
+}
+
 std::shared_ptr<SQLExpression> SQLExpression::number(double value) {
     return std::make_shared<NumberExpression>(value);
 }
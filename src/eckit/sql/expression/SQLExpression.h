@@ -23,6 +23,7 @@
 namespace eckit::sql {
 // Forward declarations
 
+class SQLBatch;
 class SQLSelect;
 class SQLTable;
 class SQLOutput;
@@ -54,6 +55,16 @@ public:
     virtual void eval(double* out, bool& missing) const;
     virtual std::string evalAsString(bool& missing) const;
 
+    // Evaluate the expression for every row of a batch. The values and missing flags must be
+    // those that eval() would give row by row. The default does just that, via SQLBatch::select().
+    // isBatchable() is false for expressions that depend on the order in which rows are evaluated.
+    // isVectorised() is true if evalBatch() works on the data held in the batch only, without going
+    // through SQLBatch::select(). Such expressions may be evaluated over different batches concurrently.
+
+    virtual void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const;
+    virtual bool isBatchable() const { return true; }
+    virtual bool isVectorised() const { return false; }
+
     virtual bool andSplit(expression::Expressions&) { return false; }
     virtual void tables(std::set<const SQLTable*>&) {}
 
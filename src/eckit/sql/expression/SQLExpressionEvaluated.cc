@@ -10,6 +10,7 @@
 
 #include "eckit/sql/expression/SQLExpressionEvaluated.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "eckit/exception/Exceptions.h"
@@ -29,6 +30,30 @@ SQLExpressionEvaluated::SQLExpressionEvaluated(SQLExpression& e) :
     hasMissingValue_ = e.hasMissingValue();
 }
 
+SQLExpressionEvaluated::SQLExpressionEvaluated(const SQLExpression& e, const double* value, size_t count,
+                                               bool missing) :
+    type_(e.type()), missing_(missing), missingValue_(e.missingValue()) {
+
+    size_t byteSize = type_->size();
+    ASSERT(byteSize % sizeof(double) == 0);
+    value_.resize(std::max<size_t>(1, byteSize / sizeof(double)), 0);
+
+    ::memcpy(&value_[0], value, std::min(count, value_.size()) * sizeof(double));
+    hasMissingValue_ = e.hasMissingValue();
+}
+
+SQLExpressionEvaluated::SQLExpressionEvaluated(const type::SQLType& type, const double* value, size_t count,
+                                               bool missing, double missingValue, bool hasMissingValue) :
+    type_(&type), missing_(missing), missingValue_(missingValue) {
+
+    size_t byteSize = type_->size();
+    ASSERT(byteSize % sizeof(double) == 0);
+    value_.resize(std::max<size_t>(1, byteSize / sizeof(double)), 0);
+
+    ::memcpy(&value_[0], value, std::min(count, value_.size()) * sizeof(double));
+    hasMissingValue_ = hasMissingValue;
+}
+
 SQLExpressionEvaluated::~SQLExpressionEvaluated() {}
 
 void SQLExpressionEvaluated::print(std::ostream& o) const {
@@ -25,6 +25,11 @@ namespace eckit::sql::expression {
 class SQLExpressionEvaluated : public SQLExpression {
 public:
     SQLExpressionEvaluated(SQLExpression&);
+    /// An already evaluated value of the given expression (count doubles, zero padded to the type size)
+    SQLExpressionEvaluated(const SQLExpression&, const double* value, size_t count, bool missing);
+    /// As above, for a value of an expression that is no longer available
+    SQLExpressionEvaluated(const type::SQLType& type, const double* value, size_t count, bool missing,
+                           double missingValue, bool hasMissingValue);
     ~SQLExpressionEvaluated() override;
 
     // Overriden
@@ -68,6 +68,13 @@ protected:
     double eval(bool& missing) const override;
     void output(SQLOutput& s) const override;
 
+    // Shifted values depend on the order of evaluation
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override {
+        SQLExpression::evalBatch(batch, out, missing);
+    }
+    bool isBatchable() const override { return false; }
+    bool isVectorised() const override { return false; }
+
 private:
     ShiftedColumnExpression& operator=(const ShiftedColumnExpression&);
 
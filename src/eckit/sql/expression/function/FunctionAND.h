@@ -39,6 +39,8 @@ private:
 
     const eckit::sql::type::SQLType* type() const override;
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override { return argsVectorised(); }
     std::shared_ptr<SQLExpression> simplify(bool&) override;
     bool andSplit(expression::Expressions&) override;
 
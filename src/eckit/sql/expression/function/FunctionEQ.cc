@@ -9,6 +9,7 @@
  */
 
 #include "eckit/sql/expression/function/FunctionEQ.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/expression/ColumnExpression.h"
 #include "eckit/sql/expression/function/FunctionFactory.h"
 #include "eckit/sql/type/SQLType.h"
@@ -79,6 +80,30 @@ double FunctionEQ::eval(bool& missing) const {
     return equal(*args_[0], *args_[1], missing);
 }
 
+void FunctionEQ::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+
+    // Strings are trimmed and compared row by row
+
+    if (args_[0]->type()->getKind() == SQLType::stringType) {
+        SQLExpression::evalBatch(batch, out, missing);
+        return;
+    }
+
+    std::vector<std::vector<double>> a;
+    evalArgsBatch(batch, a, missing);
+
+    const double* lhs = a[0].data();
+    const double* rhs = a[1].data();
+
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        out[i] = (lhs[i] == rhs[i]);
+    }
+}
+
+bool FunctionEQ::isVectorised() const {
+    return args_[0]->type()->getKind() != SQLType::stringType && argsVectorised();
+}
+
 std::shared_ptr<SQLExpression> FunctionEQ::simplify(bool& changed) {
     std::shared_ptr<SQLExpression> x = FunctionExpression::simplify(changed);
     if (x) {
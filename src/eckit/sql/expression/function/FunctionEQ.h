@@ -40,6 +40,8 @@ private:
     // -- Overridden methods
     const eckit::sql::type::SQLType* type() const override;
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override;
     std::shared_ptr<SQLExpression> simplify(bool&) override;
 
     // -- Friends
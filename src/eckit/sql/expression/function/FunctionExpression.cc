@@ -10,6 +10,8 @@
 
 #include "eckit/sql/expression/function/FunctionExpression.h"
 
+#include "eckit/sql/SQLBatch.h"
+
 namespace eckit::sql::expression::function {
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -92,6 +94,43 @@ bool FunctionExpression::isConstant() const {
     return true;
 }
 
+bool FunctionExpression::argsVectorised() const {
+    for (const auto& arg : args_) {
+        if (!arg->isVectorised()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FunctionExpression::isBatchable() const {
+    for (expression::Expressions::const_iterator j = args_.begin(); j != args_.end(); ++j) {
+        if (!(*j)->isBatchable()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FunctionExpression::evalArgsBatch(const SQLBatch& batch, std::vector<std::vector<double>>& values,
+                                       uint8_t* missing) const {
+    size_t n = batch.size();
+    std::vector<uint8_t> m(n);
+
+    values.resize(args_.size());
+    for (size_t i = 0; i < n; ++i) {
+        missing[i] = 0;
+    }
+
+    for (size_t a = 0; a < args_.size(); ++a) {
+        values[a].resize(n);
+        args_[a]->evalBatch(batch, values[a].data(), m.data());
+        for (size_t i = 0; i < n; ++i) {
+            missing[i] |= m[i];
+        }
+    }
+}
+
 bool FunctionExpression::isAggregate() const {
     for (expression::Expressions::const_iterator j = args_.begin(); j != args_.end(); ++j) {
         if ((*j)->isAggregate()) {
@@ -33,6 +33,7 @@ public:
     void updateType(SQLSelect& sql) override;
     void cleanup(SQLSelect& sql) override;
     bool isConstant() const override;
+    bool isBatchable() const override;
     std::shared_ptr<SQLExpression> simplify(bool&) override;
 
     // double eval() const override;
@@ -42,6 +43,8 @@ public:
     const type::SQLType* type() const override;
     std::shared_ptr<SQLExpression> reshift(int minColumnShift) const override;
 
+    const std::string& name() const { return name_; }
+
     // For SQLSelectFactory (maybe it should just friend SQLSelectFactory).
     expression::Expressions& args() { return args_; }
 
@@ -52,6 +55,15 @@ protected:
     expression::Expressions args_;
     // void print(std::ostream&) const override;
 
+    // -- Methods
+
+    /// Evaluate all the arguments over a batch, one vector of values per argument. A row is
+    /// flagged missing if any of the arguments is missing.
+    void evalArgsBatch(const SQLBatch& batch, std::vector<std::vector<double>>& values, uint8_t* missing) const;
+
+    /// True if all of the arguments are vectorised (see SQLExpression::isVectorised)
+    bool argsVectorised() const;
+
     // -- Overridden methods
 
     void tables(std::set<const SQLTable*>&) override;
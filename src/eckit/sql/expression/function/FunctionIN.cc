@@ -9,8 +9,14 @@
  */
 
 #include "eckit/sql/expression/function/FunctionIN.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "eckit/sql/expression/function/FunctionEQ.h"
 #include "eckit/sql/expression/function/FunctionFactory.h"
+#include "eckit/sql/type/SQLType.h"
+#include "eckit/utils/StringTools.h"
 
 namespace eckit::sql::expression::function {
 
@@ -19,10 +25,14 @@ namespace eckit::sql::expression::function {
 static FunctionBuilder<FunctionIN> inFunctionBuilder("in");
 
 FunctionIN::FunctionIN(const std::string& name, const expression::Expressions& args) :
-    FunctionExpression(name, args), size_(args.size() - 1) {}
+    FunctionExpression(name, args), size_(args.size() - 1), hashed_(false), string_(false) {}
 
 FunctionIN::FunctionIN(const FunctionIN& other) :
-    FunctionExpression(other.name_, other.args_), size_(other.args_.size() - 1) {}
+    FunctionExpression(other.name_, other.args_),
+    size_(other.args_.size() - 1),
+    hashed_(other.hashed_),
+    string_(other.string_),
+    values_(other.values_) {}
 
 FunctionIN::~FunctionIN() {}
 
@@ -34,8 +44,96 @@ std::shared_ptr<SQLExpression> FunctionIN::clone() const {
     return std::make_shared<FunctionIN>(*this);
 }
 
+void FunctionIN::prepare(SQLSelect& sql) {
+    FunctionExpression::prepare(sql);
+
+    hashed_ = false;
+    for (size_t i = 0; i < size_; ++i) {
+        if (!args_[i]->isConstant()) {
+            return;
+        }
+    }
+
+    // Values are normalised as FunctionEQ compares them: strings trimmed, and -0.0 as 0.0. If any of
+    // them is missing, or not a number, the result depends on x, so they are compared one by one.
+
+    string_ = (args_[size_]->type()->getKind() == type::SQLType::stringType);
+
+    if (string_) {
+        std::vector<std::string> strings;
+        size_t width = 1;
+        for (size_t i = 0; i < size_; ++i) {
+            bool missing = false;
+            std::string value(StringTools::trim(args_[i]->evalAsString(missing), "\t\n\v\f\r "));
+            if (missing) {
+                return;
+            }
+            width = std::max(width, (value.size() + sizeof(double) - 1) / sizeof(double));
+            strings.emplace_back(std::move(value));
+        }
+
+        values_ = SQLKeySet({width});
+        key_.resize(width);
+        for (const std::string& value : strings) {
+            std::fill(key_.begin(), key_.end(), 0);
+            ::memcpy(key_.data(), value.data(), value.size());
+            values_.insert(key_.data());
+        }
+    }
+    else {
+        values_ = SQLKeySet({1});
+        for (size_t i = 0; i < size_; ++i) {
+            bool missing = false;
+            double value = args_[i]->eval(missing);
+            if (missing || value != value) {
+                return;
+            }
+            if (value == 0) {
+                value = 0;
+            }
+            values_.insert(&value);
+        }
+    }
+
+    hashed_ = true;
+}
+
 double FunctionIN::eval(bool& missing) const {
     const SQLExpression& x = *args_[size_];
+
+    if (hashed_) {
+        if (string_) {
+
+            // n.b. the width of x may change part way through a table
+
+            size_t width = std::max<size_t>(1, x.type()->size() / sizeof(double));
+            size_t size  = std::max(width, values_.width());
+            if (key_.size() < size) {
+                key_.resize(size);
+            }
+            std::fill(key_.begin(), key_.begin() + size, 0);
+
+            x.eval(key_.data(), missing);
+            if (missing) {
+                return false;
+            }
+
+            char* s = reinterpret_cast<char*>(key_.data());
+            SQLKeySet::trimString(s, width * sizeof(double));
+            return ::strnlen(s, width * sizeof(double)) <= values_.width() * sizeof(double)
+                   && values_.contains(key_.data());
+        }
+
+        double value = x.eval(missing);
+        if (missing) {
+            return false;
+        }
+        if (value == 0) {
+            value = 0;
+        }
+        return values_.contains(&value);
+    }
+
     for (size_t i = 0; i < size_; ++i) {
         if (FunctionEQ::equal(x, *args_[i], missing)) {
             return true;
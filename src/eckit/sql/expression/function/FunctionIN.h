@@ -14,10 +14,18 @@
 #ifndef FunctionIN_H
 #define FunctionIN_H
 
+#include <vector>
+
+#include "eckit/sql/SQLKeySet.h"
 #include "eckit/sql/expression/function/FunctionExpression.h"
 
 namespace eckit::sql::expression::function {
 
+/// x IN (a, b, ...), with x as the last argument.
+///
+/// If the list is made only of constants, it is put into a hash set when prepared, so that each row is
+/// checked with a single lookup. Otherwise x is compared against each of the values in turn.
+
 class FunctionIN : public FunctionExpression {
 public:
     FunctionIN(const std::string&, const expression::Expressions&);
@@ -28,14 +36,21 @@ public:
 
     static int arity() { return -1; }
 
+protected:
+    const eckit::sql::type::SQLType* type() const override;
+    void prepare(SQLSelect& sql) override;
+    double eval(bool& missing) const override;
+
 private:
     // No copy allowed
     FunctionIN& operator=(const FunctionIN&);
 
     size_t size_;
 
-    const eckit::sql::type::SQLType* type() const override;
-    double eval(bool& missing) const override;
+    bool hashed_;  // are the values held in values_
+    bool string_;  // are they held as trimmed strings
+    SQLKeySet values_;
+    mutable std::vector<double> key_;
 
     // -- Friends
     // friend std::ostream& operator<<(std::ostream& s,const FunctionIN& p)
@@ -9,6 +9,7 @@
  */
 
 #include "eckit/sql/expression/function/FunctionJOIN.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/expression/ColumnExpression.h"
 #include "eckit/sql/expression/function/FunctionFactory.h"
 
@@ -38,4 +39,17 @@ double FunctionJOIN::eval(bool& missing) const {
     return args_[0]->eval(missing) == args_[1]->eval(missing);
 }
 
+void FunctionJOIN::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+
+    std::vector<std::vector<double>> a;
+    evalArgsBatch(batch, a, missing);
+
+    const double* lhs = a[0].data();
+    const double* rhs = a[1].data();
+
+    for (size_t i = 0, n = batch.size(); i < n; ++i) {
+        out[i] = (lhs[i] == rhs[i]);
+    }
+}
+
 }  // namespace eckit::sql::expression::function
@@ -39,6 +39,8 @@ private:
     // -- Overridden methods
     const eckit::sql::type::SQLType* type() const override;
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override;
 
     // -- Friends
     // friend std::ostream& operator<<(std::ostream& s,const FunctionNE& p)
@@ -9,7 +9,6 @@
  */
 
 #include "eckit/sql/expression/function/FunctionNOT_IN.h"
-#include "eckit/sql/expression/function/FunctionEQ.h"
 #include "eckit/sql/expression/function/FunctionFactory.h"
 
 namespace eckit::sql::expression::function {
@@ -19,10 +18,10 @@ namespace eckit::sql::expression::function {
 static FunctionBuilder<FunctionNOT_IN> not_inFunctionBuilder("not_in");
 
 FunctionNOT_IN::FunctionNOT_IN(const std::string& name, const expression::Expressions& args) :
-    FunctionExpression(name, args), size_(args.size() - 1) {}
+    FunctionIN(name, args) {}
 
 FunctionNOT_IN::FunctionNOT_IN(const FunctionNOT_IN& other) :
-    FunctionExpression(other.name_, other.args_), size_(other.args_.size() - 1) {}
+    FunctionIN(other) {}
 
 FunctionNOT_IN::~FunctionNOT_IN() {}
 
@@ -35,15 +34,7 @@ const type::SQLType* FunctionNOT_IN::type() const {
 }
 
 double FunctionNOT_IN::eval(bool& missing) const {
-    const SQLExpression& x = *args_[size_];
-    for (int i = 0; i < size_; ++i) {
-        args_[i]->eval(missing);
-        if (FunctionEQ::equal(x, *args_[i], missing)) {
-            return false;
-        }
-    }
-
-    return true;
+    return !FunctionIN::eval(missing);
 }
 
 }  // namespace eckit::sql::expression::function
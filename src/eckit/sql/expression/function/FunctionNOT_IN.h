@@ -14,11 +14,13 @@
 #ifndef FunctionNOT_IN_H
 #define FunctionNOT_IN_H
 
-#include "eckit/sql/expression/function/FunctionExpression.h"
+#include "eckit/sql/expression/function/FunctionIN.h"
 
 namespace eckit::sql::expression::function {
 
-class FunctionNOT_IN : public FunctionExpression {
+/// x NOT IN (a, b, ...). See FunctionIN.
+
+class FunctionNOT_IN : public FunctionIN {
 public:
     FunctionNOT_IN(const std::string&, const expression::Expressions&);
     FunctionNOT_IN(const FunctionNOT_IN&);
@@ -32,8 +34,6 @@ private:
     // No copy allowed
     FunctionNOT_IN& operator=(const FunctionNOT_IN&);
 
-    int size_;
-
     // -- Overridden methods
     const eckit::sql::type::SQLType* type() const override;
     double eval(bool& missing) const override;
@@ -9,6 +9,7 @@
  */
 
 #include "eckit/sql/expression/function/FunctionNULL.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/expression/function/FunctionFactory.h"
 
 namespace eckit::sql::expression::function {
@@ -41,4 +42,18 @@ double FunctionNULL::eval(bool&) const {
     return missing;
 }
 
+// Don't set the missing flags
+void FunctionNULL::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+
+    size_t n = batch.size();
+    std::vector<uint8_t> m(n);
+
+    args_[0]->evalBatch(batch, out, m.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i]     = m[i];
+        missing[i] = 0;
+    }
+}
+
 }  // namespace eckit::sql::expression::function
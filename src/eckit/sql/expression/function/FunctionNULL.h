@@ -35,6 +35,8 @@ private:
 
     // -- Overridden methods
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override { return argsVectorised(); }
     // -- Friends
     // friend std::ostream& operator<<(std::ostream& s,const FunctionNULL& p)
     //	{ p.print(s); return s; }
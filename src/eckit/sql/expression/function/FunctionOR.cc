@@ -9,6 +9,7 @@
  */
 
 #include "eckit/sql/expression/function/FunctionOR.h"
+#include "eckit/sql/SQLBatch.h"
 #include "eckit/sql/expression/function/FunctionFactory.h"
 
 namespace eckit::sql::expression::function {
@@ -37,6 +38,25 @@ double FunctionOR::eval(bool& missing) const {
     return args_[0]->eval(missing) || args_[1]->eval(missing);
 }
 
+// n.b. eval() short-circuits, so the missing flag of the second argument only counts where the
+//      first argument is false
+
+void FunctionOR::evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const {
+
+    size_t n = batch.size();
+    std::vector<double> rhs(n);
+    std::vector<uint8_t> rhsMissing(n);
+
+    args_[0]->evalBatch(batch, out, missing);
+    args_[1]->evalBatch(batch, rhs.data(), rhsMissing.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        bool lhs   = (out[i] != 0);
+        missing[i] = missing[i] | (!lhs && rhsMissing[i]);
+        out[i]     = lhs || (rhs[i] != 0);
+    }
+}
+
 std::shared_ptr<SQLExpression> FunctionOR::simplify(bool& changed) {
     std::shared_ptr<SQLExpression> x = FunctionExpression::simplify(changed);
     if (x) {
@@ -28,6 +28,8 @@ public:
     std::shared_ptr<SQLExpression> clone() const override;
 
     double eval(bool& missing) const override;
+    void evalBatch(const SQLBatch& batch, double* out, uint8_t* missing) const override;
+    bool isVectorised() const override { return argsVectorised(); }
     const eckit::sql::type::SQLType* type() const override;
     std::shared_ptr<SQLExpression> simplify(bool&) override;
 
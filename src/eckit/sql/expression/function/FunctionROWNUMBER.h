@@ -39,6 +39,7 @@ protected:
     bool isConstant() const override;
     void partialResult() override;
     double eval(bool& missing) const override;
+    bool isBatchable() const override { return false; }
     std::shared_ptr<SQLExpression> simplify(bool&) override;
     bool isAggregate() const override { return false; }
 
@@ -38,6 +38,7 @@ protected:
     void cleanup(SQLSelect&) override;
     bool isConstant() const override;
     double eval(bool& missing) const override;
+    bool isBatchable() const override { return false; }
     std::shared_ptr<SQLExpression> simplify(bool&) override;
     bool isAggregate() const override { return false; }
 
@@ -123,6 +123,7 @@ Expressions emptyExpressionList;
 
 %token ASC
 %token DESC
+%token LIMIT
 
 %token HASH
 %token LIKE
@@ -146,6 +147,7 @@ Expressions emptyExpressionList;
 
 %type <orderlist> order_by order_list;
 %type <orderexp> order;
+%type <num> limit;
 
 %type <explist> select_list select_list_;
 %type <exp> select select_;
@@ -431,7 +433,7 @@ default_value: DEFAULT expression { std::shared_ptr<SQLExpression> e($2); $$ = e
 //create_view_statement: CREATE VIEW IDENT AS select_statement { $$ = $5; }
 //	;
 
-select_statement: SELECT distinct select_list into from where group_by order_by
+select_statement: SELECT distinct select_list into from where group_by order_by limit
                 {
                     bool                                          distinct($2);
                     Expressions                                   select_list($3);
@@ -440,9 +442,10 @@ select_statement: SELECT distinct select_list into from where group_by order_by
                     std::shared_ptr<SQLExpression>                where($6);
                     Expressions                                   group_by($7);
                     std::pair<Expressions,std::vector<bool>>      order_by($8);
+                    size_t                                        limit($9);
 
                     session->setStatement(
-                        session->selectFactory().create(distinct, select_list, into, from, where, group_by, order_by)
+                        session->selectFactory().create(distinct, select_list, into, from, where, group_by, order_by, limit)
                     );
                 }
                 ;
@@ -594,6 +597,12 @@ order_list : order                  { $$ = std::make_pair(Expressions(), std::ve
            | order_list ',' order   { $$ = $1; $$.first.push_back($3.first); $$.second.push_back($3.second); }
            ;
 
+/* n.b. LIMIT is only recognised after ORDER BY, followed by a number, so only an ordered select may be limited */
+
+limit : LIMIT DOUBLE { if ($2 < 1 || $2 != std::floor($2)) { throw eckit::UserError("LIMIT must be a positive integer"); } $$ = $2; }
+      |              { $$ = 0; }
+      ;
+
 order : expression DESC      { $$ = std::make_pair($1, false); }
       | expression ASC       { $$ = std::make_pair($1, true); }
       | expression			 { $$ = std::make_pair($1, true); }
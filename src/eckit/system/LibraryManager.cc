@@ -13,14 +13,17 @@
 
 #include <algorithm>
 #include <cctype>
+#include <ctime>
 #include <map>
 
 #include <dlfcn.h>   // for dlopen
 #include <limits.h>  // for PATH_MAX
+#include <unistd.h>  // for getpid
 
 #include "eckit/system/LibraryManager.h"
 
 
+#include "eckit/bases/Loader.h"
 #include "eckit/config/LocalConfiguration.h"
 #include "eckit/config/Resource.h"
 #include "eckit/config/YAMLConfiguration.h"
@@ -31,12 +34,17 @@
 #include "eckit/log/Log.h"
 #include "eckit/log/OStreamTarget.h"
 #include "eckit/log/PrefixTarget.h"
+#include "eckit/log/Timer.h"
 #include "eckit/os/System.h"
+#include "eckit/serialisation/FileStream.h"
 #include "eckit/system/Library.h"
 #include "eckit/system/Plugin.h"
+#include "eckit/system/StartupReport.h"
 #include "eckit/system/SystemInfo.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Mutex.h"
+#include "eckit/utils/MD5.h"
+#include "eckit/utils/StringTools.h"
 #include "eckit/utils/Tokenizer.h"
 #include "eckit/utils/Translator.h"
 
@@ -60,6 +68,161 @@ static std::string path_from_libhandle(const std::string& libname, void* handle)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// What a plugin manifest declares
+struct PluginManifest {
+    std::string name_;
+    std::string namespace_;
+    std::string library_;
+    std::vector<std::string> factories_;  //< Builders the plugin provides, so that it can be loaded when first used
+
+    std::string fullName() const { return namespace_ + "." + name_; }
+};
+
+/// Binary copy of the manifests found in a list of directories, valid as long as none of the directories has been
+/// modified since it was written.
+///
+/// The cache is kept in pluginManifestCache ($PLUGINS_MANIFEST_CACHE), by default ~/.cache/eckit, with one file per
+/// list of directories; "off" disables it. Note that a manifest edited in place does not change the modification time
+/// of its directory, unlike one that is added, removed or replaced.
+class ManifestCache {
+public:
+    explicit ManifestCache(const std::vector<LocalPathName>& dirs) {
+        static std::string directory = Resource<std::string>("$PLUGINS_MANIFEST_CACHE;pluginManifestCache", "");
+
+        std::string cache = directory;
+        if (cache.empty()) {
+            const char* home = ::getenv("HOME");
+            if (home == nullptr) {
+                return;
+            }
+            cache = std::string(home) + "/.cache/eckit";
+        }
+        if (cache == "off") {
+            return;
+        }
+
+        MD5 md5;
+        for (const auto& dir : dirs) {
+            const std::string& name = dir;
+            md5.add(name);
+            stamps_.emplace_back(name, static_cast<long long>(dir.lastModified()));
+        }
+        path_ = cache + "/plugin-manifests-" + md5.digest() + ".cache";
+    }
+
+    bool read(std::map<std::string, PluginManifest>& manifests) const {
+        if (path_.empty() || !LocalPathName(path_).exists()) {
+            return false;
+        }
+
+        bool valid = false;
+        try {
+            FileStream s(path_, "r");
+            try {
+                valid = read(s, manifests);
+            }
+            catch (...) {
+                s.close();
+                throw;
+            }
+            s.close();
+        }
+        catch (Exception& e) {
+            Log::debug() << "Ignoring plugin manifests cache " << path_ << ": " << e.what() << std::endl;
+            valid = false;
+        }
+
+        if (!valid) {
+            manifests.clear();
+            return false;
+        }
+
+        Log::debug() << "Read " << manifests.size() << " plugin manifests from " << path_ << std::endl;
+        return true;
+    }
+
+    void write(const std::map<std::string, PluginManifest>& manifests) const {
+        if (path_.empty()) {
+            return;
+        }
+
+        // A directory modified within the last second may be modified again without its time changing
+        const long long now = ::time(nullptr);
+        for (const auto& stamp : stamps_) {
+            if (stamp.second >= now - 1) {
+                return;
+            }
+        }
+
+        try {
+            LocalPathName path(path_);
+            path.dirName().mkdir();
+
+            LocalPathName tmp(path_ + "." + std::to_string(::getpid()));
+            {
+                FileStream s(tmp, "w");
+                s << version() << static_cast<unsigned long>(stamps_.size());
+                for (const auto& stamp : stamps_) {
+                    s << stamp.first << stamp.second;
+                }
+                s << static_cast<unsigned long>(manifests.size());
+                for (const auto& kv : manifests) {
+                    const PluginManifest& m = kv.second;
+                    s << m.name_ << m.namespace_ << m.library_ << static_cast<unsigned long>(m.factories_.size());
+                    for (const auto& factory : m.factories_) {
+                        s << factory;
+                    }
+                }
+                s.close();
+            }
+            LocalPathName::rename(tmp, path);
+        }
+        catch (Exception& e) {
+            Log::debug() << "Cannot write plugin manifests cache " << path_ << ": " << e.what() << std::endl;
+        }
+    }
+
+private:
+    static const char* version() { return "eckit-plugin-manifests-1"; }
+
+    bool read(Stream& s, std::map<std::string, PluginManifest>& manifests) const {
+        std::string magic;
+        unsigned long n;
+        s >> magic >> n;
+        if (magic != version() || n != stamps_.size()) {
+            return false;
+        }
+
+        for (const auto& stamp : stamps_) {
+            std::string dir;
+            long long mtime;
+            s >> dir >> mtime;
+            if (dir != stamp.first || mtime != stamp.second) {
+                Log::debug() << "Plugin manifests cache " << path_ << " is out of date" << std::endl;
+                return false;
+            }
+        }
+
+        s >> n;
+        for (unsigned long i = 0; i < n; ++i) {
+            PluginManifest m;
+            unsigned long f;
+            s >> m.name_ >> m.namespace_ >> m.library_ >> f;
+            m.factories_.resize(f);
+            for (auto& factory : m.factories_) {
+                s >> factory;
+            }
+            manifests.emplace(m.fullName(), m);
+        }
+        return true;
+    }
+
+    std::string path_;  //< empty if disabled
+    std::vector<std::pair<std::string, long long>> stamps_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /// Registry for all libraries
 ///
 class LibraryRegistry {
@@ -276,8 +439,8 @@ public:  // methods
         }
     }
 
-    std::map<std::string, LocalConfiguration> scanManifestPaths() {
-        std::map<std::string, LocalConfiguration> manifests;
+    std::map<std::string, PluginManifest> scanManifestPaths() {
+        std::map<std::string, PluginManifest> manifests;
 
         static std::string pluginManifestPath = Resource<std::string>("$PLUGINS_MANIFEST_PATH;pluginManifestPath", "");
 
@@ -291,6 +454,7 @@ public:  // methods
 
         Log::debug() << "Plugins manifest candidate paths " << scanPaths << std::endl;
 
+        std::vector<LocalPathName> dirs;
         std::set<LocalPathName> visited;  //< we dont visit same path twice
 
         for (auto& path : scanPaths) {
@@ -307,14 +471,25 @@ public:  // methods
             }
 
             visited.insert(realdir);
+            dirs.push_back(realdir);
 
-            Log::debug() << "Scanning for plugins manifest path " << path << " resolved to " << realdir << std::endl;
+            Log::debug() << "Plugins manifest path " << path << " resolved to " << realdir << std::endl;
+        }
+
+        ManifestCache cache(dirs);
+        if (cache.read(manifests)) {
+            return manifests;
+        }
+
+        for (const auto& realdir : dirs) {
+
+            Log::debug() << "Scanning for plugins manifest path " << realdir << std::endl;
 
             // scan the manifests to discover the plugins and their respective libraries
 
             std::vector<LocalPathName> files;
-            std::vector<LocalPathName> dirs;
-            realdir.children(files, dirs);
+            std::vector<LocalPathName> subdirs;
+            realdir.children(files, subdirs);
             for (const auto& p : files) {
                 PathName path(p);
                 Log::debug() << "Found plugin manifest " << path << std::endl;
@@ -322,11 +497,16 @@ public:  // methods
                 if (conf.has("plugin")) {
                     LocalConfiguration manifest = conf.getSubConfiguration("plugin");
                     Log::debug() << "Loaded plugin manifest " << manifest << std::endl;
-                    std::string name              = manifest.getString("name");
-                    std::string namespce          = manifest.getString("namespace");
-                    std::string fullQualifiedName = namespce + "." + name;
+
+                    PluginManifest m;
+                    m.name_      = manifest.getString("name");
+                    m.namespace_ = manifest.getString("namespace");
+                    m.library_   = manifest.getString("library");
+                    m.factories_ = manifest.getStringVector("factories", {});
+
+                    std::string fullQualifiedName = m.fullName();
                     if (manifests.find(fullQualifiedName) == manifests.end()) {
-                        manifests[fullQualifiedName] = manifest;
+                        manifests[fullQualifiedName] = m;
                     }
                     else {
                         Log::debug() << "The plugin " << fullQualifiedName
@@ -335,19 +515,27 @@ public:  // methods
                 }
             }
         }
+
+        cache.write(manifests);
         return manifests;
     }
 
 
     void autoLoadPlugins(const std::vector<std::string>& inlist) {
 
+        // Plugins that declare the builders they provide are loaded on first use of one of them, unless requested
+        static bool lazyPlugins = Resource<bool>("$LAZY_PLUGINS;lazyPlugins", true);
+
         std::vector<std::string> plugins = inlist;
 
         AutoLock<Mutex> lockme(mutex_);
 
-        std::map<std::string, LocalConfiguration> manifests = scanManifestPaths();
+        Timer timer;
+        std::map<std::string, PluginManifest> manifests = scanManifestPaths();
+        StartupReport::instance().add("plugins", "manifests", timer.elapsed());
 
         // if no plugins configured we load all what was found in the manifests
+        bool lazy = lazyPlugins && plugins.empty();
         if (plugins.empty()) {
             for (const auto& kv : manifests) {
                 plugins.push_back(kv.first);
@@ -359,13 +547,25 @@ public:  // methods
         // loop over full qualified plugin names
         for (const auto& fqname : plugins) {
             if (manifests.find(fqname) != manifests.end()) {
-                LocalConfiguration manifest   = manifests[fqname];
-                std::string name              = manifest.getString("name");
-                std::string namespce          = manifest.getString("namespace");
-                std::string fullQualifiedName = namespce + "." + name;
-                ASSERT(fqname == fullQualifiedName);
-                std::string lib = manifest.getString("library");
-                Plugin& plugin  = loadPlugin(name, lib);
+                const PluginManifest& manifest = manifests[fqname];
+                ASSERT(fqname == manifest.fullName());
+
+                if (lazy && !manifest.factories_.empty() && !is_plugin_initialized_[manifest.name_]) {
+                    Log::debug() << "Deferring plugin " << fqname << " until first use of " << manifest.factories_
+                                 << std::endl;
+                    for (const auto& factory : manifest.factories_) {
+                        auto& v = deferred_[StringTools::lower(factory)];
+                        if (std::none_of(v.begin(), v.end(),
+                                         [&](const PluginManifest& m) { return m.fullName() == fqname; })) {
+                            v.push_back(manifest);
+                        }
+                    }
+                    continue;
+                }
+
+                Timer load;
+                loadPlugin(manifest.name_, manifest.library_);
+                StartupReport::instance().add("plugins", fqname, load.elapsed());
             }
             else {
                 Log::warning() << "Could not find manifest file for plugin " << fqname << std::endl;
@@ -373,6 +573,84 @@ public:  // methods
         }
     }
 
+    bool loadPluginsFor(const std::string& builder) {
+        AutoLock<Mutex> lockme(mutex_);
+
+        auto j = deferred_.find(StringTools::lower(builder));
+        if (j == deferred_.end()) {
+            return false;
+        }
+
+        std::vector<PluginManifest> manifests;
+        manifests.swap(j->second);
+        deferred_.erase(j);
+
+        for (const auto& manifest : manifests) {
+            // A plugin declaring several builders is deferred once for each
+            for (auto& d : deferred_) {
+                auto& v = d.second;
+                v.erase(std::remove_if(v.begin(), v.end(),
+                                       [&](const PluginManifest& m) { return m.fullName() == manifest.fullName(); }),
+                        v.end());
+            }
+
+            Log::debug() << "Loading plugin " << manifest.fullName() << " on first use of " << builder << std::endl;
+
+            Timer timer;
+            loadPlugin(manifest.name_, manifest.library_);
+            StartupReport::instance().add("plugins", manifest.fullName() + " (on use of " + builder + ")",
+                                          timer.elapsed());
+        }
+
+        for (auto d = deferred_.begin(); d != deferred_.end();) {
+            d = d->second.empty() ? deferred_.erase(d) : std::next(d);
+        }
+        return true;
+    }
+
+    bool loadDeferredPlugins() {
+        AutoLock<Mutex> lockme(mutex_);
+
+        // A plugin declaring several builders is deferred once for each
+        std::map<std::string, PluginManifest> manifests;
+        for (const auto& d : deferred_) {
+            for (const auto& m : d.second) {
+                manifests.emplace(m.fullName(), m);
+            }
+        }
+        deferred_.clear();
+
+        for (const auto& kv : manifests) {
+            const PluginManifest& manifest = kv.second;
+
+            Log::debug() << "Loading deferred plugin " << manifest.fullName() << std::endl;
+
+            Timer timer;
+            try {
+                loadPlugin(manifest.name_, manifest.library_);
+            }
+            catch (std::exception& e) {
+                Log::warning() << "Could not load deferred plugin " << manifest.fullName() << ": " << e.what()
+                               << std::endl;
+                continue;
+            }
+            StartupReport::instance().add("plugins", manifest.fullName() + " (deferred)", timer.elapsed());
+        }
+
+        return !manifests.empty();
+    }
+
+    std::vector<std::string> deferredPlugins() const {
+        AutoLock<Mutex> lockme(mutex_);
+        std::set<std::string> names;
+        for (const auto& d : deferred_) {
+            for (const auto& m : d.second) {
+                names.insert(m.fullName());
+            }
+        }
+        return std::vector<std::string>(names.begin(), names.end());
+    }
+
 
     void enregisterPlugin(const std::string& name, const std::string& libname) {
         AutoLock<Mutex> lockme(mutex_);
@@ -394,6 +672,7 @@ private:  // members
     LibraryMap libs_;
     std::map<std::string, std::string> plugins_;  //< map plugin name to library
     std::map<std::string, bool> is_plugin_initialized_;
+    std::map<std::string, std::vector<PluginManifest>> deferred_;  //< plugins to load on first use of a builder
     mutable Mutex mutex_;
 };
 
@@ -432,7 +711,10 @@ const Plugin& LibraryManager::lookupPlugin(const std::string& name) {
 }
 
 void* LibraryManager::loadLibrary(const std::string& libname) {
-    return LibraryRegistry::instance().loadDynamicLibrary(libname);
+    Timer timer;
+    void* handle = LibraryRegistry::instance().loadDynamicLibrary(libname);
+    StartupReport::instance().add("libraries", libname, timer.elapsed());
+    return handle;
 }
 
 Plugin& LibraryManager::loadPlugin(const std::string& name, const std::string& lib) {
@@ -443,6 +725,27 @@ void LibraryManager::autoLoadPlugins(const std::vector<std::string>& plugins) {
     LibraryRegistry::instance().autoLoadPlugins(plugins);
 }
 
+bool LibraryManager::loadPluginsFor(const std::string& builder) {
+    if (!LibraryRegistry::instance().loadPluginsFor(builder)) {
+        return false;
+    }
+    // Main has already executed the Loaders it found
+    Loader::executePending();
+    return true;
+}
+
+bool LibraryManager::loadDeferredPlugins() {
+    if (!LibraryRegistry::instance().loadDeferredPlugins()) {
+        return false;
+    }
+    Loader::executePending();
+    return true;
+}
+
+std::vector<std::string> LibraryManager::deferredPlugins() {
+    return LibraryRegistry::instance().deferredPlugins();
+}
+
 void LibraryManager::enregisterPlugin(const std::string& name, const std::string& libname) {
     LibraryRegistry::instance().enregisterPlugin(name, libname);
 }
@@ -70,9 +70,25 @@ public:  // class methods
     static Plugin& loadPlugin(const std::string& name, const std::string& library = std::string());
 
     /// @brief Scans and Auto loads Plugins
-    /// @param [in] dir path to scan for plugin manifests
+    ///        If no plugins are given, those whose manifest lists the builders they provide (key 'factories') are only
+    ///        loaded on first use of one of these builders, see loadPluginsFor(), unless lazyPlugins is false
+    /// @param [in] plugins full qualified names of the plugins to load, or empty for all those found
     static void autoLoadPlugins(const std::vector<std::string>& plugins);
 
+    /// @brief Loads the deferred plugins providing a builder, for factories not finding it,
+    ///        then executes the Loaders they created
+    /// @param [in] builder Name of the builder, case insensitive
+    /// @returns true if plugins were loaded
+    static bool loadPluginsFor(const std::string& builder);
+
+    /// @brief Loads all the deferred plugins, for factories listing their builders,
+    ///        then executes the Loaders they created. Plugins that fail to load are reported, and skipped.
+    /// @returns true if plugins were loaded
+    static bool loadDeferredPlugins();
+
+    /// @brief List plugins whose loading is deferred until first use
+    static std::vector<std::string> deferredPlugins();
+
     /// @brief Registers a library as a plugin
     ///        To be called from the Plugin constructor
     /// @param [in] name Name of the library plugin to register
@@ -0,0 +1,88 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#include "eckit/system/StartupReport.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit::system {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+StartupReport& StartupReport::instance() {
+    static StartupReport report;
+    return report;
+}
+
+void StartupReport::add(const std::string& category, const std::string& step, double seconds) {
+    AutoLock<Mutex> lock(mutex_);
+    steps_.push_back({category, step, seconds});
+}
+
+double StartupReport::total(const std::string& category) const {
+    AutoLock<Mutex> lock(mutex_);
+    double total = 0;
+    for (const auto& s : steps_) {
+        if (category.empty() || s.category_ == category) {
+            total += s.seconds_;
+        }
+    }
+    return total;
+}
+
+void StartupReport::print(std::ostream& out) const {
+    AutoLock<Mutex> lock(mutex_);
+
+    std::vector<std::string> categories;
+    size_t width = 0;
+    for (const auto& s : steps_) {
+        if (std::find(categories.begin(), categories.end(), s.category_) == categories.end()) {
+            categories.push_back(s.category_);
+        }
+        width = std::max(width, s.step_.size());
+    }
+
+    auto seconds = [](double t) {
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(3) << t << "s";
+        return s.str();
+    };
+
+    double total = 0;
+    for (const auto& s : steps_) {
+        total += s.seconds_;
+    }
+
+    out << "Startup " << seconds(total) << std::endl;
+    for (const auto& category : categories) {
+        double sum = 0;
+        for (const auto& s : steps_) {
+            if (s.category_ == category) {
+                sum += s.seconds_;
+            }
+        }
+        out << "  " << std::setw(int(width) + 2) << std::left << category << std::right << std::setw(10) << seconds(sum)
+            << std::endl;
+        for (const auto& s : steps_) {
+            if (s.category_ == category) {
+                out << "    " << std::setw(int(width)) << std::left << s.step_ << std::right << std::setw(10)
+                    << seconds(s.seconds_) << std::endl;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::system
@@ -0,0 +1,64 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit::system {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Time spent starting the process, by category ("resources", "libraries", "plugins", "loaders") and step.
+///
+/// Main prints it when startupReport ($ECKIT_STARTUP_REPORT) is set. Plugins loaded later, on first use of one of
+/// their factories, are added as they are loaded.
+
+class StartupReport : private NonCopyable {
+public:  // methods
+    static StartupReport& instance();
+
+    void add(const std::string& category, const std::string& step, double seconds);
+
+    /// @returns the time spent in a category, or in all of them
+    double total(const std::string& category = std::string()) const;
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const StartupReport& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // types
+    struct Step {
+        std::string category_;
+        std::string step_;
+        double seconds_;
+    };
+
+private:  // methods
+    StartupReport() = default;
+
+private:  // members
+    mutable Mutex mutex_;
+    std::vector<Step> steps_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::system
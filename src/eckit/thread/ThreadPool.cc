@@ -12,6 +12,7 @@
 // Baudouin Raoult - (c) ECMWF Feb 12
 
 #include "eckit/thread/ThreadPool.h"
+#include "eckit/log/Tracer.h"
 #include "eckit/runtime/Monitor.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Thread.h"
@@ -53,6 +54,7 @@ void ThreadPoolThread::run() {
 
 
         try {
+            ECKIT_TRACE_SPAN("ThreadPoolTask::execute", "thread");
             r->execute();
         }
         catch (std::exception& e) {
@@ -135,6 +137,7 @@ void ThreadPool::notifyEnd() {
 void ThreadPool::startTask() {
     AutoLock<MutexCond> lock(active_);
     tasks_++;
+    ECKIT_TRACE_COUNTER("ThreadPool::tasks", "thread", tasks_);
     active_.signal();
     // Log::info() << "ThreadPool::notifyStart " << name_ << " running: " << running_ << std::endl;
 }
@@ -142,6 +145,7 @@ void ThreadPool::startTask() {
 void ThreadPool::endTask() {
     AutoLock<MutexCond> lock(active_);
     tasks_--;
+    ECKIT_TRACE_COUNTER("ThreadPool::tasks", "thread", tasks_);
     active_.signal();
     // Log::info() << "ThreadPool::notifyStart " << name_ << " running: " << running_ << std::endl;
 }
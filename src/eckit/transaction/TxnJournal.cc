@@ -0,0 +1,481 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/transaction/TxnJournal.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FDataSync.h"
+#include "eckit/log/Log.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const uint32_t MAGIC = 0x4a4e5854;  // "TXNJ"
+
+/// The frame of a record, followed by the state of the transaction (length_ bytes). The checksum covers
+/// the fields that follow it, and the state.
+
+struct Header {
+    uint32_t magic_;
+    uint32_t length_;
+    uint32_t crc_;
+    uint32_t operation_;
+    uint64_t id_;
+    int64_t created_;
+};
+
+static_assert(sizeof(Header) == 32, "TxnJournal: unexpected padding of the record header");
+
+const size_t CHECKED = sizeof(Header) - offsetof(Header, operation_);
+
+uint32_t crc32(uint32_t crc, const void* data, size_t length) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc           = ~crc;
+    while (length--) {
+        crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t checksum(const Header& header, const void* state, size_t length) {
+    uint32_t crc = crc32(0, &header.operation_, CHECKED);
+    return crc32(crc, state, length);
+}
+
+void encode(std::string& out, TxnJournal::Operation operation, TxnID id, time_t created, const void* state,
+            size_t length) {
+    Header header;
+    header.magic_     = MAGIC;
+    header.length_    = length;
+    header.operation_ = operation;
+    header.id_        = id;
+    header.created_   = created;
+    header.crc_       = checksum(header, state, length);
+
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(static_cast<const char*>(state), length);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TxnJournal::TxnJournal(const PathName& directory) :
+    directory_(directory),
+    lock_(-1),
+    lastID_(0),
+    appended_(0),
+    committed_(0),
+    committing_(false),
+    failed_(false),
+    first_(0),
+    current_(0),
+    fd_(-1),
+    size_(0),
+    segmentSize_(Resource<size_t>("txnJournalSegmentSize;$ECKIT_TXN_JOURNAL_SEGMENT_SIZE", 64 * 1024 * 1024)),
+    maxSegments_(Resource<size_t>("txnJournalSegments;$ECKIT_TXN_JOURNAL_SEGMENTS", 4)) {
+
+    ASSERT(maxSegments_ > 0);
+
+    directory_.mkdir();
+    lock();
+
+    try {
+        recover();
+    }
+    catch (...) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        ::close(lock_);
+        throw;
+    }
+}
+
+TxnJournal::~TxnJournal() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    ::close(lock_);
+}
+
+void TxnJournal::lock() {
+
+    // n.b. flock() locks are held by the open file, so a second open in this process fails too
+
+    PathName path(directory_ + "/journal.lock");
+    SYSCALL2(lock_ = ::open(path.localPath(), O_RDWR | O_CREAT | O_CLOEXEC, 0644), path);
+
+    if (::flock(lock_, LOCK_EX | LOCK_NB) < 0) {
+        int error = errno;
+        ::close(lock_);
+        if (error == EWOULDBLOCK) {
+            throw UserError("TxnJournal: " + directory_ + " is already open, by this or another process");
+        }
+        throw FailedSystemCall(path, "flock", Here(), error);
+    }
+}
+
+void TxnJournal::recover() {
+
+    std::vector<PathName> files;
+    PathName::match(directory_ + "/[0-9]*.wal", files);
+
+    std::vector<unsigned long> segments;
+    for (const PathName& file : files) {
+        segments.push_back(std::strtoul(file.baseName(false).localPath(), nullptr, 10));
+    }
+    std::sort(segments.begin(), segments.end());
+
+    if (segments.empty()) {
+        first_ = current_ = 1;
+        open(current_);
+        return;
+    }
+
+    // Recovery: replay the segments in order
+
+    first_   = segments.front();
+    current_ = segments.back();
+
+    for (unsigned long s : segments) {
+
+        PathName path(segment(s));
+        size_t valid = scan(s);
+        size_t size  = path.size();
+
+        if (valid < size) {
+            if (s == current_) {
+                Log::warning() << "TxnJournal: truncating " << path << " to " << valid << " bytes, after an incomplete"
+                               << " record" << std::endl;
+                SYSCALL2(::truncate(path.localPath(), valid), path);
+            }
+            else {
+                Log::error() << "TxnJournal: " << path << " is corrupt after " << valid << " bytes, "
+                             << (size - valid) << " bytes ignored" << std::endl;
+            }
+        }
+    }
+
+    open(current_);
+
+    LOG_DEBUG_LIB(LibEcKit) << "TxnJournal: " << directory_ << " recovered, " << active_.size()
+                            << " active transaction(s) in " << segments.size() << " segment(s)" << std::endl;
+}
+
+PathName TxnJournal::segment(unsigned long n) const {
+    std::ostringstream s;
+    s << std::setfill('0') << std::setw(10) << n << ".wal";
+    return directory_ + "/" + s.str();
+}
+
+void TxnJournal::open(unsigned long n) {
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    PathName path(segment(n));
+    bool created = !path.exists();
+
+    SYSCALL2(fd_ = ::open(path.localPath(), O_WRONLY | O_CREAT | O_APPEND, 0644), path);
+    size_ = path.size();
+
+    // The new segment itself must be durable before any record in it is
+
+    if (created) {
+        path.syncParentDirectory();
+    }
+}
+
+size_t TxnJournal::scan(unsigned long n) {
+
+    // Returns the size of the valid records at the start of the segment
+
+    PathName path(segment(n));
+
+    int fd;
+    SYSCALL2(fd = ::open(path.localPath(), O_RDONLY), path);
+
+    std::string data(path.size(), 0);
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t len = ::read(fd, &data[done], data.size() - done);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            break;
+        }
+        done += len;
+    }
+    ::close(fd);
+    data.resize(done);
+
+    size_t offset = 0;
+    while (offset + sizeof(Header) <= data.size()) {
+
+        Header header;
+        ::memcpy(&header, &data[offset], sizeof(header));
+
+        const char* state = &data[offset + sizeof(Header)];
+        if (header.magic_ != MAGIC || header.length_ > data.size() - offset - sizeof(Header)
+            || header.crc_ != checksum(header, state, header.length_)) {
+            break;
+        }
+
+        apply(Operation(header.operation_), header.id_, header.created_, state, header.length_, n);
+        offset += sizeof(Header) + header.length_;
+    }
+
+    return offset;
+}
+
+void TxnJournal::apply(Operation operation, TxnID id, time_t created, const char* state, size_t length,
+                       unsigned long segment) {
+
+    // The first record of a transaction may have been removed with its segment, once its state was copied
+    // to another one: any record with a state (re)creates the transaction
+
+    lastID_ = std::max(lastID_, id);
+
+    if (operation == END) {
+        active_.erase(id);
+        return;
+    }
+
+    Entry& entry(active_[id]);
+    entry.created_ = created;
+    entry.segment_ = segment;
+    entry.state_.assign(state, length);
+}
+
+void TxnJournal::append(Operation operation, TxnID id, const void* state, size_t length) {
+
+    AutoLock<MutexCond> lock(cond_);
+
+    if (failed_) {
+        throw WriteError("TxnJournal: " + directory_ + " failed, no more records can be appended", Here());
+    }
+
+    auto entry     = active_.find(id);
+    time_t created = entry != active_.end() ? entry->second.created_ : ::time(nullptr);
+
+    records_.push_back(Pending{operation, id, created, pending_.size() + sizeof(Header), length});
+    encode(pending_, operation, id, created, state, length);
+
+    unsigned long long ticket = ++appended_;
+
+    while (committed_ < ticket) {
+        if (failed_) {
+            throw WriteError("TxnJournal: failed to write to " + directory_, Here());
+        }
+        if (committing_) {
+            cond_.wait();
+        }
+        else {
+            commit();
+        }
+    }
+}
+
+void TxnJournal::commit() {
+
+    // With the lock held: write all the records appended so far, while the other threads wait
+
+    committing_ = true;
+
+    std::string batch;
+    std::vector<Pending> records;
+    batch.swap(pending_);
+    records.swap(records_);
+    unsigned long long last = appended_;
+
+    try {
+        cond_.unlock();
+        try {
+            write(batch);
+        }
+        catch (...) {
+            cond_.lock();
+            throw;
+        }
+        cond_.lock();
+
+        for (const Pending& r : records) {
+            apply(r.operation_, r.id_, r.created_, &batch[r.offset_], r.length_, current_);
+        }
+        size_ += batch.size();
+        committed_ = last;
+
+        if (size_ >= segmentSize_) {
+            rotate();
+        }
+    }
+    catch (...) {
+        failed_     = true;
+        committing_ = false;
+        cond_.broadcast();
+        throw;
+    }
+
+    committing_ = false;
+    cond_.broadcast();
+}
+
+void TxnJournal::write(const std::string& records) {
+
+    PathName path(segment(current_));
+
+    size_t done = 0;
+    while (done < records.size()) {
+        ssize_t len = ::write(fd_, records.data() + done, records.size() - done);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len < 0) {
+            throw FailedSystemCall("write", Here(), errno);
+        }
+        done += len;
+    }
+
+    SYSCALL2(eckit::fdatasync(fd_), path);
+}
+
+void TxnJournal::rotate() {
+
+    open(++current_);
+    release();
+
+    if (current_ - first_ + 1 > maxSegments_) {
+        compactSegments();
+    }
+}
+
+void TxnJournal::compact() {
+
+    AutoLock<MutexCond> lock(cond_);
+
+    while (committing_) {
+        cond_.wait();
+    }
+
+    committing_ = true;
+    try {
+        compactSegments();
+    }
+    catch (...) {
+        committing_ = false;
+        cond_.broadcast();
+        throw;
+    }
+    committing_ = false;
+    cond_.broadcast();
+}
+
+void TxnJournal::compactSegments() {
+
+    // With the lock held, and no records being written
+
+    std::string records;
+    for (const auto& t : active_) {
+        if (t.second.segment_ < current_) {
+            encode(records, UPDATE, t.first, t.second.created_, t.second.state_.data(), t.second.state_.size());
+        }
+    }
+
+    if (!records.empty()) {
+        write(records);
+        size_ += records.size();
+        for (auto& t : active_) {
+            t.second.segment_ = current_;
+        }
+    }
+
+    release();
+}
+
+void TxnJournal::release() {
+
+    // The segments older than any that holds the state of an active transaction are not needed
+
+    unsigned long oldest = current_;
+    for (const auto& t : active_) {
+        oldest = std::min(oldest, t.second.segment_);
+    }
+
+    for (; first_ < oldest; ++first_) {
+        PathName path(segment(first_));
+        if (path.exists()) {
+            path.unlink();
+        }
+    }
+}
+
+bool TxnJournal::active(TxnID id) const {
+    AutoLock<MutexCond> lock(cond_);
+    return active_.find(id) != active_.end();
+}
+
+std::vector<TxnJournal::Transaction> TxnJournal::transactions() const {
+    AutoLock<MutexCond> lock(cond_);
+    std::vector<Transaction> result;
+    result.reserve(active_.size());
+    for (const auto& t : active_) {
+        result.push_back(Transaction{t.first, t.second.created_, t.second.state_});
+    }
+    return result;
+}
+
+TxnID TxnJournal::lastID() const {
+    AutoLock<MutexCond> lock(cond_);
+    return lastID_;
+}
+
+size_t TxnJournal::segments() const {
+    AutoLock<MutexCond> lock(cond_);
+    return current_ - first_ + 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,145 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_TxnJournal_h
+#define eckit_TxnJournal_h
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/MutexCond.h"
+#include "eckit/transaction/TxnEvent.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// An append-only log of the records of transactions (begin, update, end), kept in a directory as a sequence
+/// of segments, for TxnLog.
+///
+/// Records are framed and checksummed, so that recovery is a sequential scan of the segments, which stops at
+/// the first record that is incomplete or corrupt (the tail of the last segment is then truncated). The states
+/// of the active transactions are indexed in memory.
+///
+/// Appends return once the record is on disk. The records appended concurrently are written and synced
+/// together, by whichever thread finds none in progress (group commit), while the others wait. When a segment
+/// is full, a new one is started, and the segments that no longer hold the state of any active transaction are
+/// removed. If there are still too many, the states of the active transactions are copied to the new segment
+/// (compaction), so that the older segments can all go.
+///
+/// If records cannot be written, the append fails, and so do all further appends. A journal has a single
+/// writer: the directory is locked (see flock(2)) for as long as it is open, and opening it again, from this
+/// process or any other, fails.
+
+class TxnJournal : private NonCopyable {
+public:  // types
+    enum Operation : uint32_t
+    {
+        BEGIN  = 1,
+        UPDATE = 2,
+        END    = 3
+    };
+
+    struct Transaction {
+        TxnID id_;
+        time_t created_;
+        std::string state_;
+    };
+
+public:  // methods
+    /// Open the journal held in the directory, which is created if needed, and recover its transactions
+    TxnJournal(const PathName& directory);
+    ~TxnJournal();
+
+    /// Append a record, with the new state of the transaction (none for END), and wait until it is on disk
+    void append(Operation, TxnID, const void* state = nullptr, size_t length = 0);
+
+    bool active(TxnID) const;
+
+    /// The active transactions, by ID
+    std::vector<Transaction> transactions() const;
+
+    /// The highest ID recorded so far
+    TxnID lastID() const;
+
+    /// Copy the states of the active transactions held in older segments to the current one, and remove the
+    /// segments that are no longer needed
+    void compact();
+
+    size_t segments() const;
+
+private:  // types
+    struct Entry {
+        time_t created_;
+        unsigned long segment_;  // holding the state
+        std::string state_;
+    };
+
+    struct Pending {
+        Operation operation_;
+        TxnID id_;
+        time_t created_;
+        size_t offset_;  // of the state, in pending_
+        size_t length_;
+    };
+
+private:  // methods
+    void lock();
+    void recover();
+    PathName segment(unsigned long) const;
+    void open(unsigned long);
+    size_t scan(unsigned long);
+
+    void apply(Operation, TxnID, time_t, const char* state, size_t length, unsigned long segment);
+    void commit();
+    void write(const std::string&);
+    void rotate();
+    void compactSegments();
+    void release();
+
+private:  // members
+    PathName directory_;
+    int lock_;  // held while the journal is open
+    mutable MutexCond cond_;
+
+    std::map<TxnID, Entry> active_;
+    TxnID lastID_;
+
+    // Records appended, and not yet written
+
+    std::string pending_;
+    std::vector<Pending> records_;
+    unsigned long long appended_;
+    unsigned long long committed_;
+    bool committing_;
+    bool failed_;  // to write records: nothing more can be appended
+
+    // Segments
+
+    unsigned long first_;
+    unsigned long current_;
+    int fd_;
+    size_t size_;  // of the current segment
+    size_t segmentSize_;
+    size_t maxSegments_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -18,14 +18,18 @@
 #include "eckit/container/SharedMemArray.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/AutoCloser.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Seconds.h"
 #include "eckit/log/TimeStamp.h"
 #include "eckit/runtime/Monitor.h"
 #include "eckit/serialisation/FileStream.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Thread.h"
 #include "eckit/thread/ThreadControler.h"
+#include "eckit/transaction/TxnJournal.h"
 #include "eckit/transaction/TxnLog.h"
 #include "eckit/utils/Translator.h"
 
@@ -110,9 +114,24 @@ TxnLog<T>::TxnLog(const std::string& name) :
     }
 
 
+    std::string txnLogType = Resource<std::string>("txnLogType;$ECKIT_TXN_LOG_TYPE", "Files");
+
+    if (txnLogType == "Journal") {
+        journal_.reset(new TxnJournal(path_ + "/journal"));
+    }
+    else if (txnLogType != "Files") {
+        std::ostringstream oss;
+        oss << "Invalid txnLogType : " << txnLogType << ", valid types are 'Files' and 'Journal'" << std::endl;
+        throw eckit::BadParameter(oss.str(), Here());
+    }
+
     AutoLock<TxnArray> lock(*nextID_);
     Log::debug() << "TxnLog file is " << path_ << std::endl;
 
+    if (journal_ && journal_->lastID() > (*nextID_)[0]) {
+        (*nextID_)[0] = journal_->lastID();
+    }
+
     PathName done = path_ + "/done";
     done.mkdir();
 }
@@ -128,6 +147,14 @@ PathName TxnLog<T>::name(const T& event) {
 }
 
 
+template <class T>
+std::string TxnLog<T>::serialise(const T& event) {
+    Buffer buffer(4096);
+    ResizableMemoryStream s(buffer);
+    s << event;
+    return std::string(buffer, s.position());
+}
+
 template <class T>
 void TxnLog<T>::begin(T& event) {
     AutoLock<TxnArray> lock(*nextID_);
@@ -135,6 +162,13 @@ void TxnLog<T>::begin(T& event) {
     if (event.transactionID() == 0)
         event.transactionID(++(*nextID_)[0]);
 
+    if (journal_) {
+        ASSERT(!journal_->active(event.transactionID()));
+        std::string state = serialise(event);
+        journal_->append(TxnJournal::BEGIN, event.transactionID(), state.data(), state.size());
+        return;
+    }
+
     PathName path = name(event);
     ASSERT(!path.exists());
 
@@ -147,6 +181,12 @@ template <class T>
 void TxnLog<T>::update(const T& event) {
     // AutoLock<TxnArray > lock(*nextID_);
 
+    if (journal_) {
+        std::string state = serialise(event);
+        journal_->append(TxnJournal::UPDATE, event.transactionID(), state.data(), state.size());
+        return;
+    }
+
     PathName path = name(event);
     PathName next = path + ".tmp";
     {
@@ -174,6 +214,11 @@ void TxnLog<T>::end(T& event, bool backup) {
         log << event;
     }
 
+    if (journal_) {
+        journal_->append(TxnJournal::END, event.transactionID());
+        return;
+    }
+
     // Remove file
 
     path.unlink();
@@ -181,6 +226,9 @@ void TxnLog<T>::end(T& event, bool backup) {
 
 template <class T>
 bool TxnLog<T>::exists(T& event) {
+    if (journal_) {
+        return journal_->active(event.transactionID());
+    }
     PathName path = name(event);
     return path.exists();
 }
@@ -190,19 +238,35 @@ class RecoverThread : public Thread {
     TxnArray& nextID_;
     TxnRecoverer<T>& client_;
     std::vector<PathName> result_;
+    std::vector<TxnJournal::Transaction> transactions_;
     long age_;
     time_t now_;
     virtual void run();
 
+    void recover(const std::string& name, time_t created, Stream& s);
+
 public:
-    RecoverThread(const PathName&, TxnArray&, TxnRecoverer<T>&, long);
+    RecoverThread(const PathName&, TxnArray&, TxnRecoverer<T>&, long, const TxnJournal* = nullptr);
     void recover();
 };
 
 template <class T>
-RecoverThread<T>::RecoverThread(const PathName& path, TxnArray& nextID, TxnRecoverer<T>& client, long age) :
+RecoverThread<T>::RecoverThread(const PathName& path, TxnArray& nextID, TxnRecoverer<T>& client, long age,
+                                const TxnJournal* journal) :
     nextID_(nextID), client_(client), age_(age), now_(::time(0)) {
     AutoLock<TxnArray> lock(nextID_);
+
+    if (journal) {
+        // In order of ID
+        transactions_ = journal->transactions();
+        Log::info() << transactions_.size() << " task(s) found in journal" << std::endl;
+
+        if (transactions_.size() && transactions_.back().id_ >= nextID_[0]) {
+            nextID_[0] = transactions_.back().id_ + 1;
+        }
+        return;
+    }
+
     PathName::match(path + "/[0-9]*", result_);
 
     // Sort by ID to preserve order
@@ -224,38 +288,54 @@ void RecoverThread<T>::run() {
     recover();
 }
 
+template <class T>
+void RecoverThread<T>::recover(const std::string& name, time_t created, Stream& s) {
+    if (now_ - created < age_) {
+        Log::info() << "Skipping " << name << ", created " << Seconds(now_ - created) << " ago." << std::endl;
+        return;
+    }
+
+    T* task = Reanimator<T>::reanimate(s);
+    if (task) {
+        ASSERT(task->transactionID() < nextID_[0]);
+        client_.push(task);
+    }
+}
+
 template <class T>
 void RecoverThread<T>::recover() {
     for (Ordinal i = 0; i < result_.size(); i++) {
+        try {
+            FileStream log(result_[i], "r");
+            auto c = closer(log);
+            recover(result_[i], result_[i].created(), log);
+        }
+        catch (std::exception& e) {
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is ignored" << std::endl;
+        }
+    }
 
-        if (now_ - result_[i].created() < age_)
-            Log::info() << "Skipping " << result_[i] << ", created " << Seconds(now_ - result_[i].created()) << " ago."
-                        << std::endl;
-        else
-            try {
-                FileStream log(result_[i], "r");
-                auto c  = closer(log);
-                T* task = Reanimator<T>::reanimate(log);
-                if (task) {
-                    ASSERT(task->transactionID() < nextID_[0]);
-                    client_.push(task);
-                }
-            }
-            catch (std::exception& e) {
-                Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
-                Log::error() << "** Exception is ignored" << std::endl;
-            }
+    for (const TxnJournal::Transaction& t : transactions_) {
+        try {
+            MemoryStream s(t.state_.data(), t.state_.size());
+            recover("transaction " + Translator<unsigned long long, std::string>()(t.id_), t.created_, s);
+        }
+        catch (std::exception& e) {
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is ignored" << std::endl;
+        }
     }
 }
 
 template <class T>
 void TxnLog<T>::recover(TxnRecoverer<T>& client, bool inThread, long age) {
     if (inThread) {
-        ThreadControler c(new RecoverThread<T>(path_, *nextID_, client, age));
+        ThreadControler c(new RecoverThread<T>(path_, *nextID_, client, age, journal_.get()));
         c.start();
     }
     else {
-        RecoverThread<T> r(path_, *nextID_, client, age);
+        RecoverThread<T> r(path_, *nextID_, client, age, journal_.get());
         r.recover();
     }
 }
@@ -265,7 +345,32 @@ void TxnLog<T>::find(TxnFinder<T>& r) {
 
     // Look for active transactions
 
-    if (r.active()) {
+    if (r.active() && journal_) {
+
+        for (const TxnJournal::Transaction& t : journal_->transactions()) {
+            try {
+                MemoryStream s(t.state_.data(), t.state_.size());
+                std::unique_ptr<T> task(Reanimator<T>::reanimate(s));
+                if (task) {
+                    LOG_DEBUG_LIB(LibEcKit)
+                        << "Task found - id: " << task->transactionID() << " task: " << *task << std::endl;
+                    if (r.found(*task)) {
+                        return;
+                    }
+                }
+            }
+            catch (Abort& e) {
+                Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+                Log::error() << "** Exception is re-thrown" << std::endl;
+                throw;
+            }
+            catch (std::exception& e) {
+                Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+                Log::error() << "** Exception is ignored" << std::endl;
+            }
+        }
+    }
+    else if (r.active()) {
 
         PathName path = path_ + "/[0-9]*";
         std::vector<PathName> active;
@@ -15,6 +15,8 @@
 #ifndef eckit_TxnLog_h
 #define eckit_TxnLog_h
 
+#include <memory>
+
 #include "eckit/filesystem/PathName.h"
 #include "eckit/runtime/Main.h"
 #include "eckit/transaction/TxnEvent.h"
@@ -45,6 +47,7 @@ struct TxnFinder {
 
 
 class TxnArray;
+class TxnJournal;
 
 
 template <class T>
@@ -78,12 +81,15 @@ private:
     PathName name(const T& event);
 
     static PathName buildPath(const std::string& name);
+    static std::string serialise(const T& event);
 
     // -- Members
 
     PathName path_;
     PathName next_;     // Should be declared after 'path_'
     TxnArray* nextID_;  // Should be declared after 'next_'
+
+    std::unique_ptr<TxnJournal> journal_;  // If null, each transaction is kept in its own file
 };
 
 
@@ -16,6 +16,7 @@
 #include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/system/LibraryManager.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/utils/StringTools.h"
 
@@ -34,7 +35,7 @@ void CompressorFactory::add(const std::string& name, CompressorBuilderBase* buil
     std::string nameLowercase = StringTools::lower(name);
 
     AutoLock<Mutex> lock(mutex_);
-    if (has(nameLowercase)) {
+    if (builders_.find(nameLowercase) != builders_.end()) {
         throw SeriousBug("Duplicate entry in CompressorFactory: " + nameLowercase, Here());
     }
     builders_[nameLowercase] = builder;
@@ -50,11 +51,25 @@ void CompressorFactory::remove(const std::string& name) {
 bool CompressorFactory::has(const std::string& name) {
     std::string nameLowercase = StringTools::lower(name);
 
+    {
+        AutoLock<Mutex> lock(mutex_);
+        if (builders_.find(nameLowercase) != builders_.end()) {
+            return true;
+        }
+    }
+
+    // The builder may be provided by a plugin that is only loaded on first use
+    if (!system::LibraryManager::loadPluginsFor(nameLowercase)) {
+        return false;
+    }
+
     AutoLock<Mutex> lock(mutex_);
     return builders_.find(nameLowercase) != builders_.end();
 }
 
 void CompressorFactory::list(std::ostream& out) {
+    system::LibraryManager::loadDeferredPlugins();
+
     AutoLock<Mutex> lock(mutex_);
     const char* sep = "";
     for (std::map<std::string, CompressorBuilderBase*>::const_iterator j = builders_.begin(); j != builders_.end();
@@ -78,6 +93,9 @@ Compressor* CompressorFactory::build() {
 Compressor* CompressorFactory::build(const std::string& name) {
     std::string nameLowercase = StringTools::lower(name);
 
+    // Loads the plugin providing the builder, if deferred
+    has(nameLowercase);
+
     AutoLock<Mutex> lock(mutex_);
 
     auto j = builders_.find(nameLowercase);
@@ -94,7 +94,10 @@ public:
     void add(const std::string& name, CompressorBuilderBase* builder);
     void remove(const std::string& name);
 
+    /// Loads the plugin providing the builder, if deferred
     bool has(const std::string& name);
+
+    /// Lists the builders, once all the deferred plugins are loaded
     void list(std::ostream&);
 
     /// @returns default compressor
@@ -14,6 +14,7 @@
 
 #include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/system/LibraryManager.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Mutex.h"
 #include "eckit/utils/StringTools.h"
@@ -33,7 +34,7 @@ void HashFactory::add(const std::string& name, HashBuilderBase* builder) {
     std::string nameLowercase = StringTools::lower(name);
 
     AutoLock<Mutex> lock(mutex_);
-    if (has(nameLowercase)) {
+    if (builders_.find(nameLowercase) != builders_.end()) {
         throw SeriousBug("Duplicate entry in HashFactory: " + nameLowercase, Here());
     }
     builders_[nameLowercase] = builder;
@@ -49,11 +50,25 @@ void HashFactory::remove(const std::string& name) {
 bool HashFactory::has(const std::string& name) {
     std::string nameLowercase = StringTools::lower(name);
 
+    {
+        AutoLock<Mutex> lock(mutex_);
+        if (builders_.find(nameLowercase) != builders_.end()) {
+            return true;
+        }
+    }
+
+    // The builder may be provided by a plugin that is only loaded on first use
+    if (!system::LibraryManager::loadPluginsFor(nameLowercase)) {
+        return false;
+    }
+
     AutoLock<Mutex> lock(mutex_);
     return builders_.find(nameLowercase) != builders_.end();
 }
 
 void HashFactory::list(std::ostream& out) {
+    system::LibraryManager::loadDeferredPlugins();
+
     AutoLock<Mutex> lock(mutex_);
     const char* sep = "";
     for (std::map<std::string, HashBuilderBase*>::const_iterator j = builders_.begin(); j != builders_.end(); ++j) {
@@ -76,6 +91,9 @@ Hash* HashFactory::build() {
 Hash* HashFactory::build(const std::string& name) {
     std::string nameLowercase = StringTools::lower(name);
 
+    // Loads the plugin providing the builder, if deferred
+    has(nameLowercase);
+
     AutoLock<Mutex> lock(mutex_);
     auto j = builders_.find(nameLowercase);
 
@@ -96,6 +114,9 @@ Hash* HashFactory::build(const std::string& name) {
 Hash* HashFactory::build(const std::string& name, const std::string& param) {
     std::string nameLowercase = StringTools::lower(name);
 
+    // Loads the plugin providing the builder, if deferred
+    has(nameLowercase);
+
     AutoLock<Mutex> lock(mutex_);
     auto j = builders_.find(nameLowercase);
 
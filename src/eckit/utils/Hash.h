@@ -123,7 +123,10 @@ public:
     void add(const std::string& name, HashBuilderBase* builder);
     void remove(const std::string& name);
 
+    /// Loads the plugin providing the builder, if deferred
     bool has(const std::string& name);
+
+    /// Lists the builders, once all the deferred plugins are loaded
     void list(std::ostream&);
 
     /// @returns default hash function
@@ -0,0 +1,330 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "eckit/eckit_config.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/utils/NumberConversion.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+template <typename T>
+const char* typeName() {
+    if constexpr (std::is_same_v<T, double>) {
+        return "double";
+    }
+    else if constexpr (std::is_same_v<T, float>) {
+        return "float";
+    }
+    else if constexpr (std::is_signed_v<T>) {
+        return "integer";
+    }
+    else {
+        return "unsigned integer";
+    }
+}
+
+char* checked(std::to_chars_result r) {
+    if (r.ec != std::errc()) {
+        throw BadParameter("NumberConversion: buffer too small", Here());
+    }
+    return r.ptr;
+}
+
+inline bool isSpace(char c) {
+    return ::isspace(static_cast<unsigned char>(c));
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+template <typename T>
+bool parseInteger(std::string_view s, T& value) {
+    const char* first = s.data();
+    const char* last  = first + s.size();
+
+    if (first != last && *first == '+') {
+        ++first;
+    }
+
+    // from_chars() would accept "+-1"
+    if (first == last || !(isDigit(*first) || (*first == '-' && first == s.data()))) {
+        return false;
+    }
+
+    auto r = std::from_chars(first, last, value);
+    return r.ec == std::errc() && r.ptr == last;
+}
+
+inline double strto(const char* s, char** end, double) {
+    return ::strtod(s, end);
+}
+
+inline float strto(const char* s, char** end, float) {
+    return ::strtof(s, end);
+}
+
+template <typename T>
+bool parseFloating(std::string_view s, T& value) {
+    if (s.empty() || isSpace(s[0])) {
+        return false;
+    }
+
+#if eckit_HAVE_FLOATING_POINT_CHARCONV
+    const char* last = s.data() + s.size();
+
+    auto r = std::from_chars(s.data(), last, value);
+    if (r.ec == std::errc() && r.ptr == last && std::fpclassify(value) != FP_SUBNORMAL) {
+        return true;
+    }
+#endif
+
+    // A leading '+', hexadecimal and the values strtod() reports as out of range (subnormals included) are not read by
+    // from_chars() as by strtod(), which decides
+    std::string copy(s);
+    char* end;
+    errno = 0;
+    value = strto(copy.c_str(), &end, T());
+    return static_cast<size_t>(end - copy.c_str()) == copy.size() && errno == 0;
+}
+
+#if !eckit_HAVE_FLOATING_POINT_CHARCONV
+
+// Without to_chars() for floating point values, as with libstdc++ before GCC 11 and libc++ before LLVM 20
+
+char* print(char* first, char* last, double value, int precision) {
+    // snprintf() also writes a terminating null, which [first, last) may not have room for
+    char buffer[64];
+    int n = ::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    if (n < 0 || n > last - first) {
+        throw BadParameter("NumberConversion: buffer too small", Here());
+    }
+    if (static_cast<size_t>(n) < sizeof(buffer)) {
+        ::memcpy(first, buffer, n);
+    }
+    else {
+        std::string large(n, '\0');
+        ::snprintf(&large[0], n + 1, "%.*g", precision, value);
+        ::memcpy(first, large.data(), n);
+    }
+    return first + n;
+}
+
+/// The shortest "%g" precision that reads back to the same value. The digits are those of to_chars(), but the
+/// notation may differ, as "%g" only switches to fixed notation for exponents below the precision.
+template <typename T>
+char* shortest(char* first, char* last, T value) {
+    char buffer[NumberConversion::maxLength];
+    int precision = 1;
+    for (; precision < std::numeric_limits<T>::max_digits10; ++precision) {
+        ::snprintf(buffer, sizeof(buffer), "%.*g", precision, double(value));
+        if (strto(buffer, nullptr, T()) == value) {
+            break;
+        }
+    }
+    return print(first, last, value, precision);
+}
+
+#endif
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+char* NumberConversion::format(char* first, char* last, T value) {
+    static_assert(supported<T>, "NumberConversion: unsupported type");
+#if eckit_HAVE_FLOATING_POINT_CHARCONV
+    return checked(std::to_chars(first, last, value));
+#else
+    if constexpr (std::is_floating_point_v<T>) {
+        return shortest(first, last, value);
+    }
+    else {
+        return checked(std::to_chars(first, last, value));
+    }
+#endif
+}
+
+char* NumberConversion::format(char* first, char* last, double value, int precision) {
+#if eckit_HAVE_FLOATING_POINT_CHARCONV
+    return checked(std::to_chars(first, last, value, std::chars_format::general, precision));
+#else
+    return print(first, last, value, precision);
+#endif
+}
+
+template <typename T>
+std::string NumberConversion::toString(T value) {
+    char buffer[maxLength];
+    return std::string(buffer, format(buffer, buffer + maxLength, value));
+}
+
+std::string NumberConversion::toString(double value, int precision) {
+    if (precision <= 17) {
+        char buffer[maxLength];
+        return std::string(buffer, format(buffer, buffer + maxLength, value, precision));
+    }
+
+    // Sign, digits, point and exponent, or up to 4 leading zeros in fixed notation
+    std::string result(precision + 16, '\0');
+    result.resize(format(&result[0], &result[0] + result.size(), value, precision) - &result[0]);
+    return result;
+}
+
+template <typename T>
+void NumberConversion::toString(const T* values, size_t n, std::vector<std::string>& out) {
+    char buffer[maxLength];
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i].assign(buffer, format(buffer, buffer + maxLength, values[i]));
+    }
+}
+
+template <typename T>
+std::string NumberConversion::join(const T* values, size_t n, std::string_view delimiter) {
+    char buffer[maxLength];
+    std::string result;
+    result.reserve(n * (delimiter.size() + 8));
+    for (size_t i = 0; i < n; ++i) {
+        if (i) {
+            result += delimiter;
+        }
+        result.append(buffer, format(buffer, buffer + maxLength, values[i]));
+    }
+    return result;
+}
+
+template <typename T>
+bool NumberConversion::parse(std::string_view s, T& value) {
+    static_assert(supported<T>, "NumberConversion: unsupported type");
+    if constexpr (std::is_floating_point_v<T>) {
+        return parseFloating(s, value);
+    }
+    else {
+        return parseInteger(s, value);
+    }
+}
+
+template <typename T>
+T NumberConversion::parse(std::string_view s) {
+    T value;
+    if (!parse(s, value)) {
+        throw BadParameter("Bad conversion from std::string '" + std::string(s) + "' to " + typeName<T>(), Here());
+    }
+    return value;
+}
+
+template <typename T>
+void NumberConversion::parse(const std::string_view* s, size_t n, T* values) {
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = parse<T>(s[i]);
+    }
+}
+
+template <typename T>
+void NumberConversion::parse(const std::vector<std::string>& s, std::vector<T>& values) {
+    values.resize(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        values[i] = parse<T>(s[i]);
+    }
+}
+
+template <typename T>
+size_t NumberConversion::scan(std::string_view s, T& value) {
+    static_assert(supported<T> && std::is_integral_v<T>, "NumberConversion: scan() reads integers");
+    using U = std::make_unsigned_t<T>;
+
+    const char* begin = s.data();
+    const char* end   = begin + s.size();
+    const char* p     = begin;
+
+    value = 0;
+
+    while (p != end && isSpace(*p)) {
+        ++p;
+    }
+
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    if (p == end || !isDigit(*p)) {
+        return 0;
+    }
+
+    U magnitude = 0;
+    auto r      = std::from_chars(p, end, magnitude);
+    bool range  = r.ec != std::errc::result_out_of_range;
+
+    if constexpr (std::is_signed_v<T>) {
+        const U limit = U(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+        if (!range || magnitude > limit) {
+            value = negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+        }
+        else {
+            value = negative ? T(U(0) - magnitude) : T(magnitude);
+        }
+    }
+    else {
+        value = !range ? std::numeric_limits<T>::max() : (negative ? U(0) - magnitude : magnitude);
+    }
+
+    return r.ptr - begin;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NUMBER_CONVERSION(T)                                                                          \
+    template char* NumberConversion::format<T>(char*, char*, T);                                      \
+    template std::string NumberConversion::toString<T>(T);                                            \
+    template void NumberConversion::toString<T>(const T*, size_t, std::vector<std::string>&);         \
+    template std::string NumberConversion::join<T>(const T*, size_t, std::string_view);               \
+    template bool NumberConversion::parse<T>(std::string_view, T&);                                   \
+    template T NumberConversion::parse<T>(std::string_view);                                          \
+    template void NumberConversion::parse<T>(const std::string_view*, size_t, T*);                    \
+    template void NumberConversion::parse<T>(const std::vector<std::string>&, std::vector<T>&);
+
+#define NUMBER_CONVERSION_INTEGER(T) \
+    NUMBER_CONVERSION(T)             \
+    template size_t NumberConversion::scan<T>(std::string_view, T&);
+
+NUMBER_CONVERSION_INTEGER(short)
+NUMBER_CONVERSION_INTEGER(unsigned short)
+NUMBER_CONVERSION_INTEGER(int)
+NUMBER_CONVERSION_INTEGER(unsigned int)
+NUMBER_CONVERSION_INTEGER(long)
+NUMBER_CONVERSION_INTEGER(unsigned long)
+NUMBER_CONVERSION_INTEGER(long long)
+NUMBER_CONVERSION_INTEGER(unsigned long long)
+NUMBER_CONVERSION(float)
+NUMBER_CONVERSION(double)
+
+#undef NUMBER_CONVERSION_INTEGER
+#undef NUMBER_CONVERSION
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,109 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_NumberConversion_h
+#define eckit_NumberConversion_h
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Conversions between numbers and text built on std::to_chars and std::from_chars.
+///
+/// They do not depend on the locale, do not allocate unless they return a std::string, and read from std::string_view
+/// so that tokens of a larger buffer are parsed without being copied.
+///
+/// Doubles and floats are written in their shortest form that reads back to the same value, or with a given precision
+/// as printf("%.*g") and std::ostream do. Reading accepts what strtod() accepts, so that existing inputs (a leading
+/// '+', hexadecimal, "inf", "nan") still convert, and rejects out of range values.
+///
+/// Where the standard library does not convert floating point values with to_chars and from_chars (GCC before 11,
+/// libc++ before LLVM 20, macOS before 13.3), they are written with snprintf() and read with strtod(): the shortest
+/// form then has the same digits, but may be written in scientific notation where to_chars would not.
+///
+/// The supported types are the integers from short to long long, signed and unsigned, float and double.
+
+class NumberConversion : private NonCopyable {
+public:  // types
+    template <typename T>
+    static constexpr bool supported =
+        std::is_same_v<T, short> || std::is_same_v<T, unsigned short> || std::is_same_v<T, int> ||
+        std::is_same_v<T, unsigned int> || std::is_same_v<T, long> || std::is_same_v<T, unsigned long> ||
+        std::is_same_v<T, long long> || std::is_same_v<T, unsigned long long> || std::is_same_v<T, float> ||
+        std::is_same_v<T, double>;
+
+    /// Size of a buffer large enough for any value written by format(), without precision or with precision up to 17
+    static constexpr size_t maxLength = 32;
+
+public:  // methods
+    /// Writes value to [first, last), in shortest round-trip form for floating point values
+    /// @returns the end of the written characters
+    /// @throws BadParameter if the buffer is too small
+    template <typename T>
+    static char* format(char* first, char* last, T value);
+
+    /// Writes value as printf("%.*g", precision, value) does, which is also the std::ostream default for precision 6
+    static char* format(char* first, char* last, double value, int precision);
+
+    template <typename T>
+    static std::string toString(T value);
+
+    static std::string toString(double value, int precision);
+
+    /// Converts n values, replacing the content of out
+    template <typename T>
+    static void toString(const T* values, size_t n, std::vector<std::string>& out);
+
+    /// Converts n values into one string, separated by delimiter
+    template <typename T>
+    static std::string join(const T* values, size_t n, std::string_view delimiter);
+
+    /// Reads the whole of s, which must not have spaces
+    /// @returns false if s is not a number, or is out of the range of T
+    template <typename T>
+    static bool parse(std::string_view s, T& value);
+
+    /// @throws BadParameter if s is not a number, or is out of the range of T
+    template <typename T>
+    static T parse(std::string_view s);
+
+    /// Converts n strings, stopping at the first one that is not a number
+    /// @throws BadParameter naming the string that could not be converted
+    template <typename T>
+    static void parse(const std::string_view* s, size_t n, T* values);
+
+    template <typename T>
+    static void parse(const std::vector<std::string>& s, std::vector<T>& values);
+
+    /// Reads an integer at the beginning of s as strtol() does: skipping leading spaces, saturating on overflow and
+    /// negating unsigned values preceded by '-'
+    /// @returns the number of characters read, 0 if s does not start with a number (and value is then 0)
+    template <typename T>
+    static size_t scan(std::string_view s, T& value);
+
+private:
+    NumberConversion();  // Non instantiable
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
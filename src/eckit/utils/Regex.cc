@@ -9,9 +9,21 @@
  */
 
 
-#include "eckit/utils/Regex.h"
+#include <regex.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+
+#include "eckit/container/CacheLRU.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
+#include "eckit/utils/Regex.h"
+#include "eckit/utils/RegexDFA.h"
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -20,8 +32,91 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-Regex::Regex(const std::string& s, bool shell, bool extended) :
-    str_(s), extended_(extended) {
+struct Regex::Compiled : private NonCopyable {
+    Compiled(const std::string& str, bool extended, bool dfa) {
+        int n = regcomp(&re_, str.c_str(), extended ? REG_EXTENDED : 0);
+        if (n) {
+            char buf[1024];
+            regerror(n, &re_, buf, sizeof(buf));
+            regfree(&re_);
+            throw SeriousBug(buf);
+        }
+
+        // The POSIX engine also validates the pattern, so that both engines accept the same ones
+        if (dfa) {
+            dfa_ = RegexDFA::compile(str, extended);
+        }
+    }
+
+    ~Compiled() { regfree(&re_); }
+
+    bool match(const std::string& s) const {
+        if (dfa_) {
+            // regexec() stops at the first NUL
+            const char* p = s.c_str();
+            const void* nul = ::memchr(p, 0, s.size());
+            return dfa_->search(p, nul ? static_cast<const char*>(nul) - p : s.size());
+        }
+
+        regmatch_t pm;
+        return regexec(&re_, s.c_str(), 1, &pm, 0) == 0;
+    }
+
+    regex_t re_;
+    std::unique_ptr<RegexDFA> dfa_;
+};
+
+namespace {
+
+struct CompiledKey {
+    std::string pattern_;
+    bool extended_;
+    bool dfa_;
+
+    bool operator<(const CompiledKey& other) const {
+        if (pattern_ != other.pattern_) {
+            return pattern_ < other.pattern_;
+        }
+        return extended_ != other.extended_ ? extended_ < other.extended_ : dfa_ < other.dfa_;
+    }
+
+    bool operator==(const CompiledKey& other) const {
+        return pattern_ == other.pattern_ && extended_ == other.extended_ && dfa_ == other.dfa_;
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, const CompiledKey& k) {
+        s << "/" << k.pattern_ << "/";
+        return s;
+    }
+};
+
+// Regex is used before Main is initialised, e.g. by static YAML parsers, so these are not Resources
+
+Regex::Engine defaultEngine() {
+    static const Regex::Engine engine = [] {
+        const char* name = ::getenv("ECKIT_REGEX_ENGINE");
+        if (name == nullptr || ::strcmp(name, "dfa") == 0) {
+            return Regex::DFA;
+        }
+        if (::strcmp(name, "posix") == 0) {
+            return Regex::POSIX;
+        }
+        throw UserError(std::string("Invalid ECKIT_REGEX_ENGINE '") + name + "', must be 'dfa' or 'posix'");
+    }();
+    return engine;
+}
+
+size_t cacheSize() {
+    const char* size = ::getenv("ECKIT_REGEX_CACHE_SIZE");
+    return size ? std::max(1L, ::atol(size)) : 256;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Regex::Regex(const std::string& s, bool shell, bool extended, Engine engine) :
+    str_(s), extended_(extended), engine_(engine == DEFAULT ? defaultEngine() : engine) {
     // Log::debug() << "Regex " << str_ << std::endl;
     if (shell) {
         long len = s.length() * 3 + 1;
@@ -74,46 +169,64 @@ Regex::Regex(const std::string& s, bool shell, bool extended) :
         str_  = re;
     }
     // Log::debug() << "Regex " << str_ << std::endl;
-    compile(str_.c_str());
+    compile();
 }
 
-Regex::~Regex() {
-    regfree(&re_);
-}
+Regex::~Regex() = default;
 
 void Regex::print(std::ostream& s) const {
     s << "/" << str_ << "/";
 }
 
 bool Regex::match(const std::string& s) const {
-    regmatch_t pm;
-    // Log::debug() << "Match " << s << " with " << str_ << " -> " << (regexec(&re_,s.c_str(),1,&pm,0) == 0) <<
-    // std::endl;
-    return regexec(&re_, s.c_str(), 1, &pm, 0) == 0;
+    return compiled_->match(s);
 }
 
-void Regex::compile(const char* p) {
-    int n = regcomp(&re_, p, extended_ ? REG_EXTENDED : 0);
-    if (n) {
-        char buf[1024];
-        regerror(n, &re_, buf, sizeof(buf));
-        throw SeriousBug(buf);
+void Regex::match(const std::string* strings, size_t n, bool* result) const {
+    const Compiled& compiled = *compiled_;
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = compiled.match(strings[i]);
     }
 }
 
-Regex::Regex(const Regex& other) :
-    str_(other.str_), extended_(other.extended_) {
-    compile(str_.c_str());
+void Regex::match(const std::vector<std::string>& strings, std::vector<bool>& result) const {
+    const Compiled& compiled = *compiled_;
+    result.resize(strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+        result[i] = compiled.match(strings[i]);
+    }
 }
 
-Regex& Regex::operator=(const Regex& other) {
-    regfree(&re_);
-    str_      = other.str_;
-    extended_ = other.extended_;
-    compile(str_.c_str());
-    return *this;
+Regex::Engine Regex::engine() const {
+    return compiled_->dfa_ ? DFA : POSIX;
 }
 
+void Regex::compile() {
+    static Mutex mutex;
+    static CacheLRU<CompiledKey, std::shared_ptr<const Compiled>> cache(cacheSize());
+
+    CompiledKey key{str_, extended_, engine_ == DFA};
+
+    {
+        AutoLock<Mutex> lock(mutex);
+        if (cache.exists(key)) {
+            compiled_ = cache.access(key);
+            return;
+        }
+    }
+
+    // Compiled outside the lock, a pattern compiled twice concurrently is harmless
+    std::shared_ptr<const Compiled> compiled(new Compiled(str_, extended_, engine_ == DFA));
+
+    AutoLock<Mutex> lock(mutex);
+    cache.insert(key, compiled);
+    compiled_ = compiled;
+}
+
+Regex::Regex(const Regex& other) = default;
+
+Regex& Regex::operator=(const Regex& other) = default;
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit
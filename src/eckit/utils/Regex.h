@@ -14,20 +14,37 @@
 #ifndef eckit_Regex_h
 #define eckit_Regex_h
 
-#include <regex.h>
-
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
 
 
 namespace eckit {
 
 //--------------------------------------------------------------------------------------------------
 
+/// POSIX regular expression, matched anywhere in a string as regexec() does.
+///
+/// Compiled expressions are shared by all the Regex of the same pattern, in a cache of $ECKIT_REGEX_CACHE_SIZE
+/// patterns, so copying or constructing a Regex repeatedly is cheap.
+///
+/// By default ($ECKIT_REGEX_ENGINE, "dfa" or "posix"), patterns are matched with a RegexDFA when it supports them,
+/// and regexec() otherwise; both give the same results.
+
 class Regex {
 public:
+    enum Engine
+    {
+        DEFAULT,  //< As set by $ECKIT_REGEX_ENGINE
+        POSIX,
+        DFA
+    };
+
     // -- Contructors
 
-    Regex(const std::string& = ".*", bool shell = false, bool extended = true);
+    Regex(const std::string& = ".*", bool shell = false, bool extended = true, Engine = DEFAULT);
     Regex(const Regex&);
 
     ~Regex();
@@ -38,6 +55,13 @@ public:
 
     bool match(const std::string& s) const;
 
+    /// Matches n strings, result[i] is match(strings[i])
+    void match(const std::string* strings, size_t n, bool* result) const;
+    void match(const std::vector<std::string>& strings, std::vector<bool>& result) const;
+
+    /// @returns the engine that matches this pattern, POSIX if the DFA does not support it
+    Engine engine() const;
+
     operator const std::string&() const { return str_; }
 
     bool operator==(const Regex& other) const { return str_ == other.str_; }
@@ -45,13 +69,17 @@ public:
 protected:  // methods
     void print(std::ostream&) const;
 
+private:  // types
+    struct Compiled;
+
 private:  // members
     std::string str_;
-    regex_t re_;
+    std::shared_ptr<const Compiled> compiled_;
     bool extended_;
+    Engine engine_;
 
 private:  // methods
-    void compile(const char*);
+    void compile();
 
     friend std::ostream& operator<<(std::ostream& s, const Regex& p) {
         p.print(s);
@@ -0,0 +1,838 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <clocale>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string_view>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/utils/RegexDFA.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr int32_t Accept = -1;
+constexpr int32_t Dead   = -2;
+
+constexpr size_t maxNFAStates = 10000;
+constexpr size_t maxDFAStates = 4096;
+
+constexpr int unbounded   = -1;
+constexpr int maxInterval = 255;
+
+/// Thrown by the parser for syntax left to the POSIX engine
+struct Unsupported {};
+
+bool classicLocale() {
+    for (int category : {LC_CTYPE, LC_COLLATE}) {
+        const char* name = ::setlocale(category, nullptr);
+        if (name == nullptr || (::strcmp(name, "C") != 0 && ::strcmp(name, "POSIX") != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Parses a pattern into a syntax tree, from which the NFA is built
+class RegexDFA::Parser {
+public:
+    Parser(const std::string& pattern, bool extended) :
+        pattern_(pattern), pos_(0), extended_(extended) {}
+
+    void parse(RegexDFA& dfa) {
+        int root = extended_ ? alternation(0) : branch(0);
+        if (!end()) {
+            throw Unsupported();
+        }
+
+        literal(root, dfa);
+
+        dfa.sets_ = sets_;
+        dfa.nfa_.push_back({State::Match, -1, -1, -1});
+        dfa.start_ = compile(root, 0, dfa.nfa_);
+    }
+
+private:
+    struct Node {
+        enum Type
+        {
+            Set,
+            Concat,
+            Alternation,
+            Repeat,
+            Begin,
+            End
+        };
+        Type type_;
+        int set_;
+        int min_;  //< For a Set of a single byte, that byte
+        int max_;
+        std::vector<int> children_;
+    };
+
+    // -- Syntax
+
+    bool end() const { return pos_ >= pattern_.size(); }
+    unsigned char peek(size_t ahead = 0) const {
+        return pos_ + ahead < pattern_.size() ? pattern_[pos_ + ahead] : 0;
+    }
+
+    bool closing() const { return extended_ ? peek() == ')' : (peek() == '\\' && peek(1) == ')'); }
+
+    int alternation(int depth) {
+        std::vector<int> branches{branch(depth)};
+        while (!end() && peek() == '|') {
+            ++pos_;
+            branches.push_back(branch(depth));
+        }
+        return branches.size() == 1 ? branches.front() : node(Node::Alternation, -1, 0, 0, branches);
+    }
+
+    int branch(int depth) {
+        std::vector<int> pieces;
+        while (!end() && !(extended_ && peek() == '|')) {
+            if (closing()) {
+                if (depth == 0) {
+                    throw Unsupported();
+                }
+                break;
+            }
+
+            int atom = extended_ ? extendedAtom(depth) : basicAtom(depth);
+            if (quantifier()) {
+                int min = 0;
+                int max = 0;
+                interval(min, max);
+                const Node::Type type = nodes_[atom].type_;
+                if (type == Node::Begin || type == Node::End || quantifier()) {
+                    throw Unsupported();
+                }
+                atom = node(Node::Repeat, -1, min, max, {atom});
+            }
+            pieces.push_back(atom);
+        }
+
+        if (pieces.empty()) {
+            throw Unsupported();
+        }
+        return pieces.size() == 1 ? pieces.front() : node(Node::Concat, -1, 0, 0, pieces);
+    }
+
+    int extendedAtom(int depth) {
+        const unsigned char c = peek();
+        ++pos_;
+        switch (c) {
+            case '(': {
+                int group = alternation(depth + 1);
+                if (peek() != ')') {
+                    throw Unsupported();
+                }
+                ++pos_;
+                return group;
+            }
+            case '[':
+                return bracket();
+            case '.':
+                return any();
+            case '^':
+                return node(Node::Begin);
+            case '$':
+                return node(Node::End);
+            case '\\':
+                return escaped();
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                throw Unsupported();
+            default:
+                return single(c);
+        }
+    }
+
+    int basicAtom(int depth) {
+        const unsigned char c = peek();
+        ++pos_;
+        switch (c) {
+            case '^':
+                // Elsewhere the meaning depends on the implementation
+                if (pos_ != 1) {
+                    throw Unsupported();
+                }
+                return node(Node::Begin);
+            case '$':
+                if (!end()) {
+                    throw Unsupported();
+                }
+                return node(Node::End);
+            case '*':
+                // Literal at the start of a branch, otherwise it would have been parsed as a quantifier
+                throw Unsupported();
+            case '[':
+                return bracket();
+            case '.':
+                return any();
+            case '\\':
+                if (peek() == '(') {
+                    ++pos_;
+                    int group = branch(depth + 1);
+                    if (!closing()) {
+                        throw Unsupported();
+                    }
+                    pos_ += 2;
+                    return group;
+                }
+                if (std::strchr("){}|+?", peek()) != nullptr) {
+                    throw Unsupported();
+                }
+                return escaped();
+            default:
+                return single(c);
+        }
+    }
+
+    int escaped() {
+        const unsigned char c = peek();
+        if (end() || std::isalnum(c) || c >= 0x80) {
+            // Back-references and GNU extensions
+            throw Unsupported();
+        }
+        ++pos_;
+        return single(c);
+    }
+
+    bool quantifier() const {
+        if (end()) {
+            return false;
+        }
+        if (peek() == '*') {
+            return true;
+        }
+        return extended_ ? (peek() == '+' || peek() == '?' || peek() == '{') : (peek() == '\\' && peek(1) == '{');
+    }
+
+    void interval(int& min, int& max) {
+        const unsigned char c = peek();
+        ++pos_;
+        switch (c) {
+            case '*':
+                min = 0;
+                max = unbounded;
+                return;
+            case '+':
+                min = 1;
+                max = unbounded;
+                return;
+            case '?':
+                min = 0;
+                max = 1;
+                return;
+            default:
+                break;
+        }
+
+        if (!extended_) {
+            ++pos_;  // '{' after '\'
+        }
+
+        min = number();
+        max = min;
+        if (peek() == ',') {
+            ++pos_;
+            max = std::isdigit(peek()) ? number() : unbounded;
+        }
+
+        if (!extended_) {
+            if (peek() != '\\') {
+                throw Unsupported();
+            }
+            ++pos_;
+        }
+        if (peek() != '}' || (max != unbounded && max < min)) {
+            throw Unsupported();
+        }
+        ++pos_;
+    }
+
+    int number() {
+        if (!std::isdigit(peek())) {
+            throw Unsupported();
+        }
+        int n = 0;
+        while (std::isdigit(peek())) {
+            n = n * 10 + (peek() - '0');
+            if (n > maxInterval) {
+                throw Unsupported();
+            }
+            ++pos_;
+        }
+        return n;
+    }
+
+    int bracket() {
+        std::vector<bool> set(256, false);
+
+        bool negate = peek() == '^';
+        if (negate) {
+            ++pos_;
+        }
+
+        for (bool first = true;; first = false) {
+            if (end()) {
+                throw Unsupported();
+            }
+
+            const unsigned char c = peek();
+            if (c == ']' && !first) {
+                ++pos_;
+                break;
+            }
+
+            if (c == '[' && (peek(1) == ':' || peek(1) == '.' || peek(1) == '=')) {
+                if (peek(1) != ':') {
+                    throw Unsupported();
+                }
+                size_t close = pattern_.find(":]", pos_ + 2);
+                if (close == std::string::npos) {
+                    throw Unsupported();
+                }
+                characterClass(pattern_.substr(pos_ + 2, close - pos_ - 2), set);
+                pos_ = close + 2;
+                continue;
+            }
+
+            ++pos_;
+            unsigned char last = c;
+            if (peek() == '-' && peek(1) != ']' && pos_ + 1 < pattern_.size()) {
+                last = peek(1);
+                if (last == '[' || last < c) {
+                    throw Unsupported();
+                }
+                pos_ += 2;
+            }
+            if (last >= 0x80) {
+                // Ranges of non-ASCII characters follow the collation order
+                throw Unsupported();
+            }
+            for (int i = c; i <= last; ++i) {
+                set[i] = true;
+            }
+        }
+
+        if (negate) {
+            set.flip();
+        }
+        set[0] = false;
+
+        return node(Node::Set, addSet(set));
+    }
+
+    static void characterClass(const std::string& name, std::vector<bool>& set) {
+        static const std::map<std::string, int (*)(int)> classes{
+            {"alpha", ::isalpha}, {"digit", ::isdigit}, {"alnum", ::isalnum},   {"upper", ::isupper},
+            {"lower", ::islower}, {"space", ::isspace}, {"blank", ::isblank},   {"punct", ::ispunct},
+            {"print", ::isprint}, {"graph", ::isgraph}, {"cntrl", ::iscntrl}, {"xdigit", ::isxdigit},
+        };
+
+        auto j = classes.find(name);
+        if (j == classes.end()) {
+            throw Unsupported();
+        }
+        for (int i = 1; i < 256; ++i) {
+            if (j->second(i)) {
+                set[i] = true;
+            }
+        }
+    }
+
+    int any() {
+        std::vector<bool> set(256, true);
+        set[0] = false;
+        return node(Node::Set, addSet(set));
+    }
+
+    int single(unsigned char c) {
+        std::vector<bool> set(256, false);
+        set[c] = true;
+        return node(Node::Set, addSet(set), c);
+    }
+
+    int addSet(const std::vector<bool>& set) {
+        sets_.push_back(set);
+        return int(sets_.size() - 1);
+    }
+
+    int node(Node::Type type, int set = -1, int min = 0, int max = 0, const std::vector<int>& children = {}) {
+        nodes_.push_back({type, set, min, max, children});
+        return int(nodes_.size() - 1);
+    }
+
+    // -- Literals
+
+    bool singleton(int n) const { return nodes_[n].type_ == Node::Set && nodes_[n].min_ > 0; }
+
+    void flatten(int n, std::vector<int>& result) const {
+        if (nodes_[n].type_ == Node::Concat) {
+            for (int c : nodes_[n].children_) {
+                flatten(c, result);
+            }
+            return;
+        }
+        result.push_back(n);
+    }
+
+    /// The longest run of single bytes that every match of node n contains
+    std::string required(int n) const {
+        std::vector<int> pieces;
+        flatten(n, pieces);
+
+        std::string best;
+        std::string run;
+        for (int p : pieces) {
+            if (singleton(p)) {
+                run += char(nodes_[p].min_);
+                continue;
+            }
+
+            if (run.size() > best.size()) {
+                best = run;
+            }
+            run.clear();
+
+            if (nodes_[p].type_ == Node::Repeat && nodes_[p].min_ > 0) {
+                std::string inner = required(nodes_[p].children_.front());
+                if (inner.size() > best.size()) {
+                    best = inner;
+                }
+            }
+        }
+        return run.size() > best.size() ? run : best;
+    }
+
+    void literal(int root, RegexDFA& dfa) const {
+        std::vector<int> pieces;
+        flatten(root, pieces);
+
+        const bool begin = nodes_[pieces.front()].type_ == Node::Begin;
+        const bool end   = pieces.size() > size_t(begin) && nodes_[pieces.back()].type_ == Node::End;
+
+        std::string literal;
+        bool simple = true;
+        for (size_t i = begin ? 1 : 0; i < pieces.size() - (end ? 1 : 0); ++i) {
+            if (!singleton(pieces[i])) {
+                simple = false;
+                break;
+            }
+            literal += char(nodes_[pieces[i]].min_);
+        }
+
+        if (simple) {
+            dfa.kind_ = begin ? (end ? Equal : Prefix) : (end ? Suffix : Contains);
+            dfa.literal_ = literal;
+            return;
+        }
+
+        dfa.kind_    = Automaton;
+        dfa.literal_ = required(root);
+    }
+
+    // -- NFA
+
+    /// Builds the states of node n backwards, from the state that follows it, and returns its first state
+    int compile(int n, int out, std::vector<State>& nfa) const {
+        if (nfa.size() > maxNFAStates) {
+            throw Unsupported();
+        }
+
+        const Node& node = nodes_[n];
+        switch (node.type_) {
+            case Node::Set:
+                return add(nfa, {State::Byte, node.set_, out, -1});
+
+            case Node::Begin:
+                return add(nfa, {State::Begin, -1, out, -1});
+
+            case Node::End:
+                return add(nfa, {State::End, -1, out, -1});
+
+            case Node::Concat:
+                for (auto c = node.children_.rbegin(); c != node.children_.rend(); ++c) {
+                    out = compile(*c, out, nfa);
+                }
+                return out;
+
+            case Node::Alternation: {
+                int first = compile(node.children_.back(), out, nfa);
+                for (auto c = node.children_.rbegin() + 1; c != node.children_.rend(); ++c) {
+                    first = add(nfa, {State::Split, -1, compile(*c, out, nfa), first});
+                }
+                return first;
+            }
+
+            case Node::Repeat: {
+                const int child = node.children_.front();
+                int first       = out;
+
+                if (node.max_ == unbounded) {
+                    // The loop state is patched once the body, which leads back to it, is built
+                    int loop           = add(nfa, {State::Split, -1, -1, out});
+                    nfa[loop].out_     = compile(child, loop, nfa);
+                    first              = loop;
+                }
+                else {
+                    for (int i = node.min_; i < node.max_; ++i) {
+                        first = add(nfa, {State::Split, -1, compile(child, first, nfa), out});
+                    }
+                }
+
+                for (int i = 0; i < node.min_; ++i) {
+                    first = compile(child, first, nfa);
+                }
+                return first;
+            }
+        }
+
+        NOTIMP;
+    }
+
+    static int add(std::vector<State>& nfa, const State& state) {
+        nfa.push_back(state);
+        return int(nfa.size() - 1);
+    }
+
+private:
+    const std::string& pattern_;
+    size_t pos_;
+    bool extended_;
+
+    std::vector<Node> nodes_;
+    std::vector<std::vector<bool>> sets_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+RegexDFA::RegexDFA() :
+    kind_(Automaton), start_(-1), nclasses_(0) {}
+
+RegexDFA::~RegexDFA() = default;
+
+std::unique_ptr<RegexDFA> RegexDFA::compile(const std::string& pattern, bool extended) {
+    if (!classicLocale()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<RegexDFA> dfa(new RegexDFA());
+    try {
+        Parser(pattern, extended).parse(*dfa);
+    }
+    catch (Unsupported&) {
+        return nullptr;
+    }
+
+    if (!dfa->anchorsAtEdges()) {
+        return nullptr;
+    }
+
+    if (dfa->kind_ == Automaton) {
+        dfa->build();
+    }
+    return dfa;
+}
+
+bool RegexDFA::anchorsAtEdges() const {
+    // glibc lets '^' and '$' match next to a newline that is part of the match, e.g. /a$\nb/ matches "a\nb", which is
+    // only possible if bytes are matched before a '^' or after a '$'
+
+    std::vector<char> seen(nfa_.size(), 0);
+    std::vector<int> stack;
+
+    for (const State& state : nfa_) {
+        if (state.kind_ == State::Byte) {
+            stack.push_back(state.out_);
+        }
+    }
+
+    auto reaches = [&](State::Kind kind) {
+        while (!stack.empty()) {
+            const int s = stack.back();
+            stack.pop_back();
+            if (seen[s]) {
+                continue;
+            }
+            seen[s] = 1;
+
+            const State& state = nfa_[s];
+            if (state.kind_ == kind) {
+                return true;
+            }
+            if (state.kind_ != State::Byte && state.kind_ != State::Match) {
+                stack.push_back(state.out_);
+                if (state.kind_ == State::Split) {
+                    stack.push_back(state.out1_);
+                }
+            }
+        }
+        return false;
+    };
+
+    // No '^' after a byte
+    if (reaches(State::Begin)) {
+        return false;
+    }
+
+    // No byte after a '$'
+    std::fill(seen.begin(), seen.end(), 0);
+    for (const State& state : nfa_) {
+        if (state.kind_ == State::End) {
+            stack.push_back(state.out_);
+        }
+    }
+    return !reaches(State::Byte);
+}
+
+void RegexDFA::build() {
+
+    // Bytes belonging to the same sets are equivalent
+
+    std::map<std::vector<bool>, int> signatures;
+    for (int b = 0; b < 256; ++b) {
+        std::vector<bool> signature(sets_.size());
+        for (size_t i = 0; i < sets_.size(); ++i) {
+            signature[i] = sets_[i][b];
+        }
+        classes_[b] = uint8_t(signatures.emplace(signature, int(signatures.size())).first->second);
+    }
+    nclasses_ = signatures.size();
+
+    for (int b = 255; b >= 0; --b) {
+        representative_[classes_[b]] = uint8_t(b);
+    }
+
+    std::vector<char> seen(nfa_.size(), 0);
+
+    initial_.assign(1, start_);
+    closure(initial_, seen, true, false);
+
+    restart_.assign(1, start_);
+    closure(restart_, seen, false, false);
+
+    if (std::binary_search(initial_.begin(), initial_.end(), 0)) {
+        // The empty string matches, so everything does
+        kind_ = Contains;
+        literal_.clear();
+        return;
+    }
+
+    // Subset construction. The initial state is not shared with the others, as only there can '^' match
+
+    std::vector<std::vector<int>> states{initial_};
+    std::map<std::vector<int>, int32_t> index;
+
+    accepting_.push_back(accepts(initial_, true));
+
+    std::vector<int> next;
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (states.size() > maxDFAStates) {
+            table_.clear();
+            accepting_.clear();
+            return;
+        }
+
+        const std::vector<int> current = states[i];
+        table_.resize((i + 1) * nclasses_);
+
+        for (size_t cls = 0; cls < nclasses_; ++cls) {
+            step(current, int(cls), next, seen);
+
+            int32_t target = Dead;
+            if (std::binary_search(next.begin(), next.end(), 0)) {
+                target = Accept;
+            }
+            else if (!next.empty()) {
+                auto j = index.emplace(next, int32_t(states.size()));
+                if (j.second) {
+                    states.push_back(next);
+                    accepting_.push_back(accepts(next, false));
+                }
+                target = j.first->second * int32_t(nclasses_);
+            }
+            table_[i * nclasses_ + cls] = target;
+        }
+    }
+}
+
+void RegexDFA::closure(std::vector<int>& set, std::vector<char>& seen, bool begin, bool end) const {
+    std::vector<int> stack;
+    std::vector<int> visited;
+    stack.swap(set);
+
+    while (!stack.empty()) {
+        const int s = stack.back();
+        stack.pop_back();
+
+        if (seen[s]) {
+            continue;
+        }
+        seen[s] = 1;
+        visited.push_back(s);
+
+        const State& state = nfa_[s];
+        switch (state.kind_) {
+            case State::Byte:
+            case State::Match:
+                set.push_back(s);
+                break;
+
+            case State::End:
+                if (end) {
+                    stack.push_back(state.out_);
+                }
+                else {
+                    set.push_back(s);
+                }
+                break;
+
+            case State::Begin:
+                if (begin) {
+                    stack.push_back(state.out_);
+                }
+                break;
+
+            case State::Split:
+                stack.push_back(state.out1_);
+                stack.push_back(state.out_);
+                break;
+
+            case State::Jump:
+                stack.push_back(state.out_);
+                break;
+        }
+    }
+
+    for (int s : visited) {
+        seen[s] = 0;
+    }
+
+    std::sort(set.begin(), set.end());
+}
+
+void RegexDFA::step(const std::vector<int>& set, int cls, std::vector<int>& next, std::vector<char>& seen) const {
+    const unsigned char byte = representative_[cls];
+
+    next = restart_;
+    for (int s : set) {
+        const State& state = nfa_[s];
+        if (state.kind_ == State::Byte && sets_[state.set_][byte]) {
+            next.push_back(state.out_);
+        }
+    }
+    closure(next, seen, false, false);
+}
+
+bool RegexDFA::accepts(const std::vector<int>& set, bool begin) const {
+    std::vector<int> end;
+    for (int s : set) {
+        if (nfa_[s].kind_ == State::End) {
+            end.push_back(nfa_[s].out_);
+        }
+    }
+
+    std::vector<char> seen(nfa_.size(), 0);
+    closure(end, seen, begin, true);
+    return std::binary_search(end.begin(), end.end(), 0);
+}
+
+bool RegexDFA::search(const char* s, size_t len) const {
+    const std::string_view string(s, len);
+
+    switch (kind_) {
+        case Contains:
+            return string.find(literal_) != std::string_view::npos;
+
+        case Prefix:
+            return string.substr(0, literal_.size()) == literal_;
+
+        case Suffix:
+            return len >= literal_.size() && string.substr(len - literal_.size()) == literal_;
+
+        case Equal:
+            return string == literal_;
+
+        case Automaton:
+            break;
+    }
+
+    if (!literal_.empty() && string.find(literal_) == std::string_view::npos) {
+        return false;
+    }
+
+    const auto* p = reinterpret_cast<const unsigned char*>(s);
+    if (table_.empty()) {
+        return simulate(p, len);
+    }
+
+    const int32_t* table = table_.data();
+    const uint8_t* classes = classes_;
+
+    int32_t state = 0;
+    for (size_t i = 0; i < len; ++i) {
+        state = table[state + classes[p[i]]];
+        if (state < 0) {
+            return state == Accept;
+        }
+    }
+    return accepting_[state / int32_t(nclasses_)];
+}
+
+bool RegexDFA::simulate(const unsigned char* s, size_t len) const {
+    std::vector<char> seen(nfa_.size(), 0);
+    std::vector<int> set = initial_;
+    std::vector<int> next;
+
+    for (size_t i = 0; i < len; ++i) {
+        step(set, classes_[s[i]], next, seen);
+        if (std::binary_search(next.begin(), next.end(), 0)) {
+            return true;
+        }
+        if (next.empty()) {
+            return false;
+        }
+        set.swap(next);
+    }
+    return accepts(set, len == 0);
+}
+
+void RegexDFA::print(std::ostream& s) const {
+    static const char* kinds[] = {"automaton", "contains", "prefix", "suffix", "equal"};
+    s << "RegexDFA[" << kinds[kind_];
+    if (!literal_.empty()) {
+        s << ",literal=" << literal_;
+    }
+    if (kind_ == Automaton) {
+        s << ",nfa=" << nfa_.size() << ",classes=" << nclasses_ << ",dfa=" << accepting_.size();
+    }
+    s << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,127 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_RegexDFA_h
+#define eckit_RegexDFA_h
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Automaton answering the same question as regexec(): does a POSIX regular expression match anywhere in a string.
+///
+/// The expression is compiled into a Thompson NFA, which is turned into a DFA over classes of equivalent bytes. Matching
+/// is then one table lookup per byte, without backtracking, and the automaton is immutable so it can be shared between
+/// threads. Patterns whose DFA would be too large are matched by simulating the NFA, still in linear time.
+///
+/// Before running the automaton, strings are searched for a literal that every match must contain, and patterns that
+/// are just a literal (possibly anchored) never run it.
+///
+/// Only the syntax whose meaning is unambiguous is supported: literals, '.', bracket expressions with ranges and
+/// character classes, anchors, grouping, alternation and the repetition operators, in the extended (ERE) or basic (BRE)
+/// syntax. Anything else (back-references, GNU extensions, collating elements, multi-byte or non-C locales) is left to
+/// the POSIX engine.
+
+class RegexDFA : private NonCopyable {
+public:  // methods
+    /// @returns the automaton for a pattern, or nullptr if the pattern is not supported
+    static std::unique_ptr<RegexDFA> compile(const std::string& pattern, bool extended);
+
+    ~RegexDFA();
+
+    /// Matches the first len bytes of s, anywhere
+    bool search(const char* s, size_t len) const;
+
+    /// A string that every match contains, or empty
+    const std::string& literal() const { return literal_; }
+
+    /// Number of DFA states, 0 if the NFA is simulated
+    size_t states() const { return accepting_.size(); }
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const RegexDFA& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // types
+    struct State {
+        enum Kind
+        {
+            Byte,
+            Split,
+            Jump,
+            Begin,
+            End,
+            Match
+        };
+        Kind kind_;
+        int set_;
+        int out_;
+        int out1_;
+    };
+
+    enum Kind
+    {
+        Automaton,  //< Run the DFA, or the NFA
+        Contains,   //< Pattern is a literal
+        Prefix,     //< ^literal
+        Suffix,     //< literal$
+        Equal       //< ^literal$
+    };
+
+    class Parser;
+
+private:  // methods
+    RegexDFA();
+
+    bool anchorsAtEdges() const;
+    void build();
+    void closure(std::vector<int>& set, std::vector<char>& seen, bool begin, bool end) const;
+    void step(const std::vector<int>& set, int cls, std::vector<int>& next, std::vector<char>& seen) const;
+    bool accepts(const std::vector<int>& set, bool begin) const;
+
+    bool simulate(const unsigned char* s, size_t len) const;
+
+private:  // members
+    Kind kind_;
+    std::string literal_;
+
+    std::vector<State> nfa_;
+    std::vector<std::vector<bool>> sets_;  //< Byte sets of the Byte states
+    int start_;  //< The Match state is always 0
+
+    uint8_t classes_[256];  //< Class of equivalent bytes, for all the byte sets
+    uint8_t representative_[256];
+    size_t nclasses_;
+    std::vector<int> initial_;  //< Closure of the start state at the beginning of the string
+    std::vector<int> restart_;  //< Closure of the start state after the first byte, where a later match can begin
+
+    std::vector<int32_t> table_;   //< nclasses_ transitions per DFA state: offset of the next state, Accept or Dead
+    std::vector<char> accepting_;  //< DFA state matches at the end of the string
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
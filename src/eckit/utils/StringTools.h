@@ -15,11 +15,14 @@
 #define eckit_StringTools_h
 
 
+#include <iterator>
 #include <map>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "eckit/memory/NonCopyable.h"
+#include "eckit/utils/NumberConversion.h"
 
 
 namespace eckit {
@@ -50,6 +53,7 @@ public:
 
     static std::vector<std::string> split(const std::string& delim, const std::string& text);
 
+    /// Joins strings, or numbers (in shortest round-trip form for floating point values)
     template <typename T>
     static std::string join(const std::string&, const T&);
 
@@ -71,15 +75,31 @@ private:
 
 template <typename Iterator>
 std::string StringTools::join(const std::string& delimiter, Iterator begin, Iterator end) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
     if (begin == end) {
         return "";
     }
-    std::string r(*begin);
-    for (Iterator it = ++begin; it != end; ++it) {
-        r += delimiter;
-        r += *it;
+
+    if constexpr (NumberConversion::supported<value_type>) {
+        char buffer[NumberConversion::maxLength];
+        std::string r;
+        for (Iterator it = begin; it != end; ++it) {
+            if (it != begin) {
+                r += delimiter;
+            }
+            r.append(buffer, NumberConversion::format(buffer, buffer + NumberConversion::maxLength, *it));
+        }
+        return r;
+    }
+    else {
+        std::string r(*begin);
+        for (Iterator it = ++begin; it != end; ++it) {
+            r += delimiter;
+            r += *it;
+        }
+        return r;
     }
-    return r;
 }
 
 template <typename T>
@@ -11,6 +11,7 @@
 #include <cstdlib>
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/utils/NumberConversion.h"
 #include "eckit/utils/StringTools.h"
 #include "eckit/utils/Tokenizer.h"
 #include "eckit/utils/Translator.h"
@@ -49,10 +50,15 @@ static unsigned long long multiplier(const char* p) {
     return 1;
 }
 
+/// Reads an integer as strtol() does
+/// @returns the characters that follow it
+template <typename T>
+static const char* scan(const std::string& s, T& value) {
+    return s.c_str() + NumberConversion::scan(s, value);
+}
+
 std::string Translator<bool, std::string>::operator()(bool value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return value ? "1" : "0";
 }
 
 bool Translator<std::string, bool>::operator()(const std::string& str) {
@@ -66,19 +72,17 @@ bool Translator<std::string, bool>::operator()(const std::string& str) {
     }
 
     // Catter for ints
-    return atoi(s.c_str());  // 0 is returned on non-conversion
+    long value;
+    scan(s, value);
+    return static_cast<int>(value);  // 0 is returned on non-conversion
 }
 
 std::string Translator<int, std::string>::operator()(int value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 std::string Translator<unsigned int, std::string>::operator()(unsigned int value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 int Translator<std::string, int>::operator()(const std::string& s) {
@@ -90,8 +94,9 @@ int Translator<std::string, int>::operator()(const std::string& s) {
     }
 
     // Catter for ints
-    char* more;
-    int result = strtol(s.c_str(), &more, 10);
+    long value;
+    const char* more = scan(s, value);
+    int result       = value;
     return result * multiplier(more);
 }
 
@@ -104,27 +109,26 @@ unsigned int Translator<std::string, unsigned int>::operator()(const std::string
     }
 
     // Catter for ints
-    char* more;
-    unsigned int result = strtoul(s.c_str(), &more, 10);
+    unsigned long value;
+    const char* more    = scan(s, value);
+    unsigned int result = value;
     return result * multiplier(more);
 }
 
 std::string Translator<long, std::string>::operator()(long value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 long Translator<std::string, long>::operator()(const std::string& s) {
-    char* more;
-    long result = strtol(s.c_str(), &more, 10);
+    long result;
+    const char* more = scan(s, result);
     return result * multiplier(more);
 }
 
 
 short Translator<std::string, short>::operator()(const std::string& s) {
-    char* more;
-    long result = strtol(s.c_str(), &more, 10);
+    long result;
+    const char* more = scan(s, result);
     result      = result * multiplier(more);
 
     ASSERT(short(result) == result);
@@ -133,8 +137,8 @@ short Translator<std::string, short>::operator()(const std::string& s) {
 
 
 unsigned char Translator<std::string, unsigned char>::operator()(const std::string& s) {
-    char* more;
-    long result = strtol(s.c_str(), &more, 10);
+    long result;
+    const char* more = scan(s, result);
     result      = result * multiplier(more);
 
     ASSERT(static_cast<unsigned char>(result) == result);
@@ -143,106 +147,69 @@ unsigned char Translator<std::string, unsigned char>::operator()(const std::stri
 
 
 std::string Translator<unsigned char, std::string>::operator()(unsigned char value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    // As std::ostream, which writes the character
+    return std::string(1, static_cast<char>(value));
 }
 
 std::string Translator<short, std::string>::operator()(short value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 
 std::string Translator<float, std::string>::operator()(float value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    // The std::ostream default precision
+    return NumberConversion::toString(value, 6);
 }
 
 std::string Translator<double, std::string>::operator()(double value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    // The std::ostream default precision
+    return NumberConversion::toString(value, 6);
 }
 
 double Translator<std::string, double>::operator()(const std::string& s) {
-    char* pend;
-    errno = 0;
-
-    double d = ::strtod(s.c_str(), &pend);
-
-    //    ECKIT_DEBUG_VAR( d );
-    //    ECKIT_DEBUG_VAR( s );
-    //    ECKIT_DEBUG_VAR( s.size() );
-    //    ECKIT_DEBUG_VAR( pend - s.c_str() );
-    //    ECKIT_DEBUG_VAR( errno );
-
-    if (s.empty() || s[0] == ' ' || static_cast<size_t>(pend - s.c_str()) != s.size() || (errno != 0)) {
+    double d;
+    if (!NumberConversion::parse(s, d)) {
         throw BadParameter("Bad conversion from std::string '" + s + "' to double", Here());
     }
-
     return d;
-
-    //    return atof(s.c_str());
 }
 
 float Translator<std::string, float>::operator()(const std::string& s) {
-    char* pend;
-    errno = 0;
-
-    float f = ::strtof(s.c_str(), &pend);
-
-    //    ECKIT_DEBUG_VAR( d );
-    //    ECKIT_DEBUG_VAR( s );
-    //    ECKIT_DEBUG_VAR( s.size() );
-    //    ECKIT_DEBUG_VAR( pend - s.c_str() );
-    //    ECKIT_DEBUG_VAR( errno );
-
-    if (s.empty() || s[0] == ' ' || static_cast<size_t>(pend - s.c_str()) != s.size() || (errno != 0)) {
+    float f;
+    if (!NumberConversion::parse(s, f)) {
         throw BadParameter("Bad conversion from std::string '" + s + "' to float", Here());
     }
-
     return f;
-
-    //    return atof(s.c_str());
 }
 
 unsigned long Translator<std::string, unsigned long>::operator()(const std::string& s) {
-    char* more;
-    unsigned long result = strtoul(s.c_str(), &more, 10);
+    unsigned long result;
+    const char* more = scan(s, result);
     return result * multiplier(more);
 }
 
 std::string Translator<unsigned long, std::string>::operator()(unsigned long value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 unsigned long long Translator<std::string, unsigned long long>::operator()(const std::string& s) {
-    char* more;
-    unsigned long long result = strtoull(s.c_str(), &more, 10);
+    unsigned long long result;
+    const char* more = scan(s, result);
     return result * multiplier(more);
 }
 
 std::string Translator<unsigned long long, std::string>::operator()(unsigned long long value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 long long Translator<std::string, long long>::operator()(const std::string& s) {
-    char* more;
-    long long result = strtoll(s.c_str(), &more, 10);
+    long long result;
+    const char* more = scan(s, result);
     return result * multiplier(more);
 }
 
 std::string Translator<long long, std::string>::operator()(long long value) {
-    std::ostringstream s;
-    s << value;
-    return s.str();
+    return NumberConversion::toString(value);
 }
 
 std::vector<std::string> Translator<std::string, std::vector<std::string> >::operator()(const std::string& s) {
@@ -0,0 +1,39 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/web/MetricsResource.h"
+#include "eckit/runtime/MetricsRegistry.h"
+#include "eckit/web/HttpStream.h"
+#include "eckit/web/Url.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MetricsResource::MetricsResource() :
+    HttpResource("/metrics") {}
+
+MetricsResource::~MetricsResource() {}
+
+void MetricsResource::GET(std::ostream& out, Url& url) {
+    url.headerOut().type("text/plain; version=0.0.4");
+    url.dontCache();
+
+    out << HttpStream::dontEncode;
+    MetricsRegistry::instance().prometheus(out);
+    out << HttpStream::doEncode;
+}
+
+static MetricsResource metricsResourceInstance;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,38 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef eckit_web_MetricsResource_H
+#define eckit_web_MetricsResource_H
+
+#include "eckit/web/HttpResource.h"
+
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Serves the MetricsRegistry at /metrics, in the Prometheus text format
+class MetricsResource : public HttpResource {
+public:
+    MetricsResource();
+
+    ~MetricsResource() override;
+
+private:
+    void GET(std::ostream&, Url&) override;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
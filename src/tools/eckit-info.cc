@@ -8,6 +8,7 @@
  * does it submit to any jurisdiction.
  */
 
+#include <iomanip>
 #include <iostream>
 
 #include "eckit/config/LibEcKit.h"
@@ -16,6 +17,7 @@
 #include "eckit/log/Log.h"
 #include "eckit/option/CmdArgs.h"
 #include "eckit/option/EckitTool.h"
+#include "eckit/parser/JSONParser.h"
 #include "eckit/system/Library.h"
 #include "eckit/system/LibraryManager.h"
 
@@ -36,6 +38,9 @@ public:  // methods
         options_.push_back(new eckit::option::SimpleOption<bool>("available-plugins", "Discover available plugins"));
 
         options_.push_back(new eckit::option::SimpleOption<bool>("version", "Print version number"));
+
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "io-profile", "Print the I/O profile saved by a process, see ECKIT_IO_PROFILER_OUTPUT"));
     }
 
 private:  // methods
@@ -44,8 +49,36 @@ private:  // methods
     virtual int minimumPositionalArguments() const {
         return 0;
     }
+
+    static void printProfile(const eckit::Value&);
 };
 
+void EckitInfo::printProfile(const eckit::Value& profile) {
+    static const char* operations[] = {"open", "read", "write", "seek", "flush", "close"};
+    static const char* statistics[] = {"count", "mean", "p50", "p90", "p99", "p99.9", "max"};
+
+    eckit::ValueMap classes = profile;
+    for (const auto& c : classes) {
+        eckit::ValueMap prefixes = c.second;
+        for (const auto& p : prefixes) {
+            const eckit::Value& v = p.second;
+            std::cout << std::string(c.first) << " " << std::string(p.first) << ": " << v["bytes_read"]
+                      << " bytes read, " << v["bytes_written"] << " bytes written" << std::endl;
+
+            for (const char* op : operations) {
+                if (v.contains(op)) {
+                    const eckit::Value& h = v[op];
+                    std::cout << "  " << std::setw(6) << op;
+                    for (const char* s : statistics) {
+                        std::cout << " " << s << "=" << h[s];
+                    }
+                    std::cout << std::endl;
+                }
+            }
+        }
+    }
+}
+
 void EckitInfo::usage(const std::string& tool) const {
     eckit::Log::info() << std::endl
                        << "Usage: " << tool << "[options] ..." << std::endl;
@@ -96,6 +129,12 @@ void EckitInfo::execute(const eckit::option::CmdArgs& args) {
             json.endList();
         }
 
+        std::string profile;
+        args.get("io-profile", profile);
+        if (!profile.empty()) {
+            json << "io-profile" << eckit::JSONParser::decodeFile(profile);
+        }
+
         json.endObject();
     }
     else {
@@ -127,6 +166,13 @@ void EckitInfo::execute(const eckit::option::CmdArgs& args) {
                 std::cout << "  " << plugin << std::endl;
             }
         }
+
+        std::string profile;
+        args.get("io-profile", profile);
+        if (!profile.empty()) {
+            std::cout << "I/O profile (latencies in seconds):" << std::endl;
+            printProfile(eckit::JSONParser::decodeFile(profile));
+        }
     }
 }
 
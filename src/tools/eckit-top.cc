@@ -0,0 +1,188 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <unistd.h>
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "eckit/option/CmdArgs.h"
+#include "eckit/option/EckitTool.h"
+#include "eckit/runtime/Monitor.h"
+#include "eckit/runtime/ProcessControler.h"
+#include "eckit/runtime/TaskInfo.h"
+
+using eckit::Monitor;
+using eckit::TaskInfo;
+using eckit::TaskStatistic;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Live view of the statistics published by the tasks in the monitor, see TaskInfo::statistic()
+class EckitTop : public eckit::EckitTool {
+
+public:  // methods
+    EckitTop(int argc, char** argv) :
+        eckit::EckitTool(argc, argv) {
+        options_.push_back(new eckit::option::SimpleOption<double>("interval", "Seconds between samples, default 1"));
+        options_.push_back(
+            new eckit::option::SimpleOption<long>("iterations", "Number of samples, default 0 (until interrupted)"));
+        options_.push_back(new eckit::option::SimpleOption<long>("pid", "Only show the tasks of this process"));
+        options_.push_back(new eckit::option::SimpleOption<bool>("batch", "Do not clear the screen between samples"));
+    }
+
+private:  // types
+    struct Previous {
+        pid_t pid_;
+        double value_;
+        double time_;
+        double rate_;
+    };
+
+private:  // methods
+    virtual void execute(const eckit::option::CmdArgs& args);
+    virtual void usage(const std::string& tool) const;
+    virtual int minimumPositionalArguments() const { return 0; }
+
+    /// Change of value per second since the previous sample
+    double rate(size_t task, size_t slot, pid_t pid, const TaskStatistic&, double value);
+
+private:  // members
+    std::map<std::pair<size_t, size_t>, Previous> previous_;
+};
+
+void EckitTop::usage(const std::string& tool) const {
+    eckit::Log::info() << std::endl << "Usage: " << tool << " [--interval=<seconds>] [--iterations=<n>] [--pid=<pid>]"
+                       << std::endl;
+    eckit::EckitTool::usage(tool);
+}
+
+double EckitTop::rate(size_t task, size_t slot, pid_t pid, const TaskStatistic& s, double value) {
+    double time = s.time_.tv_sec + s.time_.tv_usec / 1e6;
+
+    auto j = previous_.find(std::make_pair(task, slot));
+    if (j == previous_.end()) {
+        previous_[std::make_pair(task, slot)] = Previous{pid, value, time, 0};
+        return 0;
+    }
+
+    // Keep the last rate if the task did not publish since the previous sample
+
+    Previous& p = j->second;
+    if (p.pid_ == pid && time == p.time_) {
+        return p.rate_;
+    }
+
+    double r = 0;
+    if (p.pid_ == pid && time > p.time_ && value >= p.value_) {
+        r = (value - p.value_) / (time - p.time_);
+    }
+
+    p = Previous{pid, value, time, r};
+    return r;
+}
+
+void EckitTop::execute(const eckit::option::CmdArgs& args) {
+    double interval = 1;
+    long iterations = 0;
+    long pid        = 0;
+    bool batch      = false;
+
+    args.get("interval", interval);
+    args.get("iterations", iterations);
+    args.get("pid", pid);
+    args.get("batch", batch);
+
+    Monitor::active(true);
+    Monitor& monitor = Monitor::instance();
+
+    Monitor::TaskArray& tasks = monitor.tasks();
+    long self                 = monitor.self();
+
+    TaskStatistic s;
+
+    for (long n = 0; iterations == 0 || n < iterations; ++n) {
+        if (n) {
+            ::usleep(static_cast<useconds_t>(interval * 1e6));
+        }
+
+        if (!batch) {
+            std::cout << "\033[H\033[2J";
+        }
+
+        std::cout << std::setw(8) << "PID" << " " << std::setw(32) << std::left << "STATISTIC" << std::right
+                  << std::setw(14) << "VALUE" << std::setw(14) << "RATE/s" << std::setw(12) << "MEAN"
+                  << std::setw(12) << "P50" << std::setw(12) << "P99" << std::setw(12) << "MAX" << std::endl;
+
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (long(i) == self) {
+                continue;
+            }
+
+            const TaskInfo& task = tasks[i];
+            if (pid && task.pid() != pid) {
+                continue;
+            }
+
+            bool header = false;
+            for (size_t j = 0; j < TaskInfo::statistics(); ++j) {
+                if (!task.sample(j, s)) {
+                    continue;
+                }
+
+                if (!header) {
+                    if (!eckit::ProcessControler::isRunning(task.pid())) {
+                        break;
+                    }
+                    std::cout << std::setw(8) << task.pid() << " " << task.name() << " [" << task.status() << "]"
+                              << std::endl;
+                    header = true;
+                }
+
+                std::cout << std::setw(8) << "" << " " << std::setw(32) << std::left << s.name_ << std::right
+                          << std::fixed << std::setprecision(0);
+
+                switch (s.kind_) {
+                    case TaskStatistic::COUNTER:
+                        std::cout << std::setw(14) << s.values_[0] << std::setw(14)
+                                  << rate(i, j, task.pid(), s, s.values_[0]);
+                        break;
+
+                    case TaskStatistic::GAUGE:
+                        std::cout << std::setw(14) << s.values_[0];
+                        break;
+
+                    case TaskStatistic::LATENCY:
+                        std::cout << std::setw(14) << s.values_[TaskStatistic::COUNT] << std::setw(14)
+                                  << rate(i, j, task.pid(), s, s.values_[TaskStatistic::COUNT])
+                                  << std::setprecision(3);
+                        for (size_t k : {TaskStatistic::MEAN, TaskStatistic::P50, TaskStatistic::P99,
+                                         TaskStatistic::MAX}) {
+                            std::cout << std::setw(10) << s.values_[k] * 1e3 << "ms";
+                        }
+                        break;
+                }
+
+                std::cout << std::endl;
+            }
+        }
+
+        std::cout << std::flush;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    EckitTop app(argc, argv);
+    return app.start();
+}
@@ -8,6 +8,7 @@
  * does it submit to any jurisdiction.
  */
 
+#include <cmath>
 #include <vector>
 
 #include "eckit/geometry/Point2.h"
@@ -374,6 +375,45 @@ CASE("LonLatPolygon") {
     }
 }
 
+CASE("LonLatPolygon batch") {
+    using geometry::Point2;
+    using geometry::polygon::LonLatPolygon;
+
+    // A wavy band around the globe, with many vertices on the same latitudes, closed over the North pole
+    std::vector<Point2> points;
+    for (size_t i = 0; i <= 3600; ++i) {
+        points.emplace_back(-180. + 0.1 * double(i), std::round(40. * std::sin(double(i) * M_PI / 180.)));
+    }
+    points.emplace_back(180., 90.);
+    points.emplace_back(-180., 90.);
+    points.push_back(points.front());
+
+    std::vector<Point2> queries;
+    for (double lat = -90.; lat <= 90.; lat += 0.5) {
+        for (double lon = -540.; lon <= 540.; lon += 1.5) {
+            queries.emplace_back(lon, lat);
+        }
+    }
+    queries.insert(queries.end(), points.begin(), points.end());
+
+    for (bool includePoles : {true, false}) {
+        LonLatPolygon poly(points, includePoles);
+
+        std::vector<bool> result;
+        poly.contains(queries, result);
+        EXPECT(result.size() == queries.size());
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            EXPECT(result[i] == poly.contains(queries[i]));
+        }
+
+        EXPECT(poly.contains({0., 60.}));
+        EXPECT(!poly.contains({0., -60.}));
+        EXPECT(poly.contains({540., 60.}));
+        EXPECT(poly.contains({0., 90.}));
+    }
+}
+
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
@@ -10,8 +10,11 @@
 
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include "eckit/geometry/Point2.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/geometry/EllipsoidOfRevolution.h"
 #include "eckit/geometry/Point3.h"
 #include "eckit/geometry/SphereT.h"
 #include "eckit/geometry/UnitSphere.h"
@@ -245,6 +248,86 @@ CASE("test two units sphere sub areas") {
     EXPECT(4. * sub_area_sphere_1 == sub_area_sphere_2);
 }
 
+// -----------------------------------------------------------------------------
+// test batch versions
+
+CASE("test unit sphere batch conversions") {
+    std::vector<double> lon;
+    std::vector<double> lat;
+    for (double x = -540.; x <= 540.; x += 22.5) {
+        for (double y = -90.; y <= 90.; y += 7.5) {
+            lon.push_back(x);
+            lat.push_back(y);
+        }
+    }
+
+    const size_t n = lon.size();
+    std::vector<double> x(n), y(n), z(n), lon2(n), lat2(n);
+
+    UnitSphere::convertSphericalToCartesian(n, lon.data(), lat.data(), x.data(), y.data(), z.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        PointXYZ p;
+        UnitSphere::convertSphericalToCartesian(PointLonLat(lon[i], lat[i]), p);
+
+        EXPECT(types::is_approximately_equal(x[i], p.x(), 1e-14));
+        EXPECT(types::is_approximately_equal(y[i], p.y(), 1e-14));
+        EXPECT(types::is_approximately_equal(z[i], p.z(), 1e-14));
+
+        // exact at the poles and quadrants
+        if (std::fmod(lon[i], 90.) == 0. && std::fmod(lat[i], 90.) == 0.) {
+            EXPECT(x[i] == p.x() && y[i] == p.y() && z[i] == p.z());
+        }
+    }
+
+    UnitSphere::convertCartesianToSpherical(n, x.data(), y.data(), z.data(), lon2.data(), lat2.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        PointLonLat q(0., 0.);
+        UnitSphere::convertCartesianToSpherical(Point3(x[i], y[i], z[i]), q);
+        EXPECT(lon2[i] == q.lon() && lat2[i] == q.lat());
+    }
+
+    std::vector<double> angle(n), distance(n);
+    std::vector<double> lon0(n, -71.6), lat0(n, -33.);
+
+    UnitSphere::centralAngle(n, lon0.data(), lat0.data(), lon.data(), lat.data(), angle.data());
+    TwoUnitsSphere::distance(n, lon0.data(), lat0.data(), lon.data(), lat.data(), distance.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        const double a = UnitSphere::centralAngle(PointLonLat(-71.6, -33.), PointLonLat(lon[i], lat[i]));
+        EXPECT(types::is_approximately_equal(angle[i], a, 1e-14));
+        EXPECT(types::is_approximately_equal(distance[i], 2. * a, 1e-14));
+    }
+
+    lat[0] = 90.1;
+    EXPECT_THROWS_AS(UnitSphere::convertSphericalToCartesian(n, lon.data(), lat.data(), x.data(), y.data(), z.data()),
+                     BadValue);
+}
+
+CASE("test ellipsoid batch conversions") {
+    const double a = 6378137.;
+    const double b = 6356752.314245;
+
+    std::vector<double> lon{-180., -90., 0., 45., 90., 180., 270., 12.3, -45.6};
+    std::vector<double> lat{-90., 0., 90., 45., -45., 0., 60., 78.9, -12.3};
+
+    const size_t n = lon.size();
+    std::vector<double> x(n), y(n), z(n);
+
+    EllipsoidOfRevolution::convertSphericalToCartesian(a, b, n, lon.data(), lat.data(), x.data(), y.data(), z.data(),
+                                                       100.);
+
+    for (size_t i = 0; i < n; ++i) {
+        PointXYZ p;
+        EllipsoidOfRevolution::convertSphericalToCartesian(a, b, PointLonLat(lon[i], lat[i]), p, 100.);
+
+        EXPECT(types::is_approximately_equal(x[i], p.x(), 1e-6));
+        EXPECT(types::is_approximately_equal(y[i], p.y(), 1e-6));
+        EXPECT(types::is_approximately_equal(z[i], p.z(), 1e-6));
+    }
+}
+
 // -----------------------------------------------------------------------------
 
 }  // namespace eckit::test
@@ -0,0 +1,191 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/CachingHandle.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/PartFileHandle.h"
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Set in main(), before the cache is created
+static const size_t blockSize = 4096;
+
+class Tester {
+public:
+    Tester(size_t size) :
+        data_(size) {
+        for (size_t i = 0; i < size; ++i) {
+            data_[i] = char(i * 7 + i / 4096);
+        }
+
+        path_ = PathName::unique(std::string(Resource<std::string>("$TMPDIR", "/tmp")) + "/cachinghandle");
+        path_ += ".dat";
+
+        FileHandle f(path_);
+        f.openForWrite(0);
+        f.write(data_.data(), long(data_.size()));
+        f.close();
+
+        HandleCache::instance().clear();
+    }
+
+    ~Tester() { path_.unlink(false); }
+
+    std::string readAll(DataHandle& h, long chunk) {
+        std::string result;
+        Buffer buffer(chunk);
+        h.openForRead();
+        long len;
+        while ((len = h.read(buffer, chunk)) > 0) {
+            result.append(buffer, len);
+        }
+        h.close();
+        return result;
+    }
+
+    std::string data() const { return std::string(data_.begin(), data_.end()); }
+
+    PathName path_;
+    std::vector<char> data_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Blocks are read once from the source") {
+    Tester test(5 * blockSize + 100);
+    HandleCache& cache = HandleCache::instance();
+
+    unsigned long long misses = cache.misses();
+
+    CachingHandle first(new FileHandle(test.path_));
+    EXPECT(test.readAll(first, 1000) == test.data());
+    EXPECT(first.misses() == 6);
+    EXPECT(first.hits() == 0);
+    EXPECT(cache.misses() - misses == 6);
+
+    // Two blocks fit in memory, the others were spilled to disk
+
+    unsigned long long hits = cache.memoryHits() + cache.diskHits();
+
+    CachingHandle second(new FileHandle(test.path_));
+    EXPECT(test.readAll(second, 3000) == test.data());
+    EXPECT(second.misses() == 0);
+    EXPECT(second.hits() == 6);
+    EXPECT(cache.memoryHits() + cache.diskHits() - hits == 6);
+    EXPECT(cache.diskHits() > 0);
+}
+
+CASE("Reading parts of a file") {
+    Tester test(3 * blockSize);
+
+    CachingHandle h(new PartFileHandle(test.path_, Offset(100), Length(2 * blockSize)));
+    EXPECT(test.readAll(h, 512) == test.data().substr(100, 2 * blockSize));
+
+    // Another range of the same file is another entry
+
+    CachingHandle other(new PartFileHandle(test.path_, Offset(200), Length(blockSize / 2)));
+    EXPECT(test.readAll(other, 512) == test.data().substr(200, blockSize / 2));
+    EXPECT(other.misses() == 1);
+}
+
+CASE("Seeking") {
+    Tester test(4 * blockSize + 10);
+    std::string data = test.data();
+
+    CachingHandle h(new FileHandle(test.path_));
+    h.openForRead();
+    EXPECT(h.canSeek());
+
+    char buffer[100];
+    for (size_t off : {size_t(3 * blockSize + 50), size_t(10), size_t(blockSize - 30), size_t(4 * blockSize)}) {
+        EXPECT(h.seek(Offset(off)) == Offset(off));
+        EXPECT(h.read(buffer, sizeof(buffer)) == long(std::min(sizeof(buffer), data.size() - off)));
+        EXPECT(std::string(buffer, std::min(sizeof(buffer), data.size() - off)) == data.substr(off, sizeof(buffer)));
+    }
+
+    h.seek(Offset(data.size()));
+    EXPECT(h.read(buffer, sizeof(buffer)) == 0);
+    h.close();
+}
+
+CASE("Handles without a hash are not cached") {
+    std::string data = "some data that is not cached";
+    HandleCache& cache = HandleCache::instance();
+    unsigned long long misses = cache.misses();
+
+    CachingHandle h(new MemoryHandle(data.c_str(), data.size()));
+    Buffer buffer(100);
+    h.openForRead();
+    EXPECT(h.read(buffer, long(buffer.size())) == long(data.size()));
+    h.close();
+
+    EXPECT(std::string(buffer, data.size()) == data);
+    EXPECT(cache.misses() == misses);
+    EXPECT(h.misses() + h.hits() == 0);
+}
+
+CASE("Concurrent reads of the same blocks are done once") {
+    Tester test(2 * blockSize - 10);
+    HandleCache& cache = HandleCache::instance();
+
+    unsigned long long misses = cache.misses();
+    std::vector<std::string> results(8);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&test, &results, i] {
+            CachingHandle h(new FileHandle(test.path_));
+            results[i] = test.readAll(h, 1024);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (const auto& r : results) {
+        EXPECT(r == test.data());
+    }
+    EXPECT(cache.misses() - misses == 2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    std::string directory = PathName::unique(std::string(::getenv("TMPDIR") ? ::getenv("TMPDIR") : "/tmp") + "/cache");
+
+    ::setenv("ECKIT_HANDLE_CACHE_BLOCK_SIZE", std::to_string(eckit::test::blockSize).c_str(), 1);
+    ::setenv("ECKIT_HANDLE_CACHE_MEMORY", std::to_string(2 * eckit::test::blockSize).c_str(), 1);
+    ::setenv("ECKIT_HANDLE_CACHE_DIRECTORY", directory.c_str(), 1);
+
+    int result = run_tests(argc, argv);
+
+    HandleCache::instance().clear();
+    PathName(directory).rmdir(false);
+
+    return result;
+}
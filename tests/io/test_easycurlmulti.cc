@@ -0,0 +1,232 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/EasyCURLMulti.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/utils/StringTools.h"
+#include "eckit/utils/Translator.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+std::string object(size_t size) {
+    std::string result(size, ' ');
+    for (size_t i = 0; i < size; ++i) {
+        result[i] = char('a' + (i * 7 + size) % 26);
+    }
+    return result;
+}
+
+/// A minimal HTTP/1.1 server, with keep-alive, serving /obj/<size> and honouring single ranges
+class Server {
+public:
+    Server() : server_(0) {
+        port_ = server_.localPort();
+        std::thread([this] { accept(); }).detach();
+    }
+
+    std::string url(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(port_) + path;
+    }
+
+    size_t connections() const { return connections_; }
+    size_t requests() const { return requests_; }
+
+private:
+    void accept() {
+        for (;;) {
+            auto* socket = new net::TCPSocket(server_.accept());
+            connections_++;
+            std::thread([this, socket] {
+                serve(*socket);
+                delete socket;
+            }).detach();
+        }
+    }
+
+    static bool readLine(net::TCPSocket& socket, std::string& line) {
+        line.clear();
+        char c;
+        while (socket.read(&c, 1) == 1) {
+            if (c == '\n') {
+                return true;
+            }
+            if (c != '\r') {
+                line += c;
+            }
+        }
+        return false;
+    }
+
+    void serve(net::TCPSocket& socket) {
+        std::string line;
+        while (readLine(socket, line)) {
+            requests_++;
+
+            auto request = StringTools::split(" ", line);
+            ASSERT(request.size() == 3);
+
+            long long first = -1;
+            long long last  = -1;
+            while (readLine(socket, line) && !line.empty()) {
+                if (StringTools::startsWith(StringTools::lower(line), "range: bytes=")) {
+                    std::sscanf(line.c_str() + 13, "%lld-%lld", &first, &last);
+                }
+            }
+
+            std::ostringstream oss;
+            std::string body;
+
+            if (StringTools::startsWith(request[1], "/obj/")) {
+                body = object(Translator<std::string, size_t>()(request[1].substr(5)));
+                if (first >= 0) {
+                    oss << "HTTP/1.1 206 Partial Content\r\n"
+                        << "Content-Range: bytes " << first << "-" << last << "/" << body.size() << "\r\n";
+                    body = body.substr(first, last - first + 1);
+                }
+                else {
+                    oss << "HTTP/1.1 200 OK\r\n";
+                }
+            }
+            else {
+                oss << "HTTP/1.1 404 Not Found\r\n";
+            }
+
+            oss << "Content-Length: " << body.size() << "\r\n\r\n";
+            if (request[0] != "HEAD") {
+                oss << body;
+            }
+
+            std::string reply = oss.str();
+            if (socket.write(reply.data(), reply.size()) != long(reply.size())) {
+                return;
+            }
+        }
+    }
+
+    net::EphemeralTCPServer server_;
+    int port_;
+    std::atomic<size_t> connections_{0};
+    std::atomic<size_t> requests_{0};
+};
+
+Server& server() {
+    static Server server;
+    return server;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Concurrent GETs are streamed to their handles, reusing the connections") {
+
+    const size_t n = 50;
+    size_t connections = server().connections();
+
+    EasyCURLMulti multi(4);
+
+    std::vector<std::unique_ptr<MemoryHandle>> handles;
+    for (size_t i = 0; i < n; ++i) {
+        handles.emplace_back(new MemoryHandle(1024, true));
+        handles.back()->openForWrite(0);
+        EXPECT(multi.GET(server().url("/obj/" + std::to_string(1000 + i * 997)), *handles.back()) == i);
+    }
+
+    multi.perform();
+
+    EXPECT(multi.transfers().size() == n);
+    for (size_t i = 0; i < n; ++i) {
+        handles[i]->close();
+        const auto& t = multi.transfers()[i];
+        EXPECT(t.error_.empty());
+        EXPECT(t.code_ == 200);
+        EXPECT(t.bytes_ == Length(1000 + i * 997));
+        EXPECT(handles[i]->str() == object(1000 + i * 997));
+    }
+
+    EXPECT(server().connections() - connections <= multi.maxTransfers());
+
+    // Transfers can be queued again, on the connections kept
+
+    connections = server().connections();
+    multi.clear();
+
+    MemoryHandle h(1024, true);
+    h.openForWrite(0);
+    multi.GET(server().url("/obj/100000"), h, 500, 1000);
+    multi.perform();
+    h.close();
+
+    EXPECT(multi.transfers()[0].code_ == 206);
+    EXPECT(h.str() == object(100000).substr(500, 1000));
+    EXPECT(server().connections() == connections);
+}
+
+CASE("Failed transfers are reported by perform") {
+
+    EasyCURLMulti multi(2);
+
+    MemoryHandle good(1024, true);
+    MemoryHandle bad(1024, true);
+    good.openForWrite(0);
+    bad.openForWrite(0);
+
+    multi.GET(server().url("/obj/1234"), good);
+    multi.GET(server().url("/missing"), bad);
+
+    EXPECT_THROWS_AS(multi.perform(), ReadError);
+
+    good.close();
+    EXPECT(multi.transfers()[0].error_.empty());
+    EXPECT(good.str() == object(1234));
+
+    EXPECT(!multi.transfers()[1].error_.empty());
+    EXPECT(multi.transfers()[1].code_ == 404);
+}
+
+CASE("Large objects are fetched in ranges, written in order") {
+
+    EasyCURLMulti multi(3);
+
+    EXPECT(multi.contentLength(server().url("/obj/1000003")) == Length(1000003));
+
+    MemoryHandle h(1024, true);
+    h.openForWrite(0);
+    EXPECT(multi.GETRanges(server().url("/obj/1000003"), h, 65536) == Length(1000003));
+    h.close();
+
+    EXPECT(h.str() == object(1000003));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -371,6 +371,51 @@ CASE("Multihandle") {
             EXPECT(r == 0);
         }
     }
+
+    SECTION("Multihandle prefetching") {
+
+        char expect[] = "aAbcBCdefgDEFGhijklmnoHIJKLMNOpqrstuvwxyz01234PQRSTUVWXYZ56789";
+
+        MultiHandle mh;
+        for (int i = 0; i < 5; i++) {
+            mh += new PartFileHandle(test.path1_, (1 << i) - 1, 1 << i);
+            mh += new PartFileHandle(test.path2_, (1 << i) - 1, 1 << i);
+        }
+        mh.prefetch(3);
+        EXPECT(mh.prefetch() == 3);
+
+        MemoryHandle result(128);
+        EXPECT_NO_THROW(mh.saveInto(result));
+        EXPECT(::memcmp(expect, result.data(), strlen(expect)) == 0);
+
+        mh.openForRead();
+        {
+            Buffer buff = Tester::makeBuffer();
+            long r      = mh.read(buff, 20);
+            EXPECT(r == 20);
+            EXPECT(std::string(buff) == "aAbcBCdefgDEFGhijklm");
+        }
+        EXPECT(mh.position() == Offset(20));
+
+        EXPECT_NO_THROW(mh.seek(40));
+        EXPECT(mh.position() == Offset(40));
+        {
+            Buffer buff = Tester::makeBuffer();
+            long r      = mh.read(buff, 10);
+            EXPECT(r == 10);
+            EXPECT(std::string(buff) == "z01234PQRS");
+        }
+
+        EXPECT_NO_THROW(mh.restartReadFrom(5));
+        {
+            Buffer buff = Tester::makeBuffer();
+            long r      = mh.read(buff, 128);
+            EXPECT(r == 57);
+            EXPECT(std::string(buff) == expect + 5);
+        }
+        EXPECT(mh.position() == Offset(62));
+        mh.close();
+    }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
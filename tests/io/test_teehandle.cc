@@ -0,0 +1,135 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/TeeHandle.h"
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Fails to write after a given number of bytes
+class FailingHandle : public DataHandle {
+public:
+    FailingHandle(long limit) :
+        limit_(limit), written_(0), closed_(false) {}
+
+    void openForWrite(const Length&) override {}
+    long write(const void*, long length) override {
+        if (written_ + length > limit_) {
+            throw WriteError("FailingHandle: limit reached");
+        }
+        written_ += length;
+        return length;
+    }
+    void close() override { closed_ = true; }
+    void print(std::ostream& s) const override { s << "FailingHandle[" << limit_ << "]"; }
+
+    long limit_;
+    long written_;
+    bool closed_;
+};
+
+std::string expected(size_t blocks) {
+    std::string result;
+    for (size_t i = 0; i < blocks; ++i) {
+        result += std::string(1000, char('a' + i % 26));
+    }
+    return result;
+}
+
+void write(TeeHandle& tee, size_t blocks) {
+    std::string data = expected(blocks);
+    for (size_t i = 0; i < blocks; ++i) {
+        EXPECT(tee.write(data.data() + i * 1000, 1000) == 1000);
+    }
+}
+
+}  // namespace
+
+CASE("Synchronous and asynchronous tees write the same data to all the handles") {
+
+    for (bool async : {false, true}) {
+
+        auto* a = new MemoryHandle(1024, true);
+        auto* b = new MemoryHandle(1024, true);
+        auto* c = new MemoryHandle(1024, true);
+
+        TeeHandle tee({a, b, c}, async);
+        EXPECT(tee.async() == async);
+
+        tee.openForWrite(0);
+        write(tee, 100);
+        tee.flush();
+        tee.close();
+
+        // As other handles, tees can be closed twice
+        tee.close();
+
+        std::string data = expected(100);
+        EXPECT(a->str() == data);
+        EXPECT(b->str() == data);
+        EXPECT(c->str() == data);
+
+        auto statistics = tee.statistics();
+        EXPECT(statistics.size() == 3);
+        for (const auto& s : statistics) {
+            EXPECT(s.bytes_ == Length(data.size()));
+        }
+    }
+}
+
+CASE("Errors of asynchronous tees are reported on close") {
+
+    auto* a = new MemoryHandle(1024, true);
+    auto* f = new FailingHandle(10000);
+
+    TeeHandle tee(a, f, true);
+
+    tee.openForWrite(0);
+    write(tee, 50);
+    tee.flush();
+
+    EXPECT_THROWS_AS(tee.close(), WriteError);
+
+    // The other handles are written to, and all are closed
+
+    EXPECT(a->str() == expected(50));
+    EXPECT(f->written_ == 10000);
+    EXPECT(f->closed_);
+}
+
+CASE("Asynchronous tees can be destroyed without being closed") {
+
+    auto* a = new MemoryHandle(1024, true);
+    auto* b = new MemoryHandle(1024, true);
+
+    TeeHandle tee(a, b, true);
+    tee.openForWrite(0);
+    write(tee, 10);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,153 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "eckit/io/IOProfiler.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/StatsHandle.h"
+#include "eckit/log/LatencyHistogram.h"
+#include "eckit/value/Value.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool close(double a, double b, double tolerance = 0.035) {
+    return std::abs(a - b) <= tolerance * b;
+}
+
+CASE("Percentiles are within the precision of the buckets") {
+
+    LatencyHistogram h;
+    EXPECT(h.count() == 0);
+    EXPECT(h.percentile(50) == 0);
+
+    // 1us to 100ms
+
+    for (uint64_t i = 1; i <= 100000; ++i) {
+        h.recordNanoseconds(i * 1000);
+    }
+
+    EXPECT(h.count() == 100000);
+    EXPECT(close(h.min(), 1e-6));
+    EXPECT(close(h.max(), 0.1));
+    EXPECT(close(h.mean(), 0.05));
+    EXPECT(close(h.percentile(50), 0.05));
+    EXPECT(close(h.percentile(90), 0.09));
+    EXPECT(close(h.percentile(99), 0.099));
+    EXPECT(close(h.percentile(99.9), 0.0999));
+    EXPECT(h.percentile(100) == h.max());
+
+    Value summary = h.summary();
+    EXPECT(size_t(summary["count"]) == 100000);
+    EXPECT(close(double(summary["p99"]), 0.099));
+
+    h.reset();
+    EXPECT(h.count() == 0);
+    EXPECT(h.max() == 0);
+}
+
+CASE("Small and very large values are recorded") {
+
+    LatencyHistogram h;
+    h.recordNanoseconds(0);
+    h.recordNanoseconds(7);
+    h.record(3600);  // beyond the largest bucket
+
+    EXPECT(h.count() == 3);
+    EXPECT(h.percentile(10) == 0);
+    EXPECT(close(h.percentile(50), 7e-9));
+    EXPECT(h.percentile(100) == 3600);
+}
+
+CASE("Histograms are merged, and recorded concurrently") {
+
+    LatencyHistogram h;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&h, t] {
+            for (uint64_t i = 0; i < 10000; ++i) {
+                h.recordNanoseconds(1000 * (t + 1));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(h.count() == 40000);
+    EXPECT(close(h.percentile(25), 1e-6));
+    EXPECT(close(h.percentile(100), 4e-6));
+
+    LatencyHistogram copy(h);
+    copy += h;
+    EXPECT(copy.count() == 80000);
+    EXPECT(close(copy.sum(), 2 * h.sum(), 1e-9));
+    EXPECT(close(copy.percentile(50), h.percentile(50), 1e-9));
+}
+
+CASE("StatsHandle records the latency of each operation") {
+
+    StatsHandle h(new MemoryHandle(1024, true));
+
+    char buffer[100] = {};
+    h.openForWrite(0);
+    for (size_t i = 0; i < 10; ++i) {
+        h.write(buffer, sizeof(buffer));
+    }
+    h.close();
+
+    EXPECT(h.latency(IOProfiler::OPEN).count() == 1);
+    EXPECT(h.latency(IOProfiler::WRITE).count() == 10);
+    EXPECT(h.latency(IOProfiler::CLOSE).count() == 1);
+    EXPECT(h.latency(IOProfiler::READ).count() == 0);
+}
+
+CASE("The profiler aggregates by handle class and path prefix") {
+
+    EXPECT(IOProfiler::prefix("/data/fdb/root/file.data") == "/data/fdb");
+    EXPECT(IOProfiler::prefix("node:/data/fdb/root/file.data") == "node:/data/fdb");
+    EXPECT(IOProfiler::prefix("/data") == "/data");
+    EXPECT(IOProfiler::prefix("<mem>") == "<mem>");
+
+    IOProfiler& profiler = IOProfiler::instance();
+
+    IOProfiler::Profile& a = profiler.profile("FileHandle", "/data/fdb/a");
+    IOProfiler::Profile& b = profiler.profile("FileHandle", "/data/fdb/b");
+    EXPECT(&a == &b);
+
+    a.latencies_[IOProfiler::READ].record(0.001);
+    a.bytesRead_ += 1024;
+
+    Value report = profiler.report();
+    EXPECT(size_t(report["FileHandle"]["/data/fdb"]["read"]["count"]) == 1);
+    EXPECT(size_t(report["FileHandle"]["/data/fdb"]["bytes_read"]) == 1024);
+
+    profiler.reset();
+    EXPECT(!profiler.report()["FileHandle"]["/data/fdb"].contains("read"));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,197 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/log/Tracer.h"
+#include "eckit/parser/JSONParser.h"
+#include "eckit/value/Value.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static Value trace() {
+    std::ostringstream oss;
+    Tracer::instance().json(oss);
+    return JSONParser::decodeString(oss.str());
+}
+
+static size_t count(const Value& trace, const std::string& name) {
+    size_t n = 0;
+    const Value& events = trace["traceEvents"];
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (std::string(events[i]["name"]) == name) {
+            n++;
+        }
+    }
+    return n;
+}
+
+CASE("Spans and counters are only recorded when tracing") {
+
+    Tracer& tracer = Tracer::instance();
+    tracer.stop();
+    tracer.clear();
+
+    {
+        ECKIT_TRACE_SPAN("ignored", "test");
+        ECKIT_TRACE_COUNTER("ignored", "test", 1);
+    }
+    EXPECT(tracer.size() == 0);
+
+    tracer.start();
+    {
+        ECKIT_TRACE_SPAN("outer", "test");
+        {
+            ECKIT_TRACE_SPAN("inner", "test");
+            ECKIT_TRACE_COUNTER("counter", "test", 42);
+        }
+    }
+    tracer.stop();
+
+    EXPECT(tracer.size() == 3);
+
+    Value t = trace();
+    EXPECT(t["traceEvents"].size() == 3);
+    EXPECT(count(t, "outer") == 1);
+    EXPECT(count(t, "inner") == 1);
+
+    // Sorted by start time, the outer span enclosing the inner one
+
+    const Value& outer = t["traceEvents"][0];
+    const Value& inner = t["traceEvents"][1];
+    const Value& c     = t["traceEvents"][2];
+
+    EXPECT(std::string(outer["name"]) == "outer");
+    EXPECT(std::string(outer["ph"]) == "X");
+    EXPECT(double(inner["ts"]) >= double(outer["ts"]));
+    EXPECT(double(inner["ts"]) + double(inner["dur"]) <= double(outer["ts"]) + double(outer["dur"]) + 1e-3);
+
+    EXPECT(std::string(c["ph"]) == "C");
+    EXPECT(long(c["args"]["value"]) == 42);
+
+    tracer.clear();
+    EXPECT(tracer.size() == 0);
+}
+
+CASE("Each thread records into its own buffer") {
+
+    Tracer& tracer = Tracer::instance();
+    tracer.clear();
+    tracer.start();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (size_t j = 0; j < 100; ++j) {
+                ECKIT_TRACE_SPAN("work", "test");
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    tracer.stop();
+
+    Value t = trace();
+    EXPECT(count(t, "work") == 400);
+
+    std::set<long> tids;
+    for (size_t i = 0; i < t["traceEvents"].size(); ++i) {
+        tids.insert(long(t["traceEvents"][i]["tid"]));
+    }
+    EXPECT(tids.size() == 4);
+
+    tracer.clear();
+}
+
+CASE("The buffers of finished threads are reused") {
+
+    Tracer& tracer = Tracer::instance();
+    tracer.clear();
+    tracer.start();
+
+    auto work = [] { ECKIT_TRACE_SPAN("short", "test"); };
+
+    std::thread(work).join();
+    size_t buffers = tracer.buffers();
+
+    for (size_t i = 0; i < 50; ++i) {
+        std::thread(work).join();
+    }
+
+    tracer.stop();
+
+    EXPECT(tracer.buffers() == buffers);
+
+    Value t = trace();
+    EXPECT(count(t, "short") == 51);
+
+    std::set<long> tids;
+    for (size_t i = 0; i < t["traceEvents"].size(); ++i) {
+        tids.insert(long(t["traceEvents"][i]["tid"]));
+    }
+    EXPECT(tids.size() == 51);
+
+    tracer.clear();
+}
+
+CASE("Instrumented code is traced, and traces are saved in binary") {
+
+    Tracer& tracer = Tracer::instance();
+    tracer.clear();
+    tracer.start();
+
+    std::string data(1024 * 1024, 'x');
+    MemoryHandle in(data.data(), data.size());
+    MemoryHandle out(1024, true);
+    in.saveInto(out);
+
+    tracer.stop();
+    EXPECT(count(trace(), "DataHandle::saveInto") == 1);
+
+    PathName path("test_tracer.trace");
+    tracer.save(path);
+
+    std::ostringstream decoded;
+    Tracer::decode(path, decoded);
+
+    std::ostringstream json;
+    tracer.json(json);
+
+    Value a = JSONParser::decodeString(decoded.str());
+    Value b = JSONParser::decodeString(json.str());
+    EXPECT(a["traceEvents"].size() == b["traceEvents"].size());
+    EXPECT(count(a, "DataHandle::saveInto") == 1);
+
+    path.unlink();
+    tracer.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
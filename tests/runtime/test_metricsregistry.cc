@@ -0,0 +1,129 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/JSON.h"
+#include "eckit/parser/JSONParser.h"
+#include "eckit/runtime/MetricsRegistry.h"
+#include "eckit/value/Value.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool contains(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+CASE("Counters are aggregated across threads") {
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+
+    MetricCounter& c = registry.counter("test_requests_total", "Requests", {{"kind", "read"}});
+    EXPECT(&c == &registry.counter("test_requests_total", "Requests", {{"kind", "read"}}));
+    EXPECT(&c != &registry.counter("test_requests_total", "Requests", {{"kind", "write"}}));
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&c] {
+            for (size_t i = 0; i < 100000; ++i) {
+                c.inc();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(c.value() == 800000);
+
+    EXPECT_THROWS_AS(registry.gauge("test_requests_total", "Requests"), UserError);
+    EXPECT_THROWS_AS(registry.counter("test-invalid", "Invalid"), BadValue);
+    EXPECT_THROWS_AS(registry.counter("test_invalid", "Invalid", {{"1st", "x"}}), BadValue);
+}
+
+CASE("Gauges and histograms") {
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+
+    MetricGauge& g = registry.gauge("test_queue_size", "Queue size");
+    g.set(10);
+    g.inc(2.5);
+    g.dec();
+    EXPECT(g.value() == 11.5);
+
+    MetricHistogram& h = registry.histogram("test_latency_seconds", "Latency", {0.1, 1, 10});
+    h.observe(0.05);
+    h.observe(0.1);
+    h.observe(5);
+    h.observe(100);
+
+    std::vector<uint64_t> buckets = h.cumulative();
+    EXPECT(buckets == std::vector<uint64_t>({2, 2, 3, 4}));
+    EXPECT(h.count() == 4);
+    EXPECT(h.sum() == 105.15);
+
+    EXPECT_THROWS_AS(registry.histogram("test_latency_seconds", "Latency", {1, 2}), UserError);
+    EXPECT_THROWS_AS(registry.histogram("test_unsorted", "Unsorted", {2, 1}), BadValue);
+}
+
+CASE("The registry is exported in the Prometheus text format and as JSON") {
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.counter("test_escaped_total", "Help with \\ and\nnewline", {{"path", "a\"b"}}).inc(3);
+
+    std::ostringstream oss;
+    registry.prometheus(oss);
+    std::string text = oss.str();
+
+    EXPECT(contains(text, "# HELP test_requests_total Requests"));
+    EXPECT(contains(text, "# TYPE test_requests_total counter"));
+    EXPECT(contains(text, "test_requests_total{kind=\"read\"} 800000"));
+    EXPECT(contains(text, "test_requests_total{kind=\"write\"} 0"));
+    EXPECT(contains(text, "# TYPE test_queue_size gauge"));
+    EXPECT(contains(text, "test_queue_size 11.5"));
+    EXPECT(contains(text, "# TYPE test_latency_seconds histogram"));
+    EXPECT(contains(text, "test_latency_seconds_bucket{le=\"0.1\"} 2"));
+    EXPECT(contains(text, "test_latency_seconds_bucket{le=\"+Inf\"} 4"));
+    EXPECT(contains(text, "test_latency_seconds_sum 105.15"));
+    EXPECT(contains(text, "test_latency_seconds_count 4"));
+    EXPECT(contains(text, "# HELP test_escaped_total Help with \\\\ and\\nnewline"));
+    EXPECT(contains(text, "test_escaped_total{path=\"a\\\"b\"} 3"));
+
+    std::ostringstream out;
+    {
+        JSON j(out);
+        registry.json(j);
+    }
+
+    Value v = JSONParser::decodeString(out.str());
+    EXPECT(std::string(v["test_queue_size"]["type"]) == "gauge");
+    EXPECT(double(v["test_queue_size"]["series"][0]["value"]) == 11.5);
+    EXPECT(size_t(v["test_latency_seconds"]["series"][0]["buckets"]["+Inf"]) == 4);
+    EXPECT(std::string(v["test_requests_total"]["series"][0]["labels"]["kind"]) == "read");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
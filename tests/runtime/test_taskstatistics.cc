@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "eckit/log/LatencyHistogram.h"
+#include "eckit/runtime/TaskInfo.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A TaskInfo in zeroed memory, as in the monitor array
+class Task {
+public:
+    Task() :
+        memory_(new char[sizeof(TaskInfo)]) {
+        ::memset(memory_.get(), 0, sizeof(TaskInfo));
+        info_ = new (memory_.get()) TaskInfo();
+    }
+
+    ~Task() { info_->~TaskInfo(); }
+
+    TaskInfo& operator*() { return *info_; }
+
+private:
+    std::unique_ptr<char[]> memory_;
+    TaskInfo* info_;
+};
+
+CASE("Statistics are allocated by name and sampled") {
+
+    Task task;
+    TaskInfo& info = *task;
+
+    TaskStatistic s;
+    for (size_t i = 0; i < TaskInfo::statistics(); ++i) {
+        EXPECT(!info.sample(i, s));
+    }
+
+    long bytes = info.statistic("bytes_read", TaskStatistic::COUNTER);
+    long queue = info.statistic("queue_depth", TaskStatistic::GAUGE);
+    long reads = info.statistic("read_latency", TaskStatistic::LATENCY);
+
+    EXPECT(bytes == 0);
+    EXPECT(queue == 1);
+    EXPECT(reads == 2);
+    EXPECT(info.statistic("bytes_read", TaskStatistic::COUNTER) == bytes);
+
+    info.publish(bytes, 1024);
+    info.publish(queue, 3);
+
+    LatencyHistogram h;
+    h.record(0.001);
+    h.record(0.003);
+    info.publish(reads, h);
+
+    EXPECT(info.sample(bytes, s));
+    EXPECT(std::string(s.name_) == "bytes_read");
+    EXPECT(s.kind_ == TaskStatistic::COUNTER);
+    EXPECT(s.values_[0] == 1024);
+
+    EXPECT(info.sample(queue, s));
+    EXPECT(s.values_[0] == 3);
+
+    EXPECT(info.sample(reads, s));
+    EXPECT(s.kind_ == TaskStatistic::LATENCY);
+    EXPECT(s.values_[TaskStatistic::COUNT] == 2);
+    EXPECT(s.values_[TaskStatistic::MAX] == h.max());
+
+    // All slots taken
+
+    for (size_t i = 3; i < TaskInfo::statistics(); ++i) {
+        EXPECT(info.statistic("counter" + std::to_string(i), TaskStatistic::COUNTER) == long(i));
+    }
+    EXPECT(info.statistic("one_too_many", TaskStatistic::COUNTER) == -1);
+
+    info.publish(-1, 42);  // ignored
+}
+
+CASE("Samples are consistent while the task publishes") {
+
+    Task task;
+    TaskInfo& info = *task;
+
+    long slot = info.statistic("latency", TaskStatistic::LATENCY);
+
+    std::atomic<bool> done(false);
+
+    // With a single value recorded, the mean, median and maximum are the same
+
+    std::thread writer([&] {
+        LatencyHistogram h;
+        for (uint64_t i = 1; i <= 200000; ++i) {
+            h.reset();
+            h.recordNanoseconds(i * 1000);
+            info.publish(slot, h);
+        }
+        done = true;
+    });
+
+    size_t samples = 0;
+    TaskStatistic s;
+    while (!done) {
+        if (info.sample(slot, s)) {
+            EXPECT(s.values_[TaskStatistic::MEAN] == s.values_[TaskStatistic::MAX]);
+            EXPECT(s.values_[TaskStatistic::P50] == s.values_[TaskStatistic::MAX]);
+            samples++;
+        }
+    }
+
+    writer.join();
+    EXPECT(samples > 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -8,16 +8,29 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <tuple>
 
+#include "eckit/sql/SQLAggregator.h"
 #include "eckit/sql/SQLColumn.h"
+#include "eckit/sql/SQLColumnarTable.h"
 #include "eckit/sql/SQLDatabase.h"
 #include "eckit/sql/SQLOutput.h"
 #include "eckit/sql/SQLParser.h"
+#include "eckit/sql/SQLPreparedStatement.h"
 #include "eckit/sql/SQLSelect.h"
 #include "eckit/sql/SQLSession.h"
 #include "eckit/sql/SQLStatement.h"
+#include "eckit/sql/expression/NumberExpression.h"
 #include "eckit/sql/expression/SQLExpressions.h"
+#include "eckit/sql/expression/function/FunctionFactory.h"
 #include "eckit/sql/type/SQLBitfield.h"
 #include "eckit/testing/Test.h"
 
@@ -137,6 +150,84 @@ private:
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// A table with two columns, id@<name> and val@<name>, for testing joins. It can be split into ranges
+/// of rows, for testing parallel scans.
+
+class KeyValueTable : public eckit::sql::SQLTable {
+
+public:
+    KeyValueTable(eckit::sql::SQLDatabase& db, const std::string& name, const std::vector<long>& keys,
+                  const std::vector<double>& values) :
+        SQLTable(db, name, name), keys_(keys), values_(values) {
+        ASSERT(keys_.size() == values_.size());
+        addColumn("id@" + name, 0, eckit::sql::type::SQLType::lookup("integer"), false, 0);
+        addColumn("val@" + name, 1, eckit::sql::type::SQLType::lookup("real"), false, 0);
+    }
+
+private:
+    class KeyValueIterator : public eckit::sql::SQLTableIterator {
+    public:
+        KeyValueIterator(const KeyValueTable& owner,
+                         const std::vector<std::reference_wrapper<const eckit::sql::SQLColumn>>& columns,
+                         size_t begin, size_t end) :
+            owner_(owner), begin_(begin), end_(end), idx_(begin), data_(2) {
+            for (const auto& col : columns) {
+                offsets_.push_back(col.get().index());
+            }
+        }
+
+    private:
+        void rewind() override { idx_ = begin_; }
+        bool next() override {
+            if (idx_ < end_) {
+                data_[0] = owner_.keys_[idx_];
+                data_[1] = owner_.values_[idx_];
+                idx_++;
+                return true;
+            }
+            return false;
+        }
+        std::vector<size_t> columnOffsets() const override { return offsets_; }
+        std::vector<size_t> doublesDataSizes() const override { return std::vector<size_t>(offsets_.size(), 1); }
+        std::vector<char> columnsHaveMissing() const override { return std::vector<char>(offsets_.size(), false); }
+        std::vector<double> missingValues() const override { return std::vector<double>(offsets_.size(), 0); }
+        const double* data() const override { return &data_[0]; }
+
+        const KeyValueTable& owner_;
+        size_t begin_;
+        size_t end_;
+        size_t idx_;
+        std::vector<size_t> offsets_;
+        std::vector<double> data_;
+    };
+
+    eckit::sql::SQLTableIterator* iterator(
+        const std::vector<std::reference_wrapper<const eckit::sql::SQLColumn>>& columns,
+        std::function<void(eckit::sql::SQLTableIterator&)>) const override {
+        return new KeyValueIterator(*this, columns, 0, keys_.size());
+    }
+
+    std::vector<eckit::sql::SQLTableRange> scanRanges(size_t count) const override {
+        std::vector<eckit::sql::SQLTableRange> ranges;
+        size_t step = (keys_.size() + count - 1) / count;
+        for (size_t begin = 0; begin < keys_.size(); begin += step) {
+            ranges.push_back({begin, std::min(begin + step, keys_.size())});
+        }
+        return ranges;
+    }
+
+    eckit::sql::SQLTableIterator* rangeIterator(
+        const std::vector<std::reference_wrapper<const eckit::sql::SQLColumn>>& columns,
+        std::function<void(eckit::sql::SQLTableIterator&)>, const eckit::sql::SQLTableRange& range) const override {
+        return new KeyValueIterator(*this, columns, range.begin_, range.end_);
+    }
+
+    std::vector<long> keys_;
+    std::vector<double> values_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 class TestOutput : public eckit::sql::SQLOutput {
 
     void cleanup(eckit::sql::SQLSelect&) override {}
@@ -301,6 +392,38 @@ CASE("Select from constructed table") {
         }
     }
 
+    SECTION("Test SQL select where in batches") {
+
+        // The results must not depend on the batch size. A size of 0 disables batching, and 3 does
+        // not divide the number of rows (nor is it larger than the point at which the columns are resized).
+
+        std::vector<std::string> queries = {
+            "select rcol from table1 where icol > 4000 and rcol < 80",
+            "select rcol from table1 where icol < 3000 or scol == \"cccc\"",
+            "select rcol from table1 where bfcolumn.bf2 == 1 and not (rcol == 12.3)",
+            "select rcol from table1 where (icol * 2 - 1) / 3 >= 4444 and icol is not null",
+        };
+
+        std::vector<std::vector<double>> expected = {{77.7, 66.6, 66.6, 44.4},
+                                                     {99.9, 77.7, 66.6, 22.2, 11.1, 12.3},
+                                                     {77.7, 44.4},
+                                                     {99.9, 88.8, 77.7}};
+
+        for (const char* size : {"0", "1", "3", "1024"}) {
+            ::setenv("ECKIT_SQL_BATCH_SIZE", size, 1);
+            for (size_t i = 0; i < queries.size(); i++) {
+
+                eckit::sql::SQLParser().parseString(session, queries[i]);
+                session.statement().execute();
+
+                EXPECT(o.intOutput.empty());
+                EXPECT(o.floatOutput == expected[i]);
+                EXPECT(o.strOutput.empty());
+            }
+        }
+        ::unsetenv("ECKIT_SQL_BATCH_SIZE");
+    }
+
     SECTION("Test SQL select distinct") {
 
         std::vector<std::string> queries = {"select distinct icol from table1",
@@ -338,6 +461,57 @@ CASE("Select from constructed table") {
         }
     }
 
+    SECTION("Test SQL select grouped aggregates") {
+
+        // Groups (of the non-aggregated columns) are output in key order
+
+        std::string sql = "select scol, count(*), sum(icol), max(rcol), avg(rcol), stdev(rcol), min(icol), first(icol) "
+                          "from table1";
+        eckit::sql::SQLParser().parseString(session, sql);
+        session.statement().execute();
+
+        std::map<std::string, std::vector<size_t>> groups;
+        for (size_t i = 0; i < STRING_DATA.size(); ++i) {
+            groups[STRING_DATA[i]].push_back(i);
+        }
+
+        std::vector<std::string> strings;
+        std::vector<double> floats;
+        std::vector<long> ints;
+        for (const auto& g : groups) {
+            double sum = 0, max = -1e300, mean = 0, squares = 0;
+            long min   = 1000000;
+            for (size_t i : g.second) {
+                sum += INTEGER_DATA[i];
+                max = std::max(max, REAL_DATA[i]);
+                mean += REAL_DATA[i];
+                squares += REAL_DATA[i] * REAL_DATA[i];
+                min = std::min(min, INTEGER_DATA[i]);
+            }
+            double n        = g.second.size();
+            double variance = squares / n - (mean / n) * (mean / n);
+            strings.push_back(g.first);
+            floats.insert(floats.end(), {n, sum, max, mean / n, std::sqrt(std::max(variance, 0.0))});
+            ints.insert(ints.end(), {min, INTEGER_DATA[g.second.front()]});
+        }
+
+        EXPECT(o.strOutput == strings);
+        EXPECT(o.floatOutput == floats);
+        EXPECT(o.intOutput == ints);
+    }
+
+    SECTION("Test SQL select grouped aggregates with numeric keys") {
+
+        std::string sql = "select icol, bfcolumn.bf2, count(*), sum(rcol) from table1";
+        eckit::sql::SQLParser().parseString(session, sql);
+        session.statement().execute();
+
+        EXPECT(o.intOutput == std::vector<long>({1111, 3, 1234, 1, 2222, 2, 3333, 2, 4444, 1, 6666, 0, 6666, 2, 7777, 1,
+                                                 8888, 0, 9999, 0}));
+        EXPECT(o.floatOutput == std::vector<double>({1, 11.1, 1, 12.3, 1, 22.2, 1, 33.3, 1, 44.4, 2, 66.6 + 88.8, 1,
+                                                     66.6, 1, 77.7, 1, 88.8, 1, 99.9}));
+    }
+
     SECTION("Test SQL select order_by") {
 
         std::vector<std::string> queries = {
@@ -373,6 +547,57 @@ CASE("Select from constructed table") {
         }
     }
 
+    SECTION("Test SQL select order_by with limit") {
+
+        std::vector<std::string> queries = {
+            "select icol from table1 order by icol DESC limit 3",
+            "select icol from table1 order by rcol, icol DESC limit 6",
+            "select icol from table1 order by scol limit 100",
+        };
+
+        std::vector<std::vector<long>> vals = {{9999, 8888, 7777},
+                                               {1111, 1234, 2222, 3333, 4444, 6666},
+                                               {6666, 1234, 8888, 3333, 4444, 2222, 1111, 9999, 7777, 6666, 6666}};
+
+        for (size_t i = 0; i < queries.size(); i++) {
+            eckit::sql::SQLParser().parseString(session, queries[i]);
+            session.statement().execute();
+            EXPECT(o.intOutput == vals[i]);
+        }
+    }
+
+    SECTION("Test SQL select with IN and NOT IN") {
+
+        // A long list of values, to be looked up through a hash set
+
+        std::string many;
+        for (long i = 10000; i < 15000; ++i) {
+            many += std::to_string(i) + ", ";
+        }
+
+        std::vector<std::string> queries = {
+            "select icol from table1 where icol in (6666, 1111, 5, 9999)",
+            "select icol from table1 where icol not in (6666, 1111, 5, 9999)",
+            "select icol from table1 where icol in (" + many + "3333, -0.0, 7777)",
+            "select icol from table1 where scol in (\"cccc\", \" hijklmno \", \"zzz\", \"a-longer-string-still\")",
+            "select icol from table1 where scol not in ('cccc', '', 'another-string')",
+            "select icol from table1 where icol in (rcol, 1111, 4444)",
+        };
+
+        std::vector<std::vector<long>> vals = {{9999, 6666, 6666, 6666, 1111},
+                                               {8888, 7777, 4444, 3333, 2222, 1234},
+                                               {7777, 3333},
+                                               {9999, 7777, 6666, 6666},
+                                               {8888, 6666, 4444, 3333, 1111},
+                                               {4444, 1111}};
+
+        for (size_t i = 0; i < queries.size(); i++) {
+            eckit::sql::SQLParser().parseString(session, queries[i]);
+            session.statement().execute();
+            EXPECT(o.intOutput == vals[i]);
+        }
+    }
+
     SECTION("Test selection of bitfield bit columns") {
 
         // n.b. ensure that we check the ability to:
@@ -481,6 +706,737 @@ CASE("Test with implicit tables") {
 }
 
 
+CASE("Test joins between tables") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    // t1/t2 are not sorted on the keys (hash join), t3/t4 are (merge join).
+
+    std::vector<long> k1{5, 3, 9, 3, 1, 7, 5, 5};
+    std::vector<double> v1{0.5, 0.3, 1.9, 1.3, 0.1, 0.7, 1.5, 2.5};
+    std::vector<long> k2{3, 5, 4, 5, 8, 3, 9};
+    std::vector<double> v2{10.3, 10.5, 10.4, 11.5, 10.8, 11.3, 10.9};
+    std::vector<long> k3{1, 2, 2, 3, 5, 8, 8};
+    std::vector<double> v3{0.1, 0.2, 1.2, 0.3, 0.5, 0.8, 1.8};
+    std::vector<long> k4{2, 2, 3, 4, 8, 8, 9};
+    std::vector<double> v4{1.0, 0.1, 0.3, 10.4, 10.8, 0.5, 10.9};
+
+    db.addTable(new KeyValueTable(db, "t1", k1, v1));
+    db.addTable(new KeyValueTable(db, "t2", k2, v2));
+    db.addTable(new KeyValueTable(db, "t3", k3, v3));
+    db.addTable(new KeyValueTable(db, "t4", k4, v4));
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    // The join must give the same results as the (nested loop) cross product, filtered.
+
+    auto expected = [](const std::vector<long>& ka, const std::vector<double>& va, const std::vector<long>& kb,
+                       const std::vector<double>& vb, bool lessThan) {
+        std::vector<std::tuple<long, double, double>> result;
+        for (size_t i = 0; i < ka.size(); ++i) {
+            for (size_t j = 0; j < kb.size(); ++j) {
+                if (ka[i] == kb[j] && (!lessThan || va[i] < vb[j])) {
+                    result.emplace_back(ka[i], va[i], vb[j]);
+                }
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    auto run = [&](const std::string& sql, const std::string& strategy) {
+        eckit::sql::SQLParser().parseString(session, sql);
+
+        auto& select = dynamic_cast<eckit::sql::SQLSelect&>(session.statement());
+        select.prepareExecute();
+        select.process();
+
+        std::ostringstream plan;
+        select.explain(plan);
+        eckit::Log::info() << plan.str();
+        EXPECT(plan.str().find(strategy) != std::string::npos);
+
+        select.postExecute();
+
+        std::vector<std::tuple<long, double, double>> result;
+        EXPECT(o.floatOutput.size() == 2 * o.intOutput.size());
+        for (size_t i = 0; i < o.intOutput.size(); ++i) {
+            result.emplace_back(o.intOutput[i], o.floatOutput[2 * i], o.floatOutput[2 * i + 1]);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    SECTION("Test hash join") {
+        auto result = run("select id@t1, val@t1, val@t2 from t1, t2 where id@t1 = id@t2", "HASH JOIN");
+        EXPECT(result.size() == 11);
+        EXPECT(result == expected(k1, v1, k2, v2, false));
+    }
+
+    SECTION("Test hash join with further conditions") {
+        auto result = run("select id@t1, val@t1, val@t2 from t1, t2 where id@t2 = id@t1 and val@t1 > 1 "
+                          "and val@t1 < val@t2",
+                          "HASH JOIN");
+        std::vector<long> k;
+        std::vector<double> v;
+        for (size_t i = 0; i < k1.size(); ++i) {
+            if (v1[i] > 1) {
+                k.push_back(k1[i]);
+                v.push_back(v1[i]);
+            }
+        }
+        EXPECT(result == expected(k, v, k2, v2, true));
+    }
+
+    SECTION("Test merge join") {
+        auto result = run("select id@t3, val@t3, val@t4 from t3, t4 where id@t3 = id@t4 and val@t3 < val@t4",
+                          "MERGE JOIN");
+        EXPECT(result == expected(k3, v3, k4, v4, true));
+    }
+
+    SECTION("Test nested loop without an equi-join") {
+        auto result = run("select id@t1, val@t1, val@t2 from t1, t2 where id@t1 <= id@t2 and id@t1 >= id@t2",
+                          "NESTED LOOP SCAN");
+        EXPECT(result == expected(k1, v1, k2, v2, false));
+    }
+}
+
+
+CASE("Test merging partial aggregations") {
+
+    using namespace eckit::sql::expression;
+    using eckit::sql::expression::function::FunctionFactory;
+
+    // Each partition is aggregated separately, and the partial results merged
+
+    auto columns = [](double key, double value) {
+        Expressions result;
+        result.push_back(std::make_shared<NumberExpression>(key));
+        for (const char* name : {"sum", "max", "count", "var"}) {
+            result.push_back(FunctionFactory::instance().build(name, std::make_shared<NumberExpression>(value)));
+        }
+        return result;
+    };
+
+    eckit::sql::SQLAggregator a(columns(1, 2));
+    eckit::sql::SQLAggregator b(columns(1, 5));
+    eckit::sql::SQLAggregator c(columns(0, 7));
+
+    for (int i = 0; i < 3; ++i) {
+        a.update();
+    }
+    for (int i = 0; i < 2; ++i) {
+        b.update();
+    }
+    c.update();
+
+    EXPECT(a.mergeable());
+    a.merge(b);
+    a.merge(c);
+    a.finalise();
+
+    EXPECT(a.size() == 2);
+
+    std::vector<std::vector<double>> expected{{0, 7, 7, 1, 0}, {1, 16, 5, 5, 62. / 5 - (16. / 5) * (16. / 5)}};
+    for (size_t g = 0; g < a.size(); ++g) {
+        Expressions result(a.result(g));
+        EXPECT(result.size() == expected[g].size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            bool missing = false;
+            EXPECT(result[i]->eval(missing) == expected[g][i]);
+            EXPECT(!missing);
+        }
+    }
+
+    Expressions firsts;
+    firsts.push_back(std::make_shared<NumberExpression>(1));
+    firsts.push_back(FunctionFactory::instance().build("first", std::make_shared<NumberExpression>(2)));
+
+    eckit::sql::SQLAggregator d(firsts);
+    EXPECT(!d.mergeable());
+}
+
+
+CASE("Test parallel scans") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    std::vector<long> keys;
+    std::vector<double> values;
+    for (size_t i = 0; i < 10000; ++i) {
+        keys.push_back((i * 7919) % 13);
+        values.push_back(double((i * 104729) % 1000) / 8);
+    }
+    db.addTable(new KeyValueTable(db, "big", keys, values));
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    // Small batches, so that the ranges hold several of them
+
+    ::setenv("ECKIT_SQL_BATCH_SIZE", "100", 1);
+
+    auto run = [&](const std::string& sql, const char* threads) {
+        ::setenv("ECKIT_SQL_THREADS", threads, 1);
+        eckit::sql::SQLParser().parseString(session, sql);
+
+        auto& select = dynamic_cast<eckit::sql::SQLSelect&>(session.statement());
+        select.prepareExecute();
+        select.process();
+
+        std::ostringstream plan;
+        select.explain(plan);
+        eckit::Log::info() << plan.str();
+
+        select.postExecute();
+        return std::make_tuple(o.intOutput, o.floatOutput, plan.str());
+    };
+
+    // Each query must give the same results, in the same order, as the sequential scan
+
+    const std::vector<std::pair<std::string, std::string>> queries{
+        {"select id@big, val@big from big", ""},
+        {"select val@big from big where id@big > 4 and val@big < 60", ""},
+        {"select id@big, count(*), sum(val@big), min(val@big), max(val@big), avg(val@big) from big "
+         "where val@big >= 10",
+         "PARTIAL AGGREGATION"},
+        {"select count(*), sum(val@big), stdev(val@big) from big where id@big <> 3", "PARTIAL AGGREGATION"},
+        {"select distinct id@big from big where val@big > 100", ""},
+        {"select id@big, val@big from big where val@big < 10 order by val@big, id@big", ""},
+        {"select id@big, first(val@big) from big where val@big > 100", ""},
+    };
+
+    for (const auto& query : queries) {
+        auto serial   = run(query.first, "1");
+        auto parallel = run(query.first, "4");
+
+        EXPECT(std::get<2>(serial).find("PARALLEL SCAN") == std::string::npos);
+        EXPECT(std::get<2>(parallel).find("PARALLEL SCAN") != std::string::npos);
+        EXPECT(std::get<2>(parallel).find(query.second) != std::string::npos);
+
+        EXPECT(!std::get<0>(serial).empty() || !std::get<1>(serial).empty());
+        EXPECT(std::get<0>(parallel) == std::get<0>(serial));
+
+        // Sums may be accumulated in a different order
+
+        EXPECT(std::get<1>(parallel).size() == std::get<1>(serial).size());
+        for (size_t i = 0; i < std::get<1>(serial).size(); ++i) {
+            double x = std::get<1>(serial)[i];
+            EXPECT(std::abs(std::get<1>(parallel)[i] - x) <= 1e-9 * std::max(1.0, std::abs(x)));
+        }
+    }
+
+    // A scan that is abandoned releases the threads waiting for their batches to be consumed
+
+    ::setenv("ECKIT_SQL_THREADS", "4", 1);
+    for (size_t i = 0; i < 10; ++i) {
+        eckit::sql::SQLParser().parseString(session, "select id@big, val@big from big");
+        auto& select = dynamic_cast<eckit::sql::SQLSelect&>(session.statement());
+        select.prepareExecute();
+        select.postExecute();
+    }
+
+    ::unsetenv("ECKIT_SQL_THREADS");
+    ::unsetenv("ECKIT_SQL_BATCH_SIZE");
+}
+
+
+CASE("Test sorting with runs spilled to disk") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    std::vector<long> keys;
+    std::vector<double> values;
+    for (size_t i = 0; i < 20000; ++i) {
+        keys.push_back((i * 7919) % 13);
+        values.push_back(double((i * 104729) % 1000) / 8 - 50);
+    }
+    db.addTable(new KeyValueTable(db, "big", keys, values));
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    // Rows are ordered by key descending, then value, and otherwise kept in the order they were read
+
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return keys[a] != keys[b] ? keys[a] > keys[b] : values[a] < values[b];
+    });
+
+    std::vector<long> expectedKeys;
+    std::vector<double> expectedValues;
+    for (size_t i : order) {
+        expectedKeys.push_back(keys[i]);
+        expectedValues.push_back(values[i]);
+    }
+
+    // With a small memory budget the rows are sorted in many runs, and merged. Otherwise the sort of the
+    // buffer is split between the threads.
+
+    for (const char* memory : {"65536", "1073741824"}) {
+        for (const char* threads : {"1", "4"}) {
+            ::setenv("ECKIT_SQL_SORT_MEMORY", memory, 1);
+            ::setenv("ECKIT_SQL_THREADS", threads, 1);
+
+            eckit::sql::SQLParser().parseString(session,
+                                                "select id@big, val@big from big order by id@big desc, val@big");
+            session.statement().execute();
+            EXPECT(o.intOutput == expectedKeys);
+            EXPECT(o.floatOutput == expectedValues);
+
+            eckit::sql::SQLParser().parseString(
+                session, "select id@big, val@big from big order by id@big desc, val@big limit 10");
+            session.statement().execute();
+            EXPECT(o.intOutput == std::vector<long>(expectedKeys.begin(), expectedKeys.begin() + 10));
+            EXPECT(o.floatOutput == std::vector<double>(expectedValues.begin(), expectedValues.begin() + 10));
+        }
+    }
+
+    ::unsetenv("ECKIT_SQL_THREADS");
+    ::unsetenv("ECKIT_SQL_SORT_MEMORY");
+}
+
+CASE("Test LIMIT is only a keyword after ORDER BY, before a number") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    db.addTable(new KeyValueTable(db, "limit", {3, 1, 2, 1}, {30, 10, 20, 15}));
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    // Column names may still contain limit
+
+    eckit::sql::SQLParser().parseString(session, "select id@limit from limit order by val@limit desc");
+    session.statement().execute();
+    EXPECT(o.intOutput == std::vector<long>({3, 2, 1, 1}));
+
+    eckit::sql::SQLParser().parseString(session,
+                                        "select val@limit from limit order by id@limit, val@limit desc limit 2");
+    session.statement().execute();
+    EXPECT(o.floatOutput == std::vector<double>({15, 10}));
+
+    // The limit must be a positive integer
+
+    EXPECT_THROWS_AS(
+        eckit::sql::SQLParser().parseString(session, "select id@limit from limit order by id@limit limit 2.5"),
+        eckit::UserError);
+    EXPECT_THROWS_AS(
+        eckit::sql::SQLParser().parseString(session, "select id@limit from limit order by id@limit limit 0"),
+        eckit::UserError);
+}
+
+
+/// A columnar table obs of 20000 rows, in blocks of 1000, with an increasing seqno@obs, and varno@obs and
+/// obsvalue@obs that vary from row to row. One obsvalue@obs in seven is missing.
+
+static const double OBS_MISSING = -2147483647;
+
+eckit::sql::SQLColumnarTable* makeObservationTable(eckit::sql::SQLDatabase& db,
+                                                   std::vector<std::vector<double>>& rows) {
+
+    auto* table = new eckit::sql::SQLColumnarTable(db, "obs", 1000);
+    table->addColumn("seqno@obs", 0, eckit::sql::type::SQLType::lookup("integer"), false, 0);
+    table->addColumn("varno@obs", 1, eckit::sql::type::SQLType::lookup("integer"), false, 0);
+    table->addColumn("obsvalue@obs", 2, eckit::sql::type::SQLType::lookup("real"), true, OBS_MISSING);
+
+    for (size_t i = 0; i < 20000; ++i) {
+        rows.push_back({double(i / 2), double(i % 5), i % 7 == 0 ? OBS_MISSING : double((i * 37) % 1000) / 10});
+        table->appendRow(rows.back());
+    }
+    db.addTable(table);
+    return table;
+}
+
+
+CASE("Test predicates pushed down to a columnar table") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    std::vector<std::vector<double>> rows;
+    auto* table = makeObservationTable(db, rows);
+
+    EXPECT(table->rows() == 20000);
+    EXPECT(table->blocks() == 20);
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    auto run = [&](const std::string& sql, const char* threads) {
+        ::setenv("ECKIT_SQL_THREADS", threads, 1);
+        table->resetStatistics();
+        eckit::sql::SQLParser().parseString(session, sql);
+
+        auto& select = dynamic_cast<eckit::sql::SQLSelect&>(session.statement());
+        select.prepareExecute();
+        select.process();
+
+        std::ostringstream plan;
+        select.explain(plan);
+        eckit::Log::info() << plan.str();
+
+        select.postExecute();
+        return plan.str();
+    };
+
+    auto expected = [&](std::function<bool(const std::vector<double>&)> where) {
+        std::vector<long> seqnos;
+        for (const auto& row : rows) {
+            if (where(row)) {
+                seqnos.push_back(row[0]);
+            }
+        }
+        return seqnos;
+    };
+
+    // The blocks that cannot hold any of the rows are skipped, with or without parallel scans
+
+    for (const char* threads : {"1", "4"}) {
+
+        std::string plan = run("select seqno@obs from obs where seqno@obs >= 5000 and seqno@obs < 5600", threads);
+        EXPECT(plan.find("PUSHED DOWN seqno@obs in [5000, inf]") != std::string::npos);
+        EXPECT(plan.find("PUSHED DOWN seqno@obs in [-inf, 5600)") != std::string::npos);
+        EXPECT(o.intOutput == expected([](const std::vector<double>& r) { return r[0] >= 5000 && r[0] < 5600; }));
+        EXPECT(table->blocksRead() == 2);
+        EXPECT(table->blocksSkipped() == 18);
+
+        run("select seqno@obs from obs where seqno@obs between 100 and 200 and 2 < obsvalue@obs", threads);
+        EXPECT(o.intOutput == expected([&](const std::vector<double>& r) {
+                   return r[0] >= 100 && r[0] <= 200 && r[2] != OBS_MISSING && r[2] > 2;
+               }));
+        EXPECT(table->blocksRead() == 1);
+
+        // Missing values never match
+
+        run("select seqno@obs from obs where obsvalue@obs <= 1 and varno@obs = 3", threads);
+        EXPECT(o.intOutput == expected([&](const std::vector<double>& r) {
+                   return r[2] != OBS_MISSING && r[2] <= 1 && r[1] == 3;
+               }));
+        EXPECT(!o.intOutput.empty());
+        EXPECT(table->blocksSkipped() == 0);
+
+        run("select seqno@obs from obs where seqno@obs > 100000", threads);
+        EXPECT(o.intOutput.empty());
+        EXPECT(table->blocksRead() == 0);
+    }
+
+    // Nothing is pushed down if the results depend on which rows are read
+
+    std::string plan = run("select seqno@obs, rownumber() from obs where seqno@obs < 10", "1");
+    EXPECT(plan.find("PUSHED DOWN") == std::string::npos);
+    EXPECT(table->blocksSkipped() == 0);
+
+    ::unsetenv("ECKIT_SQL_THREADS");
+}
+
+
+CASE("Test compiled WHERE clauses") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    std::vector<std::vector<double>> rows;
+    makeObservationTable(db, rows);
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    auto run = [&](const std::string& sql) {
+        eckit::sql::SQLParser().parseString(session, sql);
+
+        auto& select = dynamic_cast<eckit::sql::SQLSelect&>(session.statement());
+        select.prepareExecute();
+        select.process();
+
+        std::ostringstream plan;
+        select.explain(plan);
+
+        select.postExecute();
+        return std::make_pair(o.intOutput, plan.str());
+    };
+
+    // The compiled conditions must select the same rows as the expressions evaluated as they are, over
+    // batches or row by row, including where values are missing
+
+    const std::vector<std::string> conditions{
+        "(obsvalue@obs > 50 or varno@obs = 2) and not (seqno@obs between 100 and 3000)",
+        "obsvalue@obs * 0 = 0",
+        "obsvalue@obs / 2 + 1 >= varno@obs * 10 - 3 or obsvalue@obs <> 12.3",
+        "(-obsvalue@obs) < -90 and (varno@obs <> 1 or seqno@obs > 9000)",
+        "varno@obs = 3 or obsvalue@obs > 95",
+        "not (varno@obs = 3 and obsvalue@obs > 5) and seqno@obs < 2000",
+        "1 + 1 = 2 and varno@obs in (1, 4) and seqno@obs not between 200 and 9800",
+        "seqno@obs * 2 - varno@obs > 100 * 5 and obsvalue@obs / 0 > 0",
+    };
+
+    for (const auto& condition : conditions) {
+        std::string sql = "select seqno@obs, varno@obs from obs where " + condition;
+
+        auto compiled = run(sql);
+        EXPECT(compiled.second.find("COMPILED") != std::string::npos);
+
+        ::setenv("ECKIT_SQL_COMPILE", "0", 1);
+        auto interpreted = run(sql);
+        ::unsetenv("ECKIT_SQL_COMPILE");
+
+        ::setenv("ECKIT_SQL_BATCH_SIZE", "0", 1);
+        auto rowByRow = run(sql);
+        ::unsetenv("ECKIT_SQL_BATCH_SIZE");
+
+        eckit::Log::info() << condition << ": " << compiled.first.size() / 2 << " rows" << std::endl;
+
+        EXPECT(!compiled.first.empty());
+        EXPECT(compiled.first == interpreted.first);
+        EXPECT(compiled.first == rowByRow.first);
+    }
+
+    // A product with zero is zero, even if one of the factors is missing
+
+    EXPECT(run("select seqno@obs from obs where obsvalue@obs * 0 = 0").first.size() == rows.size());
+}
+
+
+CASE("Test columnar tables loaded from other tables and CSV") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    auto run = [&](const std::string& sql) {
+        eckit::sql::SQLParser().parseString(session, sql);
+        session.statement().execute();
+    };
+
+    SECTION("Test loading from another table") {
+
+        // The strings of the source widen after the first row, and are held in a dictionary. The fields of
+        // the bitfields are read from columns of their own.
+
+        TestTable source(db, "a/b/c.path", "table1");
+        auto* table = new eckit::sql::SQLColumnarTable(db, "table1", 4);
+        table->load(source);
+        db.addTable(table);
+
+        EXPECT(table->rows() == INTEGER_DATA.size());
+
+        run("select * from table1");
+        for (int row = 0; row < INTEGER_DATA.size(); ++row) {
+            EXPECT(o.intOutput[5 * row] == INTEGER_DATA[row]);
+            for (int j = 0; j < 3; ++j) {
+                EXPECT(o.intOutput[5 * row + 1 + j] == BITFIELD_DATA[row]);
+            }
+            EXPECT(o.intOutput[5 * row + 4] == INTEGER_DATA[row]);
+        }
+        EXPECT(o.floatOutput == REAL_DATA);
+        EXPECT(o.strOutput == STRING_DATA);
+
+        run("select bfcolumn.bf1, bgcolumn.bf3@tbl1, bfcolumn.bf2, bgcolumn.bf1@tbl2 from table1");
+        for (int row = 0; row < INTEGER_DATA.size(); ++row) {
+            EXPECT(o.intOutput[4 * row] == BF1_DATA[row]);
+            EXPECT(o.intOutput[4 * row + 1] == BF3_DATA[row]);
+            EXPECT(o.intOutput[4 * row + 2] == BF2_DATA[row]);
+            EXPECT(o.intOutput[4 * row + 3] == BF1_DATA[row]);
+        }
+
+        run("select icol from table1 where bfcolumn.bf2 = 2");
+        EXPECT(o.intOutput == std::vector<long>({6666, 3333, 2222}));
+
+        run("select icol, scol from table1 where scol = 'cccc' or scol = 'a-longer-string'");
+        EXPECT(o.intOutput == std::vector<long>({9999, 8888, 7777, 6666, 3333}));
+        EXPECT(o.strOutput == std::vector<std::string>({"cccc", "a-longer-string", "cccc", "cccc", "a-longer-string"}));
+    }
+
+    SECTION("Test loading from CSV") {
+
+        std::istringstream csv(
+            "station,x,n\n"
+            "alpha,1.5,1\n"
+            "beta,,2\n"
+            "alpha,3,3\n"
+            "a-much-longer-name,4.25,4\n");
+
+        auto* table = new eckit::sql::SQLColumnarTable(db, "csv");
+        table->loadCSV(csv);
+        db.addTable(table);
+
+        EXPECT(table->rows() == 4);
+        EXPECT(table->column("station").type().getKind() == eckit::sql::type::SQLType::stringType);
+        EXPECT(table->column("station").dataSizeDoubles() == 3);
+        EXPECT(table->column("x").type().getKind() == eckit::sql::type::SQLType::realType);
+        EXPECT(table->column("n").type().getKind() == eckit::sql::type::SQLType::integerType);
+
+        // Empty numbers are missing, and never selected
+
+        run("select station, x, n from csv where x > 1");
+        EXPECT(o.strOutput == std::vector<std::string>({"alpha", "alpha", "a-much-longer-name"}));
+        EXPECT(o.floatOutput == std::vector<double>({1.5, 3, 4.25}));
+        EXPECT(o.intOutput == std::vector<long>({1, 3, 4}));
+
+        run("select n from csv where x is null");
+        EXPECT(o.intOutput == std::vector<long>({2}));
+    }
+}
+
+
+CASE("Test prepared statements") {
+
+    eckit::sql::SQLSession session(std::unique_ptr<TestOutput>(new TestOutput));
+    eckit::sql::SQLDatabase& db(session.currentDatabase());
+
+    std::vector<std::vector<double>> rows;
+    auto* table = makeObservationTable(db, rows);
+    db.addTable(new TestTable(db, "a/b/c.path", "table1"));
+
+    TestOutput& o(static_cast<TestOutput&>(session.output()));
+
+    auto expected = [&](double lower, double upper) {
+        std::vector<long> seqnos;
+        for (const auto& row : rows) {
+            if (row[0] >= lower && row[0] < upper) {
+                seqnos.push_back(row[0]);
+            }
+        }
+        return seqnos;
+    };
+
+    // Parameters are pushed down to the table, with the values bound for each execution
+
+    auto range = session.prepare("select seqno@obs from obs where seqno@obs >= ?1 and seqno@obs < ?2");
+
+    range->bindInteger(1, 5000);
+    range->bindInteger(2, 5600);
+    table->resetStatistics();
+    range->execute();
+    EXPECT(o.intOutput == expected(5000, 5600));
+    EXPECT(table->blocksRead() == 2);
+
+    range->bindReal(1, 100.5);
+    range->bindInteger(2, 110);
+    table->resetStatistics();
+    range->execute();
+    EXPECT(o.intOutput == expected(100.5, 110));
+    EXPECT(table->blocksRead() == 1);
+
+    // The same SQL shares the parsed statement, but each statement has its own parameters
+
+    auto other = session.prepare("  select seqno@obs  from obs\n where seqno@obs >= ?1 and seqno@obs < ?2;");
+    EXPECT(other != range);
+    EXPECT(&other->plan() == &range->plan());
+    EXPECT(session.preparedStatements() == 1);
+
+    other->bindInteger(1, 10);
+    other->bindInteger(2, 20);
+    range->execute();
+    EXPECT(o.intOutput == expected(100.5, 110));
+    other->execute();
+    EXPECT(o.intOutput == expected(10, 20));
+
+    EXPECT(range->executions() == 3);
+    EXPECT(other->executions() == 1);
+    EXPECT(range->plan().executions() == 4);
+
+    // Strings can be bound too
+
+    auto strings = session.prepare("select icol from table1 where scol = ?1");
+    strings->bindString(1, "cccc");
+    strings->execute();
+    EXPECT(o.intOutput == std::vector<long>({9999, 7777, 6666}));
+    strings->bindString(1, "a-longer-string");
+    strings->execute();
+    EXPECT(o.intOutput == std::vector<long>({8888, 3333}));
+
+    strings->clearBindings();
+    EXPECT_THROWS_AS(strings->execute(), eckit::UserError);
+
+    // The least recently used statements are dropped from the cache
+
+    ::setenv("ECKIT_SQL_PREPARED_STATEMENTS", "2", 1);
+    eckit::sql::SQLSession small(std::unique_ptr<TestOutput>(new TestOutput));
+    ::unsetenv("ECKIT_SQL_PREPARED_STATEMENTS");
+    small.currentDatabase().addTable(new TestTable(small.currentDatabase(), "a/b/c.path", "table1"));
+
+    auto first = small.prepare("select icol from table1 where icol = ?1");
+    auto rcol  = small.prepare("select icol from table1 where rcol = ?1");
+    EXPECT(&small.prepare("select icol from table1 where icol = ?1")->plan() == &first->plan());
+    small.prepare("select icol from table1 where scol = ?1");
+    EXPECT(small.preparedStatements() == 2);
+    EXPECT(&small.prepare("select icol from table1 where icol = ?1")->plan() == &first->plan());
+    EXPECT(&small.prepare("select icol from table1 where rcol = ?1")->plan() != &rcol->plan());
+
+    first->bindInteger(1, 6666);
+    first->execute();
+    EXPECT(static_cast<TestOutput&>(small.output()).intOutput == std::vector<long>({6666, 6666, 6666}));
+}
+
+
+CASE("Test executions of prepared statements sharing a plan do not overlap") {
+
+    // Keeps the results of every execution, and runs a nested statement when asked to
+
+    class RecordingOutput : public TestOutput {
+    public:
+        std::vector<std::vector<long>> results;
+        std::shared_ptr<eckit::sql::SQLPreparedStatement> nested;
+
+    private:
+        void flush() override {
+            std::swap(intOutput_, intOutput);
+            results.push_back(intOutput);
+            if (nested) {
+                auto statement = nested;
+                nested.reset();
+                statement->execute();
+            }
+        }
+    };
+
+    eckit::sql::SQLSession session(std::unique_ptr<RecordingOutput>(new RecordingOutput));
+    session.currentDatabase().addTable(new TestTable(session.currentDatabase(), "a/b/c.path", "table1"));
+
+    RecordingOutput& o(static_cast<RecordingOutput&>(session.output()));
+
+    const std::string sql("select icol from table1 where icol = ?1");
+    const std::vector<long> values{9999, 8888, 7777, 6666, 3333};
+    const size_t executions = 20;
+
+    std::vector<std::thread> threads;
+    for (long value : values) {
+        auto statement = session.prepare(sql);
+        statement->bindInteger(1, value);
+        threads.emplace_back([statement, executions] {
+            for (size_t i = 0; i < executions; ++i) {
+                statement->execute();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(session.preparedStatements() == 1);
+    EXPECT(session.prepare(sql)->plan().executions() == values.size() * executions);
+    EXPECT(o.results.size() == values.size() * executions);
+    for (const auto& result : o.results) {
+        EXPECT(!result.empty());
+        EXPECT(std::count(values.begin(), values.end(), result.front()) == 1);
+        EXPECT(std::count(result.begin(), result.end(), result.front()) == long(result.size()));
+    }
+
+    // A statement cannot be executed from within the execution of another sharing its plan
+
+    auto outer = session.prepare(sql);
+    outer->bindInteger(1, 9999);
+    o.nested = session.prepare(sql);
+    o.nested->bindInteger(1, 8888);
+    EXPECT_THROWS_AS(outer->execute(), eckit::UserError);
+
+    outer->execute();
+    EXPECT(o.intOutput == std::vector<long>({9999}));
+}
+
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace
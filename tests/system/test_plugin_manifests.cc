@@ -0,0 +1,253 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <utime.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eckit/bases/Loader.h"
+#include "eckit/filesystem/LocalPathName.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/system/LibraryManager.h"
+#include "eckit/system/Plugin.h"
+#include "eckit/system/StartupReport.h"
+#include "eckit/utils/Compressor.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::system;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Linked into the test, but only initialised when its compressor is first built
+class LazyPlugin : public Plugin {
+public:
+    LazyPlugin() :
+        Plugin("lazy-plugin") {}
+    static LazyPlugin& instance() {
+        static LazyPlugin instance;
+        return instance;
+    }
+    void init() override {
+        ++initialised_;
+        builder_.reset(new CompressorBuilder<NoCompressor>("lazy-compressor"));
+    }
+    void finalise() override { builder_.reset(); }
+    std::string version() const override { return "0.0.0"; }
+    std::string gitsha1(unsigned int count) const override { return "undefined"; }
+
+    int initialised_ = 0;
+
+private:
+    std::unique_ptr<CompressorBuilderBase> builder_;
+};
+
+REGISTER_LIBRARY(LazyPlugin);
+
+class CountingLoader : public Loader {
+public:
+    void execute() override { ++executed_; }
+    int executed_ = 0;
+};
+
+// Provides a compressor and a Loader, also only initialised on first use
+class LazyLoaderPlugin : public Plugin {
+public:
+    LazyLoaderPlugin() :
+        Plugin("lazy-loader-plugin") {}
+    static LazyLoaderPlugin& instance() {
+        static LazyLoaderPlugin instance;
+        return instance;
+    }
+    void init() override {
+        builder_.reset(new CompressorBuilder<NoCompressor>("lazy-checked"));
+        loader_.reset(new CountingLoader);
+    }
+    void finalise() override {
+        builder_.reset();
+        loader_.reset();
+    }
+    std::string version() const override { return "0.0.0"; }
+    std::string gitsha1(unsigned int count) const override { return "undefined"; }
+
+    std::unique_ptr<CompressorBuilderBase> builder_;
+    std::unique_ptr<CountingLoader> loader_;
+};
+
+// REGISTER_LIBRARY() can only be used once in a namespace
+static const LibraryRegistration<LazyLoaderPlugin> lazyLoaderPlugin;
+
+class LazyListedPlugin : public Plugin {
+public:
+    LazyListedPlugin() :
+        Plugin("lazy-listed-plugin") {}
+    static LazyListedPlugin& instance() {
+        static LazyListedPlugin instance;
+        return instance;
+    }
+    void init() override { builder_.reset(new CompressorBuilder<NoCompressor>("lazy-listed")); }
+    void finalise() override { builder_.reset(); }
+    std::string version() const override { return "0.0.0"; }
+    std::string gitsha1(unsigned int count) const override { return "undefined"; }
+
+private:
+    std::unique_ptr<CompressorBuilderBase> builder_;
+};
+
+static const LibraryRegistration<LazyListedPlugin> lazyListedPlugin;
+
+static LocalPathName directory;
+
+static void manifest(const std::string& name, const std::string& library, const std::string& factory) {
+    std::ofstream out(std::string(directory) + "/" + name + ".yml");
+    out << "plugin:\n"
+        << "  name: " << name << "\n"
+        << "  namespace: int.ecmwf\n"
+        << "  library: " << library << "\n"
+        << "  factories: [" << factory << "]\n";
+}
+
+/// Pretend the directory was not modified recently, so that its manifests can be cached
+static void age() {
+    static const time_t past = ::time(nullptr) - 60;
+    struct utimbuf times;
+    times.actime = times.modtime = past;
+    ::utime(directory.localPath(), &times);
+}
+
+static bool deferred(const std::string& plugin) {
+    std::vector<std::string> plugins = LibraryManager::deferredPlugins();
+    return std::find(plugins.begin(), plugins.end(), plugin) != plugins.end();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Plugins declaring their builders are deferred") {
+    // Tests do not load plugins at startup
+    LibraryManager::autoLoadPlugins({});
+
+    EXPECT(deferred("int.ecmwf.lazy-plugin"));
+    EXPECT(deferred("int.ecmwf.missing-plugin"));
+    EXPECT(LazyPlugin::instance().initialised_ == 0);
+
+    std::ostringstream report;
+    report << StartupReport::instance();
+    EXPECT(report.str().find("manifests") != std::string::npos);
+}
+
+CASE("Deferred plugins are loaded on first use of their builders") {
+    std::unique_ptr<Compressor> compressor(CompressorFactory::instance().build("Lazy-Compressor"));
+    EXPECT(compressor);
+    EXPECT(LazyPlugin::instance().initialised_ == 1);
+    EXPECT(!deferred("int.ecmwf.lazy-plugin"));
+    EXPECT(deferred("int.ecmwf.missing-plugin"));
+
+    EXPECT(!LibraryManager::loadPluginsFor("lazy-compressor"));
+}
+
+CASE("Checking for a builder loads its deferred plugin, and runs the plugin's Loaders") {
+    EXPECT(deferred("int.ecmwf.lazy-loader-plugin"));
+    EXPECT(!LazyLoaderPlugin::instance().loader_);
+
+    EXPECT(CompressorFactory::instance().has("lazy-checked"));
+    EXPECT(!deferred("int.ecmwf.lazy-loader-plugin"));
+
+    // Main has executed the Loaders before the plugin was loaded
+    EXPECT(LazyLoaderPlugin::instance().loader_);
+    EXPECT(LazyLoaderPlugin::instance().loader_->executed_ == 1);
+
+    // Once
+    Loader::executePending();
+    EXPECT(LazyLoaderPlugin::instance().loader_->executed_ == 1);
+
+    EXPECT(!CompressorFactory::instance().has("no-such-compressor"));
+}
+
+CASE("Manifests are read from the cache until their directory changes") {
+    // Add a manifest without changing the time of the directory: the cache does not have it
+    manifest("new-plugin", "no-such-library", "new-builder");
+    age();
+
+    LibraryManager::autoLoadPlugins({});
+    EXPECT(!deferred("int.ecmwf.new-plugin"));
+    EXPECT(deferred("int.ecmwf.missing-plugin"));
+    EXPECT(LazyPlugin::instance().initialised_ == 1);
+
+    // Then touch the directory
+    ::utime(directory.localPath(), nullptr);
+
+    LibraryManager::autoLoadPlugins({});
+    EXPECT(deferred("int.ecmwf.new-plugin"));
+    EXPECT(LibraryManager::deferredPlugins().size() == 2);
+}
+
+CASE("Listing builders loads the deferred plugins, skipping those that fail") {
+    manifest("lazy-listed-plugin", "lazy-listed-plugin", "lazy-listed");
+    LibraryManager::autoLoadPlugins({});
+    EXPECT(deferred("int.ecmwf.lazy-listed-plugin"));
+    EXPECT(deferred("int.ecmwf.missing-plugin"));
+
+    std::ostringstream list;
+    CompressorFactory::instance().list(list);
+    EXPECT(list.str().find("lazy-listed") != std::string::npos);
+    EXPECT(LibraryManager::deferredPlugins().empty());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    using namespace eckit::test;
+
+    std::string tmp = ::getenv("TMPDIR") ? ::getenv("TMPDIR") : "/tmp";
+    directory       = PathName::unique(tmp + "/manifests").localPath();
+    directory.mkdir();
+
+    LocalPathName cache = PathName::unique(tmp + "/manifests-cache").localPath();
+
+    manifest("lazy-plugin", "lazy-plugin", "lazy-compressor");
+    manifest("lazy-loader-plugin", "lazy-loader-plugin", "lazy-checked");
+    manifest("missing-plugin", "no-such-library", "missing-builder");
+    age();
+
+    ::setenv("PLUGINS_MANIFEST_PATH", directory.localPath(), 1);
+    ::setenv("PLUGINS_MANIFEST_CACHE", cache.localPath(), 1);
+
+    int result = run_tests(argc, argv);
+
+    std::vector<LocalPathName> files;
+    std::vector<LocalPathName> dirs;
+    for (const auto& dir : {directory, cache}) {
+        if (dir.exists()) {
+            dir.children(files, dirs);
+        }
+    }
+    for (const auto& f : files) {
+        f.unlink();
+    }
+    directory.rmdir();
+    if (cache.exists()) {
+        cache.rmdir();
+    }
+
+    return result;
+}
@@ -0,0 +1,115 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/os/SamplingProfiler.h"
+#include "eckit/utils/MD5.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static uint64_t total(const std::string& folded, const std::string& frame) {
+    std::istringstream in(folded);
+    std::string line;
+    uint64_t n = 0;
+    while (std::getline(in, line)) {
+        size_t space = line.rfind(' ');
+        EXPECT(space != std::string::npos);
+        if (line.find(frame) != std::string::npos) {
+            n += std::stoull(line.substr(space + 1));
+        }
+    }
+    return n;
+}
+
+CASE("CPU samples are collected while running") {
+
+    SamplingProfiler& profiler = SamplingProfiler::instance();
+    profiler.clear();
+    profiler.start();
+    EXPECT(profiler.running());
+
+    std::string data(1024 * 1024, 'x');
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500)) {
+        MD5 md5;
+        md5.add(data.data(), data.size());
+        md5.digest();
+    }
+
+    profiler.stop();
+    EXPECT(!profiler.running());
+
+    size_t samples = profiler.samples(SamplingProfiler::CPU);
+    EXPECT(samples > 10);
+
+    std::ostringstream folded;
+    profiler.folded(folded);
+    EXPECT(total(folded.str(), "") == samples);
+    EXPECT(total(folded.str(), "eckit::MD5") > samples / 2);
+
+    // Legacy pprof: a header of 5 words, with the sampling period
+
+    std::ostringstream pprof;
+    profiler.pprof(pprof);
+    std::string p = pprof.str();
+    EXPECT(p.size() > 8 * sizeof(uintptr_t));
+
+    uintptr_t header[5];
+    ::memcpy(header, p.data(), sizeof(header));
+    EXPECT(header[0] == 0);
+    EXPECT(header[1] == 3);
+    EXPECT(header[3] == 10000);
+
+    profiler.clear();
+    EXPECT(profiler.samples(SamplingProfiler::CPU) == 0);
+}
+
+CASE("Allocations are sampled and weighted by size") {
+
+    SamplingProfiler& profiler = SamplingProfiler::instance();
+    profiler.clear();
+    profiler.startAllocations();
+
+    for (size_t i = 0; i < 8; ++i) {
+        Buffer b(1024 * 1024);
+    }
+
+    profiler.stopAllocations();
+
+    EXPECT(profiler.samples(SamplingProfiler::ALLOCATIONS) == 8);
+
+    std::ostringstream folded;
+    profiler.folded(folded, SamplingProfiler::ALLOCATIONS);
+    EXPECT(total(folded.str(), "eckit::Buffer::Buffer") == 8 * 1024 * 1024);
+
+    profiler.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,233 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/transaction/TxnJournal.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+void append(TxnJournal& journal, TxnJournal::Operation operation, TxnID id, const std::string& state) {
+    journal.append(operation, id, state.data(), state.size());
+}
+
+std::vector<PathName> segments(const PathName& dir) {
+    std::vector<PathName> result;
+    PathName::match(dir + "/[0-9]*.wal", result);
+    return result;
+}
+
+}  // namespace
+
+CASE("Transactions are recovered when the journal is reopened") {
+
+    TmpDir dir;
+
+    {
+        TxnJournal journal(dir);
+        EXPECT(journal.transactions().empty());
+
+        append(journal, TxnJournal::BEGIN, 1, "one");
+        append(journal, TxnJournal::BEGIN, 2, "two");
+        append(journal, TxnJournal::BEGIN, 3, "three");
+        append(journal, TxnJournal::UPDATE, 2, "two, updated");
+        journal.append(TxnJournal::END, 1);
+
+        EXPECT(!journal.active(1));
+        EXPECT(journal.active(2));
+    }
+
+    TxnJournal journal(dir);
+
+    auto t = journal.transactions();
+    EXPECT(t.size() == 2);
+    EXPECT(t[0].id_ == 2);
+    EXPECT(t[0].state_ == "two, updated");
+    EXPECT(t[1].id_ == 3);
+    EXPECT(t[1].state_ == "three");
+    EXPECT(journal.lastID() == 3);
+}
+
+CASE("An incomplete record at the end of the journal is discarded") {
+
+    TmpDir dir;
+
+    {
+        TxnJournal journal(dir);
+        append(journal, TxnJournal::BEGIN, 1, "one");
+        append(journal, TxnJournal::BEGIN, 2, "two");
+    }
+
+    auto files = segments(dir);
+    EXPECT(files.size() == 1);
+
+    PathName path = files[0];
+    Length valid  = path.size();
+
+    // A torn write: a record header, and half of its state
+
+    {
+        TxnJournal journal(dir);
+        append(journal, TxnJournal::BEGIN, 3, "three");
+    }
+    Length size = path.size();
+    EXPECT(::truncate(path.localPath(), size - Length(2)) == 0);
+
+    {
+        TxnJournal journal(dir);
+        EXPECT(journal.transactions().size() == 2);
+        EXPECT(!journal.active(3));
+        EXPECT(path.size() == valid);
+
+        // Appends go after the last valid record
+        append(journal, TxnJournal::BEGIN, 4, "four");
+    }
+
+    TxnJournal journal(dir);
+    EXPECT(journal.transactions().size() == 3);
+    EXPECT(journal.active(4));
+}
+
+CASE("Segments are rotated and compacted") {
+
+    TmpDir dir;
+
+    ::setenv("ECKIT_TXN_JOURNAL_SEGMENT_SIZE", "256", 1);
+    ::setenv("ECKIT_TXN_JOURNAL_SEGMENTS", "2", 1);
+
+    {
+        TxnJournal journal(dir);
+
+        // A long running transaction, among many short ones
+
+        append(journal, TxnJournal::BEGIN, 1, "long");
+
+        for (TxnID id = 2; id < 100; ++id) {
+            append(journal, TxnJournal::BEGIN, id, "short");
+            journal.append(TxnJournal::END, id);
+            EXPECT(journal.segments() <= 2);
+        }
+
+        EXPECT(segments(dir).size() <= 2);
+
+        journal.compact();
+        EXPECT(journal.segments() == 1);
+        EXPECT(segments(dir).size() == 1);
+    }
+
+    TxnJournal journal(dir);
+
+    auto t = journal.transactions();
+    EXPECT(t.size() == 1);
+    EXPECT(t[0].id_ == 1);
+    EXPECT(t[0].state_ == "long");
+
+    ::unsetenv("ECKIT_TXN_JOURNAL_SEGMENT_SIZE");
+    ::unsetenv("ECKIT_TXN_JOURNAL_SEGMENTS");
+}
+
+CASE("A journal can only be opened once at a time") {
+
+    TmpDir dir;
+
+    {
+        TxnJournal journal(dir);
+        append(journal, TxnJournal::BEGIN, 1, "one");
+
+        EXPECT_THROWS_AS(TxnJournal second(dir), UserError);
+
+        // Nor by another process
+
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            try {
+                TxnJournal other(dir);
+            }
+            catch (const UserError&) {
+                ::_exit(1);
+            }
+            ::_exit(0);
+        }
+
+        int status = 0;
+        EXPECT(::waitpid(pid, &status, 0) == pid);
+        EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+    }
+
+    // Closing the journal releases it
+
+    TxnJournal journal(dir);
+    EXPECT(journal.active(1));
+}
+
+CASE("Concurrent appends are all committed") {
+
+    TmpDir dir;
+
+    const size_t threads = 4;
+    const size_t count   = 100;
+
+    {
+        TxnJournal journal(dir);
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&journal, i] {
+                for (size_t j = 0; j < count; ++j) {
+                    TxnID id = i * count + j + 1;
+                    append(journal, TxnJournal::BEGIN, id, std::to_string(id));
+                    if (j % 2) {
+                        journal.append(TxnJournal::END, id);
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        EXPECT(journal.transactions().size() == threads * count / 2);
+    }
+
+    TxnJournal journal(dir);
+
+    auto t = journal.transactions();
+    EXPECT(t.size() == threads * count / 2);
+    for (const auto& x : t) {
+        EXPECT(x.state_ == std::to_string(x.id_));
+    }
+    EXPECT(journal.lastID() == threads * count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
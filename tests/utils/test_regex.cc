@@ -0,0 +1,150 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/utils/Regex.h"
+#include "eckit/utils/RegexDFA.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const std::vector<std::string> strings{
+    "",      "a",       "abc",     "xabcx",   "aaab",     "ab\nb",    "0x1F",       "-12_3",       "+1.5e-3",
+    ".nan",  ".Inf",    "-.inf",   "1.",      "foo.grib", "foo_grib", "a{2}",       "a+b",         "(a)",
+    "[a]",   "x\ny",    "aaaaaaa", "bbbbbba", "0o17",     "1_000",    "data.grib2", "dir/f.grib",  "abab",
+};
+
+static void compare(const std::string& pattern, bool extended = true, bool shell = false) {
+    Regex posix(pattern, shell, extended, Regex::POSIX);
+    Regex dfa(pattern, shell, extended, Regex::DFA);
+    EXPECT(posix.engine() == Regex::POSIX);
+
+    for (const auto& s : strings) {
+        if (posix.match(s) != dfa.match(s)) {
+            Log::error() << posix << (extended ? " ERE" : " BRE") << " on '" << s << "': posix=" << posix.match(s)
+                         << ", dfa=" << dfa.match(s) << std::endl;
+        }
+        EXPECT(posix.match(s) == dfa.match(s));
+    }
+}
+
+CASE("Extended expressions match as regexec() does") {
+    for (const char* pattern :
+         {"", "a", "abc", "^abc$", "^a", "c$", "b+", "a*", "^a*$", "a?b", "a|b|^c", "(ab)+", "(a|b)*c", "[a-c]+x",
+          "[^a]", "[]a]", "[a-]", "^[[:digit:]]+$", "[[:alpha:]_]+", "a{2}", "a{1,2}b", "a{2,}", "\\.grib$",
+          "^(\\.(nan|NaN|NAN)|[-+]?\\.(inf|Inf|INF))$", "^[-+]?(\\.[0-9_]+|[0-9_]+(\\.[0-9_]*)?)([eE][-+]?[0-9]+)?$",
+          "0x[0-9a-fA-F_]+$", "x.y", "(^a|b$)", "((a*)*|b)c", "\\{", "a}"}) {
+        compare(pattern);
+    }
+}
+
+CASE("Basic expressions match as regexec() does") {
+    for (const char* pattern : {"^0o[0-7_]+$", "^[-+]?[0-9_]+$", "0x[0-9a-fA-F_]+$", "a+b", "(a)", "a{2}", "a\\{2\\}",
+                                "\\(ab\\)*", "^a*$", "a?", "[a]", "\\[a\\]", "x.y"}) {
+        compare(pattern, false);
+    }
+}
+
+CASE("Shell patterns") {
+    for (const char* pattern : {"*.grib", "foo*", "*", "?", "dir/*.grib*", "[fd]*"}) {
+        compare(pattern, true, true);
+    }
+
+    Regex re("*.grib", true);
+    EXPECT(re.match("foo.grib"));
+    EXPECT(!re.match("foo.grib2"));
+    EXPECT(!re.match("foo_grib"));
+}
+
+CASE("Unsupported syntax is left to regexec()") {
+    Regex backref("\\(a\\)\\1", false, false, Regex::DFA);
+    EXPECT(backref.engine() == Regex::POSIX);
+    EXPECT(backref.match("xaa"));
+    EXPECT(!backref.match("xab"));
+
+    // glibc lets '$' match before a newline that follows in the match
+    Regex dollar("a$\nb", false, true, Regex::DFA);
+    EXPECT(dollar.engine() == Regex::POSIX);
+
+    EXPECT(Regex("[0-9]+", false, true, Regex::DFA).engine() == Regex::DFA);
+    EXPECT_THROWS_AS(Regex("a(", false, true, Regex::DFA), SeriousBug);
+}
+
+CASE("Strings are matched up to the first NUL, as regexec() does") {
+    std::string s("ab");
+    s += '\0';
+    s += "cd";
+
+    for (auto engine : {Regex::POSIX, Regex::DFA}) {
+        EXPECT(Regex("b$", false, true, engine).match(s));
+        EXPECT(!Regex("cd", false, true, engine).match(s));
+        EXPECT(!Regex("^ab.c", false, true, engine).match(s));
+    }
+}
+
+CASE("Literals and automata") {
+    EXPECT(RegexDFA::compile("^[0-9]+\\.grib$", true)->literal() == ".grib");
+    EXPECT(RegexDFA::compile("(a|b)xyz+", true)->literal() == "xy");
+    EXPECT(RegexDFA::compile("a|b", true)->literal().empty());
+
+    // Too many states for a DFA: the NFA is simulated
+    std::unique_ptr<RegexDFA> large = RegexDFA::compile("(a|b)*a(a|b){14}", true);
+    EXPECT(large->states() == 0);
+
+    std::string s(20, 'b');
+    EXPECT(!large->search(s.data(), s.size()));
+    s[3] = 'a';
+    EXPECT(large->search(s.data(), s.size()));
+    s[3] = 'b';
+    s[10] = 'a';
+    EXPECT(!large->search(s.data(), s.size()));
+}
+
+CASE("No backtracking") {
+    std::string s(100000, 'a');
+    Regex re("(a|aa)*(a*)*b", false, true, Regex::DFA);
+    EXPECT(re.engine() == Regex::DFA);
+    EXPECT(!re.match(s));
+    s += 'b';
+    EXPECT(re.match(s));
+}
+
+CASE("Batch matching") {
+    Regex re("^[-+]?[0-9_]+$");
+
+    std::vector<bool> result;
+    re.match(strings, result);
+    EXPECT(result.size() == strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+        EXPECT(result[i] == re.match(strings[i]));
+    }
+
+    Regex copy(re);
+    EXPECT(copy == re);
+    EXPECT(copy.match("-12_3"));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -166,6 +166,14 @@ CASE("back_trim") {
     EXPECT(StringTools::back_trim(t7, "0") == string("000001"));
 }
 
+CASE("join") {
+    EXPECT(StringTools::join(",", vector<string>{"a", "b", "c"}) == "a,b,c");
+    EXPECT(StringTools::join(",", vector<string>{}).empty());
+
+    EXPECT(StringTools::join(", ", vector<int>{1, -2, 3}) == "1, -2, 3");
+    EXPECT(StringTools::join("/", vector<double>{0.1, 0.1 + 0.2, 1e100, -0.5}) == "0.1/0.30000000000000004/1e+100/-0.5");
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
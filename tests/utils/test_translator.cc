@@ -8,11 +8,16 @@
  * does it submit to any jurisdiction.
  */
 
+#include <limits>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "eckit/eckit.h"
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/utils/NumberConversion.h"
 #include "eckit/utils/StringTools.h"
 #include "eckit/utils/Translator.h"
 
@@ -131,6 +136,104 @@ CASE("Translate strings to double") {
     EXPECT_THROWS_AS(t("foo555bar"), BadParameter);
 }
 
+CASE("Translate strings to integers as strtol() does") {
+    Translator<string, long> toLong;
+    Translator<string, unsigned long> toULong;
+    Translator<string, int> toInt;
+
+    EXPECT(toLong(" -5") == -5);
+    EXPECT(toLong("+7 MB") == 7 * 1024 * 1024);
+    EXPECT(toLong("12abc") == 12);
+    EXPECT(toLong("abc") == 0);
+    EXPECT(toLong("+-3") == 0);
+    EXPECT(toLong("99999999999999999999") == numeric_limits<long>::max());
+    EXPECT(toLong("-99999999999999999999") == numeric_limits<long>::min());
+
+    EXPECT(toULong("-1") == numeric_limits<unsigned long>::max());
+    EXPECT(toULong("18446744073709551615") == numeric_limits<unsigned long>::max());
+
+    EXPECT(toInt("on") == 1);
+    EXPECT(toInt("-2kb") == -2048);
+    EXPECT(translate<bool>(string("2")));
+}
+
+CASE("Translate numbers to strings as std::ostream does") {
+    for (double d : {0., -0., 0.5, 0.1 + 0.2, 1. / 3., 1e100, -1e-100, 123456789., 0.0001, 0.00001,
+                     numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN(),
+                     numeric_limits<double>::denorm_min(), numeric_limits<double>::max()}) {
+        ostringstream s;
+        s << d;
+        EXPECT(translate<string>(d) == s.str());
+
+        ostringstream f;
+        f << float(d);
+        EXPECT(translate<string>(float(d)) == f.str());
+    }
+
+    EXPECT(translate<string>(numeric_limits<long long>::min()) == "-9223372036854775808");
+    EXPECT(translate<string>(numeric_limits<unsigned long>::max()) == "18446744073709551615");
+    EXPECT(translate<string>(short(-7)) == "-7");
+    EXPECT(translate<string>(true) == "1");
+    EXPECT(translate<string>((unsigned char)'x') == "x");
+    EXPECT(translate<string>(vector<long>{1, -2, 3}) == "1 -2 3");
+}
+
+CASE("Shortest round-trip conversions") {
+    EXPECT(NumberConversion::toString(0.1) == "0.1");
+    EXPECT(NumberConversion::toString(0.1 + 0.2) == "0.30000000000000004");
+    EXPECT(NumberConversion::toString(1e100) == "1e+100");
+    EXPECT(NumberConversion::toString(0.1f) == "0.1");
+    EXPECT(NumberConversion::toString(1. / 3., 3) == "0.333");
+    EXPECT(NumberConversion::toString(1. / 3., 30).size() == 32);
+
+    for (double d : {1. / 3., 2. / 3., 1e-300, 6.02214076e23, -numeric_limits<double>::max()}) {
+        EXPECT(NumberConversion::parse<double>(NumberConversion::toString(d)) == d);
+    }
+
+    char buffer[4];
+    EXPECT(NumberConversion::format(buffer, buffer + sizeof(buffer), 123) == buffer + 3);
+    EXPECT_THROWS_AS(NumberConversion::format(buffer, buffer + sizeof(buffer), 12345), BadParameter);
+}
+
+CASE("Parsing does not copy, and is strict") {
+    string_view line("12,-3.5,x");
+
+    EXPECT(NumberConversion::parse<int>(line.substr(0, 2)) == 12);
+    EXPECT(NumberConversion::parse<double>(line.substr(3, 4)) == -3.5);
+
+    int i;
+    EXPECT(NumberConversion::parse("+12", i) && i == 12);
+    EXPECT(!NumberConversion::parse("12 ", i));
+    EXPECT(!NumberConversion::parse(" 12", i));
+    EXPECT(!NumberConversion::parse("+-12", i));
+    EXPECT(!NumberConversion::parse("2147483648", i));
+
+    unsigned int u;
+    EXPECT(!NumberConversion::parse("-1", u));
+
+    EXPECT_THROWS_AS(NumberConversion::parse<double>(line), BadParameter);
+    EXPECT_THROWS_AS(NumberConversion::parse<float>("1e39"), BadParameter);
+}
+
+CASE("Batch conversions") {
+    vector<double> values{0.5, -1., 1e-7, 3.25};
+
+    vector<string> strings;
+    NumberConversion::toString(values.data(), values.size(), strings);
+    EXPECT(strings == vector<string>({"0.5", "-1", "1e-07", "3.25"}));
+    EXPECT(NumberConversion::join(values.data(), values.size(), ",") == "0.5,-1,1e-07,3.25");
+
+    vector<double> back;
+    NumberConversion::parse(strings, back);
+    EXPECT(back == values);
+
+    vector<string_view> fields{"1", "2", "three"};
+    long longs[3];
+    EXPECT_THROWS_AS(NumberConversion::parse(fields.data(), fields.size(), longs), BadParameter);
+    NumberConversion::parse(fields.data(), 2, longs);
+    EXPECT(longs[0] == 1 && longs[1] == 2);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
@@ -0,0 +1,134 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eckit/log/Timer.h"
+#include "eckit/utils/NumberConversion.h"
+#include "eckit/utils/Translator.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const size_t N = 1000000;
+
+template <typename F>
+void time(const std::string& what, F f) {
+    size_t check = 0;
+
+    Timer timer;
+    for (size_t i = 0; i < N; ++i) {
+        check += f(i);
+    }
+    timer.stop();
+
+    std::cout << " - " << what << ": " << (timer.elapsed() * 1e9 / N) << " ns per value (" << check << ")"
+              << std::endl;
+}
+
+static std::vector<double> doubles() {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(-1e6, 1e6);
+
+    std::vector<double> values(N);
+    for (auto& v : values) {
+        v = uniform(random);
+    }
+    return values;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Formatting doubles") {
+    std::vector<double> values = doubles();
+
+    time("std::ostringstream", [&](size_t i) {
+        std::ostringstream s;
+        s << values[i];
+        return s.str().size();
+    });
+
+    time("Translator", [&](size_t i) { return Translator<double, std::string>()(values[i]).size(); });
+
+    time("NumberConversion, shortest", [&](size_t i) { return NumberConversion::toString(values[i]).size(); });
+
+    char buffer[NumberConversion::maxLength];
+    time("NumberConversion, into a buffer", [&](size_t i) {
+        return size_t(NumberConversion::format(buffer, buffer + sizeof(buffer), values[i]) - buffer);
+    });
+
+    std::vector<std::string> strings;
+    Timer timer;
+    NumberConversion::toString(values.data(), values.size(), strings);
+    timer.stop();
+    std::cout << " - NumberConversion, batch: " << (timer.elapsed() * 1e9 / N) << " ns per value" << std::endl;
+}
+
+CASE("Formatting integers") {
+    time("std::ostringstream", [&](size_t i) {
+        std::ostringstream s;
+        s << long(i * 7919);
+        return s.str().size();
+    });
+
+    time("Translator", [&](size_t i) { return Translator<long, std::string>()(i * 7919).size(); });
+}
+
+CASE("Parsing doubles") {
+    std::vector<double> values = doubles();
+    std::vector<std::string> strings;
+    NumberConversion::toString(values.data(), values.size(), strings);
+
+    time("strtod", [&](size_t i) { return size_t(::strtod(strings[i].c_str(), nullptr) != 0.); });
+
+    time("Translator", [&](size_t i) { return size_t(Translator<std::string, double>()(strings[i]) != 0.); });
+
+    std::vector<double> back;
+    Timer timer;
+    NumberConversion::parse(strings, back);
+    timer.stop();
+    std::cout << " - NumberConversion, batch: " << (timer.elapsed() * 1e9 / N) << " ns per value" << std::endl;
+
+    EXPECT(back == values);
+}
+
+CASE("Parsing integers") {
+    std::vector<long> values(N);
+    for (size_t i = 0; i < N; ++i) {
+        values[i] = long(i * 7919) - long(N);
+    }
+    std::vector<std::string> strings;
+    NumberConversion::toString(values.data(), values.size(), strings);
+
+    time("strtol", [&](size_t i) { return size_t(::strtol(strings[i].c_str(), nullptr, 10)); });
+
+    time("Translator", [&](size_t i) { return size_t(Translator<std::string, long>()(strings[i])); });
+
+    time("NumberConversion", [&](size_t i) { return size_t(NumberConversion::parse<long>(strings[i])); });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}